@@ -17,6 +17,7 @@ typedef struct apx_client_tag
 {
    apx_clientConnection_t *connection;
    apx_nodeManager_t nodeManager;
+   char sessionToken[RMF_SESSION_TOKEN_MAX_LEN+1]; //sent in the greeting when not empty, allows the server to resume our nodes after a short disconnect
 }apx_client_t;
 
 //////////////////////////////////////////////////////////////////////////////
@@ -35,5 +36,6 @@ void apx_client_vdelete(void *arg);
 
 int8_t apx_client_connect_tcp(apx_client_t *self, const char *address, uint16_t port);
 void apx_client_attachLocalNode(apx_client_t *self, apx_nodeData_t *nodeData);
+int8_t apx_client_setSessionToken(apx_client_t *self, const char *sessionToken);
 
 #endif //APX_CLIENT_H
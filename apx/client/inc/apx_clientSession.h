@@ -17,6 +17,7 @@
 #include <semaphore.h>
 #endif
 #include "osmacro.h"
+#include "ringbuf.h"
 #include "apx_clientConnection.h"
 #include "apx_sessionCmd.h"
 
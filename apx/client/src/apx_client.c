@@ -42,6 +42,7 @@ int8_t apx_client_create(apx_client_t *self)
    if( self != 0 )
    {
       self->connection = 0;
+      self->sessionToken[0] = 0;
       apx_nodeManager_create(&self->nodeManager);
    }
    errno=EINVAL;
@@ -129,6 +130,22 @@ void apx_client_attachLocalNode(apx_client_t *self, apx_nodeData_t *nodeData)
    }
 }
 
+/**
+ * Sets the session token that is presented to the server in the greeting of every (re)connect.
+ * A server with a session grace period rebinds our nodes without rebuilding its routing tables when we reconnect in time.
+ * The token must be unique per client and may only contain printable characters.
+ */
+int8_t apx_client_setSessionToken(apx_client_t *self, const char *sessionToken)
+{
+   if ( (self != 0) && (sessionToken != 0) && (strlen(sessionToken) <= RMF_SESSION_TOKEN_MAX_LEN) )
+   {
+      strcpy(self->sessionToken, sessionToken);
+      return 0;
+   }
+   errno = EINVAL;
+   return -1;
+}
+
 
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL FUNCTIONS
@@ -116,6 +116,7 @@ void apx_clientConnection_start(apx_clientConnection_t *self)
    {
       apx_transmitHandler_t serverTransmitHandler;
       //register transmit handler with our fileManager
+      memset(&serverTransmitHandler, 0, sizeof(serverTransmitHandler));
       serverTransmitHandler.arg = self;
       serverTransmitHandler.send = apx_clientConnection_send;
       serverTransmitHandler.getSendAvail = 0;
@@ -173,6 +174,12 @@ void apx_clientConnection_sendGreeting(apx_clientConnection_t *self)
    uint32_t greetingLen;
    char greeting[RMF_GREETING_MAX_LEN];
    strcpy(greeting, RMF_GREETING_START);
+   if ( (self->client != 0) && (self->client->sessionToken[0] != 0) )
+   {
+      strcat(greeting, RMF_SESSION_TOKEN_HEADER " ");
+      strcat(greeting, self->client->sessionToken);
+      strcat(greeting, "\n");
+   }
    //headers end with an additional newline
    strcat(greeting, "\n");
    greetingLen = (uint32_t) strlen(greeting);
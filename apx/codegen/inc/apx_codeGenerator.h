@@ -0,0 +1,22 @@
+#ifndef APX_CODE_GENERATOR_H
+#define APX_CODE_GENERATOR_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdint.h>
+#include "apx_node.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APX_CODE_GENERATOR_FILE_PREFIX "ApxCodec_"
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+int8_t apx_codeGenerator_writeHeader(FILE *fp, apx_node_t *node, const char *sourceName);
+int8_t apx_codeGenerator_generateFile(apx_node_t *node, const char *outputDir, const char *sourceName);
+
+#endif //APX_CODE_GENERATOR_H
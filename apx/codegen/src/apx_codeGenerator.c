@@ -0,0 +1,774 @@
+/*****************************************************************************
+* \file:    apx_codeGenerator.c
+* \brief:   Generates C headers with inline pack/unpack functions for the ports of an APX node
+*
+* The generated header has no dependencies besides stdint.h and string.h.
+* Values are always written and read byte by byte in little-endian order so the generated code is correct on any host.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include <errno.h>
+#include "apx_codeGenerator.h"
+#include "apx_port.h"
+#include "apx_dataSignature.h"
+#include "apx_error.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#ifdef _MSC_VER
+#define snprintf _snprintf
+#endif
+
+#define MAX_EXPR_LEN 512            //maximum length of a generated value expression, e.g. "value->Status[i1].Name"
+#define MAX_PATH_LEN 1024
+#define INDENT_SIZE 3
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static int8_t writePortConstants(FILE *fp, const char *nodeName, apx_port_t *port, uint32_t offset);
+static int8_t writePortType(FILE *fp, const char *nodeName, apx_port_t *port);
+static int8_t writeStructMembers(FILE *fp, apx_dataElement_t *record, int indent);
+static int8_t writePortFunctions(FILE *fp, const char *nodeName, apx_port_t *port);
+static int8_t writePackStatements(FILE *fp, apx_dataElement_t *element, const char *expr, const char *base, uint32_t offset, int indent, int depth, bool isPack);
+static int8_t writeRecordStatements(FILE *fp, apx_dataElement_t *record, const char *prefix, const char *base, uint32_t offset, int indent, int depth, bool isPack);
+static void writePrimitive(FILE *fp, int8_t baseType, const char *expr, const char *base, uint32_t offset, int indent, bool isPack);
+static void writeIdentifier(FILE *fp, const char *name);
+static void writeUpperIdentifier(FILE *fp, const char *name);
+static void writeIndent(FILE *fp, int indent);
+static int8_t makeMemberName(char *buf, size_t bufLen, apx_dataElement_t *element, int32_t index);
+static const char *getTypeName(int8_t baseType);
+static uint32_t getTypeSize(int8_t baseType);
+static bool isPrimitiveType(int8_t baseType);
+static uint32_t calcElementSize(apx_dataElement_t *element);
+static uint32_t calcPackLen(apx_dataElement_t *element);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Writes the generated header for node to fp.
+ * Require ports make up the in-port data and provide ports the out-port data, both laid out in port order.
+ * sourceName is only used in the banner comment. Returns 0 on success, -1 on failure with errno set to an APX error code.
+ */
+int8_t apx_codeGenerator_writeHeader(FILE *fp, apx_node_t *node, const char *sourceName)
+{
+   int32_t numRequirePorts;
+   int32_t numProvidePorts;
+   int32_t i;
+   uint32_t inPortDataLen = 0;
+   uint32_t outPortDataLen = 0;
+   const char *nodeName;
+   if ( (fp == 0) || (node == 0) || (node->name == 0) )
+   {
+      errno = APX_INVALID_ARGUMENT_ERROR;
+      return -1;
+   }
+   nodeName = node->name;
+   numRequirePorts = apx_node_getNumRequirePorts(node);
+   numProvidePorts = apx_node_getNumProvidePorts(node);
+   for (i=0; i<numRequirePorts; i++)
+   {
+      inPortDataLen += (uint32_t) apx_port_getPackLen(apx_node_getRequirePort(node, i));
+   }
+   for (i=0; i<numProvidePorts; i++)
+   {
+      outPortDataLen += (uint32_t) apx_port_getPackLen(apx_node_getProvidePort(node, i));
+   }
+   fprintf(fp, "/* Generated by apx_codegen from %s. Do not edit. */\n", (sourceName != 0)? sourceName : "<unknown>");
+   fprintf(fp, "#ifndef APXCODEC_");
+   writeUpperIdentifier(fp, nodeName);
+   fprintf(fp, "_H\n#define APXCODEC_");
+   writeUpperIdentifier(fp, nodeName);
+   fprintf(fp, "_H\n\n");
+   fprintf(fp, "#include <stdint.h>\n#include <string.h>\n\n");
+   fprintf(fp, "#ifndef APX_CODEC_INLINE\n");
+   fprintf(fp, "#if defined(_MSC_VER) && !defined(__cplusplus)\n");
+   fprintf(fp, "#define APX_CODEC_INLINE static __inline\n");
+   fprintf(fp, "#else\n");
+   fprintf(fp, "#define APX_CODEC_INLINE static inline\n");
+   fprintf(fp, "#endif\n");
+   fprintf(fp, "#endif\n\n");
+   fprintf(fp, "#define APX_IN_PORT_DATA_LEN_");
+   writeIdentifier(fp, nodeName);
+   fprintf(fp, " %uu\n", inPortDataLen);
+   fprintf(fp, "#define APX_OUT_PORT_DATA_LEN_");
+   writeIdentifier(fp, nodeName);
+   fprintf(fp, " %uu\n\n", outPortDataLen);
+
+   inPortDataLen = 0;
+   for (i=0; i<numRequirePorts; i++)
+   {
+      apx_port_t *port = apx_node_getRequirePort(node, i);
+      if (writePortConstants(fp, nodeName, port, inPortDataLen) != 0)
+      {
+         return -1;
+      }
+      inPortDataLen += (uint32_t) apx_port_getPackLen(port);
+   }
+   outPortDataLen = 0;
+   for (i=0; i<numProvidePorts; i++)
+   {
+      apx_port_t *port = apx_node_getProvidePort(node, i);
+      if (writePortConstants(fp, nodeName, port, outPortDataLen) != 0)
+      {
+         return -1;
+      }
+      outPortDataLen += (uint32_t) apx_port_getPackLen(port);
+   }
+   fprintf(fp, "\n");
+   for (i=0; i<numRequirePorts; i++)
+   {
+      apx_port_t *port = apx_node_getRequirePort(node, i);
+      if ( (writePortType(fp, nodeName, port) != 0) || (writePortFunctions(fp, nodeName, port) != 0) )
+      {
+         return -1;
+      }
+   }
+   for (i=0; i<numProvidePorts; i++)
+   {
+      apx_port_t *port = apx_node_getProvidePort(node, i);
+      if ( (writePortType(fp, nodeName, port) != 0) || (writePortFunctions(fp, nodeName, port) != 0) )
+      {
+         return -1;
+      }
+   }
+   fprintf(fp, "#endif /* APXCODEC_");
+   writeUpperIdentifier(fp, nodeName);
+   fprintf(fp, "_H */\n");
+   if (ferror(fp) != 0)
+   {
+      errno = APX_TRANSMIT_ERROR;
+      return -1;
+   }
+   return 0;
+}
+
+/**
+ * Writes the header for node into the file <outputDir>/ApxCodec_<node name>.h
+ */
+int8_t apx_codeGenerator_generateFile(apx_node_t *node, const char *outputDir, const char *sourceName)
+{
+   char path[MAX_PATH_LEN];
+   int len;
+   int8_t result;
+   FILE *fp;
+   if ( (node == 0) || (node->name == 0) )
+   {
+      errno = APX_INVALID_ARGUMENT_ERROR;
+      return -1;
+   }
+   if ( (outputDir == 0) || (outputDir[0] == '\0') )
+   {
+      outputDir = ".";
+   }
+   len = snprintf(path, sizeof(path), "%s/%s%s.h", outputDir, APX_CODE_GENERATOR_FILE_PREFIX, node->name);
+   if ( (len < 0) || (len >= (int) sizeof(path)) )
+   {
+      errno = APX_NAME_TOO_LONG_ERROR;
+      return -1;
+   }
+   fp = fopen(path, "w");
+   if (fp == 0)
+   {
+      errno = APX_MISSING_FILE_ERROR;
+      return -1;
+   }
+   result = apx_codeGenerator_writeHeader(fp, node, sourceName);
+   if (fclose(fp) != 0)
+   {
+      errno = APX_TRANSMIT_ERROR;
+      result = -1;
+   }
+   return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static int8_t writePortConstants(FILE *fp, const char *nodeName, apx_port_t *port, uint32_t offset)
+{
+   if ( (port == 0) || (port->derivedDsg.dataElement == 0) )
+   {
+      errno = APX_DATA_SIGNATURE_ERROR;
+      return -1;
+   }
+   fprintf(fp, "#define APX_OFFSET_");
+   writeIdentifier(fp, nodeName);
+   fprintf(fp, "_");
+   writeIdentifier(fp, port->name);
+   fprintf(fp, " %uu\n", offset);
+   fprintf(fp, "#define APX_LEN_");
+   writeIdentifier(fp, nodeName);
+   fprintf(fp, "_");
+   writeIdentifier(fp, port->name);
+   fprintf(fp, " %uu\n", (uint32_t) apx_port_getPackLen(port));
+   return 0;
+}
+
+/**
+ * record ports get a struct type named ApxCodec_<node>_<port>_T, other ports use the plain stdint types
+ */
+static int8_t writePortType(FILE *fp, const char *nodeName, apx_port_t *port)
+{
+   apx_dataElement_t *element = port->derivedDsg.dataElement;
+   if (element->baseType != APX_BASE_TYPE_RECORD)
+   {
+      return 0;
+   }
+   fprintf(fp, "typedef struct ApxCodec_");
+   writeIdentifier(fp, nodeName);
+   fprintf(fp, "_");
+   writeIdentifier(fp, port->name);
+   fprintf(fp, "_tag\n{\n");
+   if (writeStructMembers(fp, element, 1) != 0)
+   {
+      return -1;
+   }
+   fprintf(fp, "}ApxCodec_");
+   writeIdentifier(fp, nodeName);
+   fprintf(fp, "_");
+   writeIdentifier(fp, port->name);
+   fprintf(fp, "_T;\n\n");
+   return 0;
+}
+
+static int8_t writeStructMembers(FILE *fp, apx_dataElement_t *record, int indent)
+{
+   int32_t numChild = apx_dataElement_getNumChild(record);
+   int32_t i;
+   if (numChild <= 0)
+   {
+      errno = APX_DATA_SIGNATURE_ERROR;
+      return -1;
+   }
+   for (i=0; i<numChild; i++)
+   {
+      char name[MAX_EXPR_LEN];
+      apx_dataElement_t *child = apx_dataElement_getChildAt(record, i);
+      if (makeMemberName(name, sizeof(name), child, i) != 0)
+      {
+         return -1;
+      }
+      writeIndent(fp, indent);
+      if (child->baseType == APX_BASE_TYPE_RECORD)
+      {
+         fprintf(fp, "struct\n");
+         writeIndent(fp, indent);
+         fprintf(fp, "{\n");
+         if (writeStructMembers(fp, child, indent+1) != 0)
+         {
+            return -1;
+         }
+         writeIndent(fp, indent);
+         fprintf(fp, "}%s", name);
+         if (child->arrayLen > 0)
+         {
+            fprintf(fp, "[%u]", child->arrayLen);
+         }
+      }
+      else if (child->baseType == APX_BASE_TYPE_STRING)
+      {
+         fprintf(fp, "char %s[%u]", name, child->arrayLen);
+      }
+      else if (isPrimitiveType(child->baseType))
+      {
+         fprintf(fp, "%s %s", getTypeName(child->baseType), name);
+         if (child->arrayLen > 0)
+         {
+            fprintf(fp, "[%u]", child->arrayLen);
+         }
+      }
+      else
+      {
+         errno = APX_ELEMENT_TYPE_ERROR;
+         return -1;
+      }
+      fprintf(fp, ";\n");
+   }
+   return 0;
+}
+
+/**
+ * Writes ApxCodec_Pack_<node>_<port> and ApxCodec_Unpack_<node>_<port>.
+ * Scalars are passed by value, arrays, strings and records by pointer.
+ */
+static int8_t writePortFunctions(FILE *fp, const char *nodeName, apx_port_t *port)
+{
+   apx_dataElement_t *element = port->derivedDsg.dataElement;
+   const char *typeName;
+   bool isScalar = false;
+   int i;
+   if (element->baseType == APX_BASE_TYPE_STRING)
+   {
+      typeName = "char";
+   }
+   else if (element->baseType == APX_BASE_TYPE_RECORD)
+   {
+      typeName = 0;
+   }
+   else if (isPrimitiveType(element->baseType))
+   {
+      typeName = getTypeName(element->baseType);
+      isScalar = (element->arrayLen == 0);
+   }
+   else
+   {
+      errno = APX_ELEMENT_TYPE_ERROR;
+      return -1;
+   }
+   for (i=0; i<2; i++)
+   {
+      bool isPack = (i == 0);
+      int8_t result;
+      fprintf(fp, "APX_CODEC_INLINE ");
+      if (isPack || !isScalar)
+      {
+         fprintf(fp, "void");
+      }
+      else
+      {
+         fprintf(fp, "%s", typeName);
+      }
+      fprintf(fp, " ApxCodec_%s_", isPack? "Pack" : "Unpack");
+      writeIdentifier(fp, nodeName);
+      fprintf(fp, "_");
+      writeIdentifier(fp, port->name);
+      fprintf(fp, "(%s *p", isPack? "uint8_t" : "const uint8_t");
+      if (isScalar)
+      {
+         if (isPack)
+         {
+            fprintf(fp, ", %s value", typeName);
+         }
+      }
+      else
+      {
+         fprintf(fp, ", %s", isPack? "const " : "");
+         if (typeName != 0)
+         {
+            fprintf(fp, "%s", typeName);
+         }
+         else
+         {
+            fprintf(fp, "ApxCodec_");
+            writeIdentifier(fp, nodeName);
+            fprintf(fp, "_");
+            writeIdentifier(fp, port->name);
+            fprintf(fp, "_T");
+         }
+         fprintf(fp, " *value");
+      }
+      fprintf(fp, ")\n{\n");
+      if (isScalar && !isPack)
+      {
+         writeIndent(fp, 1);
+         fprintf(fp, "%s value;\n", typeName);
+      }
+      if (element->baseType == APX_BASE_TYPE_RECORD)
+      {
+         if (element->arrayLen > 0)
+         {
+            result = writePackStatements(fp, element, "value", "p", 0, 1, 0, isPack);
+         }
+         else
+         {
+            result = writeRecordStatements(fp, element, "value->", "p", 0, 1, 0, isPack);
+         }
+      }
+      else
+      {
+         result = writePackStatements(fp, element, "value", "p", 0, 1, 0, isPack);
+      }
+      if (result != 0)
+      {
+         return -1;
+      }
+      if (isScalar && !isPack)
+      {
+         writeIndent(fp, 1);
+         fprintf(fp, "return value;\n");
+      }
+      fprintf(fp, "}\n\n");
+   }
+   return 0;
+}
+
+/**
+ * Writes the statements that pack (or unpack) element at base[offset].
+ * expr is the C expression for the value of element. Arrays are written as loops, each loop level gets its own
+ * index variable i<depth> and, for arrays of records, element pointer p<depth>.
+ */
+static int8_t writePackStatements(FILE *fp, apx_dataElement_t *element, const char *expr, const char *base, uint32_t offset, int indent, int depth, bool isPack)
+{
+   if (element->baseType == APX_BASE_TYPE_STRING)
+   {
+      writeIndent(fp, indent);
+      if (isPack)
+      {
+         //copy up to arrayLen characters and zero-fill the rest of the field
+         fprintf(fp, "{\n");
+         writeIndent(fp, indent+1);
+         fprintf(fp, "uint32_t i%d;\n", depth+1);
+         writeIndent(fp, indent+1);
+         fprintf(fp, "for (i%d = 0u; (i%d < %uu) && (%s[i%d] != '\\0'); i%d++)\n", depth+1, depth+1, element->arrayLen, expr, depth+1, depth+1);
+         writeIndent(fp, indent+1);
+         fprintf(fp, "{\n");
+         writeIndent(fp, indent+2);
+         fprintf(fp, "%s[%uu + i%d] = (uint8_t) %s[i%d];\n", base, offset, depth+1, expr, depth+1);
+         writeIndent(fp, indent+1);
+         fprintf(fp, "}\n");
+         writeIndent(fp, indent+1);
+         fprintf(fp, "for (; i%d < %uu; i%d++)\n", depth+1, element->arrayLen, depth+1);
+         writeIndent(fp, indent+1);
+         fprintf(fp, "{\n");
+         writeIndent(fp, indent+2);
+         fprintf(fp, "%s[%uu + i%d] = 0u;\n", base, offset, depth+1);
+         writeIndent(fp, indent+1);
+         fprintf(fp, "}\n");
+         writeIndent(fp, indent);
+         fprintf(fp, "}\n");
+      }
+      else
+      {
+         fprintf(fp, "memcpy(%s, &%s[%uu], %uu);\n", expr, base, offset, element->arrayLen);
+      }
+   }
+   else if (element->arrayLen > 0)
+   {
+      char elementExpr[MAX_EXPR_LEN];
+      char elementBase[16];
+      int len;
+      uint32_t elementSize;
+      if (element->baseType == APX_BASE_TYPE_RECORD)
+      {
+         len = snprintf(elementExpr, sizeof(elementExpr), "%s[i%d].", expr, depth+1);
+         elementSize = calcElementSize(element);
+      }
+      else if (isPrimitiveType(element->baseType))
+      {
+         len = snprintf(elementExpr, sizeof(elementExpr), "%s[i%d]", expr, depth+1);
+         elementSize = getTypeSize(element->baseType);
+      }
+      else
+      {
+         errno = APX_ELEMENT_TYPE_ERROR;
+         return -1;
+      }
+      if ( (len < 0) || (len >= (int) sizeof(elementExpr)) )
+      {
+         errno = APX_NAME_TOO_LONG_ERROR;
+         return -1;
+      }
+      sprintf(elementBase, "p%d", depth+1);
+      writeIndent(fp, indent);
+      fprintf(fp, "{\n");
+      writeIndent(fp, indent+1);
+      fprintf(fp, "uint32_t i%d;\n", depth+1);
+      writeIndent(fp, indent+1);
+      fprintf(fp, "for (i%d = 0u; i%d < %uu; i%d++)\n", depth+1, depth+1, element->arrayLen, depth+1);
+      writeIndent(fp, indent+1);
+      fprintf(fp, "{\n");
+      writeIndent(fp, indent+2);
+      fprintf(fp, "%s*%s = &%s[%uu + (i%d * %uu)];\n", isPack? "uint8_t " : "const uint8_t ", elementBase, base, offset, depth+1, elementSize);
+      if (element->baseType == APX_BASE_TYPE_RECORD)
+      {
+         if (writeRecordStatements(fp, element, elementExpr, elementBase, 0, indent+2, depth+1, isPack) != 0)
+         {
+            return -1;
+         }
+      }
+      else
+      {
+         writePrimitive(fp, element->baseType, elementExpr, elementBase, 0, indent+2, isPack);
+      }
+      writeIndent(fp, indent+1);
+      fprintf(fp, "}\n");
+      writeIndent(fp, indent);
+      fprintf(fp, "}\n");
+   }
+   else if (element->baseType == APX_BASE_TYPE_RECORD)
+   {
+      char prefix[MAX_EXPR_LEN];
+      int len = snprintf(prefix, sizeof(prefix), "%s.", expr);
+      if ( (len < 0) || (len >= (int) sizeof(prefix)) )
+      {
+         errno = APX_NAME_TOO_LONG_ERROR;
+         return -1;
+      }
+      return writeRecordStatements(fp, element, prefix, base, offset, indent, depth, isPack);
+   }
+   else if (isPrimitiveType(element->baseType))
+   {
+      writePrimitive(fp, element->baseType, expr, base, offset, indent, isPack);
+   }
+   else
+   {
+      errno = APX_ELEMENT_TYPE_ERROR;
+      return -1;
+   }
+   return 0;
+}
+
+/**
+ * prefix is the member access prefix of the record value, e.g. "value->" or "value[i1]."
+ */
+static int8_t writeRecordStatements(FILE *fp, apx_dataElement_t *record, const char *prefix, const char *base, uint32_t offset, int indent, int depth, bool isPack)
+{
+   int32_t numChild = apx_dataElement_getNumChild(record);
+   int32_t i;
+   for (i=0; i<numChild; i++)
+   {
+      char name[MAX_EXPR_LEN];
+      char expr[MAX_EXPR_LEN];
+      int len;
+      apx_dataElement_t *child = apx_dataElement_getChildAt(record, i);
+      if (makeMemberName(name, sizeof(name), child, i) != 0)
+      {
+         return -1;
+      }
+      len = snprintf(expr, sizeof(expr), "%s%s", prefix, name);
+      if ( (len < 0) || (len >= (int) sizeof(expr)) )
+      {
+         errno = APX_NAME_TOO_LONG_ERROR;
+         return -1;
+      }
+      if (writePackStatements(fp, child, expr, base, offset, indent, depth, isPack) != 0)
+      {
+         return -1;
+      }
+      offset += calcPackLen(child);
+   }
+   return 0;
+}
+
+static void writePrimitive(FILE *fp, int8_t baseType, const char *expr, const char *base, uint32_t offset, int indent, bool isPack)
+{
+   uint32_t size = getTypeSize(baseType);
+   uint32_t bits = size * 8u;
+   uint32_t i;
+   writeIndent(fp, indent);
+   if (isPack)
+   {
+      for (i=0; i<size; i++)
+      {
+         if (i > 0)
+         {
+            writeIndent(fp, indent);
+         }
+         if (i == 0)
+         {
+            fprintf(fp, "%s[%uu] = (uint8_t) %s;\n", base, offset, expr);
+         }
+         else
+         {
+            fprintf(fp, "%s[%uu] = (uint8_t) ((uint%u_t) %s >> %uu);\n", base, offset+i, bits, expr, i*8u);
+         }
+      }
+   }
+   else
+   {
+      fprintf(fp, "%s = (%s) (", expr, getTypeName(baseType));
+      if (size > 1)
+      {
+         fprintf(fp, "(uint%u_t) ", bits);
+      }
+      fprintf(fp, "(");
+      for (i=0; i<size; i++)
+      {
+         if (i == 0)
+         {
+            fprintf(fp, "(uint%u_t) %s[%uu]", bits, base, offset);
+         }
+         else
+         {
+            fprintf(fp, " | ((uint%u_t) %s[%uu] << %uu)", bits, base, offset+i, i*8u);
+         }
+      }
+      fprintf(fp, "));\n");
+   }
+}
+
+/**
+ * writes name with every character that is not valid in a C identifier replaced by '_'
+ */
+static void writeIdentifier(FILE *fp, const char *name)
+{
+   const char *p;
+   if ( (name[0] >= '0') && (name[0] <= '9') )
+   {
+      fputc('_', fp);
+   }
+   for (p = name; *p != '\0'; p++)
+   {
+      char c = *p;
+      if ( ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')) || (c == '_') )
+      {
+         fputc(c, fp);
+      }
+      else
+      {
+         fputc('_', fp);
+      }
+   }
+}
+
+static void writeUpperIdentifier(FILE *fp, const char *name)
+{
+   const char *p;
+   if ( (name[0] >= '0') && (name[0] <= '9') )
+   {
+      fputc('_', fp);
+   }
+   for (p = name; *p != '\0'; p++)
+   {
+      char c = *p;
+      if ( (c >= 'a') && (c <= 'z') )
+      {
+         fputc(c - 'a' + 'A', fp);
+      }
+      else if ( ((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')) || (c == '_') )
+      {
+         fputc(c, fp);
+      }
+      else
+      {
+         fputc('_', fp);
+      }
+   }
+}
+
+static void writeIndent(FILE *fp, int indent)
+{
+   fprintf(fp, "%*s", indent * INDENT_SIZE, "");
+}
+
+/**
+ * record fields without a name are called field<index>
+ */
+static int8_t makeMemberName(char *buf, size_t bufLen, apx_dataElement_t *element, int32_t index)
+{
+   size_t i;
+   size_t len;
+   if ( (element->name == 0) || (element->name[0] == '\0') )
+   {
+      snprintf(buf, bufLen, "field%d", (int) index);
+      return 0;
+   }
+   if (strlen(element->name) + 2u > bufLen)
+   {
+      errno = APX_NAME_TOO_LONG_ERROR;
+      return -1;
+   }
+   i = 0;
+   if ( (element->name[0] >= '0') && (element->name[0] <= '9') )
+   {
+      buf[i++] = '_';
+   }
+   for (len = 0; element->name[len] != '\0'; len++)
+   {
+      char c = element->name[len];
+      if ( ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')) || (c == '_') )
+      {
+         buf[i++] = c;
+      }
+      else
+      {
+         buf[i++] = '_';
+      }
+   }
+   buf[i] = '\0';
+   return 0;
+}
+
+static const char *getTypeName(int8_t baseType)
+{
+   switch(baseType)
+   {
+   case APX_BASE_TYPE_UINT8:
+      return "uint8_t";
+   case APX_BASE_TYPE_UINT16:
+      return "uint16_t";
+   case APX_BASE_TYPE_UINT32:
+      return "uint32_t";
+   case APX_BASE_TYPE_UINT64:
+      return "uint64_t";
+   case APX_BASE_TYPE_SINT8:
+      return "int8_t";
+   case APX_BASE_TYPE_SINT16:
+      return "int16_t";
+   case APX_BASE_TYPE_SINT32:
+      return "int32_t";
+   case APX_BASE_TYPE_SINT64:
+      return "int64_t";
+   default:
+      return 0;
+   }
+}
+
+static uint32_t getTypeSize(int8_t baseType)
+{
+   switch(baseType)
+   {
+   case APX_BASE_TYPE_UINT8:
+   case APX_BASE_TYPE_SINT8:
+      return 1u;
+   case APX_BASE_TYPE_UINT16:
+   case APX_BASE_TYPE_SINT16:
+      return 2u;
+   case APX_BASE_TYPE_UINT32:
+   case APX_BASE_TYPE_SINT32:
+      return 4u;
+   case APX_BASE_TYPE_UINT64:
+   case APX_BASE_TYPE_SINT64:
+      return 8u;
+   default:
+      return 0u;
+   }
+}
+
+static bool isPrimitiveType(int8_t baseType)
+{
+   return (getTypeSize(baseType) > 0u);
+}
+
+/**
+ * packed size of one element of an array (or of the value itself when element is not an array)
+ */
+static uint32_t calcElementSize(apx_dataElement_t *element)
+{
+   if (element->baseType == APX_BASE_TYPE_RECORD)
+   {
+      int32_t numChild = apx_dataElement_getNumChild(element);
+      int32_t i;
+      uint32_t size = 0u;
+      for (i=0; i<numChild; i++)
+      {
+         size += calcPackLen(apx_dataElement_getChildAt(element, i));
+      }
+      return size;
+   }
+   else if (element->baseType == APX_BASE_TYPE_STRING)
+   {
+      return 1u;
+   }
+   return getTypeSize(element->baseType);
+}
+
+static uint32_t calcPackLen(apx_dataElement_t *element)
+{
+   uint32_t size = calcElementSize(element);
+   if (element->arrayLen > 0)
+   {
+      size *= element->arrayLen;
+   }
+   return size;
+}
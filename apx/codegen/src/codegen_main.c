@@ -0,0 +1,105 @@
+/*****************************************************************************
+* \file:    codegen_main.c
+* \brief:   apx_codegen - generates ApxCodec_<node>.h headers from .apx files
+*
+* Usage: apx_codegen [-o <output directory>] file.apx ...
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "apx_parser.h"
+#include "apx_codeGenerator.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static int generate(const char *filename, const char *outputDir);
+static void printUsage(const char *name);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+int8_t g_debug; // apx_logging of the shared sources expects this from main
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+   const char *outputDir = ".";
+   int numFiles = 0;
+   int i;
+   for (i=1; i<argc; i++)
+   {
+      if (strcmp(argv[i], "-o") == 0)
+      {
+         if (i+1 >= argc)
+         {
+            printUsage(argv[0]);
+            return 1;
+         }
+         outputDir = argv[++i];
+      }
+      else if ( (strcmp(argv[i], "-h") == 0) || (strcmp(argv[i], "--help") == 0) )
+      {
+         printUsage(argv[0]);
+         return 0;
+      }
+   }
+   for (i=1; i<argc; i++)
+   {
+      if (strcmp(argv[i], "-o") == 0)
+      {
+         i++;
+         continue;
+      }
+      if (generate(argv[i], outputDir) != 0)
+      {
+         return 1;
+      }
+      numFiles++;
+   }
+   if (numFiles == 0)
+   {
+      printUsage(argv[0]);
+      return 1;
+   }
+   return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static int generate(const char *filename, const char *outputDir)
+{
+   apx_parser_t parser;
+   apx_node_t *node;
+   int result = 0;
+   apx_parser_create(&parser);
+   node = apx_parser_parseFile(&parser, filename);
+   if (node == 0)
+   {
+      fprintf(stderr, "%s: failed to parse APX definition\n", filename);
+      result = -1;
+   }
+   else if (apx_codeGenerator_generateFile(node, outputDir, filename) != 0)
+   {
+      fprintf(stderr, "%s: code generation failed (error %d)\n", filename, errno);
+      result = -1;
+   }
+   else
+   {
+      printf("%s: generated %s/%s%s.h\n", filename, outputDir, APX_CODE_GENERATOR_FILE_PREFIX, apx_node_getName(node));
+   }
+   apx_parser_destroy(&parser);
+   return result;
+}
+
+static void printUsage(const char *name)
+{
+   printf("%s [-o <output directory>] file.apx ...\n", name);
+}
@@ -0,0 +1,201 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx_codeGenerator.h"
+#include "apx_node.h"
+
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define OUTPUT_BUF_SIZE 16384
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_apx_codeGenerator_scalarPorts(CuTest *tc);
+static void test_apx_codeGenerator_arrayAndStringPorts(CuTest *tc);
+static void test_apx_codeGenerator_recordPort(CuTest *tc);
+static void test_apx_codeGenerator_recordArrayPort(CuTest *tc);
+static char *generate(CuTest *tc, apx_node_t *node);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+
+CuSuite* testSuite_apx_codeGenerator(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_apx_codeGenerator_scalarPorts);
+   SUITE_ADD_TEST(suite, test_apx_codeGenerator_arrayAndStringPorts);
+   SUITE_ADD_TEST(suite, test_apx_codeGenerator_recordPort);
+   SUITE_ADD_TEST(suite, test_apx_codeGenerator_recordArrayPort);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_apx_codeGenerator_scalarPorts(CuTest *tc)
+{
+   apx_node_t node;
+   char *output;
+   apx_node_create(&node, "test_client");
+   apx_node_createDataType(&node, "OffOn_T", "C(0,3)", 0);
+   apx_node_createProvidePort(&node, "VehicleMode", "C(0,15)", "=15");
+   apx_node_createRequirePort(&node, "EngineRunningStatus", "T[0]", "=3");
+   apx_node_createRequirePort(&node, "VehicleSpeed", "S", "=0xFFFF");
+   apx_node_createRequirePort(&node, "Odometer", "l", "=0");
+   CuAssertIntEquals(tc, 0, apx_node_finalize(&node));
+   output = generate(tc, &node);
+   CuAssertPtrNotNull(tc, output);
+   CuAssertPtrNotNull(tc, strstr(output, "#ifndef APXCODEC_TEST_CLIENT_H\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "#define APX_IN_PORT_DATA_LEN_test_client 7u\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "#define APX_OUT_PORT_DATA_LEN_test_client 1u\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "#define APX_OFFSET_test_client_EngineRunningStatus 0u\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "#define APX_OFFSET_test_client_VehicleSpeed 1u\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "#define APX_LEN_test_client_VehicleSpeed 2u\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "#define APX_OFFSET_test_client_Odometer 3u\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "#define APX_OFFSET_test_client_VehicleMode 0u\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "APX_CODEC_INLINE void ApxCodec_Pack_test_client_VehicleMode(uint8_t *p, uint8_t value)\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "APX_CODEC_INLINE uint16_t ApxCodec_Unpack_test_client_VehicleSpeed(const uint8_t *p)\n"));
+   CuAssertPtrNotNull(tc, strstr(output,
+         "   p[0u] = (uint8_t) value;\n"
+         "   p[1u] = (uint8_t) ((uint16_t) value >> 8u);\n"));
+   CuAssertPtrNotNull(tc, strstr(output,
+         "   value = (int32_t) ((uint32_t) ((uint32_t) p[0u] | ((uint32_t) p[1u] << 8u) | ((uint32_t) p[2u] << 16u) | ((uint32_t) p[3u] << 24u)));\n"
+         "   return value;\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "#endif /* APXCODEC_TEST_CLIENT_H */\n"));
+   free(output);
+   apx_node_destroy(&node);
+}
+
+static void test_apx_codeGenerator_arrayAndStringPorts(CuTest *tc)
+{
+   apx_node_t node;
+   char *output;
+   apx_node_create(&node, "ArrayNode");
+   apx_node_createProvidePort(&node, "Samples", "S[4]", 0);
+   apx_node_createProvidePort(&node, "Name", "a[8]", 0);
+   CuAssertIntEquals(tc, 0, apx_node_finalize(&node));
+   output = generate(tc, &node);
+   CuAssertPtrNotNull(tc, output);
+   CuAssertPtrNotNull(tc, strstr(output, "#define APX_OUT_PORT_DATA_LEN_ArrayNode 16u\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "#define APX_OFFSET_ArrayNode_Name 8u\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "APX_CODEC_INLINE void ApxCodec_Pack_ArrayNode_Samples(uint8_t *p, const uint16_t *value)\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "APX_CODEC_INLINE void ApxCodec_Unpack_ArrayNode_Samples(const uint8_t *p, uint16_t *value)\n"));
+   CuAssertPtrNotNull(tc, strstr(output,
+         "      for (i1 = 0u; i1 < 4u; i1++)\n"
+         "      {\n"
+         "         uint8_t *p1 = &p[0u + (i1 * 2u)];\n"
+         "         p1[0u] = (uint8_t) value[i1];\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "APX_CODEC_INLINE void ApxCodec_Pack_ArrayNode_Name(uint8_t *p, const char *value)\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "      for (i1 = 0u; (i1 < 8u) && (value[i1] != '\\0'); i1++)\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "   memcpy(value, &p[0u], 8u);\n"));
+   free(output);
+   apx_node_destroy(&node);
+}
+
+static void test_apx_codeGenerator_recordPort(CuTest *tc)
+{
+   apx_node_t node;
+   char *output;
+   apx_node_create(&node, "RecordNode");
+   apx_node_createDataType(&node, "VehicleStatus_T", "{\"Speed\"S\"Gear\"C(0,7)\"Name\"a[4]\"Flags\"C[2]}", 0);
+   apx_node_createRequirePort(&node, "VehicleStatus", "T[0]", 0);
+   CuAssertIntEquals(tc, 0, apx_node_finalize(&node));
+   output = generate(tc, &node);
+   CuAssertPtrNotNull(tc, output);
+   CuAssertPtrNotNull(tc, strstr(output, "#define APX_LEN_RecordNode_VehicleStatus 9u\n"));
+   CuAssertPtrNotNull(tc, strstr(output,
+         "typedef struct ApxCodec_RecordNode_VehicleStatus_tag\n"
+         "{\n"
+         "   uint16_t Speed;\n"
+         "   uint8_t Gear;\n"
+         "   char Name[4];\n"
+         "   uint8_t Flags[2];\n"
+         "}ApxCodec_RecordNode_VehicleStatus_T;\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "APX_CODEC_INLINE void ApxCodec_Pack_RecordNode_VehicleStatus(uint8_t *p, const ApxCodec_RecordNode_VehicleStatus_T *value)\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "   p[2u] = (uint8_t) value->Gear;\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "   memcpy(value->Name, &p[3u], 4u);\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "         const uint8_t *p1 = &p[7u + (i1 * 1u)];\n"));
+   free(output);
+   apx_node_destroy(&node);
+}
+
+static void test_apx_codeGenerator_recordArrayPort(CuTest *tc)
+{
+   apx_dataElement_t *record;
+   apx_dataElement_t *child;
+   apx_node_t node;
+   apx_port_t *port;
+   char *output;
+   apx_node_create(&node, "RecordArrayNode");
+   port = apx_node_createProvidePort(&node, "Wheels", "C", 0);
+   CuAssertIntEquals(tc, 0, apx_node_finalize(&node));
+   //the parser does not accept arrays of records yet, build the data element by hand
+   record = apx_dataElement_new(APX_BASE_TYPE_RECORD, 0);
+   apx_dataElement_appendChild(record, apx_dataElement_new(APX_BASE_TYPE_UINT16, "Speed"));
+   child = apx_dataElement_new(APX_BASE_TYPE_SINT8, 0);
+   apx_dataElement_appendChild(record, child);
+   apx_dataElement_setArrayLen(record, 4);
+   apx_dataElement_delete(port->derivedDsg.dataElement);
+   port->derivedDsg.dataElement = record;
+   output = generate(tc, &node);
+   CuAssertPtrNotNull(tc, output);
+   CuAssertPtrNotNull(tc, strstr(output,
+         "typedef struct ApxCodec_RecordArrayNode_Wheels_tag\n"
+         "{\n"
+         "   uint16_t Speed;\n"
+         "   int8_t field1;\n"
+         "}ApxCodec_RecordArrayNode_Wheels_T;\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "         uint8_t *p1 = &p[0u + (i1 * 3u)];\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "         p1[2u] = (uint8_t) value[i1].field1;\n"));
+   CuAssertPtrNotNull(tc, strstr(output, "         value[i1].field1 = (int8_t) (((uint8_t) p1[2u]));\n"));
+   free(output);
+   apx_node_destroy(&node);
+}
+
+static char *generate(CuTest *tc, apx_node_t *node)
+{
+   char *output = 0;
+   FILE *fp = tmpfile();
+   CuAssertPtrNotNull(tc, fp);
+   if (apx_codeGenerator_writeHeader(fp, node, "test.apx") == 0)
+   {
+      long len = ftell(fp);
+      if ( (len > 0) && (len < OUTPUT_BUF_SIZE) )
+      {
+         output = (char*) malloc((size_t) len + 1u);
+         rewind(fp);
+         if ( (output != 0) && (fread(output, 1, (size_t) len, fp) == (size_t) len) )
+         {
+            output[len] = '\0';
+         }
+      }
+   }
+   fclose(fp);
+   return output;
+}
@@ -5,55 +5,49 @@
 // INCLUDES
 //////////////////////////////////////////////////////////////////////////////
 #include <stdint.h>
+#include <stddef.h>
 #if defined(_MSC_PLATFORM_TOOLSET) && (_MSC_PLATFORM_TOOLSET<=110)
 #include "msc_bool.h"
 #else
 #include <stdbool.h>
 #endif
 
-#ifdef _MSC_VER
-#include <Windows.h>
-#else
-#include <pthread.h>
-#include <semaphore.h>
-#endif
-#include "osmacro.h"
-#include "ringbuf.h"
-#include "soa.h"
-
 //////////////////////////////////////////////////////////////////////////////
 // CONSTANTS AND DATA TYPES
 //////////////////////////////////////////////////////////////////////////////
+#define APX_ALLOCATOR_MAX_SMALL_SIZE 256u //objects larger than this are taken directly from malloc
+#define APX_ALLOCATOR_NUM_SIZE_CLASSES 6u //8, 16, 32, 64, 128 and 256 bytes
+#define APX_ALLOCATOR_BLOCKS_PER_SLAB 64u
+
+#ifndef APX_ALLOCATOR_COUNT_ENABLE
+#if defined(MEM_LEAK_CHECK) || defined(UNIT_TEST)
+#define APX_ALLOCATOR_COUNT_ENABLE 1 //outstanding allocations are counted in leak-check and unit test builds only
+#else
+#define APX_ALLOCATOR_COUNT_ENABLE 0
+#endif
+#endif
 
 /**
- * this is a simple small object allocator with built-in garbage collector thread
+ * Small object allocator without any worker thread.
+ *
+ * Every thread that allocates gets its own cache (created on first use) with one free list per size class.
+ * Each block remembers the cache it was taken from.
+ * A block freed by the owning thread goes straight back to its local free list.
+ * A block freed by another thread is pushed onto a lock-free remote free list of the owning cache. The owner takes back the whole
+ * remote list with a single atomic exchange the next time its local list for that size class runs empty.
+ * Blocks are carved from slabs of APX_ALLOCATOR_BLOCKS_PER_SLAB blocks. When the last block of a slab is taken back by the owning thread
+ * the slab is freed, except for the last slab of a size class with free blocks which is kept to avoid malloc/free churn.
+ * Blocks freed by other threads are taken back (and their slabs freed) the next time the owning thread runs out of free blocks in that size class.
+ * A cache is deleted when its thread has exited and its last block has been returned.
+ *
+ * The caches are shared by all allocator objects. The allocator object itself only tracks the number of outstanding allocations,
+ * and only when APX_ALLOCATOR_COUNT_ENABLE is set. Release builds don't touch any shared counter in alloc and free.
  */
 typedef struct apx_allocator_tag
 {
-   THREAD_T workerThread; //local worker thread
-   SPINLOCK_T lock;  //variable lock
-   SEMAPHORE_T semaphore; //thread semaphore
-
-   //data object, all read/write accesses to these must be protected by the lock variable above
-   rbfs_t messages; //pending messages (ringbuffer)
-   bool isRunning; //when false it's time do shut down
-   bool workerThreadValid; //true if workerThread is a valid variable
-   uint8_t *ringBufferData; //memory for ringbuffer
-   uint32_t ringBufferLen; //number of items in ringbuffer
-   soa_t soa;
-
-#ifdef _MSC_VER
-   unsigned int threadId;
-#endif
+   volatile int32_t numAllocated; //number of objects allocated through this allocator and not yet freed (always 0 unless APX_ALLOCATOR_COUNT_ENABLE is set)
 }apx_allocator_t;
 
-//this data structure is used as elements in the ring buffer
-typedef struct rbf_data_tag
-{
-   uint8_t *ptr;
-   uint32_t size;
-}rbf_data_t;
-
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL VARIABLES
 //////////////////////////////////////////////////////////////////////////////
@@ -62,12 +56,12 @@ typedef struct rbf_data_tag
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
-int8_t apx_allocator_create(apx_allocator_t *self, uint16_t maxPendingMessages);
+int8_t apx_allocator_create(apx_allocator_t *self);
 void apx_allocator_destroy(apx_allocator_t *self);
 
-void apx_allocator_start(apx_allocator_t *self);
-void apx_allocator_stop(apx_allocator_t *self);
 uint8_t *apx_allocator_alloc(apx_allocator_t *self, size_t size);
 void apx_allocator_free(apx_allocator_t *self, uint8_t *ptr, uint32_t size);
+int32_t apx_allocator_getNumAllocated(apx_allocator_t *self);
+int32_t apx_allocator_getNumSlabs(void);
 
 #endif //APX_ALLOCATOR_H
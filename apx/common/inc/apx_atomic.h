@@ -0,0 +1,38 @@
+#ifndef APX_ATOMIC_H
+#define APX_ATOMIC_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#ifdef _MSC_VER
+#include <Windows.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Minimal set of atomic operations used by the lock-free data structures. All operations are sequentially consistent on MSVC
+ * and use acquire/release ordering on GCC compatible compilers.
+ */
+#ifdef _MSC_VER
+#define ATOMIC_EXCHANGE_PTR(ptr, val) InterlockedExchangePointer((PVOID volatile*) (ptr), (PVOID) (val))
+#define ATOMIC_CAS_PTR(ptr, expected, desired) (InterlockedCompareExchangePointer((PVOID volatile*) (ptr), (PVOID) (desired), (PVOID) (expected)) == (PVOID) (expected))
+#define ATOMIC_LOAD_PTR(ptr) InterlockedCompareExchangePointer((PVOID volatile*) (ptr), (PVOID) 0, (PVOID) 0)
+#define ATOMIC_STORE_PTR(ptr, val) (void) InterlockedExchangePointer((PVOID volatile*) (ptr), (PVOID) (val))
+#define ATOMIC_FETCH_ADD_I32(ptr, val) ((int32_t) InterlockedExchangeAdd((LONG volatile*) (ptr), (LONG) (val)))
+#define ATOMIC_LOAD_I32(ptr) ((int32_t) InterlockedCompareExchange((LONG volatile*) (ptr), 0, 0))
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define ATOMIC_EXCHANGE_PTR(ptr, val) __atomic_exchange_n((ptr), (val), __ATOMIC_ACQ_REL)
+#define ATOMIC_CAS_PTR(ptr, expected, desired) __atomic_compare_exchange_n((ptr), &(expected), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define ATOMIC_LOAD_PTR(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE_PTR(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define ATOMIC_FETCH_ADD_I32(ptr, val) __atomic_fetch_add((ptr), (val), __ATOMIC_ACQ_REL)
+#define ATOMIC_LOAD_I32(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define THREAD_LOCAL __thread
+#endif
+
+#endif //APX_ATOMIC_H
@@ -6,5 +6,6 @@
 #define APX_MAX_NAME_LEN     256
 #define APX_MAX_PSG_LEN      1024
 #define APX_SMALL_DATA_SIZE  0 //APX_SMALL_DATA_SIZE not supported yet in c-apx
+#define APX_MSG_INLINE_DATA_SIZE 8 //routed port writes up to this size are carried inside the message instead of in an apx_payload_t
 
 #endif //APX_CFG_H
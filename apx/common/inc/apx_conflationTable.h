@@ -0,0 +1,63 @@
+#ifndef APX_CONFLATION_TABLE_H
+#define APX_CONFLATION_TABLE_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#if defined(_MSC_PLATFORM_TOOLSET) && (_MSC_PLATFORM_TOOLSET<=110)
+#include "msc_bool.h"
+#else
+#include <stdbool.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//forward declaration
+struct apx_file_tag;
+
+/**
+ * A pending (not yet processed) file write, identified by (file, offset)
+ */
+typedef struct apx_conflationEntry_tag
+{
+   struct apx_file_tag *file; //weak pointer, 0 means that the slot is unused
+   uint32_t offset;
+   uint32_t length; //length of data
+   void *data; //weak pointer identifying the queued write, the owner uses it to update the write in place
+}apx_conflationEntry_t;
+
+/**
+ * Hash table (open addressing with linear probing) that maps (file, offset) to the latest pending write.
+ * The table doubles its capacity when it becomes half full.
+ * It is not thread-safe, the owner must protect it with the same lock that protects its message queue.
+ */
+typedef struct apx_conflationTable_tag
+{
+   apx_conflationEntry_t *entries; //strong pointer to array of slots
+   uint32_t capacity; //number of slots, always a power of 2
+   uint32_t numEntries; //number of used slots
+}apx_conflationTable_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+int8_t apx_conflationTable_create(apx_conflationTable_t *self, uint32_t initialNumEntries);
+void apx_conflationTable_destroy(apx_conflationTable_t *self);
+apx_conflationTable_t *apx_conflationTable_new(uint32_t initialNumEntries);
+void apx_conflationTable_delete(apx_conflationTable_t *self);
+void apx_conflationTable_vdelete(void *arg);
+
+apx_conflationEntry_t *apx_conflationTable_find(apx_conflationTable_t *self, const struct apx_file_tag *file, uint32_t offset);
+int8_t apx_conflationTable_insert(apx_conflationTable_t *self, struct apx_file_tag *file, uint32_t offset, uint32_t length, void *data);
+bool apx_conflationTable_remove(apx_conflationTable_t *self, const struct apx_file_tag *file, uint32_t offset, const void *data);
+uint32_t apx_conflationTable_length(const apx_conflationTable_t *self);
+
+#endif //APX_CONFLATION_TABLE_H
@@ -43,6 +43,9 @@ int8_t apx_dataElement_create(apx_dataElement_t *self, int8_t baseType, const ch
 void apx_dataElement_destroy(apx_dataElement_t *self);
 void apx_dataElement_initRecordType(apx_dataElement_t *self);
 uint8_t *apx_dataElement_pack_dv(apx_dataElement_t *self, uint8_t *pBegin, uint8_t *pEnd, dtl_dv_t *dv);
+const uint8_t *apx_dataElement_unpack_dv(apx_dataElement_t *self, const uint8_t *pBegin, const uint8_t *pEnd, dtl_dv_t **dv);
+uint8_t *apx_dataElement_pack_array(apx_dataElement_t *self, uint8_t *pBegin, uint8_t *pEnd, const void *values);
+const uint8_t *apx_dataElement_unpack_array(apx_dataElement_t *self, const uint8_t *pBegin, const uint8_t *pEnd, void *values);
 
 void apx_dataElement_setArrayLen(apx_dataElement_t *self, uint32_t arrayLen);
 uint32_t apx_dataElement_getArrayLen(apx_dataElement_t *self);
@@ -0,0 +1,79 @@
+#ifndef APX_DATA_PROGRAM_H
+#define APX_DATA_PROGRAM_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include <stdbool.h>
+#include "apx_dataElement.h"
+#include "dtl_type.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APX_DATA_OP_U8              0u
+#define APX_DATA_OP_U16             1u
+#define APX_DATA_OP_U32             2u
+#define APX_DATA_OP_U64             3u
+#define APX_DATA_OP_S8              4u
+#define APX_DATA_OP_S16             5u
+#define APX_DATA_OP_S32             6u
+#define APX_DATA_OP_S64             7u
+#define APX_DATA_OP_STRING          8u  //length is the size of the string field (including null-terminator)
+#define APX_DATA_OP_RECORD          9u  //count is the number of fields, length is the packed size of the record
+#define APX_DATA_OP_ARRAY          10u  //array of records: count is the number of elements, length is the packed size of one element
+#define APX_DATA_OP_END            11u  //closes the most recent RECORD or ARRAY
+
+#define APX_DATA_FLAG_ARRAY       0x01u //primitive values are elements of one array value instead of consecutive values
+
+#define APX_DATA_PROGRAM_MAX_DEPTH 16   //maximum nesting of records and record arrays
+
+/**
+ * One instruction of a compiled data signature.
+ * offset is relative to the start of the innermost record array element (or the start of the data when outside of record arrays).
+ * Primitive instructions cover count values of the same type: either count consecutive record fields of the same type
+ * (fused at compile time) or, with APX_DATA_FLAG_ARRAY, one array value having count elements.
+ * structOffset and structLength give the same layout for the native C struct that matches the signature (see apx_dataProgram_unpack_struct).
+ */
+typedef struct apx_dataInstruction_tag
+{
+   uint8_t opcode;
+   uint8_t flags;
+   uint32_t offset;
+   uint32_t length; //size in bytes of one value
+   uint32_t count;
+   uint32_t structOffset;
+   uint32_t structLength; //size in bytes of one value in the native struct (including padding for records)
+}apx_dataInstruction_t;
+
+/**
+ * Flat instruction array compiled once from the apx_dataElement_t tree of a data signature.
+ * Packing runs through the instruction array in a single loop instead of walking the tree recursively.
+ */
+typedef struct apx_dataProgram_tag
+{
+   apx_dataInstruction_t *instructions; //strong pointer
+   uint32_t numInstructions;
+   uint32_t capacity;
+   uint32_t packLen; //total size in bytes of the packed data
+   uint32_t structSize; //sizeof() the native C struct that matches the signature
+}apx_dataProgram_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+void apx_dataProgram_create(apx_dataProgram_t *self);
+void apx_dataProgram_destroy(apx_dataProgram_t *self);
+apx_dataProgram_t *apx_dataProgram_new(void);
+void apx_dataProgram_delete(apx_dataProgram_t *self);
+void apx_dataProgram_vdelete(void *arg);
+
+int8_t apx_dataProgram_compile(apx_dataProgram_t *self, const apx_dataElement_t *dataElement);
+uint8_t *apx_dataProgram_pack_dv(const apx_dataProgram_t *self, uint8_t *pBegin, uint8_t *pEnd, dtl_dv_t *dv);
+const uint8_t *apx_dataProgram_unpack_dv(const apx_dataProgram_t *self, const uint8_t *pBegin, const uint8_t *pEnd, dtl_dv_t **dv);
+const uint8_t *apx_dataProgram_unpack_struct(const apx_dataProgram_t *self, const uint8_t *pBegin, const uint8_t *pEnd, void *data, uint32_t dataLen);
+uint8_t *apx_dataProgram_pack_struct(const apx_dataProgram_t *self, uint8_t *pBegin, uint8_t *pEnd, const void *data, uint32_t dataLen);
+uint32_t apx_dataProgram_length(const apx_dataProgram_t *self);
+
+#endif //APX_DATA_PROGRAM_H
@@ -14,29 +14,42 @@
 
 //forward declaration
 struct apx_nodeInfo_tag;
+struct apx_fileManager_tag;
+struct apx_file_tag;
 
 
 typedef void (dataTriggerWriteHook_fn)(void *arg, struct apx_nodeInfo_tag *providerNodeInfo, struct apx_nodeInfo_tag *requesterNodeInfo, uint8_t *data, uint32_t srcOffset, uint32_t destOffset, uint32_t length);
 
-typedef struct apx_dataWriteInfo_tag
-{
-   struct apx_nodeInfo_tag *requesterNodeInfo;
-   uint32_t destOffset;       //byte offset into inDataBuffer of requesterNodeInfo
-} apx_dataWriteInfo_t;
-
+/**
+ * The routes of a trigger function are stored as a compiled route table, one column per attribute (struct of arrays).
+ * Route i writes dataLength bytes to routeFile[i] at byte offset routeDestOffset[i] using routeFileManager[i].
+ * routeNodeInfo is the requester the route was compiled from. routeGeneration holds the routeGeneration of that requester when the
+ * destination file and fileManager were resolved, a route is only re-resolved after apx_dataTrigger_invalidateRoutes was called for its own requester.
+ */
 typedef struct apx_dataTriggerFunction_tag
 {
    uint32_t srcOffset;        //offset in bytes to where the signal data actually starts (this is only used if partial signal update is supported)
    uint32_t dataLength;       //expected length of data (this is just for error checking)
-   adt_ary_t writeInfoList;   //array of apx_dataWriteInfo_t
+   int32_t numRoutes;
+   int32_t routeCapacity;
+   struct apx_fileManager_tag **routeFileManager;  //destination fileManager, 0 while the requester is not connected
+   struct apx_file_tag **routeFile;                //destination inPortDataFile, 0 while the file is not open
+   uint32_t *routeDestOffset;                      //byte offset into the inPortDataFile of the requester
+   struct apx_nodeInfo_tag **routeNodeInfo;        //requester nodeInfo
+   int32_t *routeGeneration;                       //routeGeneration of the requester nodeInfo when the destination was resolved
 }apx_dataTriggerFunction_t;
 
+/**
+ * Port boundary index of the outDataMap of a node.
+ * A written byte range is mapped to ports with a binary search in portOffsets, the connectedPorts bitmap is then used to skip
+ * over ports that have no routes. Memory use is proportional to the number of provide ports, not to the number of data bytes.
+ */
 typedef struct apx_dataTriggerTable_tag
 {
-   //Note: the lookupTable contains duplicate pointer objects, we cannot delete its items like we normally do using virtual destructor.
-
-   apx_dataTriggerFunction_t  **lookupTable;     //array of apx_dataTriggerFunction_t*,
-   uint32_t                   lookupTableLen;    //should be identical to number of bytes in the outPortMap (from corresponding NodeInfo)
+   apx_dataTriggerFunction_t  **triggerFunctions; //array of apx_dataTriggerFunction_t*, indexed by provide port index. Created when the port is first updated.
+   uint32_t                   *portOffsets;      //start offset of each provide port (sorted), followed by the total length of the outDataMap
+   uint32_t                   *connectedPorts;   //bitmap with one bit per provide port, the bit is set when the port has at least one route
+   int32_t                    numPorts;
    dataTriggerWriteHook_fn    *writeHookFunc;
    void                       *writeHookUserArg;
    struct apx_nodeInfo_tag    *nodeInfo;         //The nodeInfo where this triggertable is attached to
@@ -59,6 +72,8 @@ void apx_dataTriggerTable_delete(apx_dataTriggerTable_t *self);
 void apx_dataTriggerTable_vdelete(void *arg);
 void apx_dataTriggerTable_updateTrigger(apx_dataTriggerTable_t *self, apx_port_t *port);
 apx_dataTriggerFunction_t *apx_dataTriggerTable_get(const apx_dataTriggerTable_t *self, int32_t offset);
+int32_t apx_dataTriggerTable_findPort(const apx_dataTriggerTable_t *self, uint32_t offset);
+int32_t apx_dataTriggerTable_nextConnectedPort(const apx_dataTriggerTable_t *self, int32_t beginPortIndex, int32_t endPortIndex);
 
 //apx_dataTriggerFunction
 void apx_dataTriggerFunction_create(apx_dataTriggerFunction_t *self, uint32_t srcOffset, uint32_t dataLength);
@@ -67,11 +82,11 @@ apx_dataTriggerFunction_t *apx_dataTriggerFunction_new(uint32_t srcOffset, uint3
 void apx_dataTriggerFunction_delete(apx_dataTriggerFunction_t *self);
 void apx_dataTriggerFunction_vdelete(void *arg);
 
-//dataWriteInfo
-void apx_dataWriteInfo_create(apx_dataWriteInfo_t *self,struct apx_nodeInfo_tag *nodeInfo, uint32_t destOffset);
-void apx_dataWriteInfo_destroy(apx_dataWriteInfo_t *self);
-apx_dataWriteInfo_t *apx_dataWriteInfo_new(struct apx_nodeInfo_tag *nodeInfo, uint32_t destOffset);
-void apx_dataWriteInfo_delete(apx_dataWriteInfo_t *self);
-void apx_dataWriteInfo_vdelete(void *arg);
+int8_t apx_dataTriggerFunction_addRoute(apx_dataTriggerFunction_t *self, struct apx_nodeInfo_tag *requesterNodeInfo, uint32_t destOffset);
+void apx_dataTriggerFunction_clearRoutes(apx_dataTriggerFunction_t *self);
+int32_t apx_dataTriggerFunction_compileRoutes(apx_dataTriggerFunction_t *self);
+
+//route table
+void apx_dataTrigger_invalidateRoutes(struct apx_nodeInfo_tag *requesterNodeInfo);
 
 #endif //APX_PORT_TRIGGER_H
@@ -20,14 +20,15 @@
 #include <semaphore.h>
 #endif
 #include "osmacro.h"
-#include "ringbuf.h"
-#include "apx_allocator.h"
+#include "apx_mpscQueue.h"
+#include "apx_payload.h"
 #include "apx_msg.h"
 #include "apx_types.h"
 #include "apx_nodeData.h"
 #include "apx_fileMap.h"
 #include "adt_bytearray.h"
 #include "apx_transmitHandler.h"
+#include "apx_conflationTable.h"
 
 //////////////////////////////////////////////////////////////////////////////
 // CONSTANTS AND DATA TYPES
@@ -36,6 +37,7 @@
 //forward declaration
 struct apx_nodeData_tag;
 struct apx_nodeManager_tag;
+struct apx_workerPool_tag;
 
 #define APX_FILEMANAGER_CLIENT_MODE 0
 #define APX_FILEMANAGER_SERVER_MODE 1
@@ -43,6 +45,16 @@ struct apx_nodeManager_tag;
 
 
 
+/**
+ * Shows how well the worker amortises its wakeups. A batch is all messages processed from one wakeup until the queue is empty again.
+ */
+typedef struct apx_fileManagerBatchStats_tag
+{
+   uint32_t numBatches;
+   uint32_t numMessages; //total number of messages in all batches
+   uint32_t maxBatchSize; //largest number of messages in a single batch
+}apx_fileManagerBatchStats_t;
+
 typedef struct apx_fileManager_tag
 {
    //OS interaction variables
@@ -51,13 +63,11 @@ typedef struct apx_fileManager_tag
    SPINLOCK_T sendLock;  //lock for transmitHandler send
    SEMAPHORE_T semaphore; //thread semaphore
 
+   apx_mpscQueue_t messages; //pending messages (apx_msg_t), lock-free except when conflation is enabled
+
    //data object, all read/write accesses to these must be protected by the lock variable above
-   rbfs_t ringbuffer; //pending messages
    bool workerThreadValid;
    void *debugInfo;
-   uint8_t *ringbufferData; //strong pointer to raw data used by our ringbuffer
-   uint32_t ringbufferLen; //number of items in ringbuffer
-   apx_allocator_t allocator;
 
    apx_fileMap_t localFileMap;
    apx_fileMap_t remoteFileMap;
@@ -70,6 +80,19 @@ typedef struct apx_fileManager_tag
 
    struct apx_nodeManager_tag *nodeManager; //weak pointer to attached nodeManager
    bool isConnected;
+   char sessionToken[RMF_SESSION_TOKEN_MAX_LEN+1]; //session token presented by the remote side in its greeting, empty string if none
+
+   //worker pool variables, only used when a worker pool has been set (see apx_fileManager_setWorkerPool)
+   struct apx_workerPool_tag *workerPool; //weak pointer to shared worker pool. When 0 the fileManager uses its own workerThread
+   struct apx_fileManager_tag *workerPoolNext; //next fileManager in the run queue of the workerPool (protected by the workerPool lock)
+   bool isScheduled; //true while this fileManager is waiting in (or being processed by) the workerPool (protected by lock)
+   bool isWorkerPoolActive; //set by apx_fileManager_start, messages posted before start are processed once started
+
+   //latest-value conflation, only used when enabled (see apx_fileManager_enableConflation). Protected by lock
+   apx_conflationTable_t *conflationTable; //strong pointer, maps (file, offset) to the data of the pending RMF_MSG_FILE_WRITE. Never changed after start
+   uint32_t numConflatedWrites; //number of writes that replaced the value of an already pending write
+
+   apx_fileManagerBatchStats_t batchStats; //protected by lock
 #ifdef _WIN32
    unsigned int threadId;
 #endif
@@ -92,6 +115,11 @@ void apx_fileManager_vdelete(void *arg);
 void apx_fileManager_start(apx_fileManager_t *self);
 void apx_fileManager_stop(apx_fileManager_t *self);
 
+void apx_fileManager_setWorkerPool(apx_fileManager_t *self, struct apx_workerPool_tag *workerPool);
+bool apx_fileManager_processPending(apx_fileManager_t *self, uint32_t maxNumMessages);
+int8_t apx_fileManager_enableConflation(apx_fileManager_t *self);
+void apx_fileManager_getBatchStats(apx_fileManager_t *self, apx_fileManagerBatchStats_t *stats);
+
 void apx_fileManager_setNodeManager(apx_fileManager_t *self, struct apx_nodeManager_tag *nodeManager); //used to create remote nodes
 void apx_fileManager_setTransmitHandler(apx_fileManager_t *self, apx_transmitHandler_t *handler);
 int32_t apx_fileManager_parseMessage(apx_fileManager_t *self, const uint8_t *msgBuf, int32_t msgLen);
@@ -101,11 +129,13 @@ void apx_fileManager_attachLocalDefinitionFile(apx_fileManager_t *self, apx_file
 void apx_fileManager_attachLocalPortDataFile(apx_fileManager_t *self, apx_file_t *localFile);
 const char *apx_fileManager_modeString(apx_fileManager_t *self);
 void apx_fileManager_setDebugInfo(apx_fileManager_t *self, void *debugInfo);
+void apx_fileManager_setSessionToken(apx_fileManager_t *self, const char *sessionToken);
 
 //these messages can be sent to the fileManager to be processed by its internal worker thread
 void apx_fileManager_onConnected(apx_fileManager_t *self);
 void apx_fileManager_onDisconnected(apx_fileManager_t *self);
 void apx_fileManager_triggerFileUpdatedEvent(apx_fileManager_t *self, apx_file_t *file, uint32_t offset, uint32_t length);
 void apx_fileManager_triggerFileWriteCmdEvent(apx_fileManager_t *self, apx_file_t *file, const uint8_t *data, apx_offset_t offset, apx_size_t length);
+void apx_fileManager_triggerFileWritePayloadEvent(apx_fileManager_t *self, apx_file_t *file, apx_payload_t *payload, apx_offset_t offset);
 
 #endif //APX_FILE_MANAGER_H
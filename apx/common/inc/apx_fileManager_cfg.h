@@ -16,7 +16,11 @@
 // CONSTANTS AND DATA TYPES
 //////////////////////////////////////////////////////////////////////////////
 #ifndef APX_CONTEXT_NUM_MESSAGES
-#define APX_CONTEXT_NUM_MESSAGES 1000 //0-65535
+#define APX_CONTEXT_NUM_MESSAGES 1000 //initial size hint, message queues are unbounded
+#endif
+
+#ifndef APX_FILEMANAGER_MAX_BATCH_SIZE
+#define APX_FILEMANAGER_MAX_BATCH_SIZE 64 //number of messages the worker removes from the queue at once
 #endif
 
 //////////////////////////////////////////////////////////////////////////////
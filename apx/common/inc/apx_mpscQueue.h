@@ -0,0 +1,65 @@
+#ifndef APX_MPSC_QUEUE_H
+#define APX_MPSC_QUEUE_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#if defined(_MSC_PLATFORM_TOOLSET) && (_MSC_PLATFORM_TOOLSET<=110)
+#include "msc_bool.h"
+#else
+#include <stdbool.h>
+#endif
+#include "apx_allocator.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+typedef struct apx_mpscQueueNode_tag
+{
+   struct apx_mpscQueueNode_tag *volatile next;
+   //followed by elemSize bytes of element data
+}apx_mpscQueueNode_t;
+
+/**
+ * Unbounded lock-free multi-producer/single-consumer queue of fixed-size elements.
+ *
+ * Any thread may push. Only one thread at a time may pop (the consumer).
+ * The queue also counts elements that have been pushed but not yet released by the consumer.
+ * apx_mpscQueue_push reports when that count goes from zero to non-zero, this is the only time the consumer needs to be woken up.
+ * The consumer calls apx_mpscQueue_release after it has processed a batch and goes back to sleep when it returns 0 or less.
+ * Nodes are taken from the thread cache of the pushing thread (see apx_allocator), the consumer hands them back without taking any lock.
+ */
+typedef struct apx_mpscQueue_tag
+{
+   apx_mpscQueueNode_t *head; //consumer side, weak pointer to the node before the first element (the stub)
+   apx_mpscQueueNode_t *volatile tail; //producer side, last node in queue
+   volatile int32_t numPending; //number of pushed elements not yet released by the consumer, may briefly be negative
+   uint32_t elemSize;
+   apx_allocator_t nodeAllocator;
+}apx_mpscQueue_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+int8_t apx_mpscQueue_create(apx_mpscQueue_t *self, uint32_t elemSize);
+void apx_mpscQueue_destroy(apx_mpscQueue_t *self);
+apx_mpscQueue_t *apx_mpscQueue_new(uint32_t elemSize);
+void apx_mpscQueue_delete(apx_mpscQueue_t *self);
+void apx_mpscQueue_vdelete(void *arg);
+
+int8_t apx_mpscQueue_push(apx_mpscQueue_t *self, const void *elem, bool *wasEmpty);
+void *apx_mpscQueue_emplace(apx_mpscQueue_t *self, const void *elem, bool *wasEmpty);
+void *apx_mpscQueue_front(apx_mpscQueue_t *self);
+bool apx_mpscQueue_pop(apx_mpscQueue_t *self, void *elem);
+int32_t apx_mpscQueue_popMany(apx_mpscQueue_t *self, void *elems, int32_t maxNumElements);
+int32_t apx_mpscQueue_release(apx_mpscQueue_t *self, int32_t numElements);
+int32_t apx_mpscQueue_length(apx_mpscQueue_t *self);
+
+#endif //APX_MPSC_QUEUE_H
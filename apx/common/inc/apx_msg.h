@@ -24,7 +24,10 @@ typedef struct apx_msg_tag
       uint8_t data[APX_SMALL_DATA_SIZE]; //port data (when port data length is small)
    } msgData3;
 #ifndef APX_EMBEDDED
-   void *msgData4;    //generic void* pointer value
+   union msgData4_tag{
+      void *ptr;                                //generic void* pointer value
+      uint8_t data[APX_MSG_INLINE_DATA_SIZE];   //port data (when port data length is small)
+   } msgData4;
 #endif
 } apx_msg_t;
 
@@ -38,7 +41,7 @@ typedef struct apx_msg_tag
 #define RMF_MSG_FILE_OPEN             4 //msgData1=file startAddress
 #define RMF_MSG_FILE_CLOSE            5 //msgData1=file startAddress
 #define RMF_MSG_WRITE_NOTIFY          6 //msgData1=offset, msgData2=length, msgData3.ptr=apx_file_t *file
-#define RMF_MSG_FILE_WRITE            7 //msgData1=writeAddress, msgData2=length, msgData3.ptr=apx_file_t *file, msgData4=data
+#define RMF_MSG_FILE_WRITE            7 //msgData1=writeAddress, msgData2=length, msgData3.ptr=apx_file_t *file, msgData4.data=data (length <= APX_MSG_INLINE_DATA_SIZE) or msgData4.ptr=apx_payload_t *payload
 #define RMF_MSG_FILE_SEND             8 //msgData3=apx_file_t *file
 #define RMF_MSG_DIRECT_WRITE          9 //msgData1=writeAddress, msgData2=length, msgData3.data=port data
 
@@ -35,6 +35,7 @@ struct apx_portref_tag;
 apx_node_t *apx_node_new(const char *name);
 void apx_node_delete(apx_node_t *self);
 void apx_node_vdelete(void *arg);
+apx_node_t *apx_node_clone(const apx_node_t *other);
 void apx_node_create(apx_node_t *self,const char *name);
 void apx_node_destroy(apx_node_t *self);
 
@@ -76,6 +76,7 @@ typedef struct apx_nodeData_tag
    SPINLOCK_T outPortDataLock;
    SPINLOCK_T definitionDataLock;
    SPINLOCK_T internalLock;
+   uint8_t *outPortDataSnapshot; //server only: copy of outPortDataBuf taken when a parked node is resumed. Always owned by this object
 #endif
    struct apx_file_tag *outPortDataFile;
    struct apx_file_tag *inPortDataFile;
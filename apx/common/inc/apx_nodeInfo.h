@@ -19,6 +19,7 @@
 
 //forward declarations
 struct apx_nodeData_tag;
+struct apx_router_tag;
 
 typedef struct apx_nodeInfo_tag
 {
@@ -36,6 +37,11 @@ typedef struct apx_nodeInfo_tag
    uint32_t pendingProvidePortFlags; //number of modified providePortFlags since last check (this is an optimization to reduce some linear search time)
    apx_dataTriggerTable_t outDataTriggerTable; //trigger table routines
    struct apx_nodeData_tag *nodeData; //weak pointer to associated nodeData
+   struct apx_router_tag *router; //router this nodeInfo is attached to, NULL when not attached
+   int32_t routerIndex; //position of this nodeInfo in the nodeInfoList of router
+   adt_ary_t *dirtyList; //weak pointer to the list where this nodeInfo adds itself when it gets pending port flags (set by the router)
+   bool isDirty; //true while this nodeInfo is in dirtyList
+   volatile int32_t routeGeneration; //incremented when the destination file or fileManager of nodeData changes (see apx_dataTrigger_invalidateRoutes)
 } apx_nodeInfo_t;
 
 #define APX_PORT_EVENT_NONE         0
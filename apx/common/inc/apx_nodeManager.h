@@ -37,6 +37,10 @@ typedef struct apx_nodeManager_tag
    adt_hash_t remoteNodeDataMap; //hash containing strong references to apx_nodeData_t remotely connected nodes, only used in server mode
    adt_hash_t localNodeDataMap; //hash containing weak references to apx_nodeData_t for locally connected nodes. only used in client mode
    adt_list_t fileManagerList; //linked list of attached file managers (so far there is a one-to-one relationship between connection and fileManager)
+   adt_hash_t parkedNodeMap; //hash of strong references to apx_nodeManager_parkedNode_t, keyed by node name. Nodes of disconnected clients wait here for their client to reconnect. Only used in server mode
+   uint32_t sessionGracePeriodMs; //how long the nodes of a disconnected client are parked, 0 means nodes are removed immediately
+   adt_hash_t definitionParserMap; //hash of strong references to apx_nodeManager_definitionParser_t, keyed by node name. Definition files that are still being transferred are parsed here chunk by chunk. Only used in server mode
+   adt_hash_t nodeTemplateMap; //hash of strong references to finalized apx_node_t, keyed by the SHA-256 digest (hex) of the definition file they were parsed from. Only used in server mode
    int8_t debugMode;
    MUTEX_T lock; //locking mechanism
 }apx_nodeManager_t;
@@ -54,10 +58,14 @@ void apx_nodeManager_destroy(apx_nodeManager_t *self);
 void apx_nodeManager_remoteFileAdded(apx_nodeManager_t *self, struct apx_fileManager_tag *fileManager, apx_file_t *remoteFile);
 void apx_nodeManager_remoteFileRemoved(apx_nodeManager_t *self, struct apx_fileManager_tag *fileManager, apx_file_t *remoteFile);
 void apx_nodeManager_remoteFileWritten(apx_nodeManager_t *self, struct apx_fileManager_tag *fileManager, apx_file_t *remoteFile, uint32_t offset, int32_t length);
+void apx_nodeManager_remoteFileChunkWritten(apx_nodeManager_t *self, struct apx_fileManager_tag *fileManager, apx_file_t *remoteFile, uint32_t offset, int32_t length);
 void apx_nodeManager_setRouter(apx_nodeManager_t *self, struct apx_router_tag *router);
 void apx_nodeManager_attachLocalNode(apx_nodeManager_t *self, apx_nodeData_t *nodeData);
 void apx_nodeManager_attachFileManager(apx_nodeManager_t *self, struct apx_fileManager_tag *fileManager);
 void apx_nodeManager_detachFileManager(apx_nodeManager_t *self, struct apx_fileManager_tag *fileManager);
+void apx_nodeManager_setSessionGracePeriod(apx_nodeManager_t *self, uint32_t gracePeriodMs);
+void apx_nodeManager_parkFileManager(apx_nodeManager_t *self, struct apx_fileManager_tag *fileManager, uint32_t timestampMs);
+void apx_nodeManager_expireParkedNodes(apx_nodeManager_t *self, uint32_t timestampMs);
 void apx_nodeManager_setDebugMode(apx_nodeManager_t *self, int8_t debugMode);
 
 #endif //APX_NODE_MANAGER_H
@@ -0,0 +1,42 @@
+#ifndef APX_PAYLOAD_H
+#define APX_PAYLOAD_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Reference counted port data buffer.
+ *
+ * A payload is created once per routed write and shared by the message queues of all destinations.
+ * The creator fills in the data before the payload is shared, after that it is immutable.
+ * The memory is returned when the last reference is released, this can happen on any thread.
+ */
+typedef struct apx_payload_tag
+{
+   volatile int32_t refCount;
+   uint32_t length;
+   //followed by length bytes of data
+}apx_payload_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+apx_payload_t *apx_payload_new(uint32_t length);
+void apx_payload_retain(apx_payload_t *self);
+void apx_payload_release(apx_payload_t *self);
+uint8_t *apx_payload_data(apx_payload_t *self);
+uint32_t apx_payload_length(const apx_payload_t *self);
+int32_t apx_payload_getNumAllocated(void);
+
+#endif //APX_PAYLOAD_H
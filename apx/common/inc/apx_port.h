@@ -3,6 +3,7 @@
 //simple port - data port with one data element
 #include "apx_dataSignature.h"
 #include "apx_portAttributes.h"
+#include "apx_portSignatureTable.h"
 
 #define APX_REQUIRE_PORT 0
 #define APX_PROVIDE_PORT 1
@@ -12,9 +13,12 @@ typedef struct apx_port_tag{
 	char *dataSignature; //underived data signature, this string usually contains just a type reference, e.g. "T[0]"
 	apx_dataSignature_t derivedDsg; //this is the true data signature, e.g. "C(0.7)"
 	apx_portAttributes_t *portAttributes; //port attributes object, includes the raw attributes string
-	char *portSignature; //full port signature, excluding the initial 'R' or 'P'
+	const char *portSignature; //full port signature, excluding the initial 'R' or 'P'. Weak reference to the string stored in the port signature table
+	int32_t portSignatureId; //ID of portSignature in the port signature table, APX_INVALID_PORT_SIGNATURE_ID until the port signature has been derived
 	uint8_t portType; //APX_REQUIRE_PORT or APX_PROVIDE_PORT
 	int32_t portIndex; //index of the port 0..len(ports) where it resides on its parent node
+	int32_t portMapIndex; //position of this port in the apx_routerPortMapEntry_t list it is registered in, -1 when not registered
+	int32_t connectorIndex; //require ports only: position of the connector to this port in the connector list of its provide port, -1 when not connected
 }apx_port_t;
 
 /***************** Public Function Declarations *******************/
@@ -29,6 +33,7 @@ void apx_port_vdelete(void *arg);
 void apx_port_setDerivedDataSignature(apx_port_t *self, const char *dataSignature);
 const char *apx_port_derivePortSignature(apx_port_t *self);
 const char *apx_port_getPortSignature(apx_port_t *self);
+int32_t apx_port_getPortSignatureId(apx_port_t *self);
 int32_t apx_port_getPackLen(apx_port_t *self);
 void apx_port_setPortIndex(apx_port_t *self, int32_t portIndex);
 int32_t  apx_port_getPortIndex(apx_port_t *self);
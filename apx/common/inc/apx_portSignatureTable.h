@@ -0,0 +1,37 @@
+#ifndef APX_PORT_SIGNATURE_TABLE_H
+#define APX_PORT_SIGNATURE_TABLE_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Global symbol table for port signatures.
+ *
+ * Each distinct port signature string is stored once and is given a small integer ID. All ports with the same signature
+ * share the stored string and the ID, which lets the router index its portMap by ID instead of hashing strings.
+ * IDs are reference counted; the ID of a signature that is no longer used by any port is handed out again later.
+ * All functions can be called from any thread.
+ */
+
+#define APX_INVALID_PORT_SIGNATURE_ID -1
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+int32_t apx_portSignatureTable_intern(const char *portSignature, const char **internedSignature);
+void apx_portSignatureTable_release(int32_t signatureId);
+const char *apx_portSignatureTable_getSignature(int32_t signatureId);
+int32_t apx_portSignatureTable_getNumSignatures(void);
+
+#endif //APX_PORT_SIGNATURE_TABLE_H
@@ -5,13 +5,13 @@
 #include "apx_node.h"
 #include "apx_nodeInfo.h"
 #include "adt_ary.h"
-#include "adt_hash.h"
 #include "apx_routerPortMapEntry.h"
 
 typedef struct apx_router_tag
 {
-   adt_ary_t nodeInfoList; //list of apx_nodeInto_t
-   adt_hash_t portMap; //hash of apx_routerPortMapEntry_t
+   adt_ary_t nodeInfoList; //list of apx_nodeInto_t (unordered, each nodeInfo knows its own position through routerIndex)
+   adt_ary_t dirtyNodeInfoList; //nodeInfo objects with pending port flags, these are the only nodes that need post processing
+   adt_ary_t portMap; //list of apx_routerPortMapEntry_t, indexed by port signature ID (see apx_portSignatureTable.h)
    int8_t debugMode;
 }apx_router_t;
 
@@ -21,6 +21,8 @@ void apx_router_destroy(apx_router_t *self);
 
 void apx_router_attachNodeInfo(apx_router_t *self, apx_nodeInfo_t *nodeInfo);
 void apx_router_detachNodeInfo(apx_router_t *self, apx_nodeInfo_t *nodeInfo);
+void apx_router_attachNodeInfoBatch(apx_router_t *self, const adt_ary_t *nodeInfoList);
+void apx_router_detachNodeInfoBatch(apx_router_t *self, const adt_ary_t *nodeInfoList);
 void apx_router_setDebugMode(apx_router_t *self, int8_t debugMode);
 
 #endif //APX_ROUTER_H
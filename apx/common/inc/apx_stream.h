@@ -38,7 +38,7 @@ typedef struct apx_declarationLine_tag
 
 typedef struct apx_istream_t{
    apx_istream_handler_t handler;
-   adt_bytearray_t buf;
+   adt_bytearray_t buf; //incomplete line left over from the previous chunk, complete lines are parsed in place
    uint8_t parseState;
    apx_declarationLine_t declarationLine;
 }apx_istream_t;
@@ -21,6 +21,9 @@ typedef struct apx_transmitHandler_tag
    int32_t (*getSendAvail)(void *arg); //this is used to query the transmitHandler how many bytes that can be provided by getSendBuffer
    uint8_t* (*getSendBuffer)(void *arg, int32_t msgLen); //transmitHandler shall attempt to allocate a buffer of appropriate length
    int32_t (*send)(void *arg, int32_t offset, int32_t msgLen); //Returns 0 on success, -1 on error
+   //Batching (optional, Classic API)
+   void (*beginBatch)(void *arg); //messages given to send after this call may be queued by the transmitHandler until endBatch is called
+   void (*endBatch)(void *arg); //transmits all queued messages, preferably in as few system calls as possible
 
    //New API (APX-ES only)
    uint8_t* (*getMsgBuffer)(void *arg, int32_t *maxMsgLen, int32_t *sendAvail); //Returns a pointer to a message buffer, maxMsgLen is the maximum allowed message length, sendAvail is the number of bytes free in the underlying send buffer
@@ -0,0 +1,73 @@
+#ifndef APX_WORKER_POOL_H
+#define APX_WORKER_POOL_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#if defined(_MSC_PLATFORM_TOOLSET) && (_MSC_PLATFORM_TOOLSET<=110)
+#include "msc_bool.h"
+#else
+#include <stdbool.h>
+#endif
+
+#ifdef _MSC_VER
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <semaphore.h>
+#endif
+#include "osmacro.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//forward declaration
+struct apx_fileManager_tag;
+
+#ifndef APX_WORKER_POOL_MAX_BATCH
+#define APX_WORKER_POOL_MAX_BATCH 64 //maximum number of messages processed from one fileManager before the worker moves on to the next one
+#endif
+
+/**
+ * A fixed-size pool of worker threads that processes the message queues of many fileManagers.
+ * Each fileManager is scheduled as a work item and is serviced by at most one worker at a time which preserves the per-connection message order.
+ */
+typedef struct apx_workerPool_tag
+{
+   THREAD_T *workerThreads; //strong pointer to array of worker threads
+   uint16_t numWorkers; //number of items in workerThreads
+   uint16_t numStarted; //number of workerThreads that were successfully started
+   SPINLOCK_T lock;  //variable lock
+   SEMAPHORE_T semaphore; //posted once for each scheduled fileManager
+
+   //data object, all read/write accesses to these must be protected by the lock variable above
+   struct apx_fileManager_tag *runQueueHead; //weak pointer to first fileManager waiting for a worker
+   struct apx_fileManager_tag *runQueueTail; //weak pointer to last fileManager waiting for a worker
+   bool isRunning; //when false it's time do shut down
+#ifdef _MSC_VER
+   unsigned int threadId;
+#endif
+}apx_workerPool_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+int8_t apx_workerPool_create(apx_workerPool_t *self, uint16_t numWorkers);
+void apx_workerPool_destroy(apx_workerPool_t *self);
+apx_workerPool_t *apx_workerPool_new(uint16_t numWorkers);
+void apx_workerPool_delete(apx_workerPool_t *self);
+void apx_workerPool_vdelete(void *arg);
+
+int8_t apx_workerPool_start(apx_workerPool_t *self);
+void apx_workerPool_stop(apx_workerPool_t *self);
+bool apx_workerPool_isRunning(apx_workerPool_t *self);
+void apx_workerPool_schedule(apx_workerPool_t *self, struct apx_fileManager_tag *fileManager);
+
+#endif //APX_WORKER_POOL_H
@@ -3,13 +3,15 @@
 //////////////////////////////////////////////////////////////////////////////
 #include <errno.h>
 #include <malloc.h>
-#include <assert.h>
 #include <string.h>
 #include <stdio.h>
 #ifdef _MSC_VER
-#include <process.h>
+#include <Windows.h>
+#else
+#include <pthread.h>
 #endif
 #include "apx_allocator.h"
+#include "apx_atomic.h"
 #include "apx_logging.h"
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
@@ -19,13 +21,67 @@
 //////////////////////////////////////////////////////////////////////////////
 // CONSTANTS AND DATA TYPES
 //////////////////////////////////////////////////////////////////////////////
+#define MIN_SIZE_CLASS_SIZE 8u
+
+/**
+ * Placed in front of every small object. The union keeps the payload 8-byte aligned on all platforms.
+ */
+typedef union apx_allocatorHeader_tag
+{
+   struct apx_allocatorSlab_tag *slab; //slab the block was carved from, 0 when the block was taken directly from malloc
+   uint64_t align;
+}apx_allocatorHeader_t;
+
+/**
+ * Placed in front of the blocks of a slab. All blocks of a slab have the same size class.
+ */
+typedef struct apx_allocatorSlab_tag
+{
+   struct apx_allocatorCache_tag *owner; //cache the slab belongs to, never changes
+   struct apx_allocatorSlab_tag *next; //next slab in the same cache
+   struct apx_allocatorSlab_tag *prev; //previous slab in the same cache
+   struct apx_allocatorSlab_tag *nextAvailable; //next slab of the same size class with at least one free block
+   struct apx_allocatorSlab_tag *prevAvailable; //previous slab of the same size class with at least one free block
+   apx_allocatorHeader_t *freeList; //only accessed by the owning thread
+   uint32_t sizeClass;
+   uint32_t numUsed; //number of blocks handed out and not yet taken back by the owning thread
+}apx_allocatorSlab_t;
+
+typedef struct apx_allocatorCache_tag
+{
+   apx_allocatorSlab_t *available[APX_ALLOCATOR_NUM_SIZE_CLASSES]; //slabs with free blocks, only accessed by the owning thread
+   apx_allocatorHeader_t *volatile remoteFreeList[APX_ALLOCATOR_NUM_SIZE_CLASSES]; //pushed by other threads, taken back by the owning thread
+   apx_allocatorSlab_t *slabs; //strong pointer, linked list of all slabs of this cache
+   volatile int32_t refCount; //1 while the owning thread is alive plus 1 per outstanding block
+}apx_allocatorCache_t;
+
+#define HEADER_SIZE ((uint32_t) sizeof(apx_allocatorHeader_t))
+#define SLAB_HEADER_SIZE ((((uint32_t) sizeof(apx_allocatorSlab_t)) + 7u) & ~7u)
+#define BLOCK_PAYLOAD(block) (((uint8_t*) (block)) + HEADER_SIZE)
+#define BLOCK_FROM_PAYLOAD(ptr) ((apx_allocatorHeader_t*) (((uint8_t*) (ptr)) - HEADER_SIZE))
+#define NEXT_BLOCK(block) (*(apx_allocatorHeader_t**) BLOCK_PAYLOAD(block)) //free blocks are linked through their payload
 
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
-static int8_t apx_allocator_startThread(apx_allocator_t *self);
-static THREAD_PROTO(threadTask,arg);
-
+static uint32_t apx_allocator_sizeClass(size_t size);
+static uint8_t *apx_allocator_allocSmall(size_t size);
+static void apx_allocator_freeSmall(uint8_t *ptr, uint32_t size);
+static apx_allocatorCache_t *apx_allocator_getThreadCache(void);
+static apx_allocatorSlab_t *apx_allocator_newSlab(apx_allocatorCache_t *cache, uint32_t sizeClass);
+static void apx_allocator_deleteSlab(apx_allocatorCache_t *cache, apx_allocatorSlab_t *slab);
+static void apx_allocator_linkAvailable(apx_allocatorCache_t *cache, apx_allocatorSlab_t *slab);
+static void apx_allocator_unlinkAvailable(apx_allocatorCache_t *cache, apx_allocatorSlab_t *slab);
+static void apx_allocator_takeBack(apx_allocatorCache_t *cache, apx_allocatorHeader_t *block);
+static void apx_allocator_takeBackRemote(apx_allocatorCache_t *cache, uint32_t sizeClass);
+static void apx_allocator_releaseCache(apx_allocatorCache_t *cache);
+#ifdef _MSC_VER
+static BOOL CALLBACK apx_allocator_createCacheKey(PINIT_ONCE initOnce, PVOID param, PVOID *context);
+static VOID WINAPI apx_allocator_onThreadExit(PVOID arg);
+#else
+static void apx_allocator_createCacheKey(void);
+static void apx_allocator_onThreadExit(void *arg);
+#endif
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL VARIABLES
@@ -34,38 +90,31 @@ static THREAD_PROTO(threadTask,arg);
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL VARIABLES
 //////////////////////////////////////////////////////////////////////////////
-
+static THREAD_LOCAL apx_allocatorCache_t *m_threadCache = 0;
+#ifdef _MSC_VER
+static INIT_ONCE m_cacheKeyOnce = INIT_ONCE_STATIC_INIT;
+static DWORD m_cacheKey = FLS_OUT_OF_INDEXES;
+#else
+static pthread_once_t m_cacheKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t m_cacheKey;
+static bool m_isCacheKeyValid = false;
+#endif
+static const uint32_t m_sizeClassSize[APX_ALLOCATOR_NUM_SIZE_CLASSES] = {8u, 16u, 32u, 64u, 128u, 256u};
+#if APX_ALLOCATOR_COUNT_ENABLE
+static volatile int32_t m_numSlabs = 0;
+#endif
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL FUNCTIONS
 //////////////////////////////////////////////////////////////////////////////
-int8_t apx_allocator_create(apx_allocator_t *self, uint16_t maxPendingMessages)
+int8_t apx_allocator_create(apx_allocator_t *self)
 {
    if (self != 0)
    {
-      size_t numElem;
-      size_t elemSize = sizeof(rbf_data_t);
-
-      numElem = (size_t) maxPendingMessages;
-#ifdef _WIN32
-      self->workerThread = INVALID_HANDLE_VALUE;
-#else
-      self->workerThread = 0;
-#endif
-      self->workerThreadValid=false;
-      SPINLOCK_INIT(self->lock);
-      SEMAPHORE_CREATE(self->semaphore);
-      self->isRunning = false;
-      self->ringBufferLen = (uint16_t) numElem;
-      self->ringBufferData = (uint8_t*) malloc(numElem*elemSize);
-      if (self->ringBufferData == 0)
-      {
-         return -1;
-      }
-      rbfs_create(&self->messages,self->ringBufferData,(uint16_t) numElem,(uint8_t) elemSize);
-      soa_init(&self->soa);
+      self->numAllocated = 0;
       return 0;
    }
+   errno = EINVAL;
    return -1;
 }
 
@@ -73,204 +122,389 @@ void apx_allocator_destroy(apx_allocator_t *self)
 {
    if (self != 0)
    {
-      if (self->ringBufferData != 0)
+#if APX_ALLOCATOR_COUNT_ENABLE
+      int32_t numAllocated = ATOMIC_LOAD_I32(&self->numAllocated);
+      if (numAllocated != 0)
       {
-         free(self->ringBufferData);
+         APX_LOG_WARNING("[APX_ALLOCATOR] destroyed with %d objects not freed", (int) numAllocated);
       }
-      soa_destroy(&self->soa);
-      SEMAPHORE_DESTROY(self->semaphore);
-      SPINLOCK_DESTROY(self->lock);
-   }
-}
-
-void apx_allocator_start(apx_allocator_t *self)
-{
-   if( (self != 0) && (self->workerThreadValid == false) )
-   {
-      apx_allocator_startThread(self);
+#endif
    }
 }
 
-void apx_allocator_stop(apx_allocator_t *self)
+/**
+ * Can be called from any thread
+ */
+uint8_t *apx_allocator_alloc(apx_allocator_t *self, size_t size)
 {
-   if( (self != 0) && (self->workerThreadValid == true) )
+   uint8_t *data = 0;
+   if ( (self != 0) && (size > 0) )
    {
-#ifdef _MSC_VER
-      DWORD result;
-#endif
-      rbf_data_t data = {0,0}; //sending a null-pointer with size 0 should wake up the workerThread
-      //1. enqueue message
-      SPINLOCK_ENTER(self->lock);
-      self->isRunning = false;
-      rbfs_insert(&self->messages,(const uint8_t*) &data);
-      SPINLOCK_LEAVE(self->lock);
-      //2. wake workerThread
-      SEMAPHORE_POST(self->semaphore);
-#ifdef _MSC_VER
-      result = WaitForSingleObject(self->workerThread, 5000);
-      if (result == WAIT_TIMEOUT)
-      {
-         APX_LOG_ERROR("[APX_ALLOCATOR] timeout while joining workerThread");
-      }
-      else if (result == WAIT_FAILED)
+      if (size <= APX_ALLOCATOR_MAX_SMALL_SIZE)
       {
-         DWORD lastError = GetLastError();
-         APX_LOG_ERROR("[APX_ALLOCATOR]  joining workerThread failed with %d", (int)lastError);         
+         data = apx_allocator_allocSmall(size);
       }
-      CloseHandle(self->workerThread);
-      self->workerThread = INVALID_HANDLE_VALUE;
-#else
-      if(pthread_equal(pthread_self(),self->workerThread) == 0)
+      else
       {
-         void *status;
-         int s = pthread_join(self->workerThread, &status);
-         if (s != 0)
-         {
-            APX_LOG_ERROR("[APX_ALLOCATOR] pthread_join error %d\n",s);
-         }
+         //use the default allocator
+         data = (uint8_t*) malloc(size);
       }
-      else
+#if APX_ALLOCATOR_COUNT_ENABLE
+      if (data != 0)
       {
-         APX_LOG_ERROR("[APX_ALLOCATOR] pthread_join attempted on pthread_self()\n");
+         (void) ATOMIC_FETCH_ADD_I32(&self->numAllocated, 1);
       }
 #endif
    }
+   return data;
 }
 
-uint8_t *apx_allocator_alloc(apx_allocator_t *self, size_t size)
+/**
+ * Can be called from any thread. The memory is returned to its owner immediately, no thread is woken up.
+ * size must be the same size as was used in the call to apx_allocator_alloc.
+ */
+void apx_allocator_free(apx_allocator_t *self, uint8_t *ptr, uint32_t size)
 {
-   uint8_t *data = 0;
-   if ( (self != 0) && (size > 0) )
+   if ( (self != 0) && (ptr != 0) )
    {
-      if (size <= SOA_SMALL_OBJECT_MAX_SIZE)
+#if APX_ALLOCATOR_COUNT_ENABLE
+      (void) ATOMIC_FETCH_ADD_I32(&self->numAllocated, -1);
+#endif
+      if (size <= APX_ALLOCATOR_MAX_SMALL_SIZE)
       {
-         //use the small object allocator
-         SPINLOCK_ENTER(self->lock);
-         data = (uint8_t*) soa_alloc(&self->soa, size);
-         SPINLOCK_LEAVE(self->lock);
+         apx_allocator_freeSmall(ptr, size);
       }
       else
       {
-         //use the default allocator
-         data = (uint8_t*) malloc(size);
+         free(ptr);
       }
    }
-   return data;
 }
 
-void apx_allocator_free(apx_allocator_t *self, uint8_t *ptr, uint32_t size)
+/**
+ * Returns the number of objects not yet freed. Always returns 0 when APX_ALLOCATOR_COUNT_ENABLE is not set.
+ */
+int32_t apx_allocator_getNumAllocated(apx_allocator_t *self)
 {
    if (self != 0)
    {
-      rbf_data_t data;
-      data.ptr=ptr;
-      data.size=size;
-      //1. enqueue message
-      SPINLOCK_ENTER(self->lock);
-      rbfs_insert(&self->messages,(const uint8_t*) &data);
-      SPINLOCK_LEAVE(self->lock);
-      //2. wake worker thread
-      SEMAPHORE_POST(self->semaphore);
+      return ATOMIC_LOAD_I32(&self->numAllocated);
    }
+   return 0;
 }
 
+/**
+ * Returns the number of slabs held by all thread caches. Always returns 0 when APX_ALLOCATOR_COUNT_ENABLE is not set.
+ */
+int32_t apx_allocator_getNumSlabs(void)
+{
+#if APX_ALLOCATOR_COUNT_ENABLE
+   return ATOMIC_LOAD_I32(&m_numSlabs);
+#else
+   return 0;
+#endif
+}
 
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL FUNCTIONS
 //////////////////////////////////////////////////////////////////////////////
-static int8_t apx_allocator_startThread(apx_allocator_t *self)
+static uint32_t apx_allocator_sizeClass(size_t size)
+{
+   uint32_t sizeClass = 0;
+   uint32_t classSize = MIN_SIZE_CLASS_SIZE;
+   while (classSize < size)
+   {
+      classSize <<= 1;
+      sizeClass++;
+   }
+   return sizeClass;
+}
+
+static uint8_t *apx_allocator_allocSmall(size_t size)
 {
-   if( self != 0){
-   self->isRunning = true;
-   self->workerThreadValid = true;
-#ifdef _WIN32
-      THREAD_CREATE(self->workerThread,threadTask,self,self->threadId);
-      if(self->workerThread == INVALID_HANDLE_VALUE){
-         self->workerThreadValid = false;
-         return -1;
+   uint32_t sizeClass = apx_allocator_sizeClass(size);
+   apx_allocatorCache_t *cache = apx_allocator_getThreadCache();
+   apx_allocatorHeader_t *block;
+   if (cache != 0)
+   {
+      apx_allocatorSlab_t *slab = cache->available[sizeClass];
+      if (slab == 0)
+      {
+         apx_allocator_takeBackRemote(cache, sizeClass);
+         slab = cache->available[sizeClass];
+         if (slab == 0)
+         {
+            slab = apx_allocator_newSlab(cache, sizeClass);
+         }
       }
-#else
-      int rc = THREAD_CREATE(self->workerThread,threadTask,self);
-      if(rc != 0){
-         self->workerThreadValid = false;
-         return -1;
+      if (slab != 0)
+      {
+         block = slab->freeList;
+         slab->freeList = NEXT_BLOCK(block);
+         slab->numUsed++;
+         if (slab->freeList == 0)
+         {
+            apx_allocator_unlinkAvailable(cache, slab);
+         }
+         (void) ATOMIC_FETCH_ADD_I32(&cache->refCount, 1);
+         return BLOCK_PAYLOAD(block);
       }
-#endif
-      //from this point forward all access to self must be protected by spin lock
-      return 0;
    }
-   errno = EINVAL;
-   return -1;
+   //no cache available for this thread, fall back to malloc
+   block = (apx_allocatorHeader_t*) malloc(HEADER_SIZE + m_sizeClassSize[sizeClass]);
+   if (block == 0)
+   {
+      return (uint8_t*) 0;
+   }
+   block->slab = (apx_allocatorSlab_t*) 0;
+   return BLOCK_PAYLOAD(block);
 }
 
-static THREAD_PROTO(threadTask,arg)
+static void apx_allocator_freeSmall(uint8_t *ptr, uint32_t size)
 {
-   if(arg!=0)
+   apx_allocatorHeader_t *block = BLOCK_FROM_PAYLOAD(ptr);
+   apx_allocatorCache_t *owner;
+   uint32_t sizeClass = apx_allocator_sizeClass(size);
+   if (block->slab == 0)
+   {
+      free(block);
+      return;
+   }
+   owner = block->slab->owner;
+   if (owner == m_threadCache)
+   {
+      apx_allocator_takeBack(owner, block);
+      (void) ATOMIC_FETCH_ADD_I32(&owner->refCount, -1); //never reaches 0 while the owning thread is alive
+   }
+   else
    {
-      rbf_data_t data;
-      apx_allocator_t *self;
-      uint32_t messages_processed=0;
-      self = (apx_allocator_t*) arg;
-      for(;;)
+      apx_allocatorHeader_t *head;
+      do
       {
+         head = (apx_allocatorHeader_t*) ATOMIC_LOAD_PTR(&owner->remoteFreeList[sizeClass]);
+         NEXT_BLOCK(block) = head;
+      } while (!ATOMIC_CAS_PTR(&owner->remoteFreeList[sizeClass], head, block));
+      apx_allocator_releaseCache(owner);
+   }
+}
+
+/**
+ * returns the cache of the calling thread, creating it on first use. Returns 0 if no cache could be created.
+ */
+static apx_allocatorCache_t *apx_allocator_getThreadCache(void)
+{
+   apx_allocatorCache_t *cache = m_threadCache;
+   if (cache == 0)
+   {
 #ifdef _MSC_VER
-         DWORD result = WaitForSingleObject(self->semaphore, INFINITE);
-         if (result == WAIT_OBJECT_0)
+      InitOnceExecuteOnce(&m_cacheKeyOnce, apx_allocator_createCacheKey, NULL, NULL);
+      if (m_cacheKey == FLS_OUT_OF_INDEXES)
+      {
+         return (apx_allocatorCache_t*) 0;
+      }
 #else
-         int result = sem_wait(&self->semaphore);
-         if (result == 0)
+      (void) pthread_once(&m_cacheKeyOnce, apx_allocator_createCacheKey);
+      if (m_isCacheKeyValid == false)
+      {
+         return (apx_allocatorCache_t*) 0;
+      }
 #endif
-         {
-            uint8_t bufResult;
-            bool delayedFree = false;
-            SPINLOCK_ENTER(self->lock);
-            bufResult = rbfs_remove(&self->messages,(uint8_t*) &data);
-            if (bufResult == E_BUF_OK)
-            {
-               if (data.ptr != 0)
-               {
-                  if (data.size<=SOA_SMALL_OBJECT_MAX_SIZE)
-                  {
-                     soa_free(&self->soa,data.ptr,data.size);
-                  }
-                  else
-                  {
-                     delayedFree = true;
-                  }
-               }
-            }
-            SPINLOCK_LEAVE(self->lock);
-            messages_processed++;
-            if (delayedFree == true)
-            {
-               free(data.ptr);
-            }
-            else if ( (bufResult == E_BUF_OK) && (data.ptr == 0) )
-            {
-               break; //NULL pointer is used to exit the thread
-            }
-            else
-            {
-               //Already handled by soa_free or bufResult != E_BUF_OK
-               assert(bufResult == E_BUF_OK);
-            }
-         }
-         else
-         {
+      cache = (apx_allocatorCache_t*) malloc(sizeof(apx_allocatorCache_t));
+      if (cache == 0)
+      {
+         return (apx_allocatorCache_t*) 0;
+      }
+      memset(cache, 0, sizeof(apx_allocatorCache_t));
+      cache->refCount = 1;
+      //the thread exit callback releases the reference held by the thread
 #ifdef _MSC_VER
-            DWORD lastError = GetLastError();
-            APX_LOG_ERROR("[APX_ALLOCATOR]: failure while waiting for semaphore, lastError=%d", lastError);
+      if (FlsSetValue(m_cacheKey, cache) == FALSE)
 #else
-            APX_LOG_ERROR("[APX_ALLOCATOR]: failure while waiting for semaphore, errno=%d", errno);
+      if (pthread_setspecific(m_cacheKey, cache) != 0)
 #endif
-            break;
-         }
+      {
+         free(cache);
+         return (apx_allocatorCache_t*) 0;
       }
-      //APX_LOG_DEBUG("[APX_ALLOCATOR]: messages_processed: %u\n", messages_processed);
+      m_threadCache = cache;
    }
-   THREAD_RETURN(0);
+   return cache;
 }
 
+/**
+ * carves a new slab into blocks of the given size class and makes it the first available slab of that size class
+ */
+static apx_allocatorSlab_t *apx_allocator_newSlab(apx_allocatorCache_t *cache, uint32_t sizeClass)
+{
+   uint32_t blockSize = HEADER_SIZE + m_sizeClassSize[sizeClass];
+   uint8_t *first;
+   uint32_t i;
+   apx_allocatorSlab_t *slab = (apx_allocatorSlab_t*) malloc(SLAB_HEADER_SIZE + blockSize*APX_ALLOCATOR_BLOCKS_PER_SLAB);
+   if (slab == 0)
+   {
+      return slab;
+   }
+   slab->owner = cache;
+   slab->sizeClass = sizeClass;
+   slab->numUsed = 0;
+   slab->prev = (apx_allocatorSlab_t*) 0;
+   slab->next = cache->slabs;
+   if (cache->slabs != 0)
+   {
+      cache->slabs->prev = slab;
+   }
+   cache->slabs = slab;
+   first = ((uint8_t*) slab) + SLAB_HEADER_SIZE;
+   for (i=0; i<APX_ALLOCATOR_BLOCKS_PER_SLAB; i++)
+   {
+      apx_allocatorHeader_t *block = (apx_allocatorHeader_t*) (first + i*blockSize);
+      block->slab = slab;
+      NEXT_BLOCK(block) = (i+1 < APX_ALLOCATOR_BLOCKS_PER_SLAB)? (apx_allocatorHeader_t*) (first + (i+1)*blockSize) : (apx_allocatorHeader_t*) 0;
+   }
+   slab->freeList = (apx_allocatorHeader_t*) first;
+   apx_allocator_linkAvailable(cache, slab);
+#if APX_ALLOCATOR_COUNT_ENABLE
+   (void) ATOMIC_FETCH_ADD_I32(&m_numSlabs, 1);
+#endif
+   return slab;
+}
 
+/**
+ * removes a slab from its cache and gives its memory back to the system
+ */
+static void apx_allocator_deleteSlab(apx_allocatorCache_t *cache, apx_allocatorSlab_t *slab)
+{
+   if (slab->prev != 0)
+   {
+      slab->prev->next = slab->next;
+   }
+   else
+   {
+      cache->slabs = slab->next;
+   }
+   if (slab->next != 0)
+   {
+      slab->next->prev = slab->prev;
+   }
+   free(slab);
+#if APX_ALLOCATOR_COUNT_ENABLE
+   (void) ATOMIC_FETCH_ADD_I32(&m_numSlabs, -1);
+#endif
+}
 
+static void apx_allocator_linkAvailable(apx_allocatorCache_t *cache, apx_allocatorSlab_t *slab)
+{
+   apx_allocatorSlab_t *head = cache->available[slab->sizeClass];
+   slab->prevAvailable = (apx_allocatorSlab_t*) 0;
+   slab->nextAvailable = head;
+   if (head != 0)
+   {
+      head->prevAvailable = slab;
+   }
+   cache->available[slab->sizeClass] = slab;
+}
 
+static void apx_allocator_unlinkAvailable(apx_allocatorCache_t *cache, apx_allocatorSlab_t *slab)
+{
+   if (slab->prevAvailable != 0)
+   {
+      slab->prevAvailable->nextAvailable = slab->nextAvailable;
+   }
+   else
+   {
+      cache->available[slab->sizeClass] = slab->nextAvailable;
+   }
+   if (slab->nextAvailable != 0)
+   {
+      slab->nextAvailable->prevAvailable = slab->prevAvailable;
+   }
+   slab->prevAvailable = (apx_allocatorSlab_t*) 0;
+   slab->nextAvailable = (apx_allocatorSlab_t*) 0;
+}
+
+/**
+ * puts block back on the free list of its slab. Called by the owning thread only.
+ * A slab whose last block comes back is given back to the system, unless it's the only slab of its size class with free blocks.
+ */
+static void apx_allocator_takeBack(apx_allocatorCache_t *cache, apx_allocatorHeader_t *block)
+{
+   apx_allocatorSlab_t *slab = block->slab;
+   if (slab->freeList == 0)
+   {
+      //the slab was full
+      apx_allocator_linkAvailable(cache, slab);
+   }
+   NEXT_BLOCK(block) = slab->freeList;
+   slab->freeList = block;
+   if ( (--slab->numUsed == 0) && ( (slab->prevAvailable != 0) || (slab->nextAvailable != 0) ) )
+   {
+      apx_allocator_unlinkAvailable(cache, slab);
+      apx_allocator_deleteSlab(cache, slab);
+   }
+}
+
+/**
+ * takes back everything other threads have freed since last time in one operation
+ */
+static void apx_allocator_takeBackRemote(apx_allocatorCache_t *cache, uint32_t sizeClass)
+{
+   apx_allocatorHeader_t *block = (apx_allocatorHeader_t*) ATOMIC_EXCHANGE_PTR(&cache->remoteFreeList[sizeClass], (apx_allocatorHeader_t*) 0);
+   while (block != 0)
+   {
+      apx_allocatorHeader_t *next = NEXT_BLOCK(block);
+      apx_allocator_takeBack(cache, block);
+      block = next;
+   }
+}
+
+/**
+ * drops one reference to the cache. The last reference deletes the cache together with all its slabs.
+ */
+static void apx_allocator_releaseCache(apx_allocatorCache_t *cache)
+{
+   if (ATOMIC_FETCH_ADD_I32(&cache->refCount, -1) == 1)
+   {
+      while (cache->slabs != 0)
+      {
+         apx_allocator_deleteSlab(cache, cache->slabs);
+      }
+      free(cache);
+   }
+}
+
+#ifdef _MSC_VER
+static BOOL CALLBACK apx_allocator_createCacheKey(PINIT_ONCE initOnce, PVOID param, PVOID *context)
+{
+   (void) initOnce;
+   (void) param;
+   (void) context;
+   m_cacheKey = FlsAlloc(apx_allocator_onThreadExit);
+   return TRUE;
+}
+
+static VOID WINAPI apx_allocator_onThreadExit(PVOID arg)
+{
+   if (arg != 0)
+   {
+      m_threadCache = (apx_allocatorCache_t*) 0;
+      apx_allocator_releaseCache((apx_allocatorCache_t*) arg);
+   }
+}
+#else
+static void apx_allocator_createCacheKey(void)
+{
+   if (pthread_key_create(&m_cacheKey, apx_allocator_onThreadExit) == 0)
+   {
+      m_isCacheKeyValid = true;
+   }
+}
+
+static void apx_allocator_onThreadExit(void *arg)
+{
+   if (arg != 0)
+   {
+      m_threadCache = (apx_allocatorCache_t*) 0;
+      apx_allocator_releaseCache((apx_allocatorCache_t*) arg);
+   }
+}
+#endif
@@ -0,0 +1,262 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <errno.h>
+#include <malloc.h>
+#include <string.h>
+#include "apx_conflationTable.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define MIN_CAPACITY 8u
+#define MAX_CAPACITY 0x80000000u
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static uint32_t apx_conflationTable_hash(const struct apx_file_tag *file, uint32_t offset);
+static uint32_t apx_conflationTable_lookup(const apx_conflationTable_t *self, const struct apx_file_tag *file, uint32_t offset);
+static int8_t apx_conflationTable_grow(apx_conflationTable_t *self);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+/**
+ * initialNumEntries is the number of entries the table can hold before it needs to grow.
+ * The table is allocated with at least twice as many slots to keep the probe sequences short.
+ */
+int8_t apx_conflationTable_create(apx_conflationTable_t *self, uint32_t initialNumEntries)
+{
+   if ( (self != 0) && (initialNumEntries > 0) && (initialNumEntries <= (MAX_CAPACITY/2)) )
+   {
+      uint32_t capacity = MIN_CAPACITY;
+      while (capacity < initialNumEntries*2)
+      {
+         capacity <<= 1;
+      }
+      self->entries = (apx_conflationEntry_t*) malloc(sizeof(apx_conflationEntry_t)*capacity);
+      if (self->entries == 0)
+      {
+         errno = ENOMEM;
+         return -1;
+      }
+      memset(self->entries, 0, sizeof(apx_conflationEntry_t)*capacity);
+      self->capacity = capacity;
+      self->numEntries = 0;
+      return 0;
+   }
+   errno = EINVAL;
+   return -1;
+}
+
+void apx_conflationTable_destroy(apx_conflationTable_t *self)
+{
+   if ( (self != 0) && (self->entries != 0) )
+   {
+      free(self->entries);
+      self->entries = (apx_conflationEntry_t*) 0;
+      self->numEntries = 0;
+   }
+}
+
+apx_conflationTable_t *apx_conflationTable_new(uint32_t initialNumEntries)
+{
+   apx_conflationTable_t *self = (apx_conflationTable_t*) malloc(sizeof(apx_conflationTable_t));
+   if(self != 0)
+   {
+      int8_t result = apx_conflationTable_create(self, initialNumEntries);
+      if (result != 0)
+      {
+         free(self);
+         self = 0;
+      }
+   }
+   else
+   {
+      errno = ENOMEM;
+   }
+   return self;
+}
+
+void apx_conflationTable_delete(apx_conflationTable_t *self)
+{
+   if (self != 0)
+   {
+      apx_conflationTable_destroy(self);
+      free(self);
+   }
+}
+
+void apx_conflationTable_vdelete(void *arg)
+{
+   apx_conflationTable_delete((apx_conflationTable_t*) arg);
+}
+
+/**
+ * returns the pending write for (file, offset) or 0 if there is none
+ */
+apx_conflationEntry_t *apx_conflationTable_find(apx_conflationTable_t *self, const struct apx_file_tag *file, uint32_t offset)
+{
+   if ( (self != 0) && (file != 0) )
+   {
+      uint32_t index = apx_conflationTable_lookup(self, file, offset);
+      if (self->entries[index].file != 0)
+      {
+         return &self->entries[index];
+      }
+   }
+   return (apx_conflationEntry_t*) 0;
+}
+
+/**
+ * makes data the latest pending write for (file, offset). Any previous entry for the same key is replaced.
+ */
+int8_t apx_conflationTable_insert(apx_conflationTable_t *self, struct apx_file_tag *file, uint32_t offset, uint32_t length, void *data)
+{
+   if ( (self != 0) && (file != 0) && (data != 0) )
+   {
+      uint32_t index = apx_conflationTable_lookup(self, file, offset);
+      apx_conflationEntry_t *entry = &self->entries[index];
+      if (entry->file == 0)
+      {
+         if ( ((self->numEntries+1)*2) > self->capacity)
+         {
+            if (apx_conflationTable_grow(self) != 0)
+            {
+               return -1;
+            }
+            index = apx_conflationTable_lookup(self, file, offset);
+            entry = &self->entries[index];
+         }
+         self->numEntries++;
+         entry->file = file;
+         entry->offset = offset;
+      }
+      entry->length = length;
+      entry->data = data;
+      return 0;
+   }
+   errno = EINVAL;
+   return -1;
+}
+
+/**
+ * removes the entry for (file, offset) but only if it still refers to data.
+ * Returns false when the entry has already been replaced by a newer write (or does not exist).
+ */
+bool apx_conflationTable_remove(apx_conflationTable_t *self, const struct apx_file_tag *file, uint32_t offset, const void *data)
+{
+   if ( (self != 0) && (file != 0) )
+   {
+      uint32_t mask = self->capacity-1;
+      uint32_t index = apx_conflationTable_lookup(self, file, offset);
+      uint32_t next;
+      if ( (self->entries[index].file == 0) || (self->entries[index].data != data) )
+      {
+         return false;
+      }
+      //backward shift deletion, moves entries in the same probe sequence into the hole so that no tombstones are needed
+      next = (index+1) & mask;
+      while (self->entries[next].file != 0)
+      {
+         uint32_t home = apx_conflationTable_hash(self->entries[next].file, self->entries[next].offset) & mask;
+         //the entry at next can be moved to index if its home slot is not located cyclically in (index, next]
+         if ( ((next - home) & mask) >= ((next - index) & mask) )
+         {
+            self->entries[index] = self->entries[next];
+            index = next;
+         }
+         next = (next+1) & mask;
+      }
+      memset(&self->entries[index], 0, sizeof(apx_conflationEntry_t));
+      self->numEntries--;
+      return true;
+   }
+   return false;
+}
+
+uint32_t apx_conflationTable_length(const apx_conflationTable_t *self)
+{
+   if (self != 0)
+   {
+      return self->numEntries;
+   }
+   return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static uint32_t apx_conflationTable_hash(const struct apx_file_tag *file, uint32_t offset)
+{
+   uint32_t hash = (uint32_t) (((uintptr_t) file) >> 4);
+   hash ^= offset * 2654435761u; //Knuth's multiplicative constant
+   hash ^= hash >> 16;
+   return hash;
+}
+
+/**
+ * returns the slot containing (file, offset) or the first free slot in its probe sequence
+ */
+static uint32_t apx_conflationTable_lookup(const apx_conflationTable_t *self, const struct apx_file_tag *file, uint32_t offset)
+{
+   uint32_t mask = self->capacity-1;
+   uint32_t index = apx_conflationTable_hash(file, offset) & mask;
+   for (;;)
+   {
+      const apx_conflationEntry_t *entry = &self->entries[index];
+      if ( (entry->file == 0) || ( (entry->file == file) && (entry->offset == offset) ) )
+      {
+         return index;
+      }
+      index = (index+1) & mask;
+   }
+}
+
+/**
+ * doubles the capacity and rehashes all entries
+ */
+static int8_t apx_conflationTable_grow(apx_conflationTable_t *self)
+{
+   apx_conflationEntry_t *oldEntries = self->entries;
+   uint32_t oldCapacity = self->capacity;
+   uint32_t i;
+   if (oldCapacity >= MAX_CAPACITY)
+   {
+      errno = ENOMEM;
+      return -1;
+   }
+   self->entries = (apx_conflationEntry_t*) malloc(sizeof(apx_conflationEntry_t)*oldCapacity*2);
+   if (self->entries == 0)
+   {
+      self->entries = oldEntries;
+      errno = ENOMEM;
+      return -1;
+   }
+   memset(self->entries, 0, sizeof(apx_conflationEntry_t)*oldCapacity*2);
+   self->capacity = oldCapacity*2;
+   for (i=0; i<oldCapacity; i++)
+   {
+      if (oldEntries[i].file != 0)
+      {
+         self->entries[apx_conflationTable_lookup(self, oldEntries[i].file, oldEntries[i].offset)] = oldEntries[i];
+      }
+   }
+   free(oldEntries);
+   return 0;
+}
@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <string.h>
 #include "apx_dataElement.h"
+#include "apx_dataProgram.h"
 #include "apx_error.h"
 #include "pack.h"
 #ifdef MEM_LEAK_CHECK
@@ -19,6 +20,7 @@
 /**************** Private Function Declarations *******************/
 static uint8_t *apx_dataElement_pack_sv(apx_dataElement_t *self, uint8_t *pBegin, uint8_t *pEnd, dtl_sv_t *sv);
 static uint8_t *apx_dataElement_pack_record(apx_dataElement_t *self, uint8_t *pBegin, uint8_t *pEnd, dtl_av_t *av);
+static uint32_t apx_dataElement_getPrimitiveSize(apx_dataElement_t *self);
 
 /**************** Private Variable Declarations *******************/
 
@@ -251,6 +253,82 @@ uint8_t *apx_dataElement_pack_dv(apx_dataElement_t *self, uint8_t *pBegin, uint8
    return 0;
 }
 
+/**
+ * Unpacks the data in [pBegin, pEnd) into a dtl value, the reverse of apx_dataElement_pack_dv. See apx_dataProgram_unpack_dv for the semantics of dv.
+ * The data element is compiled for each call, use apx_dataSignature_unpack_dv to decode the same signature repeatedly.
+ */
+const uint8_t *apx_dataElement_unpack_dv(apx_dataElement_t *self, const uint8_t *pBegin, const uint8_t *pEnd, dtl_dv_t **dv)
+{
+   if ( (self != 0) && (pBegin != 0) && (pEnd != 0) && (pBegin <= pEnd) && (dv != 0) )
+   {
+      apx_dataProgram_t program;
+      const uint8_t *pResult = 0;
+      apx_dataProgram_create(&program);
+      if (apx_dataProgram_compile(&program, self) == 0)
+      {
+         pResult = apx_dataProgram_unpack_dv(&program, pBegin, pEnd, dv);
+      }
+      apx_dataProgram_destroy(&program);
+      return pResult;
+   }
+   errno = EINVAL;
+   return 0;
+}
+
+/**
+ * Packs a numeric element from the native C array values, e.g. uint16_t[arrayLen] for "S[arrayLen]" (a single value when arrayLen is 0).
+ * The whole array is packed in one call to packArrayLE instead of value by value.
+ * returns pointer to the byte after the packed data on success, 0 on failure
+ */
+uint8_t *apx_dataElement_pack_array(apx_dataElement_t *self, uint8_t *pBegin, uint8_t *pEnd, const void *values)
+{
+   if ( (self != 0) && (pBegin != 0) && (pEnd != 0) && (pBegin <= pEnd) && (values != 0) )
+   {
+      uint32_t elemSize = apx_dataElement_getPrimitiveSize(self);
+      uint32_t numElem = (self->arrayLen > 0)? self->arrayLen : 1u;
+      if (elemSize == 0)
+      {
+         apx_setError(APX_ELEMENT_TYPE_ERROR);
+         return 0;
+      }
+      if ( (uint32_t) (pEnd - pBegin) < (elemSize * numElem) )
+      {
+         apx_setError(APX_LENGTH_ERROR);
+         return 0;
+      }
+      packArrayLE(pBegin, values, (uint8_t) elemSize, numElem);
+      return pBegin + (elemSize * numElem);
+   }
+   errno = EINVAL;
+   return 0;
+}
+
+/**
+ * Unpacks a numeric element into the native C array values, the reverse of apx_dataElement_pack_array
+ */
+const uint8_t *apx_dataElement_unpack_array(apx_dataElement_t *self, const uint8_t *pBegin, const uint8_t *pEnd, void *values)
+{
+   if ( (self != 0) && (pBegin != 0) && (pEnd != 0) && (pBegin <= pEnd) && (values != 0) )
+   {
+      uint32_t elemSize = apx_dataElement_getPrimitiveSize(self);
+      uint32_t numElem = (self->arrayLen > 0)? self->arrayLen : 1u;
+      if (elemSize == 0)
+      {
+         apx_setError(APX_ELEMENT_TYPE_ERROR);
+         return 0;
+      }
+      if ( (uint32_t) (pEnd - pBegin) < (elemSize * numElem) )
+      {
+         apx_setError(APX_LENGTH_ERROR);
+         return 0;
+      }
+      unpackArrayLE(values, pBegin, (uint8_t) elemSize, numElem);
+      return pBegin + (elemSize * numElem);
+   }
+   errno = EINVAL;
+   return 0;
+}
+
 void apx_dataElement_setArrayLen(apx_dataElement_t *self, uint32_t arrayLen)
 {
    if (self != 0)
@@ -478,3 +556,27 @@ static uint8_t *apx_dataElement_pack_record(apx_dataElement_t *self, uint8_t *pB
 }
 
 
+
+/**
+ * size in bytes of one value of a numeric element, 0 for strings and records
+ */
+static uint32_t apx_dataElement_getPrimitiveSize(apx_dataElement_t *self)
+{
+   switch(self->baseType)
+   {
+   case APX_BASE_TYPE_UINT8:
+   case APX_BASE_TYPE_SINT8:
+      return (uint32_t) sizeof(uint8_t);
+   case APX_BASE_TYPE_UINT16:
+   case APX_BASE_TYPE_SINT16:
+      return (uint32_t) sizeof(uint16_t);
+   case APX_BASE_TYPE_UINT32:
+   case APX_BASE_TYPE_SINT32:
+      return (uint32_t) sizeof(uint32_t);
+   case APX_BASE_TYPE_UINT64:
+   case APX_BASE_TYPE_SINT64:
+      return (uint32_t) sizeof(uint64_t);
+   default:
+      return 0;
+   }
+}
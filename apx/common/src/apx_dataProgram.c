@@ -0,0 +1,1015 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <errno.h>
+#include <malloc.h>
+#include <string.h>
+#include "apx_dataProgram.h"
+#include "apx_error.h"
+#include "pack.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define MIN_CAPACITY 8u
+#define APX_DATA_PROGRAM_ALIGN(offset, align) ( ( (offset) + (align) - 1u) & ~((align) - 1u) )
+
+/**
+ * Compiler state: the next free offset in the packed data and in the native struct
+ */
+typedef struct apx_dataProgramLayout_tag
+{
+   uint32_t offset;
+   uint32_t structOffset;
+   uint32_t structAlign; //largest member alignment seen so far
+}apx_dataProgramLayout_t;
+
+/**
+ * Interpreter state for one open RECORD or ARRAY instruction
+ */
+typedef struct apx_dataProgramFrame_tag
+{
+   dtl_av_t *av; //weak pointer, the array value that provides the values of this frame
+   int32_t index; //index in av of the next value to consume
+   uint8_t opcode; //APX_DATA_OP_RECORD or APX_DATA_OP_ARRAY
+   uint32_t pc; //ARRAY only: index of the first instruction of the element body
+   uint32_t base; //ARRAY only: base offset of the enclosing frame
+}apx_dataProgramFrame_t;
+
+/**
+ * Interpreter state for one open RECORD or ARRAY instruction in apx_dataProgram_copyStruct
+ */
+typedef struct apx_dataProgramStructFrame_tag
+{
+   uint8_t opcode;
+   uint32_t pc; //ARRAY only: index of the first instruction of the element body
+   uint32_t index; //ARRAY only: index of the element being unpacked
+   uint32_t base; //ARRAY only: base offset of the enclosing frame
+   uint32_t structBase; //ARRAY only: struct base offset of the enclosing frame
+}apx_dataProgramStructFrame_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static apx_dataInstruction_t *apx_dataProgram_emit(apx_dataProgram_t *self, uint8_t opcode, uint8_t flags, uint32_t offset, uint32_t length, uint32_t count);
+static int8_t apx_dataProgram_compileElement(apx_dataProgram_t *self, const apx_dataElement_t *dataElement, apx_dataProgramLayout_t *layout, int32_t depth);
+static int8_t apx_dataProgram_compileRecord(apx_dataProgram_t *self, const apx_dataElement_t *dataElement, apx_dataProgramLayout_t *layout, int32_t depth);
+static uint32_t apx_dataProgram_getStructAlign(const apx_dataElement_t *dataElement);
+static uint32_t apx_dataProgram_getTypeSize(int8_t baseType);
+static dtl_sv_t *apx_dataProgram_getScalar(dtl_av_t *av, int32_t index, dtl_dv_t *dv);
+static uint8_t *apx_dataProgram_packPrimitive(const apx_dataInstruction_t *instruction, uint8_t *pNext, dtl_av_t *av, int32_t index, dtl_dv_t *dv);
+static dtl_dv_t *apx_dataProgram_getOrCreate(dtl_av_t *av, int32_t index, dtl_dv_type_id dvType);
+static const uint8_t *apx_dataProgram_unpackPrimitive(const apx_dataInstruction_t *instruction, const uint8_t *pNext, dtl_av_t *av, int32_t index, dtl_sv_t *sv);
+static int8_t apx_dataProgram_copyStruct(const apx_dataProgram_t *self, uint8_t *pPacked, uint32_t packedLen, uint8_t *pStruct, uint32_t structLen, bool toPacked);
+static void apx_dataProgram_copyPrimitive(const apx_dataInstruction_t *instruction, uint8_t *pPacked, uint8_t *pStruct, bool toPacked);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+void apx_dataProgram_create(apx_dataProgram_t *self)
+{
+   if (self != 0)
+   {
+      self->instructions = (apx_dataInstruction_t*) 0;
+      self->numInstructions = 0;
+      self->capacity = 0;
+      self->packLen = 0;
+      self->structSize = 0;
+   }
+}
+
+void apx_dataProgram_destroy(apx_dataProgram_t *self)
+{
+   if ( (self != 0) && (self->instructions != 0) )
+   {
+      free(self->instructions);
+      self->instructions = (apx_dataInstruction_t*) 0;
+   }
+}
+
+apx_dataProgram_t *apx_dataProgram_new(void)
+{
+   apx_dataProgram_t *self = (apx_dataProgram_t*) malloc(sizeof(apx_dataProgram_t));
+   if (self != 0)
+   {
+      apx_dataProgram_create(self);
+   }
+   else
+   {
+      errno = ENOMEM;
+   }
+   return self;
+}
+
+void apx_dataProgram_delete(apx_dataProgram_t *self)
+{
+   if (self != 0)
+   {
+      apx_dataProgram_destroy(self);
+      free(self);
+   }
+}
+
+void apx_dataProgram_vdelete(void *arg)
+{
+   apx_dataProgram_delete((apx_dataProgram_t*) arg);
+}
+
+/**
+ * Compiles the data element tree into a flat instruction array, replacing any previously compiled program.
+ * Consecutive record fields of the same primitive type are fused into a single instruction.
+ * returns 0 on success, -1 on failure (also sets errno or the apx error)
+ */
+int8_t apx_dataProgram_compile(apx_dataProgram_t *self, const apx_dataElement_t *dataElement)
+{
+   if ( (self != 0) && (dataElement != 0) )
+   {
+      apx_dataProgramLayout_t layout = {0, 0, 1};
+      self->numInstructions = 0;
+      self->packLen = 0;
+      self->structSize = 0;
+      if (apx_dataProgram_compileElement(self, dataElement, &layout, 0) != 0)
+      {
+         self->numInstructions = 0;
+         return -1;
+      }
+      self->packLen = layout.offset;
+      self->structSize = APX_DATA_PROGRAM_ALIGN(layout.structOffset, layout.structAlign);
+      return 0;
+   }
+   errno = EINVAL;
+   return -1;
+}
+
+/**
+ * Packs dv into the buffer [pBegin, pEnd) following the compiled program.
+ * Has the same semantics as apx_dataElement_pack_dv on the data element that the program was compiled from.
+ * returns pointer to the byte after the packed data on success, 0 on failure
+ */
+uint8_t *apx_dataProgram_pack_dv(const apx_dataProgram_t *self, uint8_t *pBegin, uint8_t *pEnd, dtl_dv_t *dv)
+{
+   if ( (self != 0) && (pBegin != 0) && (pEnd != 0) && (pBegin <= pEnd) && (dv != 0) )
+   {
+      apx_dataProgramFrame_t frames[APX_DATA_PROGRAM_MAX_DEPTH];
+      int32_t depth = 0;
+      uint32_t pc = 0;
+      uint32_t base = 0;
+      if ( (self->numInstructions == 0) || (self->packLen == 0) )
+      {
+         apx_setError(APX_ELEMENT_TYPE_ERROR);
+         return 0;
+      }
+      if ( (uint32_t) (pEnd - pBegin) < self->packLen )
+      {
+         apx_setError(APX_LENGTH_ERROR);
+         return 0;
+      }
+      while (pc < self->numInstructions)
+      {
+         const apx_dataInstruction_t *instruction = &self->instructions[pc++];
+         apx_dataProgramFrame_t *parent = (depth > 0)? &frames[depth-1] : (apx_dataProgramFrame_t*) 0;
+         if (instruction->opcode == APX_DATA_OP_END)
+         {
+            apx_dataProgramFrame_t *frame = &frames[depth-1];
+            if (frame->opcode == APX_DATA_OP_ARRAY)
+            {
+               //ARRAY frame, the element body has just been packed
+               const apx_dataInstruction_t *arrayInstruction = &self->instructions[frame->pc-1];
+               if (frame->index < (int32_t) arrayInstruction->count)
+               {
+                  base += arrayInstruction->length;
+                  pc = frame->pc;
+                  continue;
+               }
+               base = frame->base;
+            }
+            depth--;
+         }
+         else
+         {
+            dtl_dv_t *value = dv;
+            if ( (parent != 0) && ( (instruction->opcode == APX_DATA_OP_RECORD) || (instruction->opcode == APX_DATA_OP_ARRAY) || ( (instruction->flags & APX_DATA_FLAG_ARRAY) != 0) ) )
+            {
+               value = *dtl_av_get(parent->av, parent->index++);
+            }
+            if ( (instruction->opcode == APX_DATA_OP_RECORD) || (instruction->opcode == APX_DATA_OP_ARRAY) )
+            {
+               apx_dataProgramFrame_t *frame = &frames[depth];
+               if (dtl_dv_type(value) != DTL_DV_ARRAY)
+               {
+                  apx_setError(APX_DV_TYPE_ERROR); //expected array type from dv variable
+                  return 0;
+               }
+               if (dtl_av_length((dtl_av_t*) value) != (int32_t) instruction->count)
+               {
+                  apx_setError(APX_LENGTH_ERROR);
+                  return 0;
+               }
+               frame->av = (dtl_av_t*) value;
+               frame->index = 0;
+               frame->opcode = instruction->opcode;
+               frame->pc = pc;
+               frame->base = base;
+               if (instruction->opcode == APX_DATA_OP_ARRAY)
+               {
+                  base += instruction->offset;
+               }
+               depth++;
+            }
+            else if ( (instruction->flags & APX_DATA_FLAG_ARRAY) != 0)
+            {
+               if (dtl_dv_type(value) != DTL_DV_ARRAY)
+               {
+                  apx_setError(APX_DV_TYPE_ERROR); //expected array type from dv variable
+                  return 0;
+               }
+               if (dtl_av_length((dtl_av_t*) value) != (int32_t) instruction->count)
+               {
+                  apx_setError(APX_LENGTH_ERROR);
+                  return 0;
+               }
+               if (apx_dataProgram_packPrimitive(instruction, pBegin + base + instruction->offset, (dtl_av_t*) value, 0, 0) == 0)
+               {
+                  return 0;
+               }
+            }
+            else if (parent != 0)
+            {
+               //one or more consecutive record fields
+               if (apx_dataProgram_packPrimitive(instruction, pBegin + base + instruction->offset, parent->av, parent->index, 0) == 0)
+               {
+                  return 0;
+               }
+               parent->index += (int32_t) instruction->count;
+            }
+            else
+            {
+               if (apx_dataProgram_packPrimitive(instruction, pBegin + base + instruction->offset, 0, 0, dv) == 0)
+               {
+                  return 0;
+               }
+            }
+         }
+      }
+      return pBegin + self->packLen;
+   }
+   errno = EINVAL;
+   return 0;
+}
+
+/**
+ * Unpacks the data in [pBegin, pEnd) into a dtl value, the reverse of apx_dataProgram_pack_dv.
+ * If *dv is 0 a new value is created and returned in *dv.
+ * Otherwise *dv must be a value returned by an earlier call for the same signature: its arrays and scalars are updated in place,
+ * which means that decoding the same port repeatedly does not allocate.
+ * returns pointer to the byte after the unpacked data on success, 0 on failure. *dv is owned by the caller in both cases.
+ */
+const uint8_t *apx_dataProgram_unpack_dv(const apx_dataProgram_t *self, const uint8_t *pBegin, const uint8_t *pEnd, dtl_dv_t **dv)
+{
+   if ( (self != 0) && (pBegin != 0) && (pEnd != 0) && (pBegin <= pEnd) && (dv != 0) )
+   {
+      apx_dataProgramFrame_t frames[APX_DATA_PROGRAM_MAX_DEPTH];
+      int32_t depth = 0;
+      uint32_t pc = 0;
+      uint32_t base = 0;
+      const apx_dataInstruction_t *instruction;
+      dtl_dv_type_id rootType;
+      if ( (self->numInstructions == 0) || (self->packLen == 0) )
+      {
+         apx_setError(APX_ELEMENT_TYPE_ERROR);
+         return 0;
+      }
+      if ( (uint32_t) (pEnd - pBegin) < self->packLen )
+      {
+         apx_setError(APX_LENGTH_ERROR);
+         return 0;
+      }
+      instruction = &self->instructions[0];
+      rootType = ( (instruction->opcode == APX_DATA_OP_RECORD) || (instruction->opcode == APX_DATA_OP_ARRAY) || ( (instruction->flags & APX_DATA_FLAG_ARRAY) != 0) )? DTL_DV_ARRAY : DTL_DV_SCALAR;
+      if (*dv == 0)
+      {
+         *dv = (rootType == DTL_DV_ARRAY)? (dtl_dv_t*) dtl_av_new() : (dtl_dv_t*) dtl_sv_new();
+         if (*dv == 0)
+         {
+            errno = ENOMEM;
+            return 0;
+         }
+      }
+      else if (dtl_dv_type(*dv) != rootType)
+      {
+         apx_setError(APX_DV_TYPE_ERROR);
+         return 0;
+      }
+      while (pc < self->numInstructions)
+      {
+         apx_dataProgramFrame_t *parent = (depth > 0)? &frames[depth-1] : (apx_dataProgramFrame_t*) 0;
+         instruction = &self->instructions[pc++];
+         if (instruction->opcode == APX_DATA_OP_END)
+         {
+            apx_dataProgramFrame_t *frame = &frames[depth-1];
+            if (frame->opcode == APX_DATA_OP_ARRAY)
+            {
+               const apx_dataInstruction_t *arrayInstruction = &self->instructions[frame->pc-1];
+               if (frame->index < (int32_t) arrayInstruction->count)
+               {
+                  base += arrayInstruction->length;
+                  pc = frame->pc;
+                  continue;
+               }
+               base = frame->base;
+            }
+            depth--;
+         }
+         else
+         {
+            dtl_dv_t *value = *dv;
+            if ( (parent != 0) && ( (instruction->opcode == APX_DATA_OP_RECORD) || (instruction->opcode == APX_DATA_OP_ARRAY) || ( (instruction->flags & APX_DATA_FLAG_ARRAY) != 0) ) )
+            {
+               value = apx_dataProgram_getOrCreate(parent->av, parent->index++, DTL_DV_ARRAY);
+               if (value == 0)
+               {
+                  return 0;
+               }
+            }
+            if ( (instruction->opcode == APX_DATA_OP_RECORD) || (instruction->opcode == APX_DATA_OP_ARRAY) )
+            {
+               apx_dataProgramFrame_t *frame = &frames[depth];
+               if (dtl_av_length((dtl_av_t*) value) > (int32_t) instruction->count)
+               {
+                  apx_setError(APX_LENGTH_ERROR);
+                  return 0;
+               }
+               frame->av = (dtl_av_t*) value;
+               frame->index = 0;
+               frame->opcode = instruction->opcode;
+               frame->pc = pc;
+               frame->base = base;
+               if (instruction->opcode == APX_DATA_OP_ARRAY)
+               {
+                  base += instruction->offset;
+               }
+               depth++;
+            }
+            else if ( (instruction->flags & APX_DATA_FLAG_ARRAY) != 0)
+            {
+               if (dtl_av_length((dtl_av_t*) value) > (int32_t) instruction->count)
+               {
+                  apx_setError(APX_LENGTH_ERROR);
+                  return 0;
+               }
+               if (apx_dataProgram_unpackPrimitive(instruction, pBegin + base + instruction->offset, (dtl_av_t*) value, 0, 0) == 0)
+               {
+                  return 0;
+               }
+            }
+            else if (parent != 0)
+            {
+               if (apx_dataProgram_unpackPrimitive(instruction, pBegin + base + instruction->offset, parent->av, parent->index, 0) == 0)
+               {
+                  return 0;
+               }
+               parent->index += (int32_t) instruction->count;
+            }
+            else
+            {
+               if (apx_dataProgram_unpackPrimitive(instruction, pBegin + base + instruction->offset, 0, 0, (dtl_sv_t*) value) == 0)
+               {
+                  return 0;
+               }
+            }
+         }
+      }
+      return pBegin + self->packLen;
+   }
+   errno = EINVAL;
+   return 0;
+}
+
+/**
+ * Unpacks the data in [pBegin, pEnd) into the native C struct that matches the signature, without allocating memory.
+ * The struct declares the fields in signature order using the stdint.h types (uint8_t, int16_t, ...),
+ * char[N] for strings of size N, arrays for array fields and nested structs for records.
+ * A signature that is not a record maps to a struct with a single member.
+ * dataLen must be at least structSize of the program.
+ * returns pointer to the byte after the unpacked data on success, 0 on failure
+ */
+const uint8_t *apx_dataProgram_unpack_struct(const apx_dataProgram_t *self, const uint8_t *pBegin, const uint8_t *pEnd, void *data, uint32_t dataLen)
+{
+   if ( (self != 0) && (pBegin != 0) && (pEnd != 0) && (pBegin <= pEnd) && (data != 0) )
+   {
+      if (apx_dataProgram_copyStruct(self, (uint8_t*) pBegin, (uint32_t) (pEnd - pBegin), (uint8_t*) data, dataLen, false) != 0)
+      {
+         return 0;
+      }
+      return pBegin + self->packLen;
+   }
+   errno = EINVAL;
+   return 0;
+}
+
+/**
+ * Packs the native C struct that matches the signature (see apx_dataProgram_unpack_struct) into [pBegin, pEnd).
+ * Strings are copied up to the first null character and zero-padded to the size of the field.
+ * returns pointer to the byte after the packed data on success, 0 on failure
+ */
+uint8_t *apx_dataProgram_pack_struct(const apx_dataProgram_t *self, uint8_t *pBegin, uint8_t *pEnd, const void *data, uint32_t dataLen)
+{
+   if ( (self != 0) && (pBegin != 0) && (pEnd != 0) && (pBegin <= pEnd) && (data != 0) )
+   {
+      if (apx_dataProgram_copyStruct(self, pBegin, (uint32_t) (pEnd - pBegin), (uint8_t*) data, dataLen, true) != 0)
+      {
+         return 0;
+      }
+      return pBegin + self->packLen;
+   }
+   errno = EINVAL;
+   return 0;
+}
+
+uint32_t apx_dataProgram_length(const apx_dataProgram_t *self)
+{
+   if (self != 0)
+   {
+      return self->numInstructions;
+   }
+   return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static apx_dataInstruction_t *apx_dataProgram_emit(apx_dataProgram_t *self, uint8_t opcode, uint8_t flags, uint32_t offset, uint32_t length, uint32_t count)
+{
+   apx_dataInstruction_t *instruction;
+   if (self->numInstructions == self->capacity)
+   {
+      uint32_t capacity = (self->capacity == 0)? MIN_CAPACITY : self->capacity*2;
+      apx_dataInstruction_t *instructions = (apx_dataInstruction_t*) realloc(self->instructions, sizeof(apx_dataInstruction_t)*capacity);
+      if (instructions == 0)
+      {
+         errno = ENOMEM;
+         return (apx_dataInstruction_t*) 0;
+      }
+      self->instructions = instructions;
+      self->capacity = capacity;
+   }
+   instruction = &self->instructions[self->numInstructions++];
+   instruction->opcode = opcode;
+   instruction->flags = flags;
+   instruction->offset = offset;
+   instruction->length = length;
+   instruction->count = count;
+   instruction->structOffset = 0;
+   instruction->structLength = 0;
+   return instruction;
+}
+
+static int8_t apx_dataProgram_compileElement(apx_dataProgram_t *self, const apx_dataElement_t *dataElement, apx_dataProgramLayout_t *layout, int32_t depth)
+{
+   if (dataElement->baseType == APX_BASE_TYPE_RECORD)
+   {
+      if (depth >= APX_DATA_PROGRAM_MAX_DEPTH)
+      {
+         apx_setError(APX_UNSUPPORTED_ERROR);
+         return -1;
+      }
+      if (dataElement->arrayLen > 0)
+      {
+         uint32_t arrayIndex = self->numInstructions;
+         apx_dataProgramLayout_t elementLayout = {0, 0, 1};
+         uint32_t align = apx_dataProgram_getStructAlign(dataElement);
+         apx_dataInstruction_t *instruction;
+         layout->structOffset = APX_DATA_PROGRAM_ALIGN(layout->structOffset, align);
+         if (apx_dataProgram_emit(self, APX_DATA_OP_ARRAY, 0, layout->offset, 0, dataElement->arrayLen) == 0)
+         {
+            return -1;
+         }
+         if (apx_dataProgram_compileRecord(self, dataElement, &elementLayout, depth+1) != 0)
+         {
+            return -1;
+         }
+         if (apx_dataProgram_emit(self, APX_DATA_OP_END, 0, 0, 0, 0) == 0)
+         {
+            return -1;
+         }
+         instruction = &self->instructions[arrayIndex];
+         instruction->length = elementLayout.offset;
+         instruction->structOffset = layout->structOffset;
+         instruction->structLength = elementLayout.structOffset;
+         layout->offset += elementLayout.offset * dataElement->arrayLen;
+         layout->structOffset += elementLayout.structOffset * dataElement->arrayLen;
+         if (align > layout->structAlign)
+         {
+            layout->structAlign = align;
+         }
+         return 0;
+      }
+      return apx_dataProgram_compileRecord(self, dataElement, layout, depth);
+   }
+   else
+   {
+      apx_dataInstruction_t *instruction;
+      uint32_t typeSize = apx_dataProgram_getTypeSize(dataElement->baseType);
+      uint32_t align = typeSize;
+      if (typeSize == 0)
+      {
+         apx_setError(APX_ELEMENT_TYPE_ERROR);
+         return -1;
+      }
+      layout->structOffset = APX_DATA_PROGRAM_ALIGN(layout->structOffset, align);
+      if (align > layout->structAlign)
+      {
+         layout->structAlign = align;
+      }
+      if (dataElement->baseType == APX_BASE_TYPE_STRING)
+      {
+         uint32_t length = (dataElement->arrayLen > 0)? dataElement->arrayLen : typeSize;
+         instruction = apx_dataProgram_emit(self, APX_DATA_OP_STRING, 0, layout->offset, length, 1);
+         if (instruction == 0)
+         {
+            return -1;
+         }
+         instruction->structOffset = layout->structOffset;
+         instruction->structLength = length;
+         layout->offset += length;
+         layout->structOffset += length;
+      }
+      else if (dataElement->arrayLen > 0)
+      {
+         instruction = apx_dataProgram_emit(self, (uint8_t) dataElement->baseType, APX_DATA_FLAG_ARRAY, layout->offset, typeSize, dataElement->arrayLen);
+         if (instruction == 0)
+         {
+            return -1;
+         }
+         instruction->structOffset = layout->structOffset;
+         instruction->structLength = typeSize;
+         layout->offset += typeSize * dataElement->arrayLen;
+         layout->structOffset += typeSize * dataElement->arrayLen;
+      }
+      else
+      {
+         apx_dataInstruction_t *previous = (self->numInstructions > 0)? &self->instructions[self->numInstructions-1] : (apx_dataInstruction_t*) 0;
+         if ( (depth > 0) && (previous != 0) && (previous->opcode == (uint8_t) dataElement->baseType) && (previous->flags == 0) )
+         {
+            //previous record field has the same type, fuse it with this field (the struct members are contiguous as well)
+            previous->count++;
+         }
+         else
+         {
+            instruction = apx_dataProgram_emit(self, (uint8_t) dataElement->baseType, 0, layout->offset, typeSize, 1);
+            if (instruction == 0)
+            {
+               return -1;
+            }
+            instruction->structOffset = layout->structOffset;
+            instruction->structLength = typeSize;
+         }
+         layout->offset += typeSize;
+         layout->structOffset += typeSize;
+      }
+   }
+   return 0;
+}
+
+static int8_t apx_dataProgram_compileRecord(apx_dataProgram_t *self, const apx_dataElement_t *dataElement, apx_dataProgramLayout_t *layout, int32_t depth)
+{
+   int32_t i;
+   int32_t numChildren = (dataElement->childElements != 0)? adt_ary_length(dataElement->childElements) : 0;
+   uint32_t recordIndex = self->numInstructions;
+   uint32_t recordOffset;
+   uint32_t recordStructOffset;
+   uint32_t align;
+   apx_dataInstruction_t *instruction;
+   if (depth >= APX_DATA_PROGRAM_MAX_DEPTH)
+   {
+      apx_setError(APX_UNSUPPORTED_ERROR);
+      return -1;
+   }
+   if (numChildren <= 0)
+   {
+      apx_setError(APX_ELEMENT_TYPE_ERROR);
+      return -1;
+   }
+   align = apx_dataProgram_getStructAlign(dataElement);
+   layout->structOffset = APX_DATA_PROGRAM_ALIGN(layout->structOffset, align);
+   recordOffset = layout->offset;
+   recordStructOffset = layout->structOffset;
+   if (apx_dataProgram_emit(self, APX_DATA_OP_RECORD, 0, layout->offset, 0, (uint32_t) numChildren) == 0)
+   {
+      return -1;
+   }
+   for (i = 0; i < numChildren; i++)
+   {
+      const apx_dataElement_t *childElement = (const apx_dataElement_t*) adt_ary_value(dataElement->childElements, i);
+      if (apx_dataProgram_compileElement(self, childElement, layout, depth+1) != 0)
+      {
+         return -1;
+      }
+   }
+   if (apx_dataProgram_emit(self, APX_DATA_OP_END, 0, 0, 0, 0) == 0)
+   {
+      return -1;
+   }
+   //trailing padding, like the C compiler adds to a struct
+   layout->structOffset = APX_DATA_PROGRAM_ALIGN(layout->structOffset, align);
+   if (align > layout->structAlign)
+   {
+      layout->structAlign = align;
+   }
+   instruction = &self->instructions[recordIndex];
+   instruction->length = layout->offset - recordOffset;
+   instruction->structOffset = recordStructOffset;
+   instruction->structLength = layout->structOffset - recordStructOffset;
+   return 0;
+}
+
+/**
+ * alignment of the data element as a member of a native C struct
+ */
+static uint32_t apx_dataProgram_getStructAlign(const apx_dataElement_t *dataElement)
+{
+   if (dataElement->baseType == APX_BASE_TYPE_RECORD)
+   {
+      int32_t i;
+      int32_t numChildren = (dataElement->childElements != 0)? adt_ary_length(dataElement->childElements) : 0;
+      uint32_t align = 1;
+      for (i = 0; i < numChildren; i++)
+      {
+         uint32_t childAlign = apx_dataProgram_getStructAlign((const apx_dataElement_t*) adt_ary_value(dataElement->childElements, i));
+         if (childAlign > align)
+         {
+            align = childAlign;
+         }
+      }
+      return align;
+   }
+   else if (dataElement->baseType == APX_BASE_TYPE_STRING)
+   {
+      return 1;
+   }
+   else
+   {
+      uint32_t typeSize = apx_dataProgram_getTypeSize(dataElement->baseType);
+      return (typeSize > 0)? typeSize : 1;
+   }
+}
+
+static uint32_t apx_dataProgram_getTypeSize(int8_t baseType)
+{
+   switch(baseType)
+   {
+   case APX_BASE_TYPE_UINT8:
+   case APX_BASE_TYPE_SINT8:
+   case APX_BASE_TYPE_STRING:
+      return (uint32_t) sizeof(uint8_t);
+   case APX_BASE_TYPE_UINT16:
+   case APX_BASE_TYPE_SINT16:
+      return (uint32_t) sizeof(uint16_t);
+   case APX_BASE_TYPE_UINT32:
+   case APX_BASE_TYPE_SINT32:
+      return (uint32_t) sizeof(uint32_t);
+#if  defined(__GNUC__) && defined(__LP64__)
+   case APX_BASE_TYPE_UINT64:
+   case APX_BASE_TYPE_SINT64:
+      return (uint32_t) sizeof(uint64_t);
+#endif
+   default:
+      break;
+   }
+   return 0;
+}
+
+/**
+ * returns value number index of av, or dv when av is 0. Returns 0 (and sets the apx error) if the value is not a scalar.
+ */
+static dtl_sv_t *apx_dataProgram_getScalar(dtl_av_t *av, int32_t index, dtl_dv_t *dv)
+{
+   if (av != 0)
+   {
+      dv = *dtl_av_get(av, index);
+   }
+   if (dtl_dv_type(dv) != DTL_DV_SCALAR)
+   {
+      apx_setError(APX_DV_TYPE_ERROR); //expected scalar type from dv variable
+      return (dtl_sv_t*) 0;
+   }
+   return (dtl_sv_t*) dv;
+}
+
+/**
+ * Packs instruction->count values of the same primitive type, starting at index of av (or the single value dv when av is 0).
+ * The caller has already verified that the buffer is large enough.
+ */
+static uint8_t *apx_dataProgram_packPrimitive(const apx_dataInstruction_t *instruction, uint8_t *pNext, dtl_av_t *av, int32_t index, dtl_dv_t *dv)
+{
+   int32_t i;
+   int32_t end = index + (int32_t) instruction->count;
+   dtl_sv_t *sv;
+   const char *cstr;
+   size_t len;
+   switch(instruction->opcode)
+   {
+   case APX_DATA_OP_U8:
+      for (i = index; i < end; i++)
+      {
+         if ( (sv = apx_dataProgram_getScalar(av, i, dv)) == 0) return 0;
+         packU8(pNext, (uint8_t) dtl_sv_get_u32(sv));
+      }
+      break;
+   case APX_DATA_OP_U16:
+      for (i = index; i < end; i++)
+      {
+         if ( (sv = apx_dataProgram_getScalar(av, i, dv)) == 0) return 0;
+         packU16LE(pNext, (uint16_t) dtl_sv_get_u32(sv));
+      }
+      break;
+   case APX_DATA_OP_U32:
+      for (i = index; i < end; i++)
+      {
+         if ( (sv = apx_dataProgram_getScalar(av, i, dv)) == 0) return 0;
+         packU32LE(pNext, dtl_sv_get_u32(sv));
+      }
+      break;
+   case APX_DATA_OP_S8:
+      for (i = index; i < end; i++)
+      {
+         if ( (sv = apx_dataProgram_getScalar(av, i, dv)) == 0) return 0;
+         packU8(pNext, (uint8_t) dtl_sv_get_i32(sv));
+      }
+      break;
+   case APX_DATA_OP_S16:
+      for (i = index; i < end; i++)
+      {
+         if ( (sv = apx_dataProgram_getScalar(av, i, dv)) == 0) return 0;
+         packU16LE(pNext, (uint16_t) dtl_sv_get_i32(sv));
+      }
+      break;
+   case APX_DATA_OP_S32:
+      for (i = index; i < end; i++)
+      {
+         if ( (sv = apx_dataProgram_getScalar(av, i, dv)) == 0) return 0;
+         packU32LE(pNext, (uint32_t) dtl_sv_get_i32(sv));
+      }
+      break;
+#if  defined(__GNUC__) && defined(__LP64__)
+   case APX_DATA_OP_U64:
+      for (i = index; i < end; i++)
+      {
+         if ( (sv = apx_dataProgram_getScalar(av, i, dv)) == 0) return 0;
+         packU64LE(pNext, dtl_sv_get_u64(sv));
+      }
+      break;
+   case APX_DATA_OP_S64:
+      for (i = index; i < end; i++)
+      {
+         if ( (sv = apx_dataProgram_getScalar(av, i, dv)) == 0) return 0;
+         packU64LE(pNext, (uint64_t) dtl_sv_get_i64(sv));
+      }
+      break;
+#endif
+   case APX_DATA_OP_STRING:
+      if ( (sv = apx_dataProgram_getScalar(av, index, dv)) == 0) return 0;
+      cstr = dtl_sv_get_cstr(sv);
+      if (cstr == 0)
+      {
+         apx_setError(APX_DV_TYPE_ERROR);
+         return 0;
+      }
+      len = strlen(cstr);
+      if (len > instruction->length)
+      {
+         apx_setError(APX_LENGTH_ERROR);
+         return 0;
+      }
+      memcpy(pNext, cstr, len);
+      memset(pNext+len, 0, instruction->length-len);
+      pNext += instruction->length;
+      break;
+   default:
+      apx_setError(APX_UNSUPPORTED_ERROR);
+      return 0;
+   }
+   return pNext;
+}
+
+/**
+ * returns value number index of av, appending a new value of type dvType when av is shorter.
+ * Returns 0 (and sets the apx error) if the existing value has a different type.
+ */
+static dtl_dv_t *apx_dataProgram_getOrCreate(dtl_av_t *av, int32_t index, dtl_dv_type_id dvType)
+{
+   dtl_dv_t *dv;
+   if (index < dtl_av_length(av))
+   {
+      dv = *dtl_av_get(av, index);
+      if (dtl_dv_type(dv) != dvType)
+      {
+         apx_setError(APX_DV_TYPE_ERROR);
+         return (dtl_dv_t*) 0;
+      }
+      return dv;
+   }
+   dv = (dvType == DTL_DV_ARRAY)? (dtl_dv_t*) dtl_av_new() : (dtl_dv_t*) dtl_sv_new();
+   if (dv == 0)
+   {
+      errno = ENOMEM;
+      return (dtl_dv_t*) 0;
+   }
+   dtl_av_push(av, dv);
+   return dv;
+}
+
+/**
+ * Unpacks instruction->count values of the same primitive type into av, starting at index (or into the single value sv when av is 0).
+ * The caller has already verified that the buffer is large enough.
+ */
+static const uint8_t *apx_dataProgram_unpackPrimitive(const apx_dataInstruction_t *instruction, const uint8_t *pNext, dtl_av_t *av, int32_t index, dtl_sv_t *sv)
+{
+   int32_t i;
+   int32_t end = index + (int32_t) instruction->count;
+   const uint8_t *pTerminator;
+   switch(instruction->opcode)
+   {
+   case APX_DATA_OP_U8:
+      for (i = index; i < end; i++, pNext++)
+      {
+         if ( (av != 0) && ( (sv = (dtl_sv_t*) apx_dataProgram_getOrCreate(av, i, DTL_DV_SCALAR)) == 0) ) return 0;
+         dtl_sv_set_u32(sv, (uint32_t) *pNext);
+      }
+      break;
+   case APX_DATA_OP_U16:
+      for (i = index; i < end; i++, pNext+=2)
+      {
+         if ( (av != 0) && ( (sv = (dtl_sv_t*) apx_dataProgram_getOrCreate(av, i, DTL_DV_SCALAR)) == 0) ) return 0;
+         dtl_sv_set_u32(sv, (uint32_t) unpackLE(pNext, (uint8_t) sizeof(uint16_t)));
+      }
+      break;
+   case APX_DATA_OP_U32:
+      for (i = index; i < end; i++, pNext+=4)
+      {
+         if ( (av != 0) && ( (sv = (dtl_sv_t*) apx_dataProgram_getOrCreate(av, i, DTL_DV_SCALAR)) == 0) ) return 0;
+         dtl_sv_set_u32(sv, (uint32_t) unpackLE(pNext, (uint8_t) sizeof(uint32_t)));
+      }
+      break;
+   case APX_DATA_OP_S8:
+      for (i = index; i < end; i++, pNext++)
+      {
+         if ( (av != 0) && ( (sv = (dtl_sv_t*) apx_dataProgram_getOrCreate(av, i, DTL_DV_SCALAR)) == 0) ) return 0;
+         dtl_sv_set_i32(sv, (int32_t) (int8_t) *pNext);
+      }
+      break;
+   case APX_DATA_OP_S16:
+      for (i = index; i < end; i++, pNext+=2)
+      {
+         if ( (av != 0) && ( (sv = (dtl_sv_t*) apx_dataProgram_getOrCreate(av, i, DTL_DV_SCALAR)) == 0) ) return 0;
+         dtl_sv_set_i32(sv, (int32_t) (int16_t) unpackLE(pNext, (uint8_t) sizeof(uint16_t)));
+      }
+      break;
+   case APX_DATA_OP_S32:
+      for (i = index; i < end; i++, pNext+=4)
+      {
+         if ( (av != 0) && ( (sv = (dtl_sv_t*) apx_dataProgram_getOrCreate(av, i, DTL_DV_SCALAR)) == 0) ) return 0;
+         dtl_sv_set_i32(sv, (int32_t) unpackLE(pNext, (uint8_t) sizeof(uint32_t)));
+      }
+      break;
+#if  defined(__GNUC__) && defined(__LP64__)
+   case APX_DATA_OP_U64:
+      for (i = index; i < end; i++, pNext+=8)
+      {
+         if ( (av != 0) && ( (sv = (dtl_sv_t*) apx_dataProgram_getOrCreate(av, i, DTL_DV_SCALAR)) == 0) ) return 0;
+         dtl_sv_set_u64(sv, (uint64_t) unpackLE(pNext, (uint8_t) sizeof(uint64_t)));
+      }
+      break;
+   case APX_DATA_OP_S64:
+      for (i = index; i < end; i++, pNext+=8)
+      {
+         if ( (av != 0) && ( (sv = (dtl_sv_t*) apx_dataProgram_getOrCreate(av, i, DTL_DV_SCALAR)) == 0) ) return 0;
+         dtl_sv_set_i64(sv, (int64_t) unpackLE(pNext, (uint8_t) sizeof(uint64_t)));
+      }
+      break;
+#endif
+   case APX_DATA_OP_STRING:
+      if ( (av != 0) && ( (sv = (dtl_sv_t*) apx_dataProgram_getOrCreate(av, index, DTL_DV_SCALAR)) == 0) ) return 0;
+      pTerminator = (const uint8_t*) memchr(pNext, 0, instruction->length);
+      if (pTerminator == 0)
+      {
+         pTerminator = pNext + instruction->length;
+      }
+      dtl_sv_set_bstr(sv, (const char*) pNext, (const char*) pTerminator);
+      pNext += instruction->length;
+      break;
+   default:
+      apx_setError(APX_UNSUPPORTED_ERROR);
+      return 0;
+   }
+   return pNext;
+}
+
+/**
+ * Copies between packed data and the native C struct in the direction given by toPacked, following the compiled program.
+ * returns 0 on success, -1 on failure
+ */
+static int8_t apx_dataProgram_copyStruct(const apx_dataProgram_t *self, uint8_t *pPacked, uint32_t packedLen, uint8_t *pStruct, uint32_t structLen, bool toPacked)
+{
+   apx_dataProgramStructFrame_t frames[APX_DATA_PROGRAM_MAX_DEPTH];
+   int32_t depth = 0;
+   uint32_t pc = 0;
+   uint32_t base = 0;
+   uint32_t structBase = 0;
+   if ( (self->numInstructions == 0) || (self->packLen == 0) )
+   {
+      apx_setError(APX_ELEMENT_TYPE_ERROR);
+      return -1;
+   }
+   if ( (packedLen < self->packLen) || (structLen < self->structSize) )
+   {
+      apx_setError(APX_LENGTH_ERROR);
+      return -1;
+   }
+   while (pc < self->numInstructions)
+   {
+      const apx_dataInstruction_t *instruction = &self->instructions[pc++];
+      switch(instruction->opcode)
+      {
+      case APX_DATA_OP_RECORD:
+         frames[depth++].opcode = APX_DATA_OP_RECORD;
+         break;
+      case APX_DATA_OP_ARRAY:
+         frames[depth].opcode = APX_DATA_OP_ARRAY;
+         frames[depth].pc = pc;
+         frames[depth].index = 0;
+         frames[depth].base = base;
+         frames[depth].structBase = structBase;
+         base += instruction->offset;
+         structBase += instruction->structOffset;
+         depth++;
+         break;
+      case APX_DATA_OP_END:
+         if (frames[depth-1].opcode == APX_DATA_OP_ARRAY)
+         {
+            apx_dataProgramStructFrame_t *frame = &frames[depth-1];
+            const apx_dataInstruction_t *arrayInstruction = &self->instructions[frame->pc-1];
+            if (++frame->index < arrayInstruction->count)
+            {
+               base += arrayInstruction->length;
+               structBase += arrayInstruction->structLength;
+               pc = frame->pc;
+               break;
+            }
+            base = frame->base;
+            structBase = frame->structBase;
+         }
+         depth--;
+         break;
+      default:
+         apx_dataProgram_copyPrimitive(instruction, pPacked + base + instruction->offset, pStruct + structBase + instruction->structOffset, toPacked);
+         break;
+      }
+   }
+   return 0;
+}
+
+/**
+ * Copies instruction->count values of the same primitive type between the packed data and the struct member(s) at pStruct
+ */
+static void apx_dataProgram_copyPrimitive(const apx_dataInstruction_t *instruction, uint8_t *pPacked, uint8_t *pStruct, bool toPacked)
+{
+   if (instruction->opcode == APX_DATA_OP_STRING)
+   {
+      if (toPacked)
+      {
+         uint32_t len = 0;
+         while ( (len < instruction->length) && (pStruct[len] != 0u) )
+         {
+            len++;
+         }
+         memcpy(pPacked, pStruct, len);
+         memset(pPacked + len, 0, instruction->length - len);
+      }
+      else
+      {
+         memcpy(pStruct, pPacked, instruction->length);
+      }
+   }
+   else if (toPacked)
+   {
+      packArrayLE(pPacked, pStruct, (uint8_t) instruction->length, instruction->count);
+   }
+   else
+   {
+      unpackArrayLE(pStruct, pPacked, (uint8_t) instruction->length, instruction->count);
+   }
+}
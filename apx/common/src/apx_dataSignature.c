@@ -29,6 +29,7 @@ static const uint8_t *parseType(const uint8_t *pBegin, const uint8_t *pEnd, apx_
 static const uint8_t *parseArrayLength(const uint8_t *pBegin, const uint8_t *pEnd, apx_dataElement_t *pDataElement);
 static const uint8_t *parseLimit(const uint8_t *pBegin, const uint8_t *pEnd, apx_dataElement_t *pDataElement);
 static void calcPackLen(apx_dataElement_t *pDataElement);
+static void compileDataProgram(apx_dataSignature_t *self);
 /**************** Private Variable Declarations *******************/
 
 
@@ -86,6 +87,7 @@ int8_t apx_dataSignature_create(apx_dataSignature_t *self, const char *dsg)
       {
          self->str = 0;
       }
+      self->dataProgram = 0;
       if (self->str != 0)
       {
          self->dataElement=apx_dataElement_new(APX_BASE_TYPE_NONE,0);
@@ -108,6 +110,10 @@ void apx_dataSignature_destroy(apx_dataSignature_t *self)
       {
          apx_dataElement_delete(self->dataElement);
       }
+      if (self->dataProgram != 0)
+      {
+         apx_dataProgram_delete(self->dataProgram);
+      }
       if (self->str != 0)
       {
          free(self->str);
@@ -150,6 +156,7 @@ int8_t apx_dataSignature_update(apx_dataSignature_t *self,const char *dsg)
             {
                self->dataElement = apx_dataElement_new(APX_BASE_TYPE_NONE,0);
             }
+            compileDataProgram(self);
          }
       }
       else
@@ -183,6 +190,77 @@ int8_t apx_dataSignature_update(apx_dataSignature_t *self,const char *dsg)
    return 0;
 }
 
+/**
+ * packs dv using the compiled data program, falls back to apx_dataElement_pack_dv when the signature could not be compiled
+ */
+uint8_t *apx_dataSignature_pack_dv(apx_dataSignature_t *self, uint8_t *pBegin, uint8_t *pEnd, dtl_dv_t *dv)
+{
+   if (self != 0)
+   {
+      if (self->dataProgram != 0)
+      {
+         return apx_dataProgram_pack_dv(self->dataProgram, pBegin, pEnd, dv);
+      }
+      return apx_dataElement_pack_dv(self->dataElement, pBegin, pEnd, dv);
+   }
+   errno = EINVAL;
+   return 0;
+}
+
+/**
+ * unpacks data into a dtl value using the compiled data program. When *dv is not 0 its containers are reused (see apx_dataProgram_unpack_dv).
+ */
+const uint8_t *apx_dataSignature_unpack_dv(apx_dataSignature_t *self, const uint8_t *pBegin, const uint8_t *pEnd, dtl_dv_t **dv)
+{
+   if (self != 0)
+   {
+      if (self->dataProgram != 0)
+      {
+         return apx_dataProgram_unpack_dv(self->dataProgram, pBegin, pEnd, dv);
+      }
+      apx_setError(APX_DATA_SIGNATURE_ERROR);
+      return 0;
+   }
+   errno = EINVAL;
+   return 0;
+}
+
+/**
+ * unpacks data into the native C struct that matches the signature (see apx_dataProgram_unpack_struct), without allocating memory.
+ */
+const uint8_t *apx_dataSignature_unpack_struct(apx_dataSignature_t *self, const uint8_t *pBegin, const uint8_t *pEnd, void *data, uint32_t dataLen)
+{
+   if (self != 0)
+   {
+      if (self->dataProgram != 0)
+      {
+         return apx_dataProgram_unpack_struct(self->dataProgram, pBegin, pEnd, data, dataLen);
+      }
+      apx_setError(APX_DATA_SIGNATURE_ERROR);
+      return 0;
+   }
+   errno = EINVAL;
+   return 0;
+}
+
+/**
+ * packs the native C struct that matches the signature (see apx_dataProgram_pack_struct)
+ */
+uint8_t *apx_dataSignature_pack_struct(apx_dataSignature_t *self, uint8_t *pBegin, uint8_t *pEnd, const void *data, uint32_t dataLen)
+{
+   if (self != 0)
+   {
+      if (self->dataProgram != 0)
+      {
+         return apx_dataProgram_pack_struct(self->dataProgram, pBegin, pEnd, data, dataLen);
+      }
+      apx_setError(APX_DATA_SIGNATURE_ERROR);
+      return 0;
+   }
+   errno = EINVAL;
+   return 0;
+}
+
 /***************** Private Function Definitions *******************/
 /**
  * returns 0 on success, -1 on error
@@ -194,6 +272,11 @@ static int8_t parseDataSignature(apx_dataSignature_t *self, const uint8_t *dsg)
    const uint8_t *pResult;
    char c = (char) *pNext;
 
+   if (self->dataProgram != 0)
+   {
+      apx_dataProgram_delete(self->dataProgram);
+      self->dataProgram = 0;
+   }
    if (c =='{')
    {
       const uint8_t *pRecordBegin = pNext;
@@ -239,6 +322,7 @@ static int8_t parseDataSignature(apx_dataSignature_t *self, const uint8_t *dsg)
       }
    }
    calcPackLen(self->dataElement);
+   compileDataProgram(self);
    return 0;
 }
 
@@ -520,3 +604,32 @@ static void calcPackLen(apx_dataElement_t *pDataElement)
    }
 }
 
+
+/**
+ * compiles dataElement into self->dataProgram. On failure dataProgram is left as 0 and packing uses the dataElement tree instead.
+ */
+static void compileDataProgram(apx_dataSignature_t *self)
+{
+   if ( (self->dataElement == 0) || (self->dataElement->baseType == APX_BASE_TYPE_NONE) )
+   {
+      if (self->dataProgram != 0)
+      {
+         apx_dataProgram_delete(self->dataProgram);
+         self->dataProgram = 0;
+      }
+      return;
+   }
+   if (self->dataProgram == 0)
+   {
+      self->dataProgram = apx_dataProgram_new();
+      if (self->dataProgram == 0)
+      {
+         return;
+      }
+   }
+   if (apx_dataProgram_compile(self->dataProgram, self->dataElement) != 0)
+   {
+      apx_dataProgram_delete(self->dataProgram);
+      self->dataProgram = 0;
+   }
+}
@@ -10,7 +10,9 @@
 
 #include "apx_dataTrigger.h"
 #include "apx_nodeInfo.h"
+#include "apx_nodeData.h"
 #include "apx_logging.h"
+#include "apx_atomic.h"
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
 #endif
@@ -20,11 +22,15 @@
 //////////////////////////////////////////////////////////////////////////////
 // CONSTANTS AND DATA TYPES
 //////////////////////////////////////////////////////////////////////////////
+#define APX_DATA_TRIGGER_MIN_ROUTE_CAPACITY 4
+#define APX_DATA_TRIGGER_BITMAP_WORDS(numPorts) (((numPorts)+31)/32)
 
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
 //static void apx_dataTriggerTable_build(apx_dataTriggerTable_t *self);
+static int8_t apx_dataTriggerFunction_reserveRoutes(apx_dataTriggerFunction_t *self, int32_t capacity);
+static void apx_dataTriggerFunction_resolveRoute(apx_dataTriggerFunction_t *self, int32_t index);
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL VARIABLES
@@ -45,7 +51,10 @@ int8_t apx_dataTriggerTable_create(apx_dataTriggerTable_t *self, apx_nodeInfo_t
    if ( (self != 0) && (nodeInfo != 0) )
    {
       int32_t numProvidePorts;
-      self->lookupTable = 0;
+      self->triggerFunctions = (apx_dataTriggerFunction_t**) 0;
+      self->portOffsets = (uint32_t*) 0;
+      self->connectedPorts = (uint32_t*) 0;
+      self->numPorts = 0;
       self->nodeInfo=nodeInfo;
       self->writeHookFunc=writeHookFunc;
       self->writeHookUserArg=writeHookUserArg;
@@ -55,22 +64,31 @@ int8_t apx_dataTriggerTable_create(apx_dataTriggerTable_t *self, apx_nodeInfo_t
          apx_portDataMap_t *outDataMap = apx_nodeInfo_getOutDataMap(nodeInfo);
          if (outDataMap != 0)
          {
-            size_t dataSize;
-            self->lookupTableLen = (uint32_t) outDataMap->totalLen; //lookupTableLen = number of bytes in the outDataMap
-            dataSize=sizeof(apx_dataTriggerFunction_t*) * self->lookupTableLen;
-            //allocate lookupTableLen*sizeof(pointer), i.e. one pointer for each byte in the outDataMap.
-            //This is where we trade memory for speed. We get constant lookup time, O(1) by using a little extra RAM.
-            self->lookupTable = (apx_dataTriggerFunction_t**) malloc(dataSize);
-            if (self->lookupTable == 0)
+            int32_t i;
+            size_t functionsSize = sizeof(apx_dataTriggerFunction_t*) * (size_t) numProvidePorts;
+            size_t offsetsSize = sizeof(uint32_t) * ((size_t) numProvidePorts + 1);
+            size_t bitmapSize = sizeof(uint32_t) * (size_t) APX_DATA_TRIGGER_BITMAP_WORDS(numProvidePorts);
+            //all three arrays share one allocation, triggerFunctions is the start of the block
+            uint8_t *block = (uint8_t*) malloc(functionsSize + offsetsSize + bitmapSize);
+            if (block == 0)
             {
                APX_LOG_ERROR("[APX_DATA_TRIGGER] apx_dataTriggerTable_create: malloc failed");
                errno=ENOMEM;
                return -1;
             }
-            else
+            self->triggerFunctions = (apx_dataTriggerFunction_t**) block;
+            self->portOffsets = (uint32_t*) (block + functionsSize);
+            self->connectedPorts = (uint32_t*) (block + functionsSize + offsetsSize);
+            self->numPorts = numProvidePorts;
+            memset(self->triggerFunctions, 0, functionsSize);
+            memset(self->connectedPorts, 0, bitmapSize);
+            for (i=0; i<numProvidePorts; i++)
             {
-               memset(self->lookupTable,0,dataSize);
+               apx_portDataMapEntry_t *dataMapEntry = apx_portDataMap_getEntry(outDataMap, i);
+               assert(dataMapEntry != 0);
+               self->portOffsets[i] = (uint32_t) dataMapEntry->offset;
             }
+            self->portOffsets[numProvidePorts] = (uint32_t) outDataMap->totalLen;
          }
       }
       return 0;
@@ -83,22 +101,17 @@ void apx_dataTriggerTable_destroy(apx_dataTriggerTable_t *self)
 {
    if (self != 0)
    {
-      if (self->lookupTable != 0)
+      if (self->triggerFunctions != 0)
       {
-         apx_dataTriggerFunction_t **pBegin;
-         apx_dataTriggerFunction_t **pNext;
-         apx_dataTriggerFunction_t **pEnd;
-
-         pBegin = self->lookupTable;
-         pEnd = pBegin + self->lookupTableLen;
-         for (pNext=pBegin;pNext<pEnd;pNext++)
+         int32_t i;
+         for (i=0; i<self->numPorts; i++)
          {
-            if (*pNext != 0)
+            if (self->triggerFunctions[i] != 0)
             {
-               apx_dataTriggerFunction_delete(*pNext);
+               apx_dataTriggerFunction_delete(self->triggerFunctions[i]);
             }
          }
-         free(self->lookupTable);
+         free(self->triggerFunctions);
       }
    }
 }
@@ -156,14 +169,14 @@ void apx_dataTriggerTable_updateTrigger(apx_dataTriggerTable_t *self, apx_port_t
 
          dataMapEntry = apx_portDataMap_getEntry(&nodeInfo->outDataMap, port->portIndex);
          assert(dataMapEntry != 0);
-         assert(dataMapEntry->offset < (int32_t)self->lookupTableLen);
-         triggerFunction = self->lookupTable[dataMapEntry->offset];
+         assert(port->portIndex < self->numPorts);
+         triggerFunction = self->triggerFunctions[port->portIndex];
          if (triggerFunction == 0)
          {
             triggerFunction = apx_dataTriggerFunction_new(dataMapEntry->offset, dataMapEntry->length);
             if (triggerFunction != 0)
             {
-               self->lookupTable[dataMapEntry->offset] = triggerFunction;
+               self->triggerFunctions[port->portIndex] = triggerFunction;
             }
             else
             {
@@ -171,85 +184,114 @@ void apx_dataTriggerTable_updateTrigger(apx_dataTriggerTable_t *self, apx_port_t
             }
          }
          assert(triggerFunction != 0);
-         adt_ary_clear(&triggerFunction->writeInfoList);
+         apx_dataTriggerFunction_clearRoutes(triggerFunction);
          if (connectorList != 0)
          {
             int32_t i;
             int32_t numConnectors = adt_ary_length(connectorList);
+            if (apx_dataTriggerFunction_reserveRoutes(triggerFunction, numConnectors) != 0)
+            {
+               APX_LOG_ERROR("[APX_DATA_TRIGGER] apx_dataTriggerFunction_reserveRoutes failed");
+               return;
+            }
             for (i=0;i<numConnectors;i++)
             {
                apx_nodeInfo_t *requesterNodeInfo;
                int32_t requesterPortIndex;
-               apx_dataWriteInfo_t *writeInfo;
                apx_portDataMapEntry_t *requesterDataMapEntry;
                apx_portref_t *portref = (apx_portref_t*) *adt_ary_get(connectorList, i);
                requesterNodeInfo = portref->node->nodeInfo;
                requesterPortIndex =portref->port->portIndex;
                requesterDataMapEntry = apx_portDataMap_getEntry(&requesterNodeInfo->inDataMap, requesterPortIndex);
-               writeInfo = apx_dataWriteInfo_new(requesterNodeInfo, requesterDataMapEntry->offset);
-               if (writeInfo != 0)
-               {
-                  adt_ary_push(&triggerFunction->writeInfoList,writeInfo);
-               }
+               (void) apx_dataTriggerFunction_addRoute(triggerFunction, requesterNodeInfo, requesterDataMapEntry->offset);
             }
          }
+         if (triggerFunction->numRoutes > 0)
+         {
+            self->connectedPorts[port->portIndex / 32] |= (uint32_t) (1u << (port->portIndex % 32));
+         }
+         else
+         {
+            self->connectedPorts[port->portIndex / 32] &= (uint32_t) ~(1u << (port->portIndex % 32));
+         }
       }
    }
 }
 
+/**
+ * returns the trigger function of the port that contains the byte at offset
+ */
 apx_dataTriggerFunction_t *apx_dataTriggerTable_get(const apx_dataTriggerTable_t *self, int32_t offset)
 {
-   if ( (self != 0) && (offset>=0) && ( ((uint32_t)offset) < (self->lookupTableLen) ) )
+   if ( (self != 0) && (offset>=0) )
    {
-      return self->lookupTable[offset];
+      int32_t portIndex = apx_dataTriggerTable_findPort(self, (uint32_t) offset);
+      if (portIndex >= 0)
+      {
+         return self->triggerFunctions[portIndex];
+      }
    }
    errno=EINVAL;
    return (apx_dataTriggerFunction_t*) 0;
 }
 
-//dataWriteInfo
-void apx_dataWriteInfo_create(apx_dataWriteInfo_t *self,apx_nodeInfo_t *nodeInfo, uint32_t destOffset)
+/**
+ * returns the index of the provide port that contains the byte at offset, or -1 if offset is outside the outDataMap
+ */
+int32_t apx_dataTriggerTable_findPort(const apx_dataTriggerTable_t *self, uint32_t offset)
 {
-   if ( (self != 0) && (nodeInfo != 0) )
+   if ( (self != 0) && (self->numPorts > 0) && (offset < self->portOffsets[self->numPorts]) )
    {
-      self->requesterNodeInfo=nodeInfo;
-      self->destOffset = destOffset;
+      //find the last port that starts at or before offset
+      int32_t low = 0;
+      int32_t high = self->numPorts;
+      while (high - low > 1)
+      {
+         int32_t mid = low + (high - low) / 2;
+         if (self->portOffsets[mid] <= offset)
+         {
+            low = mid;
+         }
+         else
+         {
+            high = mid;
+         }
+      }
+      return low;
    }
+   return -1;
 }
 
-void apx_dataWriteInfo_destroy(apx_dataWriteInfo_t *self)
-{
-   (void) self;
-}
-
-apx_dataWriteInfo_t *apx_dataWriteInfo_new(apx_nodeInfo_t *nodeInfo, uint32_t destOffset)
+/**
+ * returns the index of the first connected port in the range [beginPortIndex, endPortIndex), or -1 if there is none
+ */
+int32_t apx_dataTriggerTable_nextConnectedPort(const apx_dataTriggerTable_t *self, int32_t beginPortIndex, int32_t endPortIndex)
 {
-   if (nodeInfo != 0 )
+   if ( (self != 0) && (beginPortIndex >= 0) )
    {
-      apx_dataWriteInfo_t *self = (apx_dataWriteInfo_t*) malloc(sizeof(apx_dataWriteInfo_t));
-      if(self != 0){
-         apx_dataWriteInfo_create(self,nodeInfo, destOffset);
+      int32_t portIndex = beginPortIndex;
+      if (endPortIndex > self->numPorts)
+      {
+         endPortIndex = self->numPorts;
       }
-      else{
-         errno = ENOMEM;
+      while (portIndex < endPortIndex)
+      {
+         uint32_t word = self->connectedPorts[portIndex / 32] >> (portIndex % 32);
+         if (word == 0)
+         {
+            //no connected ports in the rest of this word
+            portIndex = (portIndex / 32 + 1) * 32;
+            continue;
+         }
+         while ( (word & 1u) == 0)
+         {
+            word >>= 1;
+            portIndex++;
+         }
+         return (portIndex < endPortIndex)? portIndex : -1;
       }
-      return self;
-   }
-   return (apx_dataWriteInfo_t*) 0;
-}
-
-void apx_dataWriteInfo_delete(apx_dataWriteInfo_t *self)
-{
-   if (self != 0)
-   {
-      apx_dataWriteInfo_destroy(self);
-      free(self);
    }
-}
-
-void apx_dataWriteInfo_vdelete(void *arg)
-{
-   apx_dataWriteInfo_delete( (apx_dataWriteInfo_t*) arg);
+   return -1;
 }
 
 //apx_dataTriggerFunction
@@ -259,7 +301,13 @@ void apx_dataTriggerFunction_create(apx_dataTriggerFunction_t *self, uint32_t sr
    {
       self->srcOffset=srcOffset;
       self->dataLength=dataLength;
-      adt_ary_create(&self->writeInfoList,apx_dataWriteInfo_vdelete);
+      self->numRoutes = 0;
+      self->routeCapacity = 0;
+      self->routeFileManager = (struct apx_fileManager_tag**) 0;
+      self->routeFile = (struct apx_file_tag**) 0;
+      self->routeDestOffset = (uint32_t*) 0;
+      self->routeNodeInfo = (apx_nodeInfo_t**) 0;
+      self->routeGeneration = (int32_t*) 0;
    }
 }
 
@@ -267,7 +315,11 @@ void apx_dataTriggerFunction_destroy(apx_dataTriggerFunction_t *self)
 {
    if (self != 0)
    {
-      adt_ary_destroy(&self->writeInfoList);
+      //all columns live in the block that starts with routeFileManager
+      if (self->routeFileManager != 0)
+      {
+         free(self->routeFileManager);
+      }
    }
 }
 
@@ -299,9 +351,142 @@ void apx_dataTriggerFunction_vdelete(void *arg)
    apx_dataTriggerFunction_delete((apx_dataTriggerFunction_t*) arg);
 }
 
+/**
+ * appends a route to requesterNodeInfo, the destination is resolved immediately
+ */
+int8_t apx_dataTriggerFunction_addRoute(apx_dataTriggerFunction_t *self, apx_nodeInfo_t *requesterNodeInfo, uint32_t destOffset)
+{
+   if ( (self != 0) && (requesterNodeInfo != 0) )
+   {
+      int32_t index = self->numRoutes;
+      if (index == self->routeCapacity)
+      {
+         int32_t capacity = (self->routeCapacity < APX_DATA_TRIGGER_MIN_ROUTE_CAPACITY)? APX_DATA_TRIGGER_MIN_ROUTE_CAPACITY : self->routeCapacity*2;
+         if (apx_dataTriggerFunction_reserveRoutes(self, capacity) != 0)
+         {
+            return -1;
+         }
+      }
+      self->routeNodeInfo[index] = requesterNodeInfo;
+      self->routeDestOffset[index] = destOffset;
+      apx_dataTriggerFunction_resolveRoute(self, index);
+      self->numRoutes++;
+      return 0;
+   }
+   errno = EINVAL;
+   return -1;
+}
+
+/**
+ * removes all routes but keeps the memory for when the routes are added back
+ */
+void apx_dataTriggerFunction_clearRoutes(apx_dataTriggerFunction_t *self)
+{
+   if (self != 0)
+   {
+      self->numRoutes = 0;
+   }
+}
+
+/**
+ * Makes sure the destination columns are up to date and returns the number of routes.
+ * This is called from the data path, it only re-resolves routes whose requester was passed to apx_dataTrigger_invalidateRoutes since the last time.
+ */
+int32_t apx_dataTriggerFunction_compileRoutes(apx_dataTriggerFunction_t *self)
+{
+   if (self != 0)
+   {
+      int32_t i;
+      for (i=0; i<self->numRoutes; i++)
+      {
+         if (self->routeGeneration[i] != ATOMIC_LOAD_I32(&self->routeNodeInfo[i]->routeGeneration))
+         {
+            apx_dataTriggerFunction_resolveRoute(self, i);
+         }
+      }
+      return self->numRoutes;
+   }
+   return 0;
+}
+
+/**
+ * Called when the destination file or fileManager of the nodeData of requesterNodeInfo has changed.
+ * Only routes to that requester are re-resolved (lazily, by apx_dataTriggerFunction_compileRoutes), the routes to all other nodes stay untouched.
+ */
+void apx_dataTrigger_invalidateRoutes(apx_nodeInfo_t *requesterNodeInfo)
+{
+   if (requesterNodeInfo != 0)
+   {
+      (void) ATOMIC_FETCH_ADD_I32(&requesterNodeInfo->routeGeneration, 1);
+   }
+}
+
 
 
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL FUNCTIONS
 //////////////////////////////////////////////////////////////////////////////
 
+static int8_t apx_dataTriggerFunction_reserveRoutes(apx_dataTriggerFunction_t *self, int32_t capacity)
+{
+   if (capacity > self->routeCapacity)
+   {
+      size_t ptrSize = sizeof(void*) * (size_t) capacity;
+      size_t u32Size = sizeof(uint32_t) * (size_t) capacity;
+      uint8_t *block = (uint8_t*) malloc(ptrSize * 3 + u32Size * 2);
+      struct apx_fileManager_tag **routeFileManager;
+      struct apx_file_tag **routeFile;
+      apx_nodeInfo_t **routeNodeInfo;
+      uint32_t *routeDestOffset;
+      int32_t *routeGeneration;
+      if (block == 0)
+      {
+         errno = ENOMEM;
+         return -1;
+      }
+      //the pointer columns come first to keep them aligned, the 32-bit columns are last
+      routeFileManager = (struct apx_fileManager_tag**) block;
+      routeFile = (struct apx_file_tag**) (block + ptrSize);
+      routeNodeInfo = (apx_nodeInfo_t**) (block + ptrSize * 2);
+      routeDestOffset = (uint32_t*) (block + ptrSize * 3);
+      routeGeneration = (int32_t*) (block + ptrSize * 3 + u32Size);
+      if (self->numRoutes > 0)
+      {
+         size_t numBytes = sizeof(void*) * (size_t) self->numRoutes;
+         memcpy(routeFileManager, self->routeFileManager, numBytes);
+         memcpy(routeFile, self->routeFile, numBytes);
+         memcpy(routeNodeInfo, self->routeNodeInfo, numBytes);
+         memcpy(routeDestOffset, self->routeDestOffset, sizeof(uint32_t) * (size_t) self->numRoutes);
+         memcpy(routeGeneration, self->routeGeneration, sizeof(int32_t) * (size_t) self->numRoutes);
+      }
+      if (self->routeFileManager != 0)
+      {
+         free(self->routeFileManager);
+      }
+      self->routeFileManager = routeFileManager;
+      self->routeFile = routeFile;
+      self->routeNodeInfo = routeNodeInfo;
+      self->routeDestOffset = routeDestOffset;
+      self->routeGeneration = routeGeneration;
+      self->routeCapacity = capacity;
+   }
+   return 0;
+}
+
+static void apx_dataTriggerFunction_resolveRoute(apx_dataTriggerFunction_t *self, int32_t index)
+{
+   apx_nodeData_t *nodeData;
+   //store the generation first, a change that happens while we resolve triggers another pass next time
+   self->routeGeneration[index] = ATOMIC_LOAD_I32(&self->routeNodeInfo[index]->routeGeneration);
+   nodeData = self->routeNodeInfo[index]->nodeData;
+   if ( (nodeData != 0) && (nodeData->inPortDataFile != 0) && (nodeData->fileManager != 0) )
+   {
+      self->routeFileManager[index] = nodeData->fileManager;
+      self->routeFile[index] = nodeData->inPortDataFile;
+   }
+   else
+   {
+      self->routeFileManager[index] = (struct apx_fileManager_tag*) 0;
+      self->routeFile[index] = (struct apx_file_tag*) 0;
+   }
+}
@@ -62,6 +62,9 @@ int8_t apx_datatype_create(apx_datatype_t *self, const char *name, const char *d
       nameLen = (name==0)? 0 : (uint32_t) strlen(name);
       dsgLen  = (dsg==0)?  0 : (uint32_t) strlen(dsg);
       attrLen = (attr==0)? 0 : (uint32_t) strlen(attr);
+      self->name=0;
+      self->dsg=0;
+      self->attr=0;
       if (nameLen > 0)
       {
          numNullChars++;
@@ -3,6 +3,7 @@
 //////////////////////////////////////////////////////////////////////////////
 #include "apx_file.h"
 #include "apx_logging.h"
+#include "sha256.h"
 #include <errno.h>
 #ifndef APX_EMBEDDED
 #include <malloc.h>
@@ -72,6 +73,13 @@ int8_t apx_file_createLocalFile(apx_file_t *self, uint8_t fileType, apx_nodeData
          }
          strcpy(name+len, ext);
          rmf_fileInfo_create(&self->fileInfo, name, RMF_INVALID_ADDRESS, filelen, RMF_FILE_TYPE_FIXED);
+         if ( (fileType == APX_DEFINITION_FILE) && (nodeData->definitionDataBuf != 0) )
+         {
+            //the digest lets the server reuse an already parsed copy of the same definition
+            uint8_t digest[SHA256_DIGEST_SIZE];
+            sha256_calc(nodeData->definitionDataBuf, filelen, &digest[0]);
+            rmf_fileInfo_setDigestData(&self->fileInfo, RMF_DIGEST_TYPE_SHA256, &digest[0], RMF_DIGEST_SIZE);
+         }
          return 0;
       }
    }
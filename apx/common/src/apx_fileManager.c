@@ -10,9 +10,12 @@
 #include <stdio.h>
 #ifdef _MSC_VER
 #include <process.h>
+#else
+#include <time.h>
 #endif
 #include "apx_fileManager.h"
 #include "apx_nodeManager.h"
+#include "apx_workerPool.h"
 #include "apx_logging.h"
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
@@ -30,11 +33,25 @@
 #ifndef APX_FILEMANAGER_DEBUG_ENABLE
 #define APX_FILEMANAGER_DEBUG_ENABLE 0
 #endif
+
+#define APX_FILEMANAGER_STOP_POLL_MS 100 //how often apx_fileManager_stop checks that the worker pool is still running
+#define APX_FILEMANAGER_MAX_PUSH_SPINS 16 //number of times the worker yields while waiting for a producer to finish its push before it starts sleeping
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
 static int8_t apx_fileManager_startThread(apx_fileManager_t *self);
 static THREAD_PROTO(threadTask,arg);
+static void apx_fileManager_postMessage(apx_fileManager_t *self, const apx_msg_t *msg);
+static void apx_fileManager_queueFileWrite(apx_fileManager_t *self, apx_file_t *file, const uint8_t *data, apx_payload_t *payload, apx_offset_t offset, apx_size_t length);
+static void apx_fileManager_releaseMessageData(apx_msg_t *msg);
+static void apx_fileManager_releaseMessages(apx_msg_t *messages, int32_t numMessages);
+static bool apx_fileManager_processMessage(apx_fileManager_t *self, const apx_msg_t *msg);
+static int32_t apx_fileManager_removeMessages(apx_fileManager_t *self, apx_msg_t *messages, int32_t maxNumMessages);
+static void apx_fileManager_updateBatchStats(apx_fileManager_t *self, uint32_t batchSize);
+static void apx_fileManager_beginTransmitBatch(apx_fileManager_t *self);
+static void apx_fileManager_endTransmitBatch(apx_fileManager_t *self);
+static bool apx_fileManager_waitForWorkerExit(apx_fileManager_t *self);
+static void apx_fileManager_dropMessages(apx_fileManager_t *self);
 
 
 //handlers are run by internal thread
@@ -68,11 +85,6 @@ int8_t apx_fileManager_create(apx_fileManager_t *self, uint8_t mode)
 {
    if (self != 0 && ( (mode == APX_FILEMANAGER_CLIENT_MODE) || (mode == APX_FILEMANAGER_SERVER_MODE) ) )
    {
-      size_t numItems = APX_CONTEXT_NUM_MESSAGES;
-      size_t elemSize = RMF_MSG_SIZE;
-      int8_t result = apx_allocator_create(&self->allocator, APX_CONTEXT_NUM_MESSAGES);
-
-      if (result == 0)
       {
 #ifdef _WIN32
          self->workerThread = INVALID_HANDLE_VALUE;
@@ -85,24 +97,27 @@ int8_t apx_fileManager_create(apx_fileManager_t *self, uint8_t mode)
          SPINLOCK_INIT(self->lock);
          SPINLOCK_INIT(self->sendLock);
          SEMAPHORE_CREATE(self->semaphore);
-         self->ringbufferLen = numItems;
-         self->ringbufferData = (uint8_t*) malloc(numItems*elemSize);
-         if (self->ringbufferData == 0)
+         if (apx_mpscQueue_create(&self->messages, RMF_MSG_SIZE) != 0)
          {
-            apx_allocator_destroy(&self->allocator);
             return -1;
          }
-         rbfs_create(&self->ringbuffer, self->ringbufferData,(uint16_t) numItems,(uint8_t) elemSize);
          apx_fileMap_create(&self->localFileMap);
          apx_fileMap_create(&self->remoteFileMap);
          apx_fileManager_setTransmitHandler(self, 0);
-         apx_allocator_start(&self->allocator);
 
          self->curFileStartAddress = 0;
          self->curFileEndAddress = 0;
          self->curFile = 0;
          self->nodeManager = (apx_nodeManager_t*) 0;
          self->isConnected = false;
+         self->sessionToken[0] = 0;
+         self->workerPool = (apx_workerPool_t*) 0;
+         self->workerPoolNext = (apx_fileManager_t*) 0;
+         self->isScheduled = false;
+         self->isWorkerPoolActive = false;
+         self->conflationTable = (apx_conflationTable_t*) 0;
+         self->numConflatedWrites = 0;
+         memset(&self->batchStats, 0, sizeof(self->batchStats));
          return 0;
       }
    }
@@ -114,17 +129,22 @@ void apx_fileManager_destroy(apx_fileManager_t *self)
 {
    if (self != 0)
    {
-      apx_allocator_stop(&self->allocator);
-      if (self->ringbufferData != 0)
+      apx_msg_t msg;
+      //messages left in the queue after the worker exited still hold a payload reference
+      while (apx_mpscQueue_pop(&self->messages, &msg) == true)
       {
-         free(self->ringbufferData);
+         apx_fileManager_releaseMessageData(&msg);
       }
+      apx_mpscQueue_destroy(&self->messages);
       SEMAPHORE_DESTROY(self->semaphore);
       SPINLOCK_DESTROY(self->lock);
       SPINLOCK_DESTROY(self->sendLock);
-      apx_allocator_destroy(&self->allocator);
       apx_fileMap_destroy(&self->localFileMap);
       apx_fileMap_destroy(&self->remoteFileMap);
+      if (self->conflationTable != 0)
+      {
+         apx_conflationTable_delete(self->conflationTable);
+      }
    }
 }
 
@@ -169,24 +189,62 @@ void apx_fileManager_vdelete(void *arg)
 
 void apx_fileManager_start(apx_fileManager_t *self)
 {
-   if( (self != 0) && (self->workerThreadValid == false) )
+   if (self != 0)
    {
-      apx_fileManager_startThread(self);
+      if (self->workerPool != 0)
+      {
+         bool schedule = false;
+         SPINLOCK_ENTER(self->lock);
+         if (self->isWorkerPoolActive == false)
+         {
+            self->isWorkerPoolActive = true;
+            if ( (self->isScheduled == false) && (apx_mpscQueue_length(&self->messages) > 0) )
+            {
+               self->isScheduled = true;
+               schedule = true;
+            }
+         }
+         SPINLOCK_LEAVE(self->lock);
+         if (schedule == true)
+         {
+            apx_workerPool_schedule(self->workerPool, self);
+         }
+      }
+      else if (self->workerThreadValid == false)
+      {
+         apx_fileManager_startThread(self);
+      }
    }
 }
 
 void apx_fileManager_stop(apx_fileManager_t *self)
 {
-   if ( (self != 0) && (self->workerThreadValid == true) )
+   if ( (self != 0) && (self->workerPool != 0) && (self->isWorkerPoolActive == true) )
+   {
+      //a stopped pool has no worker left that could process RMF_MSG_EXIT, queued messages stay until the next start
+      if (apx_workerPool_isRunning(self->workerPool) == true)
+      {
+         apx_msg_t msg = {RMF_MSG_EXIT, 0, 0, {0}, {0} }; //{msgType, msgData1, msgData2, msgData3.ptr, msgData4}
+         apx_fileManager_postMessage(self, &msg);
+         if (apx_fileManager_waitForWorkerExit(self) == false)
+         {
+            APX_LOG_ERROR("[APX_FILE_MANAGER] %s", "worker pool stopped before processing RMF_MSG_EXIT");
+            apx_fileManager_dropMessages(self);
+         }
+      }
+      //the fileManager can be started again, the next apx_fileManager_start schedules it if messages are waiting
+      SPINLOCK_ENTER(self->lock);
+      self->isScheduled = false;
+      self->isWorkerPoolActive = false;
+      SPINLOCK_LEAVE(self->lock);
+   }
+   else if ( (self != 0) && (self->workerThreadValid == true) )
    {
 #ifdef _MSC_VER
       DWORD result;
 #endif
-      apx_msg_t msg = {RMF_MSG_EXIT, 0, 0, {0}, 0 }; //{msgType, msgData1, msgData2, msgData3.ptr, msgData4}
-      SPINLOCK_ENTER(self->lock);
-      rbfs_insert(&self->ringbuffer,(const uint8_t*) &msg);
-      SPINLOCK_LEAVE(self->lock);
-      SEMAPHORE_POST(self->semaphore);
+      apx_msg_t msg = {RMF_MSG_EXIT, 0, 0, {0}, {0} }; //{msgType, msgData1, msgData2, msgData3.ptr, msgData4}
+      apx_fileManager_postMessage(self, &msg);
 #ifdef _MSC_VER
       result = WaitForSingleObject(self->workerThread, 5000);
       if (result == WAIT_TIMEOUT)
@@ -219,6 +277,119 @@ void apx_fileManager_stop(apx_fileManager_t *self)
 }
 
 
+/**
+ * Makes the fileManager use a shared worker pool instead of starting its own worker thread.
+ * Must be called before apx_fileManager_start.
+ */
+void apx_fileManager_setWorkerPool(apx_fileManager_t *self, struct apx_workerPool_tag *workerPool)
+{
+   if ( (self != 0) && (self->workerThreadValid == false) && (self->isWorkerPoolActive == false) )
+   {
+      self->workerPool = workerPool;
+   }
+}
+
+/**
+ * Called by worker pool threads. Processes at most maxNumMessages messages from the queue.
+ * Returns true when there are still messages left in the queue, in that case the caller must schedule the fileManager again.
+ * Returns false when the queue is empty (or the fileManager was stopped), the fileManager must not be accessed by the caller after that.
+ */
+bool apx_fileManager_processPending(apx_fileManager_t *self, uint32_t maxNumMessages)
+{
+   if (self != 0)
+   {
+      apx_msg_t messages[APX_FILEMANAGER_MAX_BATCH_SIZE];
+      int32_t numProcessed = 0;
+      apx_fileManager_beginTransmitBatch(self);
+      while ((uint32_t) numProcessed < maxNumMessages)
+      {
+         int32_t i;
+         int32_t numRemoved;
+         uint32_t numRemaining = maxNumMessages - (uint32_t) numProcessed;
+         numRemoved = apx_fileManager_removeMessages(self, &messages[0], (numRemaining < APX_FILEMANAGER_MAX_BATCH_SIZE)? (int32_t) numRemaining : APX_FILEMANAGER_MAX_BATCH_SIZE);
+         if (numRemoved == 0)
+         {
+            break;
+         }
+         for (i=0; i<numRemoved; i++)
+         {
+            if (apx_fileManager_processMessage(self, &messages[i]) == false)
+            {
+               //the rest of the batch has already been removed from the queue, drop the payload references it holds
+               apx_fileManager_releaseMessages(&messages[i+1], numRemoved-(i+1));
+               apx_fileManager_endTransmitBatch(self);
+               apx_fileManager_updateBatchStats(self, (uint32_t) (numProcessed+i+1));
+               //isScheduled stays true until apx_fileManager_stop has returned, messages posted in the meantime do not schedule this fileManager
+               (void) apx_mpscQueue_release(&self->messages, numProcessed+numRemoved);
+               SEMAPHORE_POST(self->semaphore); //wakes up apx_fileManager_stop, do not touch self after this point
+               return false;
+            }
+         }
+         numProcessed += numRemoved;
+      }
+      apx_fileManager_endTransmitBatch(self);
+      apx_fileManager_updateBatchStats(self, (uint32_t) numProcessed);
+      if (apx_mpscQueue_release(&self->messages, numProcessed) > 0)
+      {
+         //more messages (or a message still being pushed by a producer)
+         return true;
+      }
+      SPINLOCK_ENTER(self->lock);
+      self->isScheduled = false;
+      //a message posted after the release above may have seen isScheduled as true, in that case we are still responsible for it
+      if (apx_mpscQueue_length(&self->messages) > 0)
+      {
+         self->isScheduled = true;
+         SPINLOCK_LEAVE(self->lock);
+         return true;
+      }
+      SPINLOCK_LEAVE(self->lock);
+      //queue is empty, the next apx_fileManager_postMessage will schedule us again
+      return false;
+   }
+   return false;
+}
+
+/**
+ * Enables latest-value conflation of port writes. When a new write arrives for a (file, offset) that already has a write waiting in the queue,
+ * the new value replaces the queued value in place instead of being queued after it. Only the latest value of each port is then transmitted.
+ * This relies on all writes to a port using the same offset and length, which is true for writes produced by the router.
+ * Call this before apx_fileManager_start.
+ */
+int8_t apx_fileManager_enableConflation(apx_fileManager_t *self)
+{
+   if (self != 0)
+   {
+      int8_t retval = 0;
+      SPINLOCK_ENTER(self->lock);
+      if (self->conflationTable == 0)
+      {
+         self->conflationTable = apx_conflationTable_new(APX_CONTEXT_NUM_MESSAGES);
+         if (self->conflationTable == 0)
+         {
+            retval = -1;
+         }
+      }
+      SPINLOCK_LEAVE(self->lock);
+      return retval;
+   }
+   errno = EINVAL;
+   return -1;
+}
+
+/**
+ * Copies the batch statistics of the worker. Average batch size is numMessages/numBatches.
+ */
+void apx_fileManager_getBatchStats(apx_fileManager_t *self, apx_fileManagerBatchStats_t *stats)
+{
+   if ( (self != 0) && (stats != 0) )
+   {
+      SPINLOCK_ENTER(self->lock);
+      *stats = self->batchStats;
+      SPINLOCK_LEAVE(self->lock);
+   }
+}
+
 /**
  * used to attach a node manager to allow fileManager to create remote nodes
  */
@@ -255,6 +426,24 @@ void apx_fileManager_setDebugInfo(apx_fileManager_t *self, void *debugInfo)
    }
 }
 
+/**
+ * Stores the session token received in the greeting. Tokens longer than RMF_SESSION_TOKEN_MAX_LEN are ignored
+ */
+void apx_fileManager_setSessionToken(apx_fileManager_t *self, const char *sessionToken)
+{
+   if (self != 0)
+   {
+      if ( (sessionToken != 0) && (strlen(sessionToken) <= RMF_SESSION_TOKEN_MAX_LEN) )
+      {
+         strcpy(self->sessionToken, sessionToken);
+      }
+      else
+      {
+         self->sessionToken[0] = 0;
+      }
+   }
+}
+
 
 /**
  * returns number of bytes parsed from msgBuf. returns -1 on error or 0 if msgBuf is too short (wait for more data to arrive)
@@ -403,11 +592,8 @@ void apx_fileManager_onConnected(apx_fileManager_t *self)
 {
    if (self != 0)
    {
-      apx_msg_t msg = {RMF_MSG_CONNECT, 0, 0, {0}, 0 }; //{msgType,  msgData1, msgData2, msgData3.ptr, msgData4}
-      SPINLOCK_ENTER(self->lock);
-      rbfs_insert(&self->ringbuffer,(const uint8_t*) &msg);
-      SPINLOCK_LEAVE(self->lock);
-      SEMAPHORE_POST(self->semaphore);
+      apx_msg_t msg = {RMF_MSG_CONNECT, 0, 0, {0}, {0} }; //{msgType,  msgData1, msgData2, msgData3.ptr, msgData4}
+      apx_fileManager_postMessage(self, &msg);
    }
 }
 
@@ -415,11 +601,8 @@ void apx_fileManager_onDisconnected(apx_fileManager_t *self)
 {
    if (self != 0)
    {
-      apx_msg_t msg = {RMF_MSG_DISCONNECT, 0, 0, {0}, 0 }; //{msgType,  msgData1, msgData2, msgData3.ptr, msgData4}
-      SPINLOCK_ENTER(self->lock);
-      rbfs_insert(&self->ringbuffer,(const uint8_t*) &msg);
-      SPINLOCK_LEAVE(self->lock);
-      SEMAPHORE_POST(self->semaphore);
+      apx_msg_t msg = {RMF_MSG_DISCONNECT, 0, 0, {0}, {0} }; //{msgType,  msgData1, msgData2, msgData3.ptr, msgData4}
+      apx_fileManager_postMessage(self, &msg);
    }
 }
 
@@ -427,39 +610,55 @@ void apx_fileManager_triggerFileUpdatedEvent(apx_fileManager_t *self, apx_file_t
 {
    if (self !=0 )
    {
-      apx_msg_t msg = {RMF_MSG_WRITE_NOTIFY, 0, 0, {0}, 0 }; //{msgType,  msgData1, msgData2, msgData3.ptr, msgData4}
+      apx_msg_t msg = {RMF_MSG_WRITE_NOTIFY, 0, 0, {0}, {0} }; //{msgType,  msgData1, msgData2, msgData3.ptr, msgData4}
       msg.msgData1 = (uint32_t) offset;
       msg.msgData2 = (uint32_t) length;
       msg.msgData3.ptr = file; //sent from node in nodeDataPtr
-      SPINLOCK_ENTER(self->lock);
-      rbfs_insert(&self->ringbuffer,(const uint8_t*) &msg);
-      SPINLOCK_LEAVE(self->lock);
-      SEMAPHORE_POST(self->semaphore);
+      apx_fileManager_postMessage(self, &msg);
    }
 }
 
+/**
+ * Queues a write of a private copy of data. Data that does not fit inside the message is copied into a new payload.
+ */
 void apx_fileManager_triggerFileWriteCmdEvent(apx_fileManager_t *self, apx_file_t *file, const uint8_t *data, apx_offset_t offset, apx_size_t length)
 {
-   if (self !=0 )
+   if ( (self != 0) && (data != 0) )
    {
-      uint8_t *dataCopy;
-      apx_msg_t msg = {RMF_MSG_FILE_WRITE, 0, 0, {0}, 0 }; //{msgType,  msgData1, msgData2, msgData3.ptr, msgData4}
-      msg.msgData1 = (uint32_t) offset;
-      msg.msgData2 = (uint32_t) length;
-      msg.msgData3.ptr = file; //sent from node in nodeDataPtr
-      dataCopy = apx_allocator_alloc(&self->allocator,length);
-      if (dataCopy == 0)
+      apx_payload_t *payload;
+      if (length <= APX_MSG_INLINE_DATA_SIZE)
       {
-         APX_LOG_ERROR("[APX_REMOTE_FILE] apx_allocator out of memory while attempting to allocate %d bytes", (int)length);
+         apx_fileManager_queueFileWrite(self, file, data, (apx_payload_t*) 0, offset, length);
+         return;
+      }
+      payload = apx_payload_new((uint32_t) length);
+      if (payload == 0)
+      {
+         APX_LOG_ERROR("[APX_FILE_MANAGER] out of memory while attempting to allocate %d bytes", (int)length);
+         return;
+      }
+      memcpy(apx_payload_data(payload), data, length);
+      apx_fileManager_queueFileWrite(self, file, (const uint8_t*) 0, payload, offset, length);
+      apx_payload_release(payload);
+   }
+}
+
+/**
+ * Queues a write of a shared payload. The fileManager takes its own reference, the caller keeps its reference.
+ * This allows the same payload to be queued for any number of fileManagers without copying.
+ */
+void apx_fileManager_triggerFileWritePayloadEvent(apx_fileManager_t *self, apx_file_t *file, apx_payload_t *payload, apx_offset_t offset)
+{
+   if ( (self != 0) && (payload != 0) )
+   {
+      apx_size_t length = (apx_size_t) apx_payload_length(payload);
+      if (length <= APX_MSG_INLINE_DATA_SIZE)
+      {
+         apx_fileManager_queueFileWrite(self, file, apx_payload_data(payload), (apx_payload_t*) 0, offset, length);
       }
       else
       {
-         memcpy(dataCopy, data, length);
-         msg.msgData4 = dataCopy;
-         SPINLOCK_ENTER(self->lock);
-         rbfs_insert(&self->ringbuffer,(const uint8_t*) &msg);
-         SPINLOCK_LEAVE(self->lock);
-         SEMAPHORE_POST(self->semaphore);
+         apx_fileManager_queueFileWrite(self, file, (const uint8_t*) 0, payload, offset, length);
       }
    }
 }
@@ -469,6 +668,77 @@ void apx_fileManager_triggerFileWriteCmdEvent(apx_fileManager_t *self, apx_file_
 // LOCAL FUNCTIONS
 //////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Puts a RMF_MSG_FILE_WRITE in the queue. Exactly one of data (inline copy) or payload (shared, a new reference is taken) is used.
+ * In conflation mode a write to a location that already has a queued write replaces the data of the queued message instead.
+ */
+static void apx_fileManager_queueFileWrite(apx_fileManager_t *self, apx_file_t *file, const uint8_t *data, apx_payload_t *payload, apx_offset_t offset, apx_size_t length)
+{
+   apx_msg_t msg = {RMF_MSG_FILE_WRITE, 0, 0, {0}, {0} }; //{msgType,  msgData1, msgData2, msgData3.ptr, msgData4}
+   if (self->conflationTable != 0)
+   {
+      apx_conflationEntry_t *entry;
+      SPINLOCK_ENTER(self->lock);
+      entry = apx_conflationTable_find(self->conflationTable, file, (uint32_t) offset);
+      if ( (entry != 0) && (entry->length == (uint32_t) length) )
+      {
+         //entry->data is the message still in the queue, the worker cannot take it from the queue while we hold the lock
+         apx_msg_t *queuedMsg = (apx_msg_t*) entry->data;
+         if (payload == 0)
+         {
+            memcpy(queuedMsg->msgData4.data, data, length);
+         }
+         else
+         {
+            apx_payload_t *oldPayload = (apx_payload_t*) queuedMsg->msgData4.ptr;
+            apx_payload_retain(payload);
+            queuedMsg->msgData4.ptr = payload;
+            apx_payload_release(oldPayload);
+         }
+         self->numConflatedWrites++;
+         SPINLOCK_LEAVE(self->lock);
+         return;
+      }
+      SPINLOCK_LEAVE(self->lock);
+   }
+   msg.msgData1 = (uint32_t) offset;
+   msg.msgData2 = (uint32_t) length;
+   msg.msgData3.ptr = file; //sent from node in nodeDataPtr
+   if (payload == 0)
+   {
+      memcpy(msg.msgData4.data, data, length);
+   }
+   else
+   {
+      apx_payload_retain(payload);
+      msg.msgData4.ptr = payload;
+   }
+   apx_fileManager_postMessage(self, &msg);
+}
+
+/**
+ * Releases the payload reference held by a message (if any)
+ */
+static void apx_fileManager_releaseMessageData(apx_msg_t *msg)
+{
+   if ( (msg->msgType == RMF_MSG_FILE_WRITE) && (msg->msgData2 > APX_MSG_INLINE_DATA_SIZE) )
+   {
+      apx_payload_release((apx_payload_t*) msg->msgData4.ptr);
+   }
+}
+
+/**
+ * Releases the payload references of numMessages removed messages that will not be processed
+ */
+static void apx_fileManager_releaseMessages(apx_msg_t *messages, int32_t numMessages)
+{
+   int32_t i;
+   for (i=0; i<numMessages; i++)
+   {
+      apx_fileManager_releaseMessageData(&messages[i]);
+   }
+}
+
 static int8_t apx_fileManager_startThread(apx_fileManager_t *self)
 {
    if( (self != 0) && (self->workerThreadValid == false) ){
@@ -500,7 +770,7 @@ static THREAD_PROTO(threadTask,arg)
 {
    if(arg!=0)
    {
-      apx_msg_t msg;
+      apx_msg_t messages[APX_FILEMANAGER_MAX_BATCH_SIZE];
       apx_fileManager_t *self;
       uint32_t messages_processed=0;
       bool isRunning=true;
@@ -516,30 +786,41 @@ static THREAD_PROTO(threadTask,arg)
          if (result == 0)
 #endif
          {
-            SPINLOCK_ENTER(self->lock);
-            rbfs_remove(&self->ringbuffer,(uint8_t*) &msg);
-            SPINLOCK_LEAVE(self->lock);
-            messages_processed++;
-            switch(msg.msgType)
+            //the semaphore is only posted when the queue goes from empty to non-empty, drain it completely before waiting again
+            int32_t numPending = 0;
+            uint32_t batchSize = 0;
+            uint32_t numSpins = 0;
+            apx_fileManager_beginTransmitBatch(self);
+            do
             {
-            case RMF_MSG_EXIT:
-               isRunning=false;
-               break;
-            case RMF_MSG_CONNECT:
-               apx_fileManager_connectHandler(self);
-               break;
-            case RMF_MSG_WRITE_NOTIFY:
-               apx_fileManager_fileWriteNotifyHandler(self, (apx_file_t*) msg.msgData3.ptr, (apx_offset_t) msg.msgData1, (apx_size_t) msg.msgData2);
-               break;
-            case RMF_MSG_FILE_WRITE:
-               apx_fileManager_fileWriteCmdHandler(self, (apx_file_t*) msg.msgData3.ptr, (const uint8_t*) msg.msgData4, (apx_offset_t) msg.msgData1, (apx_size_t) msg.msgData2);
-               apx_allocator_free(&self->allocator, (uint8_t*) msg.msgData4, (uint32_t) msg.msgData2);
-               break;
-            default:
-               APX_LOG_ERROR("[APX_FILE_MANAGER]: unknown message type: %u", msg.msgType);               
-               isRunning=false;
-               break;
-            }
+               int32_t i;
+               int32_t numRemoved = apx_fileManager_removeMessages(self, &messages[0], APX_FILEMANAGER_MAX_BATCH_SIZE);
+               for (i=0; (i<numRemoved) && (isRunning == true); i++)
+               {
+                  batchSize++;
+                  isRunning = apx_fileManager_processMessage(self, &messages[i]);
+               }
+               if (isRunning == false)
+               {
+                  //the rest of the batch has already been removed from the queue, drop the payload references it holds
+                  apx_fileManager_releaseMessages(&messages[i], numRemoved-i);
+                  break;
+               }
+               numPending = apx_mpscQueue_release(&self->messages, numRemoved);
+               if ( (numPending > 0) && (numRemoved == 0) )
+               {
+                  //a producer is in the middle of pushing its message, it is normally done after a few yields
+                  SLEEP( (numSpins++ < APX_FILEMANAGER_MAX_PUSH_SPINS)? 0 : 1);
+               }
+               else
+               {
+                  numSpins = 0;
+               }
+            } while (numPending > 0);
+            //everything produced since the wakeup is transmitted together once the queue runs dry
+            apx_fileManager_endTransmitBatch(self);
+            messages_processed += batchSize;
+            apx_fileManager_updateBatchStats(self, batchSize);
          }
          else
          {            
@@ -552,6 +833,221 @@ static THREAD_PROTO(threadTask,arg)
    THREAD_RETURN(0);
 }
 
+/**
+ * Puts a message in the queue. Only the message that makes the queue non-empty wakes up the worker thread (or schedules the fileManager in the worker pool)
+ */
+static void apx_fileManager_postMessage(apx_fileManager_t *self, const apx_msg_t *msg)
+{
+   bool wasEmpty = false;
+   int8_t result;
+   if ( (self->conflationTable != 0) && (msg->msgType == RMF_MSG_FILE_WRITE) )
+   {
+      //a conflated write must enter the queue and the conflation table atomically
+      apx_msg_t *queuedMsg;
+      SPINLOCK_ENTER(self->lock);
+      queuedMsg = (apx_msg_t*) apx_mpscQueue_emplace(&self->messages, msg, &wasEmpty);
+      result = (queuedMsg != 0)? 0 : -1;
+      if ( (result == 0) && (apx_conflationTable_insert(self->conflationTable, (apx_file_t*) msg->msgData3.ptr, msg->msgData1, msg->msgData2, queuedMsg) != 0) )
+      {
+         APX_LOG_ERROR("[APX_FILE_MANAGER] %s", "apx_conflationTable_insert failed");
+      }
+      SPINLOCK_LEAVE(self->lock);
+   }
+   else
+   {
+      result = apx_mpscQueue_push(&self->messages, msg, &wasEmpty);
+   }
+   if (result != 0)
+   {
+      APX_LOG_ERROR("[APX_FILE_MANAGER] out of memory while posting message type %u", msg->msgType);
+      apx_fileManager_releaseMessageData((apx_msg_t*) msg);
+      return;
+   }
+   if (wasEmpty == true)
+   {
+      if (self->workerPool == 0)
+      {
+         SEMAPHORE_POST(self->semaphore);
+      }
+      else
+      {
+         bool schedule = false;
+         SPINLOCK_ENTER(self->lock);
+         if ( (self->isWorkerPoolActive == true) && (self->isScheduled == false) )
+         {
+            self->isScheduled = true;
+            schedule = true;
+         }
+         SPINLOCK_LEAVE(self->lock);
+         if (schedule == true)
+         {
+            apx_workerPool_schedule(self->workerPool, self);
+         }
+      }
+   }
+   else
+   {
+      //the worker that is processing (or about to process) this fileManager will also see this message
+   }
+}
+
+/**
+ * Takes up to maxNumMessages messages from the queue. Must only be called by the worker currently processing this fileManager.
+ * A write removed from the queue can no longer be conflated since its data is about to be read by the worker.
+ */
+static int32_t apx_fileManager_removeMessages(apx_fileManager_t *self, apx_msg_t *messages, int32_t maxNumMessages)
+{
+   int32_t numMessages;
+   if (self->conflationTable == 0)
+   {
+      return apx_mpscQueue_popMany(&self->messages, messages, maxNumMessages);
+   }
+   //one lock round-trip for the whole batch
+   SPINLOCK_ENTER(self->lock);
+   for (numMessages=0; numMessages<maxNumMessages; numMessages++)
+   {
+      //the conflation table identifies a write by the address of the message inside the queue
+      void *queuedMsg = apx_mpscQueue_front(&self->messages);
+      if ( (queuedMsg == 0) || (apx_mpscQueue_pop(&self->messages, &messages[numMessages]) == false) )
+      {
+         break;
+      }
+      if (messages[numMessages].msgType == RMF_MSG_FILE_WRITE)
+      {
+         (void) apx_conflationTable_remove(self->conflationTable, (apx_file_t*) messages[numMessages].msgData3.ptr, messages[numMessages].msgData1, queuedMsg);
+      }
+   }
+   SPINLOCK_LEAVE(self->lock);
+   return numMessages;
+}
+
+static void apx_fileManager_updateBatchStats(apx_fileManager_t *self, uint32_t batchSize)
+{
+   if (batchSize > 0)
+   {
+      SPINLOCK_ENTER(self->lock);
+      self->batchStats.numBatches++;
+      self->batchStats.numMessages += batchSize;
+      if (batchSize > self->batchStats.maxBatchSize)
+      {
+         self->batchStats.maxBatchSize = batchSize;
+      }
+      SPINLOCK_LEAVE(self->lock);
+   }
+}
+
+/**
+ * Processes one message taken from the queue. Returns false when the worker shall stop processing messages
+ */
+static bool apx_fileManager_processMessage(apx_fileManager_t *self, const apx_msg_t *msg)
+{
+   bool isRunning = true;
+   switch(msg->msgType)
+   {
+   case RMF_MSG_EXIT:
+      isRunning=false;
+      break;
+   case RMF_MSG_CONNECT:
+      apx_fileManager_connectHandler(self);
+      break;
+   case RMF_MSG_WRITE_NOTIFY:
+      apx_fileManager_fileWriteNotifyHandler(self, (apx_file_t*) msg->msgData3.ptr, (apx_offset_t) msg->msgData1, (apx_size_t) msg->msgData2);
+      break;
+   case RMF_MSG_FILE_WRITE:
+      if (msg->msgData2 <= APX_MSG_INLINE_DATA_SIZE)
+      {
+         apx_fileManager_fileWriteCmdHandler(self, (apx_file_t*) msg->msgData3.ptr, msg->msgData4.data, (apx_offset_t) msg->msgData1, (apx_size_t) msg->msgData2);
+      }
+      else
+      {
+         apx_payload_t *payload = (apx_payload_t*) msg->msgData4.ptr;
+         apx_fileManager_fileWriteCmdHandler(self, (apx_file_t*) msg->msgData3.ptr, apx_payload_data(payload), (apx_offset_t) msg->msgData1, (apx_size_t) msg->msgData2);
+         apx_payload_release(payload);
+      }
+      break;
+   default:
+      APX_LOG_ERROR("[APX_FILE_MANAGER]: unknown message type: %u", msg->msgType);
+      isRunning=false;
+      break;
+   }
+   return isRunning;
+}
+
+/**
+ * Lets the transmitHandler queue outgoing messages until apx_fileManager_endTransmitBatch is called
+ */
+static void apx_fileManager_beginTransmitBatch(apx_fileManager_t *self)
+{
+   if (self->transmitHandler.beginBatch != 0)
+   {
+      SPINLOCK_ENTER(self->sendLock);
+      self->transmitHandler.beginBatch(self->transmitHandler.arg);
+      SPINLOCK_LEAVE(self->sendLock);
+   }
+}
+
+static void apx_fileManager_endTransmitBatch(apx_fileManager_t *self)
+{
+   if (self->transmitHandler.endBatch != 0)
+   {
+      SPINLOCK_ENTER(self->sendLock);
+      self->transmitHandler.endBatch(self->transmitHandler.arg);
+      SPINLOCK_LEAVE(self->sendLock);
+   }
+}
+
+/**
+ * Waits for the worker that processes RMF_MSG_EXIT to post the semaphore.
+ * Returns false if the worker pool was stopped before that happened.
+ */
+static bool apx_fileManager_waitForWorkerExit(apx_fileManager_t *self)
+{
+   for(;;)
+   {
+#ifdef _MSC_VER
+      if (WaitForSingleObject(self->semaphore, APX_FILEMANAGER_STOP_POLL_MS) == WAIT_OBJECT_0)
+      {
+         return true;
+      }
+#else
+      struct timespec deadline;
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_nsec += APX_FILEMANAGER_STOP_POLL_MS*1000000L;
+      if (deadline.tv_nsec >= 1000000000L)
+      {
+         deadline.tv_sec++;
+         deadline.tv_nsec -= 1000000000L;
+      }
+      if (sem_timedwait(&self->semaphore, &deadline) == 0)
+      {
+         return true;
+      }
+      if (errno == EINTR)
+      {
+         continue;
+      }
+#endif
+      if (apx_workerPool_isRunning(self->workerPool) == false)
+      {
+         return false;
+      }
+   }
+}
+
+/**
+ * Removes all messages from the queue without processing them
+ */
+static void apx_fileManager_dropMessages(apx_fileManager_t *self)
+{
+   apx_msg_t messages[APX_FILEMANAGER_MAX_BATCH_SIZE];
+   int32_t numRemoved;
+   while ( (numRemoved = apx_fileManager_removeMessages(self, &messages[0], APX_FILEMANAGER_MAX_BATCH_SIZE)) > 0)
+   {
+      apx_fileManager_releaseMessages(&messages[0], numRemoved);
+      (void) apx_mpscQueue_release(&self->messages, numRemoved);
+   }
+}
+
 /**
  * Handlers are run by our worker thread
  */
@@ -895,6 +1391,11 @@ static void apx_fileManager_parseDataMsg(apx_fileManager_t *self, uint32_t addre
                   {
                      apx_nodeManager_remoteFileWritten(self->nodeManager, self, remoteFile, offset, dataLen);
                   }
+                  else if ( (remoteFile->fileType == APX_DEFINITION_FILE) && (self->nodeManager != 0) )
+                  {
+                     //lets the nodeManager parse the definition while the rest of it is still being transferred
+                     apx_nodeManager_remoteFileChunkWritten(self->nodeManager, self, remoteFile, offset, dataLen);
+                  }
                }
             }
             else
@@ -0,0 +1,243 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <errno.h>
+#include <malloc.h>
+#include <string.h>
+#include "apx_mpscQueue.h"
+#include "apx_atomic.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define NODE_DATA(node) (((uint8_t*) (node)) + sizeof(apx_mpscQueueNode_t))
+#define NODE_SIZE(self) ((uint32_t) sizeof(apx_mpscQueueNode_t) + (self)->elemSize)
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+int8_t apx_mpscQueue_create(apx_mpscQueue_t *self, uint32_t elemSize)
+{
+   if ( (self != 0) && (elemSize > 0) )
+   {
+      apx_mpscQueueNode_t *stub;
+      self->elemSize = elemSize;
+      apx_allocator_create(&self->nodeAllocator);
+      stub = (apx_mpscQueueNode_t*) apx_allocator_alloc(&self->nodeAllocator, NODE_SIZE(self));
+      if (stub == 0)
+      {
+         apx_allocator_destroy(&self->nodeAllocator);
+         errno = ENOMEM;
+         return -1;
+      }
+      stub->next = (apx_mpscQueueNode_t*) 0;
+      self->head = stub;
+      self->tail = stub;
+      self->numPending = 0;
+      return 0;
+   }
+   errno = EINVAL;
+   return -1;
+}
+
+/**
+ * frees all remaining elements. No other thread may access the queue at this point.
+ */
+void apx_mpscQueue_destroy(apx_mpscQueue_t *self)
+{
+   if (self != 0)
+   {
+      apx_mpscQueueNode_t *node = self->head;
+      while (node != 0)
+      {
+         apx_mpscQueueNode_t *next = node->next;
+         apx_allocator_free(&self->nodeAllocator, (uint8_t*) node, NODE_SIZE(self));
+         node = next;
+      }
+      self->head = (apx_mpscQueueNode_t*) 0;
+      self->tail = (apx_mpscQueueNode_t*) 0;
+      apx_allocator_destroy(&self->nodeAllocator);
+   }
+}
+
+apx_mpscQueue_t *apx_mpscQueue_new(uint32_t elemSize)
+{
+   apx_mpscQueue_t *self = (apx_mpscQueue_t*) malloc(sizeof(apx_mpscQueue_t));
+   if(self != 0)
+   {
+      int8_t result = apx_mpscQueue_create(self, elemSize);
+      if (result != 0)
+      {
+         free(self);
+         self = 0;
+      }
+   }
+   else
+   {
+      errno = ENOMEM;
+   }
+   return self;
+}
+
+void apx_mpscQueue_delete(apx_mpscQueue_t *self)
+{
+   if (self != 0)
+   {
+      apx_mpscQueue_destroy(self);
+      free(self);
+   }
+}
+
+void apx_mpscQueue_vdelete(void *arg)
+{
+   apx_mpscQueue_delete((apx_mpscQueue_t*) arg);
+}
+
+/**
+ * Appends a copy of elem to the queue. Can be called from any thread.
+ * wasEmpty (optional) is set to true when this push made the number of unreleased elements go from 0 to 1. The caller must then wake up the consumer.
+ */
+int8_t apx_mpscQueue_push(apx_mpscQueue_t *self, const void *elem, bool *wasEmpty)
+{
+   return (apx_mpscQueue_emplace(self, elem, wasEmpty) != 0)? 0 : -1;
+}
+
+/**
+ * Same as apx_mpscQueue_push but returns a pointer to the copy of elem stored in the queue, or 0 on failure.
+ * The copy stays valid until the consumer pops it. It is up to the caller to make sure that the consumer does not pop it
+ * while it is being accessed (e.g. by holding a lock that the consumer also takes around apx_mpscQueue_pop).
+ */
+void *apx_mpscQueue_emplace(apx_mpscQueue_t *self, const void *elem, bool *wasEmpty)
+{
+   if ( (self != 0) && (elem != 0) )
+   {
+      apx_mpscQueueNode_t *prev;
+      int32_t numPending;
+      apx_mpscQueueNode_t *node = (apx_mpscQueueNode_t*) apx_allocator_alloc(&self->nodeAllocator, NODE_SIZE(self));
+      if (node == 0)
+      {
+         errno = ENOMEM;
+         return (void*) 0;
+      }
+      node->next = (apx_mpscQueueNode_t*) 0;
+      memcpy(NODE_DATA(node), elem, self->elemSize);
+      prev = (apx_mpscQueueNode_t*) ATOMIC_EXCHANGE_PTR(&self->tail, node);
+      //between the exchange and the store below the consumer cannot see node (nor any node pushed after it)
+      ATOMIC_STORE_PTR(&prev->next, node);
+      numPending = ATOMIC_FETCH_ADD_I32(&self->numPending, 1);
+      if (wasEmpty != 0)
+      {
+         *wasEmpty = (numPending == 0)? true : false;
+      }
+      return (void*) NODE_DATA(node);
+   }
+   errno = EINVAL;
+   return (void*) 0;
+}
+
+/**
+ * Takes the first element out of the queue. Must only be called by the consumer.
+ * Returns false when no element is available. Note that this can happen for a short while even though apx_mpscQueue_length is greater than 0,
+ * a producer may be in the middle of apx_mpscQueue_push.
+ */
+bool apx_mpscQueue_pop(apx_mpscQueue_t *self, void *elem)
+{
+   if ( (self != 0) && (elem != 0) )
+   {
+      apx_mpscQueueNode_t *head = self->head;
+      apx_mpscQueueNode_t *next = (apx_mpscQueueNode_t*) ATOMIC_LOAD_PTR(&head->next);
+      if (next == 0)
+      {
+         return false;
+      }
+      //next becomes the new stub, its data is no longer needed after this copy
+      memcpy(elem, NODE_DATA(next), self->elemSize);
+      self->head = next;
+      //goes back to the cache of the thread that pushed it, not to the global heap
+      apx_allocator_free(&self->nodeAllocator, (uint8_t*) head, NODE_SIZE(self));
+      return true;
+   }
+   return false;
+}
+
+/**
+ * Returns a pointer to the element that the next apx_mpscQueue_pop will take, or 0 if there is none. Must only be called by the consumer.
+ */
+void *apx_mpscQueue_front(apx_mpscQueue_t *self)
+{
+   if (self != 0)
+   {
+      apx_mpscQueueNode_t *next = (apx_mpscQueueNode_t*) ATOMIC_LOAD_PTR(&self->head->next);
+      if (next != 0)
+      {
+         return (void*) NODE_DATA(next);
+      }
+   }
+   return (void*) 0;
+}
+
+/**
+ * Takes up to maxNumElements elements out of the queue and copies them into the array elems. Must only be called by the consumer.
+ * Returns the number of elements taken.
+ */
+int32_t apx_mpscQueue_popMany(apx_mpscQueue_t *self, void *elems, int32_t maxNumElements)
+{
+   int32_t numElements = 0;
+   if ( (self != 0) && (elems != 0) )
+   {
+      uint8_t *next = (uint8_t*) elems;
+      while ( (numElements < maxNumElements) && (apx_mpscQueue_pop(self, next) == true) )
+      {
+         next += self->elemSize;
+         numElements++;
+      }
+   }
+   return numElements;
+}
+
+/**
+ * Called by the consumer after it has processed numElements popped elements.
+ * Returns the number of elements that are still pending. When it returns 0 or less the consumer may go to sleep,
+ * the next push will then report wasEmpty.
+ */
+int32_t apx_mpscQueue_release(apx_mpscQueue_t *self, int32_t numElements)
+{
+   if (self != 0)
+   {
+      return ATOMIC_FETCH_ADD_I32(&self->numPending, -numElements) - numElements;
+   }
+   return 0;
+}
+
+/**
+ * returns the number of pushed elements not yet released by the consumer
+ */
+int32_t apx_mpscQueue_length(apx_mpscQueue_t *self)
+{
+   if (self != 0)
+   {
+      return ATOMIC_LOAD_I32(&self->numPending);
+   }
+   return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
@@ -55,6 +55,62 @@ void apx_node_vdelete(void *arg)
    apx_node_delete((apx_node_t*) arg);
 }
 
+/**
+ * Creates a new finalized node with the same name, datatypes and ports as other.
+ * The copy is built from the strings already stored in other, no APX text needs to be parsed.
+ * Returns 0 on failure.
+ */
+apx_node_t *apx_node_clone(const apx_node_t *other)
+{
+   apx_node_t *self;
+   int32_t i;
+   int32_t len;
+   if (other == 0)
+   {
+      errno = EINVAL;
+      return (apx_node_t*) 0;
+   }
+   self = apx_node_new(other->name);
+   if (self == 0)
+   {
+      return self;
+   }
+   len = adt_ary_length(&other->datatypeList);
+   for (i=0; i<len; i++)
+   {
+      apx_datatype_t *datatype = (apx_datatype_t*) adt_ary_value(&other->datatypeList, i);
+      if (apx_node_createDataType(self, datatype->name, datatype->dsg, datatype->attr) == 0)
+      {
+         apx_node_delete(self);
+         return (apx_node_t*) 0;
+      }
+   }
+   len = adt_ary_length(&other->requirePortList);
+   for (i=0; i<len; i++)
+   {
+      apx_port_t *port = (apx_port_t*) adt_ary_value(&other->requirePortList, i);
+      const char *attr = (port->portAttributes != 0)? port->portAttributes->rawValue : (const char*) 0;
+      if (apx_node_createRequirePort(self, port->name, port->dataSignature, attr) == 0)
+      {
+         apx_node_delete(self);
+         return (apx_node_t*) 0;
+      }
+   }
+   len = adt_ary_length(&other->providePortList);
+   for (i=0; i<len; i++)
+   {
+      apx_port_t *port = (apx_port_t*) adt_ary_value(&other->providePortList, i);
+      const char *attr = (port->portAttributes != 0)? port->portAttributes->rawValue : (const char*) 0;
+      if (apx_node_createProvidePort(self, port->name, port->dataSignature, attr) == 0)
+      {
+         apx_node_delete(self);
+         return (apx_node_t*) 0;
+      }
+   }
+   apx_node_finalize(self);
+   return self;
+}
+
 void apx_node_create(apx_node_t *self,const char *name){
    if(self != 0){
       self->name = 0;
@@ -413,7 +469,7 @@ int32_t apx_node_fillPortInitData(apx_node_t *self, apx_port_t *port, adt_bytear
             uint8_t *pResult;
             pBegin = adt_bytearray_data(output);
             pEnd = pBegin + dataElement->packLen;
-            pResult = apx_dataElement_pack_dv(dataElement, pBegin, pEnd, attr->initValue);
+            pResult = apx_dataSignature_pack_dv(&port->derivedDsg, pBegin, pEnd, attr->initValue);
             if ( (pResult == 0) || (pResult == pBegin) )
             {
                return -1;
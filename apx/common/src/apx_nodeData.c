@@ -18,6 +18,7 @@
 #include <assert.h>
 #include "apx_fileManager.h"
 #include "apx_nodeInfo.h"
+#include "apx_dataTrigger.h"
 #include "apx_cfg.h"
 #endif
 #ifdef MEM_LEAK_CHECK
@@ -79,6 +80,7 @@ void apx_nodeData_create(apx_nodeData_t *self, const char *name, uint8_t *defini
       SPINLOCK_INIT(self->internalLock);
       self->fileManager = (apx_fileManager_t*) 0;
       self->nodeInfo = (apx_nodeInfo_t*) 0;
+      self->outPortDataSnapshot = (uint8_t*) 0;
 #endif
    }
 }
@@ -92,6 +94,10 @@ void apx_nodeData_destroy(apx_nodeData_t *self)
       SPINLOCK_DESTROY(self->outPortDataLock);
       SPINLOCK_DESTROY(self->definitionDataLock);
       SPINLOCK_DESTROY(self->internalLock);
+      if (self->outPortDataSnapshot != 0)
+      {
+         free(self->outPortDataSnapshot);
+      }
 
       if (self->isWeakref == false)
       {
@@ -425,6 +431,12 @@ void apx_nodeData_setInPortDataFile(apx_nodeData_t *self, struct apx_file_tag *f
    if (self != 0)
    {
       self->inPortDataFile = file;
+#ifndef APX_EMBEDDED
+      if (self->nodeInfo != 0)
+      {
+         apx_dataTrigger_invalidateRoutes(self->nodeInfo);
+      }
+#endif
    }
 }
 
@@ -456,6 +468,12 @@ void apx_nodeData_setFileManager(apx_nodeData_t *self, struct apx_fileManager_ta
    if (self != 0)
    {
       self->fileManager = fileManager;
+#ifndef APX_EMBEDDED
+      if (self->nodeInfo != 0)
+      {
+         apx_dataTrigger_invalidateRoutes(self->nodeInfo);
+      }
+#endif
    }
 }
 
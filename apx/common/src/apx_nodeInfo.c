@@ -29,6 +29,8 @@ static void apx_nodeInfo_connectProvidePortInternal(apx_nodeInfo_t *self, int32_
 static void apx_nodeInfo_disconnectRequirePortInternal(apx_nodeInfo_t *requesterNodeInfo, int32_t requesterPortIndex);
 static void apx_nodeInfo_disconnectProvidePortInternal(apx_nodeInfo_t *providerNodeInfo, int32_t providerPortIndex, apx_portref_t *portref);
 static bool apx_nodeInfo_isPortEntryOutsidePortDataLen(const apx_portDataMapEntry_t* portEntry, uint32_t portDataLen);
+static void apx_nodeInfo_markDirty(apx_nodeInfo_t *self);
+static int32_t apx_nodeInfo_findConnector(const adt_ary_t *connectorList, const apx_node_t *requesterNode, const apx_port_t *requirePort);
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL VARIABLES
@@ -58,6 +60,11 @@ void apx_nodeInfo_create(apx_nodeInfo_t *self, apx_node_t *node)
       self->requirePortFlags=0;
       self->pendingProvidePortFlags=0;
       self->pendingRequirePortFlags=0;
+      self->router = (struct apx_router_tag*) 0;
+      self->routerIndex = -1;
+      self->dirtyList = (adt_ary_t*) 0;
+      self->isDirty = false;
+      self->routeGeneration = 0;
       self->node=node;
       node->nodeInfo=self;
       self->isWeakRef_node = true; //default true
@@ -189,10 +196,12 @@ void apx_nodeInfo_connectPort(apx_nodeInfo_t *providerNodeInfo, int32_t provider
          //set event flag on require port (for later processing)
          providerNodeInfo->providePortFlags[providerPortIndex] |= APX_PORT_EVENT_CONNECTED;
          providerNodeInfo->pendingProvidePortFlags++;
+         apx_nodeInfo_markDirty(providerNodeInfo);
 
          //set event flag on require port (for later processing)
          requesterNodeInfo->requirePortFlags[requesterPortIndex] |= APX_PORT_EVENT_CONNECTED;
          requesterNodeInfo->pendingRequirePortFlags++;
+         apx_nodeInfo_markDirty(requesterNodeInfo);
       }
    }
 }
@@ -227,6 +236,7 @@ void apx_nodeInfo_disconnectProvidePort(apx_nodeInfo_t *providerNodeInfo, int32_
             apx_nodeInfo_disconnectRequirePortInternal(requesterNodeInfo,requesterPortIndex);
             requesterNodeInfo->requirePortFlags[requesterPortIndex] |= APX_PORT_EVENT_DISCONNECTED;
             requesterNodeInfo->pendingRequirePortFlags++;
+            apx_nodeInfo_markDirty(requesterNodeInfo);
          }
          //now all connections to connectList should be cleared, time to delete connectionList entirely
          //First set the connectorList pointer to NULL (i.e. we detach the object from the list)
@@ -236,6 +246,7 @@ void apx_nodeInfo_disconnectProvidePort(apx_nodeInfo_t *providerNodeInfo, int32_
          //finally set the disconnected event for later processing where we will need to update data trigger tables
          providerNodeInfo->providePortFlags[providerPortIndex] |= APX_PORT_EVENT_DISCONNECTED;
          providerNodeInfo->pendingProvidePortFlags++;
+         apx_nodeInfo_markDirty(providerNodeInfo);
       }
    }
 }
@@ -274,6 +285,8 @@ void apx_nodeInfo_disconnectRequirePort(apx_nodeInfo_t *requesterNodeInfo, int32
             providerNodeInfo->providePortFlags[providerPortIndex] |= APX_PORT_EVENT_DISCONNECTED;
             providerNodeInfo->pendingProvidePortFlags++;
             requesterNodeInfo->pendingRequirePortFlags++;
+            apx_nodeInfo_markDirty(providerNodeInfo);
+            apx_nodeInfo_markDirty(requesterNodeInfo);
          }
          else
          {
@@ -506,6 +519,7 @@ void apx_nodeInfo_setNodeData(apx_nodeInfo_t *self, apx_nodeData_t *nodeData)
    if (self != 0)
    {
       self->nodeData = nodeData;
+      apx_dataTrigger_invalidateRoutes(self);
    }
 }
 
@@ -560,7 +574,7 @@ static void apx_nodeInfo_connectProvidePortInternal(apx_nodeInfo_t *self, int32_
       }
       if ( (portIndex >= 0) && (portIndex<numPorts) )
       {
-         apx_portref_t *newConnection = apx_portref_new(requesterNode, requirePort);
+         apx_portref_t *newConnection;
          adt_ary_t *innerConnectionList;
          /*
           * For provide ports it gets a little trickier than for require ports.
@@ -591,29 +605,19 @@ static void apx_nodeInfo_connectProvidePortInternal(apx_nodeInfo_t *self, int32_
          innerConnectionList = (adt_ary_t*) *adt_ary_get(outerConnectionList,portIndex);
          if (innerConnectionList == 0)
          {
-            //innerConnectionList does not exist for this port, create inner list and append new item to it
+            //innerConnectionList does not exist for this port, create inner list
             innerConnectionList = adt_ary_new(apx_portref_vdelete);
-            adt_ary_push(innerConnectionList, newConnection);
             adt_ary_set(outerConnectionList, portIndex,innerConnectionList);
          }
-         else
+         else if (apx_nodeInfo_findConnector(innerConnectionList, requesterNode, requirePort) >= 0)
          {
-            //innerConnectionList already exists for this port, grab it and search for duplicates before appending
-            int32_t end;
-            int32_t i;
-            end = adt_ary_length(innerConnectionList);
-            for(i=0;i<end;i++)
-            {
-               apx_portref_t *ref = (apx_portref_t*) adt_ary_value(innerConnectionList,i);
-               if (apx_portref_equals(ref,newConnection) != 0)
-               {
-                  //identical connection found, don't add it again
-                  return;
-               }
-            }
-            //add new connection
-            adt_ary_push(innerConnectionList, newConnection);
+            //identical connection found, don't add it again
+            return;
          }
+         //add new connection, the require port remembers its position in the list
+         newConnection = apx_portref_new(requesterNode, requirePort);
+         requirePort->connectorIndex = adt_ary_length(innerConnectionList);
+         adt_ary_push(innerConnectionList, newConnection);
       }
    }
 }
@@ -653,22 +657,51 @@ static void apx_nodeInfo_disconnectProvidePortInternal(apx_nodeInfo_t *providerN
          adt_ary_t *innerList = (adt_ary_t*) *adt_ary_get(&providerNodeInfo->provideConnectors, providerPortIndex);
          if (innerList != 0)
          {
-            int32_t i;
-            int32_t end;
-
-            end = adt_ary_length(innerList);
-            for (i=0;i<end;i++)
+            int32_t index = apx_nodeInfo_findConnector(innerList, portref->node, portref->port);
+            if (index >= 0)
             {
-               apx_portref_t *other = (apx_portref_t*) *adt_ary_get(innerList,i); // todo adt_ary_value
-               if ( apx_portref_equals(portref,other) != 0)
+               //the order of connectors does not matter, move the last connector into the free position
+               apx_portref_t *other = (apx_portref_t*) adt_ary_value(innerList,index);
+               apx_portref_t *last = (apx_portref_t*) adt_ary_pop(innerList);
+               if (last != other)
                {
-                  //found element
-                  adt_ary_splice(innerList,i,1);
-                  return; //cannot continue loop, we just modified the list. This is OK since duplicates are not allowed
+                  adt_ary_set(innerList,index,last);
+                  last->port->connectorIndex = index;
                }
+               apx_portref_delete(other);
+               portref->port->connectorIndex = -1;
             }
          }
       }
    }
 }
 
+/**
+ * returns the position of the connector to (requesterNode,requirePort) in connectorList or -1 if there is none.
+ * A require port is connected to at most one provide port, requirePort->connectorIndex therefore tells where to look.
+ */
+static int32_t apx_nodeInfo_findConnector(const adt_ary_t *connectorList, const apx_node_t *requesterNode, const apx_port_t *requirePort)
+{
+   int32_t index = requirePort->connectorIndex;
+   if ( (index >= 0) && (index < adt_ary_length(connectorList)) )
+   {
+      apx_portref_t *ref = (apx_portref_t*) adt_ary_value(connectorList,index);
+      if ( (ref->node == requesterNode) && (ref->port == requirePort) )
+      {
+         return index;
+      }
+   }
+   return -1;
+}
+
+/**
+ * adds self to its dirtyList (at most once) so that the router only needs to post-process nodes that have pending port flags
+ */
+static void apx_nodeInfo_markDirty(apx_nodeInfo_t *self)
+{
+   if ( (self->isDirty == false) && (self->dirtyList != 0) )
+   {
+      self->isDirty = true;
+      adt_ary_push(self->dirtyList, self);
+   }
+}
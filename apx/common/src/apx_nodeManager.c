@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <malloc.h>
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <stdint.h>
@@ -22,6 +23,7 @@
 #include "apx_nodeInfo.h"
 #include "apx_router.h"
 #include "apx_logging.h"
+#include "sha256.h"
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
 #endif
@@ -33,14 +35,69 @@
 #if defined(_MSC_VER) && (_MSC_VER<=1800)
 #define snprintf _snprintf
 #endif
+#define APX_NODEMANAGER_MAX_COALESCED_WRITES 64 //number of port writes that are grouped by destination before they are sent
+#define APX_NODEMANAGER_MAX_NODE_TEMPLATES 256 //upper limit of cached node definitions
+#define APX_NODEMANAGER_DIGEST_KEY_LEN (RMF_DIGEST_SIZE*2) //definition digest in hex format, used as key in nodeTemplateMap
+
+/**
+ * one destination write produced by routing a multi-port update
+ */
+typedef struct apx_nodeManager_portWrite_tag
+{
+   apx_fileManager_t *fileManager;
+   apx_file_t *file;
+   uint32_t destOffset;
+   uint32_t srcOffset;
+   uint32_t length;
+}apx_nodeManager_portWrite_t;
+
+/**
+ * node of a disconnected client that is kept (including its router connections) until the client reconnects or the grace period expires
+ */
+typedef struct apx_nodeManager_parkedNode_tag
+{
+   apx_nodeInfo_t *nodeInfo; //weak reference, owned by nodeInfoMap
+   uint32_t parkedTimeMs;
+   uint16_t digestType;
+   uint8_t digestData[RMF_DIGEST_SIZE]; //digest of the definition file the node was created from
+   char sessionToken[RMF_SESSION_TOKEN_MAX_LEN+1];
+}apx_nodeManager_parkedNode_t;
+
+/**
+ * parser state of a definition file that is being transferred, chunks are parsed as they arrive
+ */
+typedef struct apx_nodeManager_definitionParser_tag
+{
+   apx_parser_t parser;
+   apx_istream_t istream;
+   uint32_t parsedLen; //number of bytes from the start of definitionDataBuf that have been written to istream
+}apx_nodeManager_definitionParser_t;
 
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
-static void apx_nodeManager_createNode(apx_nodeManager_t *self, const uint8_t *definitionBuf, int32_t definitionLen, struct apx_fileManager_tag *fileManager);
+static void apx_nodeManager_createNode(apx_nodeManager_t *self, const uint8_t *definitionBuf, int32_t definitionLen, struct apx_fileManager_tag *fileManager, const rmf_fileInfo_t *definitionInfo);
+static void apx_nodeManager_createNodesFromParser(apx_nodeManager_t *self, apx_parser_t *parser, const uint8_t *definitionBuf, int32_t definitionLen, struct apx_fileManager_tag *fileManager, const rmf_fileInfo_t *definitionInfo);
+static void apx_nodeManager_createParserStream(apx_istream_t *istream, apx_parser_t *parser);
+static apx_nodeManager_definitionParser_t *apx_nodeManager_definitionParser_new(void);
+static void apx_nodeManager_definitionParser_delete(apx_nodeManager_definitionParser_t *self);
+static void apx_nodeManager_definitionParser_vdelete(void *arg);
+static bool apx_nodeManager_createNodeFromTemplate(apx_nodeManager_t *self, struct apx_fileManager_tag *fileManager, apx_file_t *remoteFile, const char *basename);
+static void apx_nodeManager_attachNodes(apx_nodeManager_t *self, adt_ary_t *nodes, struct apx_fileManager_tag *fileManager);
+static void apx_nodeManager_openOutDataFile(apx_nodeData_t *nodeData, apx_nodeInfo_t *nodeInfo, apx_file_t *outDataFile, struct apx_fileManager_tag *fileManager);
+static void apx_nodeManager_storeNodeTemplate(apx_nodeManager_t *self, const rmf_fileInfo_t *definitionInfo, const uint8_t *definitionBuf, int32_t definitionLen, const apx_node_t *node);
+static void apx_nodeManager_parkNode(apx_nodeManager_t *self, apx_nodeInfo_t *nodeInfo, struct apx_fileManager_tag *fileManager, uint32_t timestampMs);
+static bool apx_nodeManager_resumeParkedNode(apx_nodeManager_t *self, struct apx_fileManager_tag *fileManager, apx_file_t *remoteFile, const char *basename);
+static void apx_nodeManager_releaseParkedNode(apx_nodeManager_t *self, apx_nodeManager_parkedNode_t *parkedNode);
+static bool apx_nodeManager_getDigestKey(const rmf_fileInfo_t *fileInfo, char *key);
+static void apx_nodeManager_getDebugInfoStr(const struct apx_fileManager_tag *fileManager, char *debugInfoStr);
 static apx_nodeData_t *apx_nodeManager_getNodeData(const apx_nodeManager_t *self, const char *name);
 static void apx_nodeManager_setLocalNodeData(apx_nodeManager_t *self, apx_nodeData_t *nodeData);
-static void apx_nodeManager_executePortTriggerFunction(const apx_dataTriggerFunction_t *triggerFunction, const apx_file_t *file);
+static void apx_nodeManager_executePortTriggerFunction(apx_dataTriggerFunction_t *triggerFunction, const apx_file_t *file);
+static void apx_nodeManager_routePortRange(apx_dataTriggerTable_t *triggerTable, const apx_file_t *file, int32_t firstPortIndex, int32_t lastPortIndex);
+static void apx_nodeManager_routeChangedPorts(apx_dataTriggerTable_t *triggerTable, const apx_file_t *file, int32_t firstPortIndex, int32_t lastPortIndex, const uint8_t *snapshot);
+static void apx_nodeManager_flushPortWrites(apx_nodeManager_portWrite_t *writes, int32_t numWrites, const uint8_t *srcBuf, uint32_t srcBegin);
+static int apx_nodeManager_comparePortWrites(const void *a, const void *b);
 static void apx_nodeManager_attachLocalNodeToFileManager(apx_nodeData_t *nodeData, apx_fileManager_t *fileManager);
 static void apx_nodeManager_removeRemoteNodeData(apx_nodeManager_t *self, apx_nodeData_t *nodeData);
 static void apx_nodeManager_removeNodeInfo(apx_nodeManager_t *self, apx_nodeInfo_t *nodeInfo);
@@ -61,24 +118,18 @@ void apx_nodeManager_create(apx_nodeManager_t *self)
 {
    if (self != 0)
    {
-      apx_istream_handler_t apx_istream_handler;
       adt_hash_create(&self->nodeInfoMap, apx_nodeInfo_vdelete);
       apx_parser_create(&self->parser);
-      memset(&apx_istream_handler,0,sizeof(apx_istream_handler));
       self->router = (apx_router_t*) 0;
       self->debugMode = APX_DEBUG_NONE;
-      apx_istream_handler.arg = &self->parser;
-      apx_istream_handler.open = apx_parser_vopen;
-      apx_istream_handler.close = apx_parser_vclose;
-      apx_istream_handler.node = apx_parser_vnode;
-      apx_istream_handler.datatype = apx_parser_vdatatype;
-      apx_istream_handler.provide = apx_parser_vprovide;
-      apx_istream_handler.require = apx_parser_vrequire;
-      apx_istream_handler.node_end = apx_parser_vnode_end;
-      apx_istream_create(&self->apx_istream,&apx_istream_handler);
+      apx_nodeManager_createParserStream(&self->apx_istream, &self->parser);
       adt_hash_create(&self->remoteNodeDataMap, apx_nodeData_vdelete);
       adt_hash_create(&self->localNodeDataMap, (void(*)(void*)) 0);
       adt_list_create(&self->fileManagerList, (void(*)(void*)) 0);
+      adt_hash_create(&self->parkedNodeMap, free);
+      adt_hash_create(&self->definitionParserMap, apx_nodeManager_definitionParser_vdelete);
+      adt_hash_create(&self->nodeTemplateMap, apx_node_vdelete);
+      self->sessionGracePeriodMs = 0;
       MUTEX_INIT(self->lock);
    }
 }
@@ -93,6 +144,9 @@ void apx_nodeManager_destroy(apx_nodeManager_t *self)
       adt_hash_destroy(&self->remoteNodeDataMap);
       adt_hash_destroy(&self->localNodeDataMap);
       adt_list_destroy(&self->fileManagerList);
+      adt_hash_destroy(&self->parkedNodeMap);
+      adt_hash_destroy(&self->definitionParserMap);
+      adt_hash_destroy(&self->nodeTemplateMap);
       MUTEX_DESTROY(self->lock);
    }
 }
@@ -110,36 +164,54 @@ void apx_nodeManager_remoteFileAdded(apx_nodeManager_t *self, struct apx_fileMan
          if (basename != 0)
          {
             apx_nodeData_t *nodeData;
+            bool isResumed = false;
             //this is potentially a new node, check if it exists already
             MUTEX_LOCK(self->lock);
+            if (fileManager->mode == APX_FILEMANAGER_SERVER_MODE)
+            {
+               //a client that reconnects within the session grace period gets its parked node back
+               isResumed = apx_nodeManager_resumeParkedNode(self, fileManager, remoteFile, basename);
+            }
             nodeData = apx_nodeManager_getNodeData(self, basename);
             MUTEX_UNLOCK(self->lock);
-            if (nodeData == 0)
+            if (isResumed)
+            {
+               //router connections and data buffers are already in place
+            }
+            else if (nodeData == 0)
             {
                if (fileManager->mode == APX_FILEMANAGER_SERVER_MODE)
                {
-                  //create new nodeData structure and initiate download of file
-                  nodeData = apx_nodeData_newRemote(basename, false); //setting weakref to false will force apx_nodeData_delete to delete all buffers we created here
-                  if (nodeData != 0)
+                  bool isCreated;
+                  //a definition that has been seen before (same digest) does not need to be downloaded and parsed again
+                  MUTEX_LOCK(self->lock);
+                  isCreated = apx_nodeManager_createNodeFromTemplate(self, fileManager, remoteFile, basename);
+                  MUTEX_UNLOCK(self->lock);
+                  if (isCreated == false)
                   {
-                     nodeData->definitionDataBuf = (uint8_t*) malloc(remoteFile->fileInfo.length);
-                     if (nodeData->definitionDataBuf==0)
+                     //create new nodeData structure and initiate download of file
+                     nodeData = apx_nodeData_newRemote(basename, false); //setting weakref to false will force apx_nodeData_delete to delete all buffers we created here
+                     if (nodeData != 0)
                      {
-                        APX_LOG_ERROR("[APX_NODE_MANAGER] out of memory when attempting to create definitionDataBuf of length %d for node %s", (int) remoteFile->fileInfo.length, basename);
-                        free(basename);
-                        apx_nodeData_delete(nodeData);
-                        return;
-                     }
-                     else
-                     {
-                        nodeData->definitionDataLen = remoteFile->fileInfo.length;
-                        MUTEX_LOCK(self->lock);
-                        adt_hash_set(&self->remoteNodeDataMap, basename, 0, nodeData);
-                        MUTEX_UNLOCK(self->lock);
-                        //now that memory has been allocated, send request to open the file (triggering file transfer)
-                        apx_fileManager_sendFileOpen(fileManager, remoteFile->fileInfo.address);
-                        //the following line binds our new nodeData object to the apx_file_t structure
-                        remoteFile->nodeData=nodeData;
+                        nodeData->definitionDataBuf = (uint8_t*) malloc(remoteFile->fileInfo.length);
+                        if (nodeData->definitionDataBuf==0)
+                        {
+                           APX_LOG_ERROR("[APX_NODE_MANAGER] out of memory when attempting to create definitionDataBuf of length %d for node %s", (int) remoteFile->fileInfo.length, basename);
+                           free(basename);
+                           apx_nodeData_delete(nodeData);
+                           return;
+                        }
+                        else
+                        {
+                           nodeData->definitionDataLen = remoteFile->fileInfo.length;
+                           MUTEX_LOCK(self->lock);
+                           adt_hash_set(&self->remoteNodeDataMap, basename, 0, nodeData);
+                           MUTEX_UNLOCK(self->lock);
+                           //now that memory has been allocated, send request to open the file (triggering file transfer)
+                           apx_fileManager_sendFileOpen(fileManager, remoteFile->fileInfo.address);
+                           //the following line binds our new nodeData object to the apx_file_t structure
+                           remoteFile->nodeData=nodeData;
+                        }
                      }
                   }
                }
@@ -187,6 +259,23 @@ void apx_nodeManager_remoteFileAdded(apx_nodeManager_t *self, struct apx_fileMan
             free(basename);
          }
       }
+      else if ( (remoteFile->fileType == APX_OUTDATA_FILE) && (fileManager->mode == APX_FILEMANAGER_SERVER_MODE) )
+      {
+         char *basename = apx_file_basename(remoteFile);
+         if (basename != 0)
+         {
+            apx_nodeData_t *nodeData;
+            MUTEX_LOCK(self->lock);
+            nodeData = apx_nodeManager_getNodeData(self, basename);
+            //nodes created from a cached definition already exist when their .out file is seen
+            if ( (nodeData != 0) && (nodeData->nodeInfo != 0) && (nodeData->fileManager == fileManager) )
+            {
+               apx_nodeManager_openOutDataFile(nodeData, nodeData->nodeInfo, remoteFile, fileManager);
+            }
+            MUTEX_UNLOCK(self->lock);
+            free(basename);
+         }
+      }
       else
       {
          
@@ -207,6 +296,48 @@ void apx_nodeManager_remotefileRemoved(apx_nodeManager_t *self, struct apx_fileM
    //printf("apx_nodeManager_remotefileRemoved\n");
 }
 
+/**
+ * this is called by fileManager for each received part of a file write that continues in later messages (more_bit set).
+ * Chunks of definition files are parsed right away so that parsing overlaps with the transfer, apx_nodeManager_remoteFileWritten
+ * parses the last chunk and creates the nodes. Chunks that don't arrive in order fall back to parsing the complete file at the end.
+ */
+void apx_nodeManager_remoteFileChunkWritten(apx_nodeManager_t *self, struct apx_fileManager_tag *fileManager, apx_file_t *remoteFile, uint32_t offset, int32_t length)
+{
+   if ( (self != 0) && (fileManager != 0) && (remoteFile != 0) && (remoteFile->fileType == APX_DEFINITION_FILE) && (remoteFile->nodeData != 0) && (length > 0) )
+   {
+      apx_nodeData_t *nodeData = remoteFile->nodeData;
+      apx_nodeManager_definitionParser_t *definitionParser = (apx_nodeManager_definitionParser_t*) 0;
+      void **ppVal;
+      MUTEX_LOCK(self->lock);
+      ppVal = adt_hash_get(&self->definitionParserMap, nodeData->name, 0);
+      if (ppVal != 0)
+      {
+         definitionParser = (apx_nodeManager_definitionParser_t*) *ppVal;
+         if (definitionParser->parsedLen != offset)
+         {
+            adt_hash_remove(&self->definitionParserMap, nodeData->name, 0);
+            apx_nodeManager_definitionParser_delete(definitionParser);
+            definitionParser = (apx_nodeManager_definitionParser_t*) 0;
+         }
+      }
+      else if (offset == 0)
+      {
+         definitionParser = apx_nodeManager_definitionParser_new();
+         if (definitionParser != 0)
+         {
+            adt_hash_set(&self->definitionParserMap, nodeData->name, 0, definitionParser);
+         }
+      }
+      if (definitionParser != 0)
+      {
+         //the lock is held while parsing, apx_nodeManager_removeRemoteNodeData deletes the parser when the connection goes away
+         apx_istream_write(&definitionParser->istream, &nodeData->definitionDataBuf[offset], (uint32_t) length);
+         definitionParser->parsedLen += (uint32_t) length;
+      }
+      MUTEX_UNLOCK(self->lock);
+   }
+}
+
 /**
  * this is called by fileManager when a file has been written to
  */
@@ -216,9 +347,29 @@ void apx_nodeManager_remoteFileWritten(apx_nodeManager_t *self, struct apx_fileM
    {
       if (remoteFile->fileType == APX_DEFINITION_FILE)
       {
+         apx_nodeData_t *nodeData = remoteFile->nodeData;
+         apx_nodeManager_definitionParser_t *definitionParser = (apx_nodeManager_definitionParser_t*) 0;
+         void **ppVal;
          MUTEX_LOCK(self->lock);
-         apx_nodeManager_createNode(self, remoteFile->nodeData->definitionDataBuf, remoteFile->nodeData->definitionDataLen, fileManager);
+         ppVal = adt_hash_get(&self->definitionParserMap, nodeData->name, 0);
+         if (ppVal != 0)
+         {
+            definitionParser = (apx_nodeManager_definitionParser_t*) *ppVal;
+            adt_hash_remove(&self->definitionParserMap, nodeData->name, 0);
+         }
+         if ( (definitionParser != 0) && (definitionParser->parsedLen == offset) && (offset + (uint32_t) length == nodeData->definitionDataLen) )
+         {
+            //everything but the last chunk has already been parsed during the transfer
+            apx_istream_write(&definitionParser->istream, &nodeData->definitionDataBuf[offset], (uint32_t) length);
+            apx_istream_close(&definitionParser->istream);
+            apx_nodeManager_createNodesFromParser(self, &definitionParser->parser, nodeData->definitionDataBuf, nodeData->definitionDataLen, fileManager, &remoteFile->fileInfo);
+         }
+         else
+         {
+            apx_nodeManager_createNode(self, nodeData->definitionDataBuf, nodeData->definitionDataLen, fileManager, &remoteFile->fileInfo);
+         }
          MUTEX_UNLOCK(self->lock);
+         apx_nodeManager_definitionParser_delete(definitionParser);
       }
       else
       {
@@ -234,20 +385,31 @@ void apx_nodeManager_remoteFileWritten(apx_nodeManager_t *self, struct apx_fileM
          if (remoteFile->fileType == APX_OUTDATA_FILE)
          {
             apx_nodeInfo_t *nodeInfo = remoteFile->nodeData->nodeInfo;
+            apx_dataTriggerTable_t *triggerTable;
+            int32_t firstPortIndex;
+            int32_t lastPortIndex;
             assert(nodeInfo != 0);
-            while (offset < endOffset)
+            triggerTable = &nodeInfo->outDataTriggerTable;
+            firstPortIndex = apx_dataTriggerTable_findPort(triggerTable, offset);
+            lastPortIndex = (length > 0)? apx_dataTriggerTable_findPort(triggerTable, endOffset-1) : -1;
+            if ( (firstPortIndex >= 0) && (lastPortIndex < 0) && (length > 0) )
+            {
+               //write extends beyond the outDataMap
+               lastPortIndex = triggerTable->numPorts-1;
+            }
+            if ( (firstPortIndex >= 0) && (lastPortIndex >= firstPortIndex) )
             {
-               apx_dataTriggerFunction_t *triggerFunction;
-               triggerFunction = apx_nodeInfo_getTriggerFunction(nodeInfo, offset);
-               if (triggerFunction != 0)
+               uint8_t *snapshot = remoteFile->nodeData->outPortDataSnapshot;
+               if (snapshot != 0)
                {
-                  apx_nodeManager_executePortTriggerFunction(triggerFunction, remoteFile);
-                  offset = triggerFunction->srcOffset + triggerFunction->dataLength;
+                  //first write after a resumed session, receivers already have the data from before the disconnect
+                  remoteFile->nodeData->outPortDataSnapshot = (uint8_t*) 0;
+                  apx_nodeManager_routeChangedPorts(triggerTable, remoteFile, firstPortIndex, lastPortIndex, snapshot);
+                  free(snapshot);
                }
                else
                {
-                  //fprintf(stderr, "APX_NODE_MANAGER(%s)] no trigger function found for file %s at offset %d\n", apx_fileManager_modeString(fileManager), remoteFile->fileInfo.name, offset);               
-                  offset++;
+                  apx_nodeManager_routePortRange(triggerTable, remoteFile, firstPortIndex, lastPortIndex);
                }
             }
          }
@@ -379,15 +541,16 @@ void apx_nodeManager_detachFileManager(apx_nodeManager_t *self, struct apx_fileM
             }
          }
       } while(ppVal != 0);
+      if (self->router != 0)
+      {
+         //detach all nodes of the fileManager in one pass, their require ports are not rerouted to each other
+         apx_router_detachNodeInfoBatch(self->router, &toBeDeleted);
+      }
       end = adt_ary_length(&toBeDeleted);
       for (i=0; i<end; i++)
       {
          apx_nodeInfo_t *nodeInfo = (apx_nodeInfo_t*) *adt_ary_get(&toBeDeleted, i);
          apx_nodeData_t *nodeData = nodeInfo->nodeData;
-         if (self->router != 0)
-         {
-            apx_router_detachNodeInfo(self->router, nodeInfo);
-         }
          apx_nodeManager_removeRemoteNodeData(self, nodeData);
          apx_nodeData_delete(nodeData);
          adt_ary_push(&deletedNodeData,nodeData);
@@ -443,6 +606,121 @@ void apx_nodeManager_detachFileManager(apx_nodeManager_t *self, struct apx_fileM
    }
 }
 
+/**
+ * Sets how long the nodes of a disconnected client are kept (see apx_nodeManager_parkFileManager). 0 disables parking.
+ */
+void apx_nodeManager_setSessionGracePeriod(apx_nodeManager_t *self, uint32_t gracePeriodMs)
+{
+   if (self != 0)
+   {
+      self->sessionGracePeriodMs = gracePeriodMs;
+   }
+}
+
+/**
+ * Called instead of apx_nodeManager_detachFileManager when a client disconnects.
+ * Nodes of a client that presented a session token (and whose definition has a digest) are parked:
+ * they keep their nodeInfo, router connections and data buffers but are no longer bound to any fileManager.
+ * All other nodes of the fileManager are detached as usual.
+ */
+void apx_nodeManager_parkFileManager(apx_nodeManager_t *self, struct apx_fileManager_tag *fileManager, uint32_t timestampMs)
+{
+   if ( (self != 0) && (fileManager != 0) )
+   {
+      if ( (self->sessionGracePeriodMs > 0) && (fileManager->sessionToken[0] != 0) && (fileManager->mode == APX_FILEMANAGER_SERVER_MODE) )
+      {
+         void **ppVal;
+         const char *key;
+         uint32_t keyLen;
+         int32_t i;
+         int32_t end;
+         adt_ary_t nodeInfos; //weak references to apx_nodeInfo_t
+         adt_list_elem_t *iter;
+         adt_ary_create(&nodeInfos, (void(*)(void*)) 0);
+         MUTEX_LOCK(self->lock);
+         adt_hash_iter_init(&self->nodeInfoMap);
+         do
+         {
+            ppVal = adt_hash_iter_next(&self->nodeInfoMap, &key, &keyLen);
+            if (ppVal != 0)
+            {
+               apx_nodeInfo_t *nodeInfo = (apx_nodeInfo_t*) *ppVal;
+               if ( (nodeInfo->nodeData != 0) && (nodeInfo->nodeData->fileManager == fileManager) )
+               {
+                  adt_ary_push(&nodeInfos, nodeInfo);
+               }
+            }
+         } while(ppVal != 0);
+         end = adt_ary_length(&nodeInfos);
+         for (i=0; i<end; i++)
+         {
+            apx_nodeManager_parkNode(self, (apx_nodeInfo_t*) adt_ary_value(&nodeInfos, i), fileManager, timestampMs);
+         }
+         //unbind parked nodeData from the remote files so apx_nodeManager_detachFileManager leaves it alone
+         adt_list_iter_init(&fileManager->remoteFileMap.fileList);
+         do
+         {
+            iter = adt_list_iter_next(&fileManager->remoteFileMap.fileList);
+            if (iter != 0)
+            {
+               apx_file_t *file = (apx_file_t*) iter->pItem;
+               if ( (file != 0) && (file->nodeData != 0) )
+               {
+                  ppVal = adt_hash_get(&self->parkedNodeMap, file->nodeData->name, 0);
+                  if ( (ppVal != 0) && ( ((apx_nodeManager_parkedNode_t*) *ppVal)->nodeInfo->nodeData == file->nodeData) )
+                  {
+                     file->nodeData = (apx_nodeData_t*) 0;
+                  }
+               }
+            }
+         } while(iter != 0);
+         MUTEX_UNLOCK(self->lock);
+         adt_ary_destroy(&nodeInfos);
+      }
+      apx_nodeManager_detachFileManager(self, fileManager);
+   }
+}
+
+/**
+ * Removes all parked nodes that have been waiting longer than the session grace period
+ */
+void apx_nodeManager_expireParkedNodes(apx_nodeManager_t *self, uint32_t timestampMs)
+{
+   if (self != 0)
+   {
+      void **ppVal;
+      const char *key;
+      uint32_t keyLen;
+      int32_t i;
+      int32_t end;
+      adt_ary_t expired; //weak references to apx_nodeManager_parkedNode_t
+      adt_ary_create(&expired, (void(*)(void*)) 0);
+      MUTEX_LOCK(self->lock);
+      adt_hash_iter_init(&self->parkedNodeMap);
+      do
+      {
+         ppVal = adt_hash_iter_next(&self->parkedNodeMap, &key, &keyLen);
+         if (ppVal != 0)
+         {
+            apx_nodeManager_parkedNode_t *parkedNode = (apx_nodeManager_parkedNode_t*) *ppVal;
+            if ( (uint32_t) (timestampMs - parkedNode->parkedTimeMs) >= self->sessionGracePeriodMs)
+            {
+               adt_ary_push(&expired, parkedNode);
+            }
+         }
+      } while(ppVal != 0);
+      end = adt_ary_length(&expired);
+      for (i=0; i<end; i++)
+      {
+         apx_nodeManager_parkedNode_t *parkedNode = (apx_nodeManager_parkedNode_t*) adt_ary_value(&expired, i);
+         APX_LOG_INFO("[APX_NODE_MANAGER] session of %s expired", parkedNode->nodeInfo->node->name);
+         apx_nodeManager_releaseParkedNode(self, parkedNode);
+      }
+      MUTEX_UNLOCK(self->lock);
+      adt_ary_destroy(&expired);
+   }
+}
+
 void apx_nodeManager_setDebugMode(apx_nodeManager_t *self, int8_t debugMode)
 {
    if (self != 0)
@@ -458,135 +736,298 @@ void apx_nodeManager_setDebugMode(apx_nodeManager_t *self, int8_t debugMode)
 /**
  * used to create new remote nodes on server side
  */
-static void apx_nodeManager_createNode(apx_nodeManager_t *self, const uint8_t *definitionBuf, int32_t definitionLen, struct apx_fileManager_tag *fileManager)
+static void apx_nodeManager_createNode(apx_nodeManager_t *self, const uint8_t *definitionBuf, int32_t definitionLen, struct apx_fileManager_tag *fileManager, const rmf_fileInfo_t *definitionInfo)
 {
    if( (self != 0) && (definitionBuf != 0) && (definitionLen > 0) )
    {
-      int32_t numNodes;
-      int32_t i;
-      char debugInfoStr[APX_DEBUG_INFO_MAX_LEN];
-      debugInfoStr[0]=0;
-      if (fileManager->debugInfo != 0)
-      {
-         snprintf(debugInfoStr, APX_DEBUG_INFO_MAX_LEN, " (%p)", fileManager->debugInfo);
-      }
-      APX_LOG_INFO("[APX_NODE_MANAGER]%s Server processing APX definition, len=%d", debugInfoStr, (int) definitionLen);
-
-
       apx_istream_reset(&self->apx_istream);
       apx_istream_open(&self->apx_istream);
       apx_istream_write(&self->apx_istream, definitionBuf, (uint32_t) definitionLen);
       apx_istream_close(&self->apx_istream);
-      numNodes = apx_parser_getNumNodes(&self->parser);
-      for (i=0;i<numNodes;i++)
-      {
-         apx_nodeInfo_t *nodeInfo;
-         apx_node_t *apxNode = apx_parser_getNode(&self->parser, i);
-         assert(apxNode != 0);
-         apx_node_finalize(apxNode);
-         nodeInfo = apx_nodeInfo_new(apxNode);
-         if (nodeInfo != 0)
-         {
-            apx_nodeData_t *nodeData=0;
-            char fileName[RMF_MAX_FILE_NAME];
-            char *p;
-            int32_t inPortDataLen;
-            int32_t outPortDataLen;
-            apx_file_t *inDataFile = (apx_file_t*) 0;
-
-
-            nodeData = apx_nodeManager_getNodeData(self, apxNode->name);
-            if (nodeData == 0)
-            {
-               APX_LOG_ERROR("[APX_NODE_MANAGER] %s", "Failed to create nodeData object");
-               return;
-            }
-            apx_nodeData_setFileManager(nodeData,fileManager);
-            apx_nodeData_setNodeInfo(nodeData, nodeInfo);
-            apx_nodeInfo_setNodeData(nodeInfo, nodeData);
-            nodeInfo->isWeakRef_node = false; //nodeInfo is now the owner of the node pointer (will trigger deletion when apx_nodeInfo_delete is called)
-            adt_hash_set(&self->nodeInfoMap, apxNode->name, 0, nodeInfo);
-            inPortDataLen = apx_nodeInfo_getInPortDataLen(nodeInfo);
-            outPortDataLen = apx_nodeInfo_getOutPortDataLen(nodeInfo);
-            
-            //if node has output data, search a file called "<node_name>.out"
-            if (outPortDataLen > 0)
+      apx_nodeManager_createNodesFromParser(self, &self->parser, definitionBuf, definitionLen, fileManager, definitionInfo);
+   }
+}
+
+/**
+ * attaches the nodes of a parser that has seen the complete definition, the parser no longer references the nodes afterwards
+ */
+static void apx_nodeManager_createNodesFromParser(apx_nodeManager_t *self, apx_parser_t *parser, const uint8_t *definitionBuf, int32_t definitionLen, struct apx_fileManager_tag *fileManager, const rmf_fileInfo_t *definitionInfo)
+{
+   int32_t numNodes;
+   int32_t i;
+   adt_ary_t nodes; //weak references to the parsed apx_node_t
+   char debugInfoStr[APX_DEBUG_INFO_MAX_LEN];
+   apx_nodeManager_getDebugInfoStr(fileManager, debugInfoStr);
+   APX_LOG_INFO("[APX_NODE_MANAGER]%s Server processing APX definition, len=%d", debugInfoStr, (int) definitionLen);
+   numNodes = apx_parser_getNumNodes(parser);
+   adt_ary_create(&nodes, (void(*)(void*)) 0);
+   for (i=0;i<numNodes;i++)
+   {
+      apx_node_t *apxNode = apx_parser_getNode(parser, i);
+      assert(apxNode != 0);
+      apx_node_finalize(apxNode);
+      adt_ary_push(&nodes, apxNode);
+   }
+   if (numNodes == 1)
+   {
+      apx_nodeManager_storeNodeTemplate(self, definitionInfo, definitionBuf, definitionLen, (apx_node_t*) adt_ary_value(&nodes, 0));
+   }
+   apx_nodeManager_attachNodes(self, &nodes, fileManager);
+   adt_ary_destroy(&nodes);
+   apx_parser_clearNodes(parser);
+}
+
+static void apx_nodeManager_createParserStream(apx_istream_t *istream, apx_parser_t *parser)
+{
+   apx_istream_handler_t apx_istream_handler;
+   memset(&apx_istream_handler,0,sizeof(apx_istream_handler));
+   apx_istream_handler.arg = parser;
+   apx_istream_handler.open = apx_parser_vopen;
+   apx_istream_handler.close = apx_parser_vclose;
+   apx_istream_handler.node = apx_parser_vnode;
+   apx_istream_handler.datatype = apx_parser_vdatatype;
+   apx_istream_handler.provide = apx_parser_vprovide;
+   apx_istream_handler.require = apx_parser_vrequire;
+   apx_istream_handler.node_end = apx_parser_vnode_end;
+   apx_istream_create(istream,&apx_istream_handler);
+}
+
+static apx_nodeManager_definitionParser_t *apx_nodeManager_definitionParser_new(void)
+{
+   apx_nodeManager_definitionParser_t *self = (apx_nodeManager_definitionParser_t*) malloc(sizeof(apx_nodeManager_definitionParser_t));
+   if (self != 0)
+   {
+      apx_parser_create(&self->parser);
+      apx_nodeManager_createParserStream(&self->istream, &self->parser);
+      self->parsedLen = 0;
+      apx_istream_open(&self->istream);
+   }
+   else
+   {
+      errno = ENOMEM;
+   }
+   return self;
+}
+
+static void apx_nodeManager_definitionParser_delete(apx_nodeManager_definitionParser_t *self)
+{
+   if (self != 0)
+   {
+      apx_istream_destroy(&self->istream);
+      apx_parser_destroy(&self->parser);
+      free(self);
+   }
+}
+
+static void apx_nodeManager_definitionParser_vdelete(void *arg)
+{
+   apx_nodeManager_definitionParser_delete((apx_nodeManager_definitionParser_t*) arg);
+}
+
+/**
+ * Creates a remote node by cloning a cached node definition instead of downloading and parsing the definition file.
+ * Returns false when remoteFile does not match any cached definition (caller must download the file).
+ * Must be called while holding self->lock
+ */
+static bool apx_nodeManager_createNodeFromTemplate(apx_nodeManager_t *self, struct apx_fileManager_tag *fileManager, apx_file_t *remoteFile, const char *basename)
+{
+   char key[APX_NODEMANAGER_DIGEST_KEY_LEN+1];
+   char debugInfoStr[APX_DEBUG_INFO_MAX_LEN];
+   void **ppVal;
+   apx_node_t *templateNode;
+   apx_node_t *node;
+   apx_nodeData_t *nodeData;
+   adt_ary_t nodes;
+   if (apx_nodeManager_getDigestKey(&remoteFile->fileInfo, key) == false)
+   {
+      return false;
+   }
+   ppVal = adt_hash_get(&self->nodeTemplateMap, key, 0);
+   if (ppVal == 0)
+   {
+      return false;
+   }
+   templateNode = (apx_node_t*) *ppVal;
+   if (strcmp(templateNode->name, basename) != 0)
+   {
+      return false;
+   }
+   node = apx_node_clone(templateNode);
+   if (node == 0)
+   {
+      return false;
+   }
+   nodeData = apx_nodeData_newRemote(basename, false);
+   if (nodeData == 0)
+   {
+      apx_node_delete(node);
+      return false;
+   }
+   apx_nodeManager_getDebugInfoStr(fileManager, debugInfoStr);
+   APX_LOG_INFO("[APX_NODE_MANAGER]%s Server reusing cached APX definition of %s", debugInfoStr, basename);
+   adt_hash_set(&self->remoteNodeDataMap, basename, 0, nodeData);
+   //binds nodeData to the definition file so it is cleaned up together with the other files of the fileManager
+   remoteFile->nodeData=nodeData;
+   adt_ary_create(&nodes, (void(*)(void*)) 0);
+   adt_ary_push(&nodes, node);
+   apx_nodeManager_attachNodes(self, &nodes, fileManager);
+   adt_ary_destroy(&nodes);
+   return true;
+}
+
+/**
+ * Creates nodeInfo objects and port data files for the finalized nodes in the nodes array and attaches them to the router.
+ * Ownership of each node is transferred to its new nodeInfo object.
+ */
+static void apx_nodeManager_attachNodes(apx_nodeManager_t *self, adt_ary_t *nodes, struct apx_fileManager_tag *fileManager)
+{
+   int32_t numNodes;
+   int32_t i;
+   adt_ary_t newNodeInfos; //weak references to apx_nodeInfo_t, attached to the router in one batch
+   adt_ary_t inDataFiles; //weak references to apx_file_t, same order as newNodeInfos (NULL for nodes without inPortData)
+#ifndef UNIT_TEST
+   char debugInfoStr[APX_DEBUG_INFO_MAX_LEN];
+   apx_nodeManager_getDebugInfoStr(fileManager, debugInfoStr);
+#endif
+   numNodes = adt_ary_length(nodes);
+   adt_ary_create(&newNodeInfos, (void(*)(void*)) 0);
+   adt_ary_create(&inDataFiles, (void(*)(void*)) 0);
+   for (i=0;i<numNodes;i++)
+   {
+      apx_nodeInfo_t *nodeInfo;
+      apx_node_t *apxNode = (apx_node_t*) adt_ary_value(nodes, i);
+      assert(apxNode != 0);
+      nodeInfo = apx_nodeInfo_new(apxNode);
+      if (nodeInfo != 0)
+      {
+         apx_nodeData_t *nodeData=0;
+         char fileName[RMF_MAX_FILE_NAME];
+         char *p;
+         int32_t inPortDataLen;
+         int32_t outPortDataLen;
+         apx_file_t *inDataFile = (apx_file_t*) 0;
+
+
+         nodeData = apx_nodeManager_getNodeData(self, apxNode->name);
+         if (nodeData == 0)
+         {
+            APX_LOG_ERROR("[APX_NODE_MANAGER] %s", "Failed to create nodeData object");
+            nodeInfo->isWeakRef_node = false; //the node is not referenced anywhere else, let nodeInfo delete it
+            apx_nodeInfo_delete(nodeInfo);
+            continue;
+         }
+         apx_nodeData_setFileManager(nodeData,fileManager);
+         apx_nodeData_setNodeInfo(nodeData, nodeInfo);
+         apx_nodeInfo_setNodeData(nodeInfo, nodeData);
+         nodeInfo->isWeakRef_node = false; //nodeInfo is now the owner of the node pointer (will trigger deletion when apx_nodeInfo_delete is called)
+         adt_hash_set(&self->nodeInfoMap, apxNode->name, 0, nodeInfo);
+         inPortDataLen = apx_nodeInfo_getInPortDataLen(nodeInfo);
+         outPortDataLen = apx_nodeInfo_getOutPortDataLen(nodeInfo);
+
+         //if node has output data, search a file called "<node_name>.out"
+         if (outPortDataLen > 0)
+         {
+            apx_file_t *outDataFile;
+            strcpy(fileName,apxNode->name);
+            p=fileName+strlen(fileName);
+            strcpy(p,".out");
+
+            outDataFile = apx_fileManager_findRemoteFile(fileManager, fileName);
+            if (outDataFile != 0)
             {
-               apx_file_t *outDataFile;
-               strcpy(fileName,apxNode->name);
-               p=fileName+strlen(fileName);
-               strcpy(p,".out");
-               
-               outDataFile = apx_fileManager_findRemoteFile(fileManager, fileName);
-               if (outDataFile != 0)
-               {
-                  //check if length of file is the expected length of our outPortDataLen calculation
-                  if (outPortDataLen != (int32_t) outDataFile->fileInfo.length)
-                  {
-                     APX_LOG_ERROR("[APX_NODE_MANAGER] length of file %s is %d, expected length was %d\n", fileName, outDataFile->fileInfo.length, outPortDataLen);
-                  }
-                  else
-                  {
-                     if (outDataFile->nodeData==0)
-                     {
-                        outDataFile->nodeData=nodeData;
-                        //now create memory for the outPortData
-                        nodeData->outPortDataBuf = (uint8_t*) malloc(outPortDataLen);
-                        assert(nodeData->outPortDataBuf);
-                        nodeData->outPortDirtyFlags = (uint8_t*) malloc(outPortDataLen);
-                        assert(nodeData->outPortDirtyFlags);
-                        nodeData->outPortDataLen = outPortDataLen;
-                        APX_LOG_INFO("[APX_NODE_MANAGER]%s Server opening client file %s[%d,%d]", debugInfoStr, fileName, outDataFile->fileInfo.address, outDataFile->fileInfo.length);
-                        apx_nodeData_setNodeInfo(nodeData, nodeInfo);
-                        apx_fileManager_sendFileOpen(fileManager, outDataFile->fileInfo.address);
-                     }
-                  }
-               }
-               else
-               {
-                  APX_LOG_WARNING("[APX_NODE_MANAGER] '%s': no file found", fileName);
-               }
+               apx_nodeManager_openOutDataFile(nodeData, nodeInfo, outDataFile, fileManager);
             }
-            if (inPortDataLen > 0)
+            else
             {
-               //create local inPortData file
-
-               bool result;
-               strcpy(fileName,apxNode->name);
-               p=fileName+strlen(fileName);
-               strcpy(p,".in");
-               
-               nodeData->inPortDataBuf = (uint8_t*) malloc(inPortDataLen);
-               assert(nodeData->inPortDataBuf);
-               nodeData->inPortDirtyFlags = (uint8_t*) malloc(inPortDataLen);
-               assert(nodeData->inPortDirtyFlags);
-               result = apx_nodeManager_createInitData(apxNode, nodeData->inPortDataBuf, inPortDataLen);
-               if (result == false)
-               {
-                  APX_LOG_ERROR("[APX_NODE_MANAGER] Failed to create init data for node %s", apx_node_getName(apxNode));
-               }
-               nodeData->inPortDataLen = inPortDataLen;
-               inDataFile = apx_file_newLocalInPortDataFile(nodeData);
-               if (inDataFile == 0)
-               {
-                  APX_LOG_ERROR("[APX_NODE_MANAGER]%s Server failed to create local file '%s'", debugInfoStr, fileName);
-               }
+               APX_LOG_WARNING("[APX_NODE_MANAGER] '%s': no file found", fileName);
             }
-            //router is set, attach the newly create nodeInfo to the router
-            if (self->router != 0)
+         }
+         if (inPortDataLen > 0)
+         {
+            //create local inPortData file
+
+            bool result;
+            strcpy(fileName,apxNode->name);
+            p=fileName+strlen(fileName);
+            strcpy(p,".in");
+
+            nodeData->inPortDataBuf = (uint8_t*) malloc(inPortDataLen);
+            assert(nodeData->inPortDataBuf);
+            nodeData->inPortDirtyFlags = (uint8_t*) malloc(inPortDataLen);
+            assert(nodeData->inPortDirtyFlags);
+            result = apx_nodeManager_createInitData(apxNode, nodeData->inPortDataBuf, inPortDataLen);
+            if (result == false)
             {
-               apx_router_attachNodeInfo(self->router, nodeInfo);
+               APX_LOG_ERROR("[APX_NODE_MANAGER] Failed to create init data for node %s", apx_node_getName(apxNode));
             }
-            //for all connected require ports copy data from the provide port into our newly create inDataFile buffer
-            apx_nodeInfo_copyInitDataFromProvideConnectors(nodeInfo);
-            if (inDataFile != 0)
+            nodeData->inPortDataLen = inPortDataLen;
+            inDataFile = apx_file_newLocalInPortDataFile(nodeData);
+            if (inDataFile == 0)
             {
-               apx_fileManager_attachLocalPortDataFile(fileManager, inDataFile);
-               APX_LOG_INFO("[APX_NODE_MANAGER]%s Server created file %s[%d,%d]", debugInfoStr, fileName, inDataFile->fileInfo.address, inDataFile->fileInfo.length);
+               APX_LOG_ERROR("[APX_NODE_MANAGER]%s Server failed to create local file '%s'", debugInfoStr, fileName);
             }
          }
+         adt_ary_push(&newNodeInfos, nodeInfo);
+         adt_ary_push(&inDataFiles, inDataFile);
+      }
+   }
+   //router is set, attach all nodes from this definition to the router in one batch
+   if (self->router != 0)
+   {
+      apx_router_attachNodeInfoBatch(self->router, &newNodeInfos);
+   }
+   numNodes = adt_ary_length(&newNodeInfos);
+   for (i=0;i<numNodes;i++)
+   {
+      apx_nodeInfo_t *nodeInfo = (apx_nodeInfo_t*) adt_ary_value(&newNodeInfos, i);
+      apx_file_t *inDataFile = (apx_file_t*) adt_ary_value(&inDataFiles, i);
+      //for all connected require ports copy data from the provide port into our newly create inDataFile buffer
+      apx_nodeInfo_copyInitDataFromProvideConnectors(nodeInfo);
+      if (inDataFile != 0)
+      {
+         apx_fileManager_attachLocalPortDataFile(fileManager, inDataFile);
+         APX_LOG_INFO("[APX_NODE_MANAGER]%s Server created file %s[%d,%d]", debugInfoStr, inDataFile->fileInfo.name, inDataFile->fileInfo.address, inDataFile->fileInfo.length);
+      }
+   }
+   adt_ary_destroy(&newNodeInfos);
+   adt_ary_destroy(&inDataFiles);
+}
+
+/**
+ * allocates the outPortData buffers of nodeData (unless a resumed node already has them) and requests the client to open outDataFile
+ */
+static void apx_nodeManager_openOutDataFile(apx_nodeData_t *nodeData, apx_nodeInfo_t *nodeInfo, apx_file_t *outDataFile, struct apx_fileManager_tag *fileManager)
+{
+   int32_t outPortDataLen = apx_nodeInfo_getOutPortDataLen(nodeInfo);
+   //check if length of file is the expected length of our outPortDataLen calculation
+   if (outPortDataLen != (int32_t) outDataFile->fileInfo.length)
+   {
+      APX_LOG_ERROR("[APX_NODE_MANAGER] length of file %s is %d, expected length was %d\n", outDataFile->fileInfo.name, outDataFile->fileInfo.length, outPortDataLen);
+   }
+   else
+   {
+      if ( (outDataFile->nodeData==0) && ( (nodeData->outPortDataBuf == 0) || (nodeData->outPortDataLen == (uint32_t) outPortDataLen) ) )
+      {
+         outDataFile->nodeData=nodeData;
+         if (nodeData->outPortDataBuf == 0)
+         {
+            //now create memory for the outPortData
+            nodeData->outPortDataBuf = (uint8_t*) malloc(outPortDataLen);
+            assert(nodeData->outPortDataBuf);
+            nodeData->outPortDirtyFlags = (uint8_t*) malloc(outPortDataLen);
+            assert(nodeData->outPortDirtyFlags);
+            nodeData->outPortDataLen = outPortDataLen;
+         }
+#ifndef UNIT_TEST
+         {
+            char debugInfoStr[APX_DEBUG_INFO_MAX_LEN];
+            apx_nodeManager_getDebugInfoStr(fileManager, debugInfoStr);
+            APX_LOG_INFO("[APX_NODE_MANAGER]%s Server opening client file %s[%d,%d]", debugInfoStr, outDataFile->fileInfo.name, outDataFile->fileInfo.address, outDataFile->fileInfo.length);
+         }
+#endif
+         apx_nodeData_setNodeInfo(nodeData, nodeInfo);
+         apx_fileManager_sendFileOpen(fileManager, outDataFile->fileInfo.address);
       }
-      apx_parser_clearNodes(&self->parser);
    }
 }
 
@@ -625,39 +1066,202 @@ static void apx_nodeManager_setLocalNodeData(apx_nodeManager_t *self, apx_nodeDa
 
 /**
  * applies the portTriggerFunction
+ * The port data is read once. Small values travel inline in the message of each destination,
+ * larger values are read into a single payload that is shared by all destinations.
  */
-static void apx_nodeManager_executePortTriggerFunction(const apx_dataTriggerFunction_t *triggerFunction, const apx_file_t *file)
+static void apx_nodeManager_executePortTriggerFunction(apx_dataTriggerFunction_t *triggerFunction, const apx_file_t *file)
 {
    if( (triggerFunction != 0) && (file != 0) )
    {
       if (file->fileType == APX_OUTDATA_FILE)
       {
-         uint8_t *dataBuf = (uint8_t*) malloc(triggerFunction->dataLength);
-         if (dataBuf != 0)
+         uint8_t inlineBuf[APX_MSG_INLINE_DATA_SIZE];
+         apx_payload_t *payload = (apx_payload_t*) 0;
+         uint8_t *dataBuf = &inlineBuf[0];
+         if (triggerFunction->dataLength > APX_MSG_INLINE_DATA_SIZE)
+         {
+            payload = apx_payload_new(triggerFunction->dataLength);
+            if (payload == 0)
+            {
+               return;
+            }
+            dataBuf = apx_payload_data(payload);
+         }
+         if (apx_nodeData_readOutPortData(file->nodeData, dataBuf, triggerFunction->srcOffset, triggerFunction->dataLength) == 0)
          {
-            int8_t result = apx_nodeData_readOutPortData(file->nodeData, dataBuf, triggerFunction->srcOffset, triggerFunction->dataLength);
-            if (result == 0)
+            int32_t i;
+            int32_t numRoutes = apx_dataTriggerFunction_compileRoutes(triggerFunction);
+            apx_fileManager_t **routeFileManager = triggerFunction->routeFileManager;
+            apx_file_t **routeFile = triggerFunction->routeFile;
+            const uint32_t *routeDestOffset = triggerFunction->routeDestOffset;
+            for(i=0;i<numRoutes;i++)
             {
-               int32_t i;
-               int32_t end = adt_ary_length(&triggerFunction->writeInfoList);
-               for(i=0;i<end;i++)
+               if (routeFile[i] != 0)
                {
-                  apx_dataWriteInfo_t *writeInfo = (apx_dataWriteInfo_t*) adt_ary_value(&triggerFunction->writeInfoList, i);
-                  apx_nodeInfo_t *targetNodeInfo = writeInfo->requesterNodeInfo;
-                  if( targetNodeInfo->nodeData != 0)
+                  if (payload == 0)
                   {
-                     apx_nodeData_t *targetNodeData = targetNodeInfo->nodeData;
-                     if( (targetNodeData->inPortDataFile != 0) && (targetNodeData->fileManager != 0) )
-                     {
-                        apx_fileManager_triggerFileWriteCmdEvent(targetNodeData->fileManager, targetNodeData->inPortDataFile, dataBuf, writeInfo->destOffset, triggerFunction->dataLength);
-                     }
+                     apx_fileManager_triggerFileWriteCmdEvent(routeFileManager[i], routeFile[i], dataBuf, routeDestOffset[i], triggerFunction->dataLength);
+                  }
+                  else
+                  {
+                     apx_fileManager_triggerFileWritePayloadEvent(routeFileManager[i], routeFile[i], payload, routeDestOffset[i]);
                   }
                }
             }
-            free(dataBuf);
+         }
+         if (payload != 0)
+         {
+            apx_payload_release(payload);
+         }
+      }
+   }
+}
+
+/**
+ * Routes a write that covers the provide ports firstPortIndex..lastPortIndex of file.
+ * A single connected port is handled by its trigger function. When several ports are connected the resulting writes are grouped
+ * by destination file, and writes that are adjacent in the destination file are merged so that they are sent as one message.
+ */
+static void apx_nodeManager_routePortRange(apx_dataTriggerTable_t *triggerTable, const apx_file_t *file, int32_t firstPortIndex, int32_t lastPortIndex)
+{
+   apx_nodeManager_portWrite_t writes[APX_NODEMANAGER_MAX_COALESCED_WRITES];
+   int32_t numWrites = 0;
+   int32_t portIndex;
+   int32_t nextPortIndex;
+   uint32_t srcBegin;
+   uint32_t srcEnd;
+   uint8_t *srcBuf;
+   //only visit the ports in the written range that have routes
+   portIndex = apx_dataTriggerTable_nextConnectedPort(triggerTable, firstPortIndex, lastPortIndex+1);
+   if (portIndex < 0)
+   {
+      return;
+   }
+   nextPortIndex = apx_dataTriggerTable_nextConnectedPort(triggerTable, portIndex+1, lastPortIndex+1);
+   if (nextPortIndex < 0)
+   {
+      apx_nodeManager_executePortTriggerFunction(triggerTable->triggerFunctions[portIndex], file);
+      return;
+   }
+   //take one snapshot of all the port data that is about to be routed
+   srcBegin = triggerTable->portOffsets[portIndex];
+   srcEnd = triggerTable->portOffsets[lastPortIndex+1];
+   srcBuf = (uint8_t*) malloc(srcEnd - srcBegin);
+   if ( (srcBuf == 0) || (apx_nodeData_readOutPortData(file->nodeData, srcBuf, srcBegin, srcEnd - srcBegin) != 0) )
+   {
+      if (srcBuf != 0)
+      {
+         free(srcBuf);
+      }
+      for (; portIndex >= 0; portIndex = apx_dataTriggerTable_nextConnectedPort(triggerTable, portIndex+1, lastPortIndex+1))
+      {
+         apx_nodeManager_executePortTriggerFunction(triggerTable->triggerFunctions[portIndex], file);
+      }
+      return;
+   }
+   for (; portIndex >= 0; portIndex = apx_dataTriggerTable_nextConnectedPort(triggerTable, portIndex+1, lastPortIndex+1))
+   {
+      apx_dataTriggerFunction_t *triggerFunction = triggerTable->triggerFunctions[portIndex];
+      int32_t i;
+      int32_t numRoutes = apx_dataTriggerFunction_compileRoutes(triggerFunction);
+      for (i=0; i<numRoutes; i++)
+      {
+         if (triggerFunction->routeFile[i] != 0)
+         {
+            apx_nodeManager_portWrite_t *write;
+            if (numWrites == APX_NODEMANAGER_MAX_COALESCED_WRITES)
+            {
+               apx_nodeManager_flushPortWrites(&writes[0], numWrites, srcBuf, srcBegin);
+               numWrites = 0;
+            }
+            write = &writes[numWrites++];
+            write->fileManager = triggerFunction->routeFileManager[i];
+            write->file = triggerFunction->routeFile[i];
+            write->destOffset = triggerFunction->routeDestOffset[i];
+            write->srcOffset = triggerFunction->srcOffset;
+            write->length = triggerFunction->dataLength;
          }
       }
    }
+   apx_nodeManager_flushPortWrites(&writes[0], numWrites, srcBuf, srcBegin);
+   free(srcBuf);
+}
+
+/**
+ * Sorts writes by destination file and offset, then sends each run of adjacent writes as one write command.
+ * Writes that are separated by a gap are not merged since the bytes in between may be changed by other routes.
+ */
+static void apx_nodeManager_flushPortWrites(apx_nodeManager_portWrite_t *writes, int32_t numWrites, const uint8_t *srcBuf, uint32_t srcBegin)
+{
+   int32_t runBegin = 0;
+   if (numWrites > 1)
+   {
+      qsort(writes, (size_t) numWrites, sizeof(apx_nodeManager_portWrite_t), apx_nodeManager_comparePortWrites);
+   }
+   while (runBegin < numWrites)
+   {
+      apx_nodeManager_portWrite_t *first = &writes[runBegin];
+      uint32_t runLength = first->length;
+      int32_t runEnd = runBegin+1;
+      int32_t i;
+      while ( (runEnd < numWrites) && (writes[runEnd].file == first->file) && (writes[runEnd].destOffset == first->destOffset + runLength) )
+      {
+         runLength += writes[runEnd].length;
+         runEnd++;
+      }
+      if (runEnd == runBegin+1)
+      {
+         apx_fileManager_triggerFileWriteCmdEvent(first->fileManager, first->file, &srcBuf[first->srcOffset - srcBegin], first->destOffset, first->length);
+      }
+      else
+      {
+         uint8_t inlineBuf[APX_MSG_INLINE_DATA_SIZE];
+         apx_payload_t *payload = (apx_payload_t*) 0;
+         uint8_t *runData = &inlineBuf[0];
+         uint8_t *dest;
+         if (runLength > APX_MSG_INLINE_DATA_SIZE)
+         {
+            payload = apx_payload_new(runLength);
+            if (payload == 0)
+            {
+               runBegin = runEnd;
+               continue;
+            }
+            runData = apx_payload_data(payload);
+         }
+         dest = runData;
+         for (i=runBegin; i<runEnd; i++)
+         {
+            memcpy(dest, &srcBuf[writes[i].srcOffset - srcBegin], writes[i].length);
+            dest += writes[i].length;
+         }
+         if (payload == 0)
+         {
+            apx_fileManager_triggerFileWriteCmdEvent(first->fileManager, first->file, runData, first->destOffset, runLength);
+         }
+         else
+         {
+            apx_fileManager_triggerFileWritePayloadEvent(first->fileManager, first->file, payload, first->destOffset);
+            apx_payload_release(payload);
+         }
+      }
+      runBegin = runEnd;
+   }
+}
+
+static int apx_nodeManager_comparePortWrites(const void *a, const void *b)
+{
+   const apx_nodeManager_portWrite_t *lhs = (const apx_nodeManager_portWrite_t*) a;
+   const apx_nodeManager_portWrite_t *rhs = (const apx_nodeManager_portWrite_t*) b;
+   if (lhs->file != rhs->file)
+   {
+      return ( (uintptr_t) lhs->file < (uintptr_t) rhs->file)? -1 : 1;
+   }
+   if (lhs->destOffset != rhs->destOffset)
+   {
+      return (lhs->destOffset < rhs->destOffset)? -1 : 1;
+   }
+   return 0;
 }
 
 static void apx_nodeManager_attachLocalNodeToFileManager(apx_nodeData_t *nodeData, apx_fileManager_t *fileManager)
@@ -679,12 +1283,175 @@ static void apx_nodeManager_attachLocalNodeToFileManager(apx_nodeData_t *nodeDat
    }
 }
 
+/**
+ * Unbinds the node of nodeInfo from fileManager and moves it into parkedNodeMap. Must be called while holding self->lock
+ */
+static void apx_nodeManager_parkNode(apx_nodeManager_t *self, apx_nodeInfo_t *nodeInfo, struct apx_fileManager_tag *fileManager, uint32_t timestampMs)
+{
+   char fileName[RMF_MAX_FILE_NAME+1];
+   apx_file_t *definitionFile;
+   apx_nodeManager_parkedNode_t *parkedNode;
+   apx_nodeData_t *nodeData = nodeInfo->nodeData;
+   const char *name = nodeInfo->node->name;
+   if (strlen(name) + sizeof(APX_DEFINITION_FILE_EXT) > sizeof(fileName))
+   {
+      return;
+   }
+   strcpy(fileName, name);
+   strcat(fileName, APX_DEFINITION_FILE_EXT);
+   definitionFile = apx_fileManager_findRemoteFile(fileManager, fileName);
+   if ( (definitionFile == 0) || (definitionFile->fileInfo.digestType != RMF_DIGEST_TYPE_SHA256) )
+   {
+      //without a digest there is no way to tell whether the reconnecting client still has the same definition
+      return;
+   }
+   parkedNode = (apx_nodeManager_parkedNode_t*) malloc(sizeof(apx_nodeManager_parkedNode_t));
+   if (parkedNode == 0)
+   {
+      return;
+   }
+   parkedNode->nodeInfo = nodeInfo;
+   parkedNode->parkedTimeMs = timestampMs;
+   parkedNode->digestType = definitionFile->fileInfo.digestType;
+   memcpy(&parkedNode->digestData[0], &definitionFile->fileInfo.digestData[0], RMF_DIGEST_SIZE);
+   strcpy(parkedNode->sessionToken, fileManager->sessionToken);
+   //the files are owned by the fileManager which is about to be deleted, routes to this node are disabled until it is resumed
+   apx_nodeData_setInPortDataFile(nodeData, (apx_file_t*) 0);
+   apx_nodeData_setOutPortDataFile(nodeData, (apx_file_t*) 0);
+   apx_nodeData_setFileManager(nodeData, (apx_fileManager_t*) 0);
+   adt_hash_set(&self->parkedNodeMap, name, 0, parkedNode);
+   APX_LOG_INFO("[APX_NODE_MANAGER] parked %s", name);
+}
+
+/**
+ * Rebinds a parked node to the fileManager of its reconnected client. The node keeps its router connections.
+ * Returns false if basename is not parked or if the session token or definition digest don't match. In the latter case the parked node is removed.
+ * Must be called while holding self->lock
+ */
+static bool apx_nodeManager_resumeParkedNode(apx_nodeManager_t *self, struct apx_fileManager_tag *fileManager, apx_file_t *remoteFile, const char *basename)
+{
+   char fileName[RMF_MAX_FILE_NAME+1];
+   char debugInfoStr[APX_DEBUG_INFO_MAX_LEN];
+   apx_nodeManager_parkedNode_t *parkedNode;
+   apx_nodeInfo_t *nodeInfo;
+   apx_nodeData_t *nodeData;
+   apx_file_t *outDataFile;
+   void **ppVal = adt_hash_get(&self->parkedNodeMap, basename, 0);
+   if (ppVal == 0)
+   {
+      return false;
+   }
+   parkedNode = (apx_nodeManager_parkedNode_t*) *ppVal;
+   if ( (strcmp(parkedNode->sessionToken, fileManager->sessionToken) != 0) ||
+        (parkedNode->digestType != remoteFile->fileInfo.digestType) ||
+        (memcmp(&parkedNode->digestData[0], &remoteFile->fileInfo.digestData[0], RMF_DIGEST_SIZE) != 0) )
+   {
+      //someone else (or a changed definition) takes over the name
+      apx_nodeManager_releaseParkedNode(self, parkedNode);
+      return false;
+   }
+   nodeInfo = parkedNode->nodeInfo;
+   nodeData = nodeInfo->nodeData;
+   adt_hash_remove(&self->parkedNodeMap, basename, 0);
+   free(parkedNode);
+   apx_nodeManager_getDebugInfoStr(fileManager, debugInfoStr);
+   APX_LOG_INFO("[APX_NODE_MANAGER]%s Server resumed %s", debugInfoStr, basename);
+   apx_nodeData_setFileManager(nodeData, fileManager);
+   remoteFile->nodeData = nodeData;
+   if ( (nodeData->outPortDataBuf != 0) && (nodeData->outPortDataSnapshot == 0) )
+   {
+      //the client sends its complete out data when the file is opened, only ports that have changed since are routed
+      nodeData->outPortDataSnapshot = (uint8_t*) malloc(nodeData->outPortDataLen);
+      if (nodeData->outPortDataSnapshot != 0)
+      {
+         apx_nodeData_readOutPortData(nodeData, nodeData->outPortDataSnapshot, 0, nodeData->outPortDataLen);
+      }
+   }
+   strcpy(fileName, basename);
+   strcat(fileName, APX_OUTDATA_FILE_EXT);
+   outDataFile = apx_fileManager_findRemoteFile(fileManager, fileName);
+   if (outDataFile != 0)
+   {
+      apx_nodeManager_openOutDataFile(nodeData, nodeInfo, outDataFile, fileManager);
+   }
+   if (nodeData->inPortDataBuf != 0)
+   {
+      apx_file_t *inDataFile;
+      //writes to this node were dropped while it was parked
+      apx_nodeInfo_copyInitDataFromProvideConnectors(nodeInfo);
+      inDataFile = apx_file_newLocalInPortDataFile(nodeData);
+      if (inDataFile != 0)
+      {
+         apx_fileManager_attachLocalPortDataFile(fileManager, inDataFile);
+      }
+   }
+   return true;
+}
+
+/**
+ * Detaches a parked node from the router and deletes it. Must be called while holding self->lock
+ */
+static void apx_nodeManager_releaseParkedNode(apx_nodeManager_t *self, apx_nodeManager_parkedNode_t *parkedNode)
+{
+   apx_nodeInfo_t *nodeInfo = parkedNode->nodeInfo;
+   apx_nodeData_t *nodeData = nodeInfo->nodeData;
+   adt_hash_remove(&self->parkedNodeMap, nodeInfo->node->name, 0);
+   free(parkedNode);
+   if (self->router != 0)
+   {
+      apx_router_detachNodeInfo(self->router, nodeInfo);
+   }
+   apx_nodeManager_removeRemoteNodeData(self, nodeData);
+   apx_nodeData_delete(nodeData);
+   apx_nodeManager_removeNodeInfo(self, nodeInfo);
+   apx_nodeInfo_delete(nodeInfo);
+}
+
+/**
+ * Routes the ports in [firstPortIndex, lastPortIndex] whose data differs from snapshot, adjacent changed ports are routed together
+ */
+static void apx_nodeManager_routeChangedPorts(apx_dataTriggerTable_t *triggerTable, const apx_file_t *file, int32_t firstPortIndex, int32_t lastPortIndex, const uint8_t *snapshot)
+{
+   int32_t portIndex;
+   int32_t runBegin = -1;
+   const uint8_t *outPortDataBuf = file->nodeData->outPortDataBuf;
+   for (portIndex = firstPortIndex; portIndex <= lastPortIndex; portIndex++)
+   {
+      uint32_t offset = triggerTable->portOffsets[portIndex];
+      uint32_t length = triggerTable->portOffsets[portIndex+1] - offset;
+      if (memcmp(&snapshot[offset], &outPortDataBuf[offset], length) != 0)
+      {
+         if (runBegin < 0)
+         {
+            runBegin = portIndex;
+         }
+      }
+      else if (runBegin >= 0)
+      {
+         apx_nodeManager_routePortRange(triggerTable, file, runBegin, portIndex-1);
+         runBegin = -1;
+      }
+   }
+   if (runBegin >= 0)
+   {
+      apx_nodeManager_routePortRange(triggerTable, file, runBegin, lastPortIndex);
+   }
+}
+
 static void apx_nodeManager_removeRemoteNodeData(apx_nodeManager_t *self, apx_nodeData_t *nodeData)
 {
    if ( (self != 0) && (nodeData != 0) )
    {
       void **tmp = adt_hash_remove(&self->remoteNodeDataMap, nodeData->name, 0);
       assert(tmp != 0);
+      //drop the parser of a definition transfer that never completed
+      tmp = adt_hash_get(&self->definitionParserMap, nodeData->name, 0);
+      if (tmp != 0)
+      {
+         apx_nodeManager_definitionParser_t *definitionParser = (apx_nodeManager_definitionParser_t*) *tmp;
+         adt_hash_remove(&self->definitionParserMap, nodeData->name, 0);
+         apx_nodeManager_definitionParser_delete(definitionParser);
+      }
    }
 }
 
@@ -728,3 +1495,63 @@ static bool apx_nodeManager_createInitData(apx_node_t *node, uint8_t *buf, int32
    }
    return false;
 }
+
+/**
+ * Caches a copy of node in nodeTemplateMap, keyed by the digest the client announced for the definition file.
+ * The announced digest is only trusted after it has been verified against the downloaded definition.
+ */
+static void apx_nodeManager_storeNodeTemplate(apx_nodeManager_t *self, const rmf_fileInfo_t *definitionInfo, const uint8_t *definitionBuf, int32_t definitionLen, const apx_node_t *node)
+{
+   char key[APX_NODEMANAGER_DIGEST_KEY_LEN+1];
+   uint8_t digest[SHA256_DIGEST_SIZE];
+   apx_node_t *templateNode;
+   if ( (definitionInfo == 0) || (node == 0) || (apx_nodeManager_getDigestKey(definitionInfo, key) == false) )
+   {
+      return;
+   }
+   if ( (adt_hash_get(&self->nodeTemplateMap, key, 0) != 0) || (adt_hash_length(&self->nodeTemplateMap) >= APX_NODEMANAGER_MAX_NODE_TEMPLATES) )
+   {
+      return;
+   }
+   sha256_calc(definitionBuf, (uint32_t) definitionLen, &digest[0]);
+   if (memcmp(&digest[0], &definitionInfo->digestData[0], SHA256_DIGEST_SIZE) != 0)
+   {
+      APX_LOG_WARNING("[APX_NODE_MANAGER] digest of %s does not match its content", definitionInfo->name);
+      return;
+   }
+   templateNode = apx_node_clone(node);
+   if (templateNode != 0)
+   {
+      adt_hash_set(&self->nodeTemplateMap, key, 0, templateNode);
+   }
+}
+
+/**
+ * writes the digest of fileInfo as a null-terminated hex string into key (APX_NODEMANAGER_DIGEST_KEY_LEN+1 bytes).
+ * Returns false if fileInfo has no SHA-256 digest
+ */
+static bool apx_nodeManager_getDigestKey(const rmf_fileInfo_t *fileInfo, char *key)
+{
+   static const char hexChars[] = "0123456789abcdef";
+   uint32_t i;
+   if (fileInfo->digestType != RMF_DIGEST_TYPE_SHA256)
+   {
+      return false;
+   }
+   for (i=0; i<RMF_DIGEST_SIZE; i++)
+   {
+      key[i*2] = hexChars[fileInfo->digestData[i] >> 4];
+      key[i*2+1] = hexChars[fileInfo->digestData[i] & 0x0F];
+   }
+   key[APX_NODEMANAGER_DIGEST_KEY_LEN] = 0;
+   return true;
+}
+
+static void apx_nodeManager_getDebugInfoStr(const struct apx_fileManager_tag *fileManager, char *debugInfoStr)
+{
+   debugInfoStr[0]=0;
+   if (fileManager->debugInfo != 0)
+   {
+      snprintf(debugInfoStr, APX_DEBUG_INFO_MAX_LEN, " (%p)", fileManager->debugInfo);
+   }
+}
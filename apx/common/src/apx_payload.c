@@ -0,0 +1,98 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <errno.h>
+#include "apx_payload.h"
+#include "apx_allocator.h"
+#include "apx_atomic.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define PAYLOAD_SIZE(length) ((uint32_t) sizeof(apx_payload_t) + (length))
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+//payloads outlive the fileManager that created them, they are therefore taken from an allocator that is never destroyed
+static apx_allocator_t m_allocator = {0};
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+/**
+ * Creates a payload with room for length bytes. The caller holds the first reference and must fill in the data before sharing it.
+ */
+apx_payload_t *apx_payload_new(uint32_t length)
+{
+   apx_payload_t *self = (apx_payload_t*) apx_allocator_alloc(&m_allocator, PAYLOAD_SIZE(length));
+   if (self != 0)
+   {
+      self->refCount = 1;
+      self->length = length;
+   }
+   else
+   {
+      errno = ENOMEM;
+   }
+   return self;
+}
+
+void apx_payload_retain(apx_payload_t *self)
+{
+   if (self != 0)
+   {
+      (void) ATOMIC_FETCH_ADD_I32(&self->refCount, 1);
+   }
+}
+
+void apx_payload_release(apx_payload_t *self)
+{
+   if ( (self != 0) && (ATOMIC_FETCH_ADD_I32(&self->refCount, -1) == 1) )
+   {
+      apx_allocator_free(&m_allocator, (uint8_t*) self, PAYLOAD_SIZE(self->length));
+   }
+}
+
+uint8_t *apx_payload_data(apx_payload_t *self)
+{
+   if (self != 0)
+   {
+      return ((uint8_t*) self) + sizeof(apx_payload_t);
+   }
+   return (uint8_t*) 0;
+}
+
+uint32_t apx_payload_length(const apx_payload_t *self)
+{
+   if (self != 0)
+   {
+      return self->length;
+   }
+   return 0;
+}
+
+/**
+ * returns the number of payloads that have not yet been released
+ */
+int32_t apx_payload_getNumAllocated(void)
+{
+   return apx_allocator_getNumAllocated(&m_allocator);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
@@ -35,7 +35,10 @@ void apx_port_create(apx_port_t *self,uint8_t portDirection,const char *name, co
 			self->dataSignature = (dataSignature != 0)? STRDUP(dataSignature) : 0;
 			self->portType = portDirection;
          self->portSignature = 0;
+         self->portSignatureId = APX_INVALID_PORT_SIGNATURE_ID;
          self->portIndex = -1;
+         self->portMapIndex = -1;
+         self->connectorIndex = -1;
 			apx_dataSignature_create(&self->derivedDsg,0);
 			if (attributes != 0)
 			{
@@ -61,10 +64,7 @@ void apx_port_destroy(apx_port_t *self){
 		{
 			apx_portAttributes_delete(self->portAttributes);
 		}
-      if (self->portSignature != 0)
-      {
-         free(self->portSignature);
-      }
+      apx_portSignatureTable_release(self->portSignatureId);
       apx_dataSignature_destroy(&self->derivedDsg);
 	}
 }
@@ -117,7 +117,7 @@ void apx_port_setDerivedDataSignature(apx_port_t *self, const char *dataSignatur
 /**
  * creates a port signature string for this port of the form:
  * "{port_name}"{dsg}
- * the string is stored in self->self->portSignature
+ * the string is interned in the port signature table, self->portSignature points to the shared copy and self->portSignatureId holds its ID
  */
 const char *apx_port_derivePortSignature(apx_port_t *self)
 {
@@ -127,11 +127,12 @@ const char *apx_port_derivePortSignature(apx_port_t *self)
       uint32_t dsgLen=0;
       const char *dsgPtr=0;
 
-      if (self->portSignature != 0)
+      if (self->portSignatureId != APX_INVALID_PORT_SIGNATURE_ID)
       {
-         free(self->portSignature);
-         self->portSignature = 0;
+         apx_portSignatureTable_release(self->portSignatureId);
+         self->portSignatureId = APX_INVALID_PORT_SIGNATURE_ID;
       }
+      self->portSignature = 0;
 
       if (self->name != 0)
       {
@@ -150,17 +151,23 @@ const char *apx_port_derivePortSignature(apx_port_t *self)
 
       if ( (namelen > 0) && (dsgLen > 0) && (dsgPtr != 0) )
       {
+         char buf[APX_MAX_PORT_SIG_LEN];
          uint32_t psgLen=namelen+dsgLen+3; //add 3 to fit null-terminator + 2 '"' characters
-         self->portSignature = (char*) malloc(psgLen);
-         if (self->portSignature != 0)
+         char *psg = (psgLen <= APX_MAX_PORT_SIG_LEN)? buf : (char*) malloc(psgLen);
+         if (psg != 0)
          {
-            char *p = self->portSignature;
+            char *p = psg;
             *p++='"';
             memcpy(p,self->name,namelen); p+=namelen;
             *p++='"';
             memcpy(p,dsgPtr,dsgLen); p+=dsgLen;
             *p++='\0';
-            assert(p == self->portSignature+psgLen);
+            assert(p == psg+psgLen);
+            self->portSignatureId = apx_portSignatureTable_intern(psg, &self->portSignature);
+            if (psg != buf)
+            {
+               free(psg);
+            }
             return self->portSignature;
          }
       }
@@ -184,6 +191,23 @@ const char *apx_port_getPortSignature(apx_port_t *self)
    return 0;
 }
 
+/**
+ * returns the ID of the port signature, deriving the port signature first if needed.
+ * Ports with identical port signatures have the same ID.
+ */
+int32_t apx_port_getPortSignatureId(apx_port_t *self)
+{
+   if (self != 0)
+   {
+      if (self->portSignatureId == APX_INVALID_PORT_SIGNATURE_ID)
+      {
+         (void) apx_port_derivePortSignature(self);
+      }
+      return self->portSignatureId;
+   }
+   return APX_INVALID_PORT_SIGNATURE_ID;
+}
+
 int32_t apx_port_getPackLen(apx_port_t *self)
 {
    if (self != 0)
@@ -0,0 +1,248 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <errno.h>
+#include <malloc.h>
+#include <string.h>
+#ifdef _MSC_VER
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+#include "apx_portSignatureTable.h"
+#include "osmacro.h"
+#include "adt_ary.h"
+#include "adt_hash.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#ifdef _MSC_VER
+#define STRDUP _strdup
+#else
+#define STRDUP strdup
+#endif
+
+typedef struct apx_portSignatureEntry_tag
+{
+   char *signature; //0 while the entry is on the free list
+   int32_t refCount;
+   int32_t signatureId;
+   int32_t nextFree; //next free entry when signature is 0
+}apx_portSignatureEntry_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+#ifdef _MSC_VER
+static BOOL CALLBACK apx_portSignatureTable_init(PINIT_ONCE initOnce, PVOID param, PVOID *context);
+#else
+static void apx_portSignatureTable_init(void);
+#endif
+static void apx_portSignatureTable_lock(void);
+static void apx_portSignatureTable_unlock(void);
+static apx_portSignatureEntry_t *apx_portSignatureTable_allocEntry(void);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+//the table lives for the whole process, it is initialized by the first thread that uses it
+#ifdef _MSC_VER
+static INIT_ONCE m_initOnce = INIT_ONCE_STATIC_INIT;
+#else
+static pthread_once_t m_initOnce = PTHREAD_ONCE_INIT;
+#endif
+static MUTEX_T m_lock;
+static adt_ary_t m_entries; //strong references to apx_portSignatureEntry_t, indexed by signatureId
+static adt_hash_t m_signatureMap; //weak references to apx_portSignatureEntry_t, key is the port signature
+static int32_t m_firstFree = APX_INVALID_PORT_SIGNATURE_ID;
+static int32_t m_numSignatures = 0;
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the ID of portSignature, adding it to the table if it's not already there. Each successful call must be matched by
+ * a call to apx_portSignatureTable_release.
+ * internedSignature (optional) is set to the stored copy of the string, it stays valid until the ID is released.
+ * Returns APX_INVALID_PORT_SIGNATURE_ID on error.
+ */
+int32_t apx_portSignatureTable_intern(const char *portSignature, const char **internedSignature)
+{
+   if (portSignature != 0)
+   {
+      apx_portSignatureEntry_t *entry;
+      void **ptr;
+      apx_portSignatureTable_lock();
+      ptr = adt_hash_get(&m_signatureMap, portSignature, 0);
+      if (ptr != 0)
+      {
+         entry = (apx_portSignatureEntry_t*) *ptr;
+      }
+      else
+      {
+         entry = apx_portSignatureTable_allocEntry();
+         if (entry != 0)
+         {
+            entry->signature = STRDUP(portSignature);
+            if (entry->signature == 0)
+            {
+               entry->nextFree = m_firstFree;
+               m_firstFree = entry->signatureId;
+               entry = (apx_portSignatureEntry_t*) 0;
+            }
+            else
+            {
+               adt_hash_set(&m_signatureMap, portSignature, 0, entry);
+               m_numSignatures++;
+            }
+         }
+      }
+      if (entry != 0)
+      {
+         int32_t signatureId = entry->signatureId;
+         entry->refCount++;
+         if (internedSignature != 0)
+         {
+            *internedSignature = entry->signature;
+         }
+         apx_portSignatureTable_unlock();
+         return signatureId;
+      }
+      apx_portSignatureTable_unlock();
+      errno = ENOMEM;
+      return APX_INVALID_PORT_SIGNATURE_ID;
+   }
+   errno = EINVAL;
+   return APX_INVALID_PORT_SIGNATURE_ID;
+}
+
+/**
+ * Gives back a reference taken by apx_portSignatureTable_intern. The string is freed and the ID can be reused when the last reference is gone.
+ */
+void apx_portSignatureTable_release(int32_t signatureId)
+{
+   if (signatureId >= 0)
+   {
+      apx_portSignatureTable_lock();
+      if (signatureId < adt_ary_length(&m_entries))
+      {
+         apx_portSignatureEntry_t *entry = (apx_portSignatureEntry_t*) adt_ary_value(&m_entries, signatureId);
+         if ( (entry->signature != 0) && (--entry->refCount == 0) )
+         {
+            adt_hash_remove(&m_signatureMap, entry->signature, 0);
+            free(entry->signature);
+            entry->signature = (char*) 0;
+            entry->nextFree = m_firstFree;
+            m_firstFree = signatureId;
+            m_numSignatures--;
+         }
+      }
+      apx_portSignatureTable_unlock();
+   }
+}
+
+/**
+ * Returns the port signature string with the given ID or 0 if the ID is not in use.
+ */
+const char *apx_portSignatureTable_getSignature(int32_t signatureId)
+{
+   const char *signature = (const char*) 0;
+   if (signatureId >= 0)
+   {
+      apx_portSignatureTable_lock();
+      if (signatureId < adt_ary_length(&m_entries))
+      {
+         apx_portSignatureEntry_t *entry = (apx_portSignatureEntry_t*) adt_ary_value(&m_entries, signatureId);
+         signature = entry->signature;
+      }
+      apx_portSignatureTable_unlock();
+   }
+   return signature;
+}
+
+/**
+ * Returns the number of distinct port signatures currently in the table
+ */
+int32_t apx_portSignatureTable_getNumSignatures(void)
+{
+   int32_t numSignatures;
+   apx_portSignatureTable_lock();
+   numSignatures = m_numSignatures;
+   apx_portSignatureTable_unlock();
+   return numSignatures;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+#ifdef _MSC_VER
+static BOOL CALLBACK apx_portSignatureTable_init(PINIT_ONCE initOnce, PVOID param, PVOID *context)
+{
+   (void) initOnce;
+   (void) param;
+   (void) context;
+   MUTEX_INIT(m_lock);
+   adt_ary_create(&m_entries, free);
+   adt_hash_create(&m_signatureMap, (void(*)(void*)) 0);
+   return TRUE;
+}
+#else
+static void apx_portSignatureTable_init(void)
+{
+   MUTEX_INIT(m_lock);
+   adt_ary_create(&m_entries, free);
+   adt_hash_create(&m_signatureMap, (void(*)(void*)) 0);
+}
+#endif
+
+static void apx_portSignatureTable_lock(void)
+{
+#ifdef _MSC_VER
+   (void) InitOnceExecuteOnce(&m_initOnce, apx_portSignatureTable_init, 0, 0);
+#else
+   (void) pthread_once(&m_initOnce, apx_portSignatureTable_init);
+#endif
+   MUTEX_LOCK(m_lock);
+}
+
+static void apx_portSignatureTable_unlock(void)
+{
+   MUTEX_UNLOCK(m_lock);
+}
+
+/**
+ * Takes an entry from the free list or appends a new one. Must be called with the lock held.
+ */
+static apx_portSignatureEntry_t *apx_portSignatureTable_allocEntry(void)
+{
+   apx_portSignatureEntry_t *entry;
+   if (m_firstFree != APX_INVALID_PORT_SIGNATURE_ID)
+   {
+      entry = (apx_portSignatureEntry_t*) adt_ary_value(&m_entries, m_firstFree);
+      m_firstFree = entry->nextFree;
+   }
+   else
+   {
+      entry = (apx_portSignatureEntry_t*) malloc(sizeof(apx_portSignatureEntry_t));
+      if (entry == 0)
+      {
+         return entry;
+      }
+      entry->signatureId = adt_ary_length(&m_entries);
+      adt_ary_push(&m_entries, entry);
+   }
+   entry->signature = (char*) 0;
+   entry->refCount = 0;
+   entry->nextFree = APX_INVALID_PORT_SIGNATURE_ID;
+   return entry;
+}
@@ -26,11 +26,17 @@
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
+static bool apx_router_registerNodeInfo(apx_router_t *self, apx_nodeInfo_t *nodeInfo);
+static void apx_router_connectProvidePorts(apx_router_t *self, apx_nodeInfo_t *nodeInfo);
+static void apx_router_connectRequirePorts(apx_router_t *self, apx_nodeInfo_t *nodeInfo);
+static bool apx_router_unregisterNodeInfo(apx_router_t *self, apx_nodeInfo_t *nodeInfo, adt_ary_t *requireRefs);
+static void apx_router_rerouteRequirePorts(apx_router_t *self, adt_ary_t *requireRefs);
+static apx_routerPortMapEntry_t *apx_router_getPortMapEntry(const apx_router_t *self, apx_port_t *port);
 static void apx_router_attachPortToPortMap(apx_router_t *self, apx_node_t *node, apx_port_t *port);
 static void apx_router_detachPortFromPortMap(apx_router_t *self, apx_node_t *node, apx_port_t *port);
 static bool apx_router_createDefaultPortConnector(const apx_router_t *self, apx_nodeInfo_t *nodeInfo, apx_port_t *port, apx_portref_t *provideConnector);
 static void apx_router_build_requireRefs(apx_nodeInfo_t *nodeInfo, adt_ary_t *requireRefs);
-static void apx_router_postProcessNodes(const apx_router_t *self, apx_nodeInfo_t *detachedNodeInfo);
+static void apx_router_postProcessNodes(apx_router_t *self);
 static void apx_router_postProcessNode(apx_nodeInfo_t *extraNodeInfo, int8_t debugMode);
 
 //////////////////////////////////////////////////////////////////////////////
@@ -52,7 +58,8 @@ void apx_router_create(apx_router_t *self)
    if ( (self != 0) )
    {
       adt_ary_create(&self->nodeInfoList, (void(*)(void*)) 0); //weak references to apx_nodeInfo_t.
-      adt_hash_create(&self->portMap, apx_routerPortMapEntry_vdelete); //hash where key is the port signature (string) and value is apx_routerPortMapEntry_t
+      adt_ary_create(&self->dirtyNodeInfoList, (void(*)(void*)) 0); //weak references to apx_nodeInfo_t.
+      adt_ary_create(&self->portMap, apx_routerPortMapEntry_vdelete); //strong references to apx_routerPortMapEntry_t, unused signature IDs have no entry
       self->debugMode = APX_DEBUG_NONE;
    }
 }
@@ -65,7 +72,8 @@ void apx_router_destroy(apx_router_t *self)
    if ( self != 0)
    {
       adt_ary_destroy(&self->nodeInfoList);
-      adt_hash_destroy(&self->portMap);
+      adt_ary_destroy(&self->dirtyNodeInfoList);
+      adt_ary_destroy(&self->portMap);
    }
 }
 
@@ -76,79 +84,62 @@ void apx_router_attachNodeInfo(apx_router_t *self, apx_nodeInfo_t *nodeInfo)
 {
    if ( (self != 0) && (nodeInfo != 0) )
    {
-      int32_t i;
-      int32_t requirePortLen;
-      int32_t providePortLen;
-      int32_t nodeInfoListLen;
-      char debugInfoStr[APX_DEBUG_INFO_MAX_LEN];
-
-      apx_node_t *node = nodeInfo->node;
-
-      debugInfoStr[0]=0;
-      if ( (nodeInfo->nodeData != 0) && (nodeInfo->nodeData->fileManager->debugInfo) != 0)
-      {
-         snprintf(debugInfoStr, APX_DEBUG_INFO_MAX_LEN, " (%p)", nodeInfo->nodeData->fileManager->debugInfo);
-      }
-
-      assert(node != 0);
-
-
-      APX_LOG_DEBUG("[APX_ROUTER]%s Attaching %s",debugInfoStr, node->name);
-      nodeInfoListLen = adt_ary_length(&self->nodeInfoList);
-      requirePortLen = adt_ary_length(&node->requirePortList);
-      providePortLen = adt_ary_length(&node->providePortList);
-      //1. Is the node already attached?
-      for (i=0;i<nodeInfoListLen;i++)
+      if (apx_router_registerNodeInfo(self, nodeInfo) == false)
       {
-         apx_nodeInfo_t *elem = (apx_nodeInfo_t*) adt_ary_value(&self->nodeInfoList,i);
-         if (elem == nodeInfo)
-         {
-            //node already attached, ignore request
-            APX_LOG_WARNING("[APX_ROUTER]%s Node with name %s is already attached",debugInfoStr, node->name);
-            return;
-         }
-      }
-
-      //This is a new node.
-      //2. add this nodeInfo to the nodeInfoList
-      adt_ary_push(&self->nodeInfoList,nodeInfo);
-
-      //3. register all require ports into the portMap
-      for (i=0;i<requirePortLen;i++)
-      {
-         apx_port_t *port = apx_node_getRequirePort(node,i);
-         apx_router_attachPortToPortMap(self,node,port);
-      }
-      //4. register all provide ports into the portMap
-      for (i=0;i<providePortLen;i++)
-      {
-         apx_port_t *port = apx_node_getProvidePort(node,i);
-         apx_router_attachPortToPortMap(self,node,port);
+         return;
       }
+      apx_router_connectProvidePorts(self, nodeInfo);
+      apx_router_connectRequirePorts(self, nodeInfo);
+      //6. post process the nodes whose connectors were changed by this attach
+      apx_router_postProcessNodes(self);
       if (self->debugMode == APX_DEBUG_1_PROFILE)
       {
-         APX_LOG_DEBUG("[APX_ROUTER] done registering ports for %s",node->name);
+         APX_LOG_DEBUG("[APX_ROUTER] done post processing %s connect",nodeInfo->node->name);
       }
-      //5. create connectors using default connection rules (latest attached node is provider of a signal)
-      for (i=0;i<requirePortLen;i++)
+   }
+}
+
+/**
+ * attaches many nodeInfo structures at once.
+ * The ports of all nodes are registered before any connector is created. This way each signal is connected to its final provider
+ * directly and data triggers are only recalculated once, instead of once per attached node.
+ * The result is the same as attaching the nodes one by one in list order.
+ */
+void apx_router_attachNodeInfoBatch(apx_router_t *self, const adt_ary_t *nodeInfoList)
+{
+   if ( (self != 0) && (nodeInfoList != 0) )
+   {
+      int32_t i;
+      int32_t numNodeInfos = adt_ary_length(nodeInfoList);
+      int32_t numRegistered;
+      adt_ary_t registered; //weak references to apx_nodeInfo_t, the nodes that were not already attached
+      adt_ary_create(&registered, (void(*)(void*)) 0);
+      for (i=0;i<numNodeInfos;i++)
       {
-         apx_port_t *port = apx_node_getRequirePort(node,i);
-         apx_router_createDefaultPortConnector(self,nodeInfo,port,0);
+         apx_nodeInfo_t *nodeInfo = (apx_nodeInfo_t*) adt_ary_value(nodeInfoList,i);
+         if ( (nodeInfo != 0) && (apx_router_registerNodeInfo(self, nodeInfo) == true) )
+         {
+            adt_ary_push(&registered, nodeInfo);
+         }
       }
-      for (i=0;i<providePortLen;i++)
+      numRegistered = adt_ary_length(&registered);
+      //Connect all provide ports before any require port, this way each require port is connected once, directly to its final provider.
+      for (i=0;i<numRegistered;i++)
       {
-         apx_port_t *port = apx_node_getProvidePort(node,i);
-         apx_router_createDefaultPortConnector(self,nodeInfo,port,0);
+         apx_router_connectProvidePorts(self, (apx_nodeInfo_t*) adt_ary_value(&registered,i));
       }
-      if (self->debugMode == APX_DEBUG_1_PROFILE)
+      for (i=0;i<numRegistered;i++)
       {
-         APX_LOG_DEBUG("[APX_ROUTER] done creating default connectors for %s",node->name);
+         apx_router_connectRequirePorts(self, (apx_nodeInfo_t*) adt_ary_value(&registered,i));
       }
-      //6. loop through all nodes and check for flags (flags indicate extra post processing steps are required)
-      apx_router_postProcessNodes(self,0);
-      if (self->debugMode == APX_DEBUG_1_PROFILE)
+      adt_ary_destroy(&registered);
+      if (numRegistered > 0)
       {
-         APX_LOG_DEBUG("[APX_ROUTER] done post processing %s connect",node->name);
+         apx_router_postProcessNodes(self);
+         if (self->debugMode == APX_DEBUG_1_PROFILE)
+         {
+            APX_LOG_DEBUG("[APX_ROUTER] done post processing connect of %d nodes", (int) numRegistered);
+         }
       }
    }
 }
@@ -160,120 +151,293 @@ void apx_router_detachNodeInfo(apx_router_t *self, apx_nodeInfo_t *nodeInfo)
 {
    if ( (self != 0) && (nodeInfo != 0) )
    {
-      int8_t found=0;
-      int32_t i;
-      int32_t requirePortLen;
-      int32_t providePortLen;
-      int32_t nodeInfoListLen;
-      int32_t numRequireRefs;
       adt_ary_t requireRefs; //array of apx_portref_t*
-      apx_node_t *node = nodeInfo->node;
-      char debugInfoStr[APX_DEBUG_INFO_MAX_LEN];
-      assert(node != 0);
-
-      debugInfoStr[0]=0;
-      if ( (nodeInfo->nodeData != 0) && (nodeInfo->nodeData->fileManager->debugInfo != 0) )
+      adt_ary_create(&requireRefs,apx_portref_vdelete);
+      if (apx_router_unregisterNodeInfo(self, nodeInfo, &requireRefs) == true)
       {
-         snprintf(debugInfoStr, APX_DEBUG_INFO_MAX_LEN, " (%p)", nodeInfo->nodeData->fileManager->debugInfo);
+         apx_router_rerouteRequirePorts(self, &requireRefs);
+         //the detached node is still in the dirty list (its ports were disconnected), stop tracking it after this pass
+         apx_router_postProcessNodes(self);
+         nodeInfo->dirtyList = (adt_ary_t*) 0;
       }
+      adt_ary_destroy(&requireRefs);
+   }
+}
 
-      APX_LOG_DEBUG("[APX_ROUTER]%s Detaching %s", debugInfoStr, node->name);
-      nodeInfoListLen = adt_ary_length(&self->nodeInfoList);
-      requirePortLen = adt_ary_length(&node->requirePortList);
-      providePortLen = adt_ary_length(&node->providePortList);
-      for (i=0;i<nodeInfoListLen;i++)
+/**
+ * detaches many nodeInfo structures at once.
+ * All nodes are disconnected before the orphaned require ports of the remaining nodes are rerouted, this prevents require ports
+ * from being rerouted to a provider that is detached later in the same batch.
+ */
+void apx_router_detachNodeInfoBatch(apx_router_t *self, const adt_ary_t *nodeInfoList)
+{
+   if ( (self != 0) && (nodeInfoList != 0) )
+   {
+      int32_t i;
+      int32_t numNodeInfos = adt_ary_length(nodeInfoList);
+      adt_ary_t requireRefs; //array of apx_portref_t*
+      adt_ary_create(&requireRefs,apx_portref_vdelete);
+      for (i=0;i<numNodeInfos;i++)
       {
-         apx_nodeInfo_t *elem = (apx_nodeInfo_t*) adt_ary_value(&self->nodeInfoList,i);
-         if (elem == nodeInfo)
+         apx_nodeInfo_t *nodeInfo = (apx_nodeInfo_t*) adt_ary_value(nodeInfoList,i);
+         if (nodeInfo != 0)
          {
-            found = 1;
-            //found the node, remove it from the list
-            adt_ary_splice(&self->nodeInfoList,i,1);
-            break; //important to break for-loop here since splice modifies the list (invalidating the nodeInfoListLen variable)
+            (void) apx_router_unregisterNodeInfo(self, nodeInfo, &requireRefs);
          }
       }
-
-      if (found == 0)
+      apx_router_rerouteRequirePorts(self, &requireRefs);
+      adt_ary_destroy(&requireRefs);
+      apx_router_postProcessNodes(self);
+      for (i=0;i<numNodeInfos;i++)
       {
-         return; //user tried to detach a node that wasn't attached in the first place
+         apx_nodeInfo_t *nodeInfo = (apx_nodeInfo_t*) adt_ary_value(nodeInfoList,i);
+         if ( (nodeInfo != 0) && (nodeInfo->router == 0) )
+         {
+            nodeInfo->dirtyList = (adt_ary_t*) 0;
+         }
       }
+   }
+}
 
-      //1. Detach all ports from the portMap
-      for (i=0;i<requirePortLen;i++)
-      {
-         apx_port_t *port = apx_node_getRequirePort(node,i);
-         apx_router_detachPortFromPortMap(self,node,port);
-      }
-      for (i=0;i<providePortLen;i++)
-      {
-         apx_port_t *port = apx_node_getProvidePort(node,i);
-         apx_router_detachPortFromPortMap(self,node,port);
-      }
+void apx_router_setDebugMode(apx_router_t *self, int8_t debugMode)
+{
+   if (self != 0)
+   {
+      self->debugMode = debugMode;
+   }
+}
 
-      //2. follow all connectors reaching out from this node and determine what other nodes will be affected by this delete
-      adt_ary_create(&requireRefs,apx_portref_vdelete);
 
-      apx_router_build_requireRefs(nodeInfo,&requireRefs);
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
 
-      //3. disconnect require and provide ports
-      for (i=0;i<requirePortLen;i++)
-      {
-         apx_nodeInfo_disconnectRequirePort(nodeInfo,i);
-      }
-      for (i=0;i<providePortLen;i++)
+/**
+ * adds nodeInfo to the nodeInfoList and registers all of its ports in the portMap.
+ * Returns false if nodeInfo was already attached.
+ */
+static bool apx_router_registerNodeInfo(apx_router_t *self, apx_nodeInfo_t *nodeInfo)
+{
+   int32_t i;
+   int32_t requirePortLen;
+   int32_t providePortLen;
+   char debugInfoStr[APX_DEBUG_INFO_MAX_LEN];
+
+   apx_node_t *node = nodeInfo->node;
+
+   debugInfoStr[0]=0;
+   if ( (nodeInfo->nodeData != 0) && (nodeInfo->nodeData->fileManager != 0) && (nodeInfo->nodeData->fileManager->debugInfo != 0) )
+   {
+      snprintf(debugInfoStr, APX_DEBUG_INFO_MAX_LEN, " (%p)", nodeInfo->nodeData->fileManager->debugInfo);
+   }
+
+   assert(node != 0);
+
+
+   APX_LOG_DEBUG("[APX_ROUTER]%s Attaching %s",debugInfoStr, node->name);
+   requirePortLen = adt_ary_length(&node->requirePortList);
+   providePortLen = adt_ary_length(&node->providePortList);
+   //1. Is the node already attached?
+   if (nodeInfo->router == self)
+   {
+      //node already attached, ignore request
+      APX_LOG_WARNING("[APX_ROUTER]%s Node with name %s is already attached",debugInfoStr, node->name);
+      return false;
+   }
+
+   //This is a new node.
+   //2. add this nodeInfo to the nodeInfoList, from now on it reports port flag changes to our dirty list
+   nodeInfo->router = self;
+   nodeInfo->routerIndex = adt_ary_length(&self->nodeInfoList);
+   nodeInfo->dirtyList = &self->dirtyNodeInfoList;
+   adt_ary_push(&self->nodeInfoList,nodeInfo);
+
+   //3. register all require ports into the portMap
+   for (i=0;i<requirePortLen;i++)
+   {
+      apx_port_t *port = apx_node_getRequirePort(node,i);
+      apx_router_attachPortToPortMap(self,node,port);
+   }
+   //4. register all provide ports into the portMap
+   for (i=0;i<providePortLen;i++)
+   {
+      apx_port_t *port = apx_node_getProvidePort(node,i);
+      apx_router_attachPortToPortMap(self,node,port);
+   }
+   if (self->debugMode == APX_DEBUG_1_PROFILE)
+   {
+      APX_LOG_DEBUG("[APX_ROUTER] done registering ports for %s",node->name);
+   }
+   return true;
+}
+
+/**
+ * 5a. create connectors from the provide ports of a registered node using default connection rules (latest attached node is provider of a signal).
+ * A provide port only takes over its signal when it is the latest provider in the portMap, this matters when several nodes
+ * providing the same signal are registered in one batch.
+ */
+static void apx_router_connectProvidePorts(apx_router_t *self, apx_nodeInfo_t *nodeInfo)
+{
+   int32_t i;
+   apx_node_t *node = nodeInfo->node;
+   int32_t providePortLen = adt_ary_length(&node->providePortList);
+   for (i=0;i<providePortLen;i++)
+   {
+      apx_port_t *port = apx_node_getProvidePort(node,i);
+      apx_routerPortMapEntry_t *portMapEntry = apx_router_getPortMapEntry(self,port);
+      if (portMapEntry != 0)
       {
-         apx_nodeInfo_disconnectProvidePort(nodeInfo,i);
+         int32_t numProvidePorts = adt_ary_length(&portMapEntry->providePorts);
+         apx_portref_t *lastProvider = apx_routerPortMapEntry_getProvidePortById(portMapEntry,numProvidePorts-1);
+         if ( (lastProvider != 0) && (lastProvider->port == port) )
+         {
+            apx_router_createDefaultPortConnector(self,nodeInfo,port,0);
+         }
       }
+   }
+}
 
-      //4. for the deleted connectors, try to reroute using default rule
-      numRequireRefs = adt_ary_length(&requireRefs);
-      for (i=0;i<numRequireRefs;i++)
+/**
+ * 5b. create connectors for the require ports of a registered node that were not connected by a provide port in step 5a
+ */
+static void apx_router_connectRequirePorts(apx_router_t *self, apx_nodeInfo_t *nodeInfo)
+{
+   int32_t i;
+   apx_node_t *node = nodeInfo->node;
+   int32_t requirePortLen = adt_ary_length(&node->requirePortList);
+   for (i=0;i<requirePortLen;i++)
+   {
+      if (apx_nodeInfo_getRequirePortConnector(nodeInfo,i) == 0)
       {
-         apx_nodeInfo_t *requesterNodeInfo; //this is the node that requested the signal this node provided
-         apx_portref_t *requireConnector;
-         apx_portref_t *portref = (apx_portref_t*) adt_ary_value(&requireRefs,i);
-         requesterNodeInfo = portref->node->nodeInfo;
-         requireConnector = apx_nodeInfo_getRequirePortConnector(requesterNodeInfo, portref->port->portIndex);
-         assert(requireConnector == 0);
-         //This is now an empty connector due to the fact that our detached nodeInfo was the provider of that signal.
-         //Try to reroute the signal from a different source
-         (void)apx_router_createDefaultPortConnector(self,requesterNodeInfo,portref->port,0);
+         apx_port_t *port = apx_node_getRequirePort(node,i);
+         apx_router_createDefaultPortConnector(self,nodeInfo,port,0);
       }
-      adt_ary_destroy(&requireRefs);
-      apx_router_postProcessNodes(self,nodeInfo);
+   }
+   if (self->debugMode == APX_DEBUG_1_PROFILE)
+   {
+      APX_LOG_DEBUG("[APX_ROUTER] done creating default connectors for %s",node->name);
    }
 }
 
-void apx_router_setDebugMode(apx_router_t *self, int8_t debugMode)
+/**
+ * removes nodeInfo from the nodeInfoList and the portMap and disconnects all of its ports.
+ * The require ports of other nodes that were connected to the provide ports of nodeInfo are appended to requireRefs.
+ * Returns false if nodeInfo was not attached to this router.
+ */
+static bool apx_router_unregisterNodeInfo(apx_router_t *self, apx_nodeInfo_t *nodeInfo, adt_ary_t *requireRefs)
 {
-   if (self != 0)
+   int32_t i;
+   int32_t requirePortLen;
+   int32_t providePortLen;
+   apx_nodeInfo_t *lastNodeInfo;
+   apx_node_t *node = nodeInfo->node;
+   char debugInfoStr[APX_DEBUG_INFO_MAX_LEN];
+   assert(node != 0);
+
+   debugInfoStr[0]=0;
+   if ( (nodeInfo->nodeData != 0) && (nodeInfo->nodeData->fileManager != 0) && (nodeInfo->nodeData->fileManager->debugInfo != 0) )
    {
-      self->debugMode = debugMode;
+      snprintf(debugInfoStr, APX_DEBUG_INFO_MAX_LEN, " (%p)", nodeInfo->nodeData->fileManager->debugInfo);
+   }
+
+   APX_LOG_DEBUG("[APX_ROUTER]%s Detaching %s", debugInfoStr, node->name);
+   requirePortLen = adt_ary_length(&node->requirePortList);
+   providePortLen = adt_ary_length(&node->providePortList);
+   if (nodeInfo->router != self)
+   {
+      return false; //user tried to detach a node that wasn't attached in the first place
+   }
+   //remove the node from the list by moving the last node into its position
+   lastNodeInfo = (apx_nodeInfo_t*) adt_ary_pop(&self->nodeInfoList);
+   assert(lastNodeInfo != 0);
+   if (lastNodeInfo != nodeInfo)
+   {
+      adt_ary_set(&self->nodeInfoList, nodeInfo->routerIndex, lastNodeInfo);
+      lastNodeInfo->routerIndex = nodeInfo->routerIndex;
+   }
+   nodeInfo->router = (apx_router_t*) 0;
+   nodeInfo->routerIndex = -1;
+
+   //1. Detach all ports from the portMap
+   for (i=0;i<requirePortLen;i++)
+   {
+      apx_port_t *port = apx_node_getRequirePort(node,i);
+      apx_router_detachPortFromPortMap(self,node,port);
+   }
+   for (i=0;i<providePortLen;i++)
+   {
+      apx_port_t *port = apx_node_getProvidePort(node,i);
+      apx_router_detachPortFromPortMap(self,node,port);
+   }
+
+   //2. follow all connectors reaching out from this node and determine what other nodes will be affected by this delete
+   apx_router_build_requireRefs(nodeInfo,requireRefs);
+
+   //3. disconnect require and provide ports
+   for (i=0;i<requirePortLen;i++)
+   {
+      apx_nodeInfo_disconnectRequirePort(nodeInfo,i);
+   }
+   for (i=0;i<providePortLen;i++)
+   {
+      apx_nodeInfo_disconnectProvidePort(nodeInfo,i);
    }
+   return true;
 }
 
+/**
+ * 4. for the deleted connectors, try to reroute using default rule.
+ * Require ports of nodes that are no longer attached (e.g. detached in the same batch) are skipped.
+ */
+static void apx_router_rerouteRequirePorts(apx_router_t *self, adt_ary_t *requireRefs)
+{
+   int32_t i;
+   int32_t numRequireRefs = adt_ary_length(requireRefs);
+   for (i=0;i<numRequireRefs;i++)
+   {
+      apx_nodeInfo_t *requesterNodeInfo; //this is the node that requested the signal this node provided
+      apx_portref_t *requireConnector;
+      apx_portref_t *portref = (apx_portref_t*) adt_ary_value(requireRefs,i);
+      requesterNodeInfo = portref->node->nodeInfo;
+      if (requesterNodeInfo->router != self)
+      {
+         continue;
+      }
+      requireConnector = apx_nodeInfo_getRequirePortConnector(requesterNodeInfo, portref->port->portIndex);
+      assert(requireConnector == 0);
+      //This is now an empty connector due to the fact that our detached nodeInfo was the provider of that signal.
+      //Try to reroute the signal from a different source
+      (void)apx_router_createDefaultPortConnector(self,requesterNodeInfo,portref->port,0);
+   }
+}
 
-//////////////////////////////////////////////////////////////////////////////
-// LOCAL FUNCTIONS
-//////////////////////////////////////////////////////////////////////////////
+/**
+ * returns the portMap entry for the port signature of port or 0 if there is none
+ */
+static apx_routerPortMapEntry_t *apx_router_getPortMapEntry(const apx_router_t *self, apx_port_t *port)
+{
+   int32_t signatureId = apx_port_getPortSignatureId(port);
+   if ( (signatureId >= 0) && (signatureId < adt_ary_length(&self->portMap)) )
+   {
+      return (apx_routerPortMapEntry_t*) adt_ary_value(&self->portMap, signatureId);
+   }
+   return (apx_routerPortMapEntry_t*) 0;
+}
 
 static void apx_router_attachPortToPortMap(apx_router_t *self, apx_node_t *node, apx_port_t *port)
 {
    if ( (self != 0) && (node != 0) && (port != 0) )
    {
-      apx_routerPortMapEntry_t *portMapEntry = (apx_routerPortMapEntry_t*) 0;
-      void **ptr;
-      const char *psg = apx_port_getPortSignature(port);
-      ptr = adt_hash_get(&self->portMap,psg,0);
-      if (ptr == 0)
-      {
-         //no entry, create new entry
-         portMapEntry = apx_routerPortMapEntry_new();
-         adt_hash_set(&self->portMap,psg,0,portMapEntry);
-      }
-      else
+      apx_routerPortMapEntry_t *portMapEntry = apx_router_getPortMapEntry(self,port);
+      if (portMapEntry == 0)
       {
-         portMapEntry = (apx_routerPortMapEntry_t*) *ptr;
+         int32_t signatureId = apx_port_getPortSignatureId(port);
+         if (signatureId >= 0)
+         {
+            //no entry, create new entry (adt_ary_set grows the array when needed)
+            portMapEntry = apx_routerPortMapEntry_new();
+            adt_ary_set(&self->portMap,signatureId,portMapEntry);
+         }
       }
       if (portMapEntry != 0)
       {
@@ -286,19 +450,12 @@ static void apx_router_detachPortFromPortMap(apx_router_t *self, apx_node_t *nod
 {
    if ( (self != 0) && (node != 0) && (port != 0) )
    {
-      apx_routerPortMapEntry_t *portMapEntry = (apx_routerPortMapEntry_t*) 0;
-      void **ptr;
-      const char *psg = apx_port_getPortSignature(port);
-      ptr = adt_hash_get(&self->portMap,psg,0);
-      if (ptr == 0)
+      apx_routerPortMapEntry_t *portMapEntry = apx_router_getPortMapEntry(self,port);
+      if (portMapEntry == 0)
       {
          //no entry, this is a weird situation
       }
       else
-      {
-         portMapEntry = (apx_routerPortMapEntry_t*) *ptr;
-      }
-      if (portMapEntry != 0)
       {
          apx_routerPortMapEntry_removePort(portMapEntry,node,port);
       }
@@ -312,25 +469,19 @@ static bool apx_router_createDefaultPortConnector(const apx_router_t *self, apx_
 {
    if ( (self != 0) && (nodeInfo != 0) && (port != 0) )
    {
-      apx_routerPortMapEntry_t *portMapEntry = (apx_routerPortMapEntry_t*) 0;
+      apx_routerPortMapEntry_t *portMapEntry = apx_router_getPortMapEntry(self,port);
       //char debugInfoStr[APX_DEBUG_INFO_MAX_LEN];
-      void **ptr;
-      const char *psg = apx_port_getPortSignature(port);
       //debugInfoStr[0]=0;
 /*      if (nodeInfo->nodeData->fileManager->debugInfo != 0)
       {
          snprintf(debugInfoStr, APX_DEBUG_INFO_MAX_LEN, " (%p)", nodeInfo->nodeData->fileManager->debugInfo);
       }*/
-      ptr = adt_hash_get(&self->portMap,psg,0);
-      if (ptr == 0)
+      if (portMapEntry == 0)
       {
          //no entry, this is a weird situation
       }
       else
       {
-         portMapEntry = (apx_routerPortMapEntry_t*) *ptr;
-
-
          if (port->portType == APX_REQUIRE_PORT)
          {
             //if port is a require port, try to find a matching provide port.
@@ -446,21 +597,23 @@ static void apx_router_build_requireRefs(apx_nodeInfo_t *nodeInfo, adt_ary_t *re
    }
 }
 
-static void apx_router_postProcessNodes(const apx_router_t *self, apx_nodeInfo_t *detachedNodeInfo)
+/**
+ * post processes the nodes that got pending port flags since the last call. The cost is proportional to the number of affected nodes,
+ * not to the number of attached nodes.
+ */
+static void apx_router_postProcessNodes(apx_router_t *self)
 {
    int32_t numNodes;
    int32_t i;
-   numNodes = adt_ary_length(&self->nodeInfoList);
+   numNodes = adt_ary_length(&self->dirtyNodeInfoList);
    for (i=0;i<numNodes;i++)
    {
-      apx_nodeInfo_t *nodeInfo = (apx_nodeInfo_t*) adt_ary_value(&self->nodeInfoList,i);
+      apx_nodeInfo_t *nodeInfo = (apx_nodeInfo_t*) adt_ary_value(&self->dirtyNodeInfoList,i);
       assert(nodeInfo != 0);
+      nodeInfo->isDirty = false;
       apx_router_postProcessNode(nodeInfo, self->debugMode);
    }
-   if (detachedNodeInfo != 0) //detachedNodeInfo is the nodeInfo that is no longer in self->nodeInfoList
-   {
-      apx_router_postProcessNode(detachedNodeInfo, self->debugMode);
-   }
+   adt_ary_clear(&self->dirtyNodeInfoList);
 }
 
 static void apx_router_postProcessNode(apx_nodeInfo_t *nodeInfo, int8_t debugMode)
@@ -529,6 +682,7 @@ static void apx_router_postProcessNode(apx_nodeInfo_t *nodeInfo, int8_t debugMod
       adt_str_delete(str);
       //clear flags
       memset(nodeInfo->providePortFlags,0,numProvidePorts);
+      nodeInfo->pendingProvidePortFlags = 0; //a port that got several events in one pass is only counted once above
    }
    if (nodeInfo->pendingRequirePortFlags>0)
    {
@@ -564,5 +718,6 @@ static void apx_router_postProcessNode(apx_nodeInfo_t *nodeInfo, int8_t debugMod
       }
       //clear flags
       memset(nodeInfo->requirePortFlags,0,numRequirePorts);
+      nodeInfo->pendingRequirePortFlags = 0;
    }
 }
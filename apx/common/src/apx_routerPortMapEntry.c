@@ -19,6 +19,7 @@
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
+static int32_t apx_routerPortMapEntry_findPort(const adt_ary_t *portrefList, const apx_node_t *node, const apx_port_t *port);
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -81,44 +82,36 @@ int8_t apx_routerPortMapEntry_insertPort(apx_routerPortMapEntry_t *self, apx_nod
 {
    if ( (self != 0) && (node != 0) && (port != 0) )
    {
-      int32_t i;
-      int32_t end;
       adt_ary_t *portrefList = 0;
-      apx_portref_t *portref = apx_portref_new(node,port);
-
-      if (portref == 0)
-      {
-         return -1; //apx_portref_new should already have set errno
-      }
-      if (portref->port->portType == APX_REQUIRE_PORT)
+      apx_portref_t *portref;
+      if (port->portType == APX_REQUIRE_PORT)
       {
          portrefList = &self->requirePorts;
       }
-      else if (portref->port->portType == APX_PROVIDE_PORT)
+      else if (port->portType == APX_PROVIDE_PORT)
       {
          portrefList = &self->providePorts;
       }
       else
       {
-         apx_portref_delete(portref);
          errno = EINVAL;
          return -1;
       }
       //prevent the user from adding the same port reference twice.
       assert(portrefList != 0);
-      end = adt_ary_length(portrefList);
-      for (i=0;i<end;i++)
+      if (apx_routerPortMapEntry_findPort(portrefList,node,port) >= 0)
       {
-         apx_portref_t *elem = (apx_portref_t*) adt_ary_value(portrefList,i);
-         if (apx_portref_equals(elem,portref) != 0)
-         {
-            //the portref already exists in this list, take no more action
-            apx_portref_delete(portref);
-            return 0;
-         }
+         //the portref already exists in this list, take no more action
+         return 0;
+      }
+      portref = apx_portref_new(node,port);
+      if (portref == 0)
+      {
+         return -1; //apx_portref_new should already have set errno
       }
       //New portref.
       //Add it to portrefList, destruction of portref will be automatically taken care of when destructor of apx_routerPortMapEntry_t is called.
+      port->portMapIndex = adt_ary_length(portrefList);
       adt_ary_push(portrefList,portref);
       return 0;
    }
@@ -162,38 +155,51 @@ int8_t apx_routerPortMapEntry_removePort(apx_routerPortMapEntry_t *self, apx_nod
 {
    if ( (self != 0) && (node != 0) && (port != 0) )
    {
-      int32_t i;
-      int32_t end;
-      apx_portref_t portref;
-      adt_ary_t *portrefList = 0;
-      apx_portref_create(&portref,node,port);
-      if (portref.port->portType == APX_REQUIRE_PORT)
+      int32_t index;
+      if (port->portType == APX_REQUIRE_PORT)
       {
-         portrefList = &self->requirePorts;
+         index = apx_routerPortMapEntry_findPort(&self->requirePorts,node,port);
+         if (index >= 0)
+         {
+            //the order of require ports does not matter, move the last element into the free position
+            apx_portref_t *elem = (apx_portref_t*) adt_ary_value(&self->requirePorts,index);
+            apx_portref_t *last = (apx_portref_t*) adt_ary_pop(&self->requirePorts);
+            if (last != elem)
+            {
+               adt_ary_set(&self->requirePorts,index,last);
+               last->port->portMapIndex = index;
+            }
+            apx_portref_delete(elem);
+         }
       }
-      else if (portref.port->portType == APX_PROVIDE_PORT)
+      else if (port->portType == APX_PROVIDE_PORT)
       {
-         portrefList = &self->providePorts;
+         index = apx_routerPortMapEntry_findPort(&self->providePorts,node,port);
+         if (index >= 0)
+         {
+            //The default routing rule picks the last provider, the order must therefore be kept.
+            //Signals rarely have more than a few providers so shifting the remaining elements is cheap.
+            int32_t i;
+            int32_t end;
+            //using the adt_ary_splice method will both shorten the list and destroy the object (it calls apx_portref_vdelete)
+            adt_ary_splice(&self->providePorts,index,1);
+            end = adt_ary_length(&self->providePorts);
+            for (i=index;i<end;i++)
+            {
+               apx_portref_t *elem = (apx_portref_t*) adt_ary_value(&self->providePorts,i);
+               elem->port->portMapIndex = i;
+            }
+         }
       }
       else
       {
          errno = EINVAL;
          return -1;
       }
-      assert(portrefList != 0);
-      end = adt_ary_length(portrefList);
-      for (i=0;i<end;i++)
+      if (index >= 0)
       {
-         apx_portref_t *elem = (apx_portref_t*) adt_ary_value(portrefList,i);
-         if (apx_portref_equals(elem,&portref) != 0)
-         {
-            //found in list, we can now remove it and shorten the list.
-            //using the adt_ary_splice method will both shorten the list and destroy the object (it calls apx_portref_vdelete)
-            adt_ary_splice(portrefList,i,1);
-            break;
-         }
+         port->portMapIndex = -1;
       }
-      apx_portref_destroy(&portref); //nothing is actually destroyed here but call is made here to match call to the constructor
       return 0;
    }
    errno=EINVAL;
@@ -241,5 +247,23 @@ apx_portref_t *apx_routerPortMapEntry_getRequirePortById(apx_routerPortMapEntry_
 // LOCAL FUNCTIONS
 //////////////////////////////////////////////////////////////////////////////
 
+/**
+ * returns the position of (node,port) in portrefList or -1 if it is not in the list.
+ * A port is registered in at most one list, port->portMapIndex therefore tells where to look.
+ */
+static int32_t apx_routerPortMapEntry_findPort(const adt_ary_t *portrefList, const apx_node_t *node, const apx_port_t *port)
+{
+   int32_t index = port->portMapIndex;
+   if ( (index >= 0) && (index < adt_ary_length(portrefList)) )
+   {
+      apx_portref_t *elem = (apx_portref_t*) adt_ary_value(portrefList,index);
+      if ( (elem->node == node) && (elem->port == port) )
+      {
+         return index;
+      }
+   }
+   return -1;
+}
+
 
 
@@ -21,6 +21,8 @@ typedef struct apx_headerLine_tag
    int minorVersion;
 }apx_headerLine_t;
 
+#define APX_DECLARATION_LINE_MIN_ALLOC 128u
+
 
 
 /**************** Private Function Declarations *******************/
@@ -31,6 +33,7 @@ static void apx_istream_handler_require(const apx_istream_handler_t *handler,con
 static void apx_istream_handler_provide(const apx_istream_handler_t *handler,const char *name, const char *dsg, const char *attr); //P"<name>"<dsg>:<attr>
 static void apx_istream_handler_close(const apx_istream_handler_t *handler);
 
+static const uint8_t *apx_istream_parseLines(apx_istream_t *self, const uint8_t *pBegin, const uint8_t *pEnd);
 static const uint8_t* apx_istream_parseNodeName(apx_istream_t *self,const uint8_t *pBegin, const uint8_t *pEnd);
 static const uint8_t *apx_stream_parse_textLine(apx_istream_t *self,const uint8_t *pLineBegin,const uint8_t *pLineEnd);
 static const uint8_t *apx_stream_parseApxHeaderLine(const uint8_t *pBegin, const uint8_t *pEnd, apx_headerLine_t *data);
@@ -84,68 +87,40 @@ void apx_istream_open(apx_istream_t *self){
 }
 
 /**
- * Writes data to the istream. This function parses the data and forwards to sub-handlers
- * Returns 0 on success, negative on error
+ * Writes data to the istream. This function parses the data and forwards to sub-handlers.
+ * Complete lines are parsed directly from pChunk, only an incomplete line at the end of pChunk is copied and kept until the next write.
+ * Writing a complete definition in one call therefore parses it without copying the buffer.
  */
 void apx_istream_write(apx_istream_t *self, const uint8_t *pChunk, uint32_t chunkLen){
    if( (self != 0) && (pChunk != 0) && (chunkLen != 0) ){
-      const uint8_t *pEnd;
-      const uint8_t *pBegin;
-      const uint8_t *pNext;
-      const uint8_t *pResult;
-      const uint8_t *pNextOld = 0;
-      adt_bytearray_append(&self->buf,(uint8_t*) pChunk,(uint32_t) chunkLen);
-      pBegin = adt_bytearray_data(&self->buf);
-      pEnd = pBegin+adt_bytearray_length(&self->buf);
-      pNext = pBegin;
-      while(pNext < pEnd){
-         uint8_t firstByte;
-
-         assert(pNextOld != pNext); //sanity-check for parser during development, this must never be true
-         pNextOld = pNext;
-         firstByte =  *pNext; //do not move pNext forward yet, it could be a single '\n' character
-         if(firstByte < 128U){
-            //ascii character if firstByte is in the range 0-127-
-            //wait to parse until a complete line has been seen. lines end with a single \n (not with \r\n as in HTML)
-            //if the line is empty it means end of data-block. This is the same principe as the empty \r\n at the end of an HTML request header.
-            const uint8_t *pLineEnd = 0;
-            const uint8_t *pLineBegin = pNext;
-
-            pLineEnd = bstr_searchVal(pNext,pEnd,(uint8_t) '\n');
-
-            if(pLineEnd == pLineBegin){
-               pNext = pLineEnd+1;
-               if(self->handler.node_end != 0){
-                  //empty line '\n'
-                  self->handler.node_end(self->handler.arg);
-               }
-            }
-            else if(pLineEnd > pLineBegin){
-
-               pNext = pLineEnd+1;
-               assert( ((char) *pLineEnd) == '\n'); //check during development, remove later
-               pResult = apx_stream_parse_textLine(self,pLineBegin,pLineEnd);
-               if(pResult == 0){
-                  //parse failure, ignore all data
-                  adt_bytearray_clear(&self->buf);
-                  APX_LOG_ERROR("[APX_STREAM] %s", "Parse error");
-                  return;
-               }
-            }
-            else{
-               //'\n' not seen, trim byffer and try parsing again later
-               break;
-            }
-         }
-      }
-      if (pNext <= pEnd)
+      const uint8_t *pEnd = pChunk+chunkLen;
+      const uint8_t *pNext = pChunk;
+      if (adt_bytearray_length(&self->buf) > 0)
       {
-         adt_bytearray_trimLeft(&self->buf,pNext);
+         //complete the line that was started in the previous chunk
+         const uint8_t *pLineEnd = bstr_searchVal(pNext,pEnd,(uint8_t) '\n');
+         const uint8_t *pBegin;
+         const uint8_t *pResult;
+         if ( (pLineEnd == 0) || (*pLineEnd != (uint8_t) '\n') )
+         {
+            adt_bytearray_append(&self->buf, pChunk, chunkLen);
+            return;
+         }
+         pNext = pLineEnd+1;
+         adt_bytearray_append(&self->buf, pChunk, (uint32_t) (pNext-pChunk));
+         pBegin = adt_bytearray_data(&self->buf);
+         pResult = apx_istream_parseLines(self, pBegin, pBegin+adt_bytearray_length(&self->buf));
+         adt_bytearray_clear(&self->buf);
+         if (pResult == 0)
+         {
+            return;
+         }
       }
-      else
+      pNext = apx_istream_parseLines(self, pNext, pEnd);
+      if ( (pNext != 0) && (pNext < pEnd) )
       {
-         //pNext is outside array bounds
-         assert(0);
+         //'\n' not seen, keep the remainder and try parsing again when more data arrives
+         adt_bytearray_append(&self->buf, pNext, (uint32_t) (pEnd-pNext));
       }
    }
 }
@@ -218,12 +193,18 @@ int8_t apx_declarationLine_resize(apx_declarationLine_t *self, uint32_t len)
    {
       if (len > self->allocLen)
       {
+         //grow geometrically so that a definition with increasingly long lines only causes a few allocations
+         uint32_t allocLen = (self->allocLen < APX_DECLARATION_LINE_MIN_ALLOC)? APX_DECLARATION_LINE_MIN_ALLOC : self->allocLen;
+         while (allocLen < len)
+         {
+            allocLen *= 2u;
+         }
          if (self->pAlloc != 0)
          {
             free(self->pAlloc);
          }
-         self->pAlloc = (char*) malloc(len);
-         self->allocLen = len;
+         self->pAlloc = (char*) malloc(allocLen);
+         self->allocLen = (self->pAlloc != 0)? allocLen : 0u;
       }
       if (self->pAlloc != 0)
       {
@@ -282,6 +263,50 @@ void apx_istream_handler_close(const apx_istream_handler_t *handler){
    }
 }
 
+/**
+ * Parses all complete lines in [pBegin, pEnd). Lines end with a single '\n' (not with \r\n as in HTML).
+ * An empty line means end of data-block, the same principle as the empty \r\n at the end of an HTML request header.
+ * Returns a pointer to the first byte of the incomplete line at the end (pEnd if there is none) or NULL on parse error.
+ */
+static const uint8_t *apx_istream_parseLines(apx_istream_t *self, const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   const uint8_t *pNext = pBegin;
+   while(pNext < pEnd)
+   {
+      const uint8_t *pLineBegin = pNext;
+      const uint8_t *pLineEnd;
+      if (*pLineBegin >= 128U)
+      {
+         //only ascii characters (0-127) are allowed at the start of a line
+         adt_bytearray_clear(&self->buf);
+         APX_LOG_ERROR("[APX_STREAM] %s", "Parse error");
+         return 0;
+      }
+      pLineEnd = bstr_searchVal(pLineBegin,pEnd,(uint8_t) '\n');
+      if ( (pLineEnd == 0) || (*pLineEnd != (uint8_t) '\n') )
+      {
+         break; //incomplete line
+      }
+      pNext = pLineEnd+1;
+      if (pLineEnd == pLineBegin)
+      {
+         //empty line '\n'
+         if(self->handler.node_end != 0)
+         {
+            self->handler.node_end(self->handler.arg);
+         }
+      }
+      else if (apx_stream_parse_textLine(self,pLineBegin,pLineEnd) == 0)
+      {
+         //parse failure, ignore all data
+         adt_bytearray_clear(&self->buf);
+         APX_LOG_ERROR("[APX_STREAM] %s", "Parse error");
+         return 0;
+      }
+   }
+   return pNext;
+}
+
 const uint8_t* apx_istream_parseNodeName(apx_istream_t *self, const uint8_t *pBegin, const uint8_t *pEnd){
    if (self != 0){
       const uint8_t *pNext;
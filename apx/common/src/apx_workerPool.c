@@ -0,0 +1,304 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <errno.h>
+#include <malloc.h>
+#include <assert.h>
+#include <string.h>
+#include <stdio.h>
+#ifdef _MSC_VER
+#include <process.h>
+#endif
+#include "apx_workerPool.h"
+#include "apx_fileManager.h"
+#include "apx_logging.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void apx_workerPool_joinThread(apx_workerPool_t *self, uint16_t index);
+static THREAD_PROTO(workerTask,arg);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+int8_t apx_workerPool_create(apx_workerPool_t *self, uint16_t numWorkers)
+{
+   if ( (self != 0) && (numWorkers > 0) )
+   {
+      self->workerThreads = (THREAD_T*) malloc(sizeof(THREAD_T)*numWorkers);
+      if (self->workerThreads == 0)
+      {
+         errno = ENOMEM;
+         return -1;
+      }
+      self->numWorkers = numWorkers;
+      self->numStarted = 0;
+      self->runQueueHead = (apx_fileManager_t*) 0;
+      self->runQueueTail = (apx_fileManager_t*) 0;
+      self->isRunning = false;
+      SPINLOCK_INIT(self->lock);
+      SEMAPHORE_CREATE(self->semaphore);
+      return 0;
+   }
+   errno = EINVAL;
+   return -1;
+}
+
+void apx_workerPool_destroy(apx_workerPool_t *self)
+{
+   if (self != 0)
+   {
+      apx_workerPool_stop(self);
+      SEMAPHORE_DESTROY(self->semaphore);
+      SPINLOCK_DESTROY(self->lock);
+      if (self->workerThreads != 0)
+      {
+         free(self->workerThreads);
+      }
+   }
+}
+
+apx_workerPool_t *apx_workerPool_new(uint16_t numWorkers)
+{
+   apx_workerPool_t *self = (apx_workerPool_t*) malloc(sizeof(apx_workerPool_t));
+   if(self != 0)
+   {
+      int8_t result = apx_workerPool_create(self, numWorkers);
+      if (result != 0)
+      {
+         free(self);
+         self = 0;
+      }
+   }
+   else
+   {
+      errno = ENOMEM;
+   }
+   return self;
+}
+
+void apx_workerPool_delete(apx_workerPool_t *self)
+{
+   if (self != 0)
+   {
+      apx_workerPool_destroy(self);
+      free(self);
+   }
+}
+
+void apx_workerPool_vdelete(void *arg)
+{
+   apx_workerPool_delete((apx_workerPool_t*) arg);
+}
+
+int8_t apx_workerPool_start(apx_workerPool_t *self)
+{
+   if ( (self != 0) && (self->numStarted == 0) )
+   {
+      uint16_t i;
+      self->isRunning = true;
+      for (i=0; i<self->numWorkers; i++)
+      {
+#ifdef _WIN32
+         THREAD_CREATE(self->workerThreads[i],workerTask,self,self->threadId);
+         if(self->workerThreads[i] == INVALID_HANDLE_VALUE)
+         {
+            break;
+         }
+#else
+         int rc = THREAD_CREATE(self->workerThreads[i],workerTask,self);
+         if(rc != 0)
+         {
+            break;
+         }
+#endif
+         self->numStarted++;
+      }
+      if (self->numStarted < self->numWorkers)
+      {
+         APX_LOG_ERROR("[APX_WORKER_POOL] only %d of %d worker threads could be started", (int) self->numStarted, (int) self->numWorkers);
+         if (self->numStarted == 0)
+         {
+            self->isRunning = false;
+            return -1;
+         }
+      }
+      return 0;
+   }
+   errno = EINVAL;
+   return -1;
+}
+
+/**
+ * Stops all worker threads. fileManagers still waiting in the run queue are dropped. Make sure all fileManagers using this pool have been stopped before calling this.
+ */
+void apx_workerPool_stop(apx_workerPool_t *self)
+{
+   if ( (self != 0) && (self->numStarted > 0) )
+   {
+      uint16_t i;
+      SPINLOCK_ENTER(self->lock);
+      self->isRunning = false;
+      SPINLOCK_LEAVE(self->lock);
+      for (i=0; i<self->numStarted; i++)
+      {
+         SEMAPHORE_POST(self->semaphore);
+      }
+      for (i=0; i<self->numStarted; i++)
+      {
+         apx_workerPool_joinThread(self, i);
+      }
+      self->numStarted = 0;
+      self->runQueueHead = (apx_fileManager_t*) 0;
+      self->runQueueTail = (apx_fileManager_t*) 0;
+   }
+}
+
+bool apx_workerPool_isRunning(apx_workerPool_t *self)
+{
+   bool isRunning = false;
+   if (self != 0)
+   {
+      SPINLOCK_ENTER(self->lock);
+      isRunning = self->isRunning;
+      SPINLOCK_LEAVE(self->lock);
+   }
+   return isRunning;
+}
+
+/**
+ * Puts fileManager at the end of the run queue and wakes up one worker.
+ * The caller is responsible for making sure a fileManager is never in the run queue more than once (see apx_fileManager_t.isScheduled)
+ */
+void apx_workerPool_schedule(apx_workerPool_t *self, struct apx_fileManager_tag *fileManager)
+{
+   if ( (self != 0) && (fileManager != 0) )
+   {
+      fileManager->workerPoolNext = (apx_fileManager_t*) 0;
+      SPINLOCK_ENTER(self->lock);
+      if (self->runQueueTail == 0)
+      {
+         self->runQueueHead = fileManager;
+      }
+      else
+      {
+         self->runQueueTail->workerPoolNext = fileManager;
+      }
+      self->runQueueTail = fileManager;
+      SPINLOCK_LEAVE(self->lock);
+      SEMAPHORE_POST(self->semaphore);
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void apx_workerPool_joinThread(apx_workerPool_t *self, uint16_t index)
+{
+#ifdef _MSC_VER
+   DWORD result = WaitForSingleObject(self->workerThreads[index], 5000);
+   if (result == WAIT_TIMEOUT)
+   {
+      APX_LOG_ERROR("[APX_WORKER_POOL] timeout while joining workerThread");
+   }
+   else if (result == WAIT_FAILED)
+   {
+      DWORD lastError = GetLastError();
+      APX_LOG_ERROR("[APX_WORKER_POOL]  joining workerThread failed with %d", (int)lastError);
+   }
+   CloseHandle(self->workerThreads[index]);
+   self->workerThreads[index] = INVALID_HANDLE_VALUE;
+#else
+   if(pthread_equal(pthread_self(),self->workerThreads[index]) == 0)
+   {
+      void *status;
+      int s = pthread_join(self->workerThreads[index], &status);
+      if (s != 0)
+      {
+         APX_LOG_ERROR("[APX_WORKER_POOL] pthread_join error %d\n",s);
+      }
+   }
+   else
+   {
+      APX_LOG_ERROR("[APX_WORKER_POOL] pthread_join attempted on pthread_self()\n");
+   }
+#endif
+}
+
+static THREAD_PROTO(workerTask,arg)
+{
+   if(arg!=0)
+   {
+      apx_workerPool_t *self = (apx_workerPool_t*) arg;
+      for(;;)
+      {
+#ifdef _MSC_VER
+         DWORD result = WaitForSingleObject(self->semaphore, INFINITE);
+         if (result == WAIT_OBJECT_0)
+#else
+         int result = sem_wait(&self->semaphore);
+         if (result == 0)
+#endif
+         {
+            apx_fileManager_t *fileManager;
+            bool isRunning;
+            SPINLOCK_ENTER(self->lock);
+            isRunning = self->isRunning;
+            fileManager = self->runQueueHead;
+            if ( (isRunning == true) && (fileManager != 0) )
+            {
+               self->runQueueHead = fileManager->workerPoolNext;
+               if (self->runQueueHead == 0)
+               {
+                  self->runQueueTail = (apx_fileManager_t*) 0;
+               }
+            }
+            SPINLOCK_LEAVE(self->lock);
+            if (isRunning == false)
+            {
+               break;
+            }
+            if (fileManager != 0)
+            {
+               //the fileManager remains scheduled (and thus invisible to other workers) until it reports that its queue is empty
+               bool hasMoreWork = apx_fileManager_processPending(fileManager, APX_WORKER_POOL_MAX_BATCH);
+               if (hasMoreWork == true)
+               {
+                  //move to the back of the run queue to give other connections a fair share of the workers
+                  apx_workerPool_schedule(self, fileManager);
+               }
+            }
+         }
+         else
+         {
+#ifdef _MSC_VER
+            DWORD lastError = GetLastError();
+            APX_LOG_ERROR("[APX_WORKER_POOL]: failure while waiting for semaphore, lastError=%d", lastError);
+#else
+            APX_LOG_ERROR("[APX_WORKER_POOL]: failure while waiting for semaphore, errno=%d", errno);
+#endif
+            break;
+         }
+      }
+   }
+   THREAD_RETURN(0);
+}
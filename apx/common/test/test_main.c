@@ -15,16 +15,25 @@ CuSuite* testSuite_apx_routerPortMapEntry(void);
 CuSuite* testSuite_apx_router(void);
 CuSuite* testSuite_apx_dataTrigger(void);
 CuSuite* testSuite_apx_allocator(void);
+CuSuite* testSuite_apx_workerPool(void);
+CuSuite* testSuite_apx_conflationTable(void);
+CuSuite* testSuite_apx_mpscQueue(void);
+CuSuite* testSuite_apx_payload(void);
+CuSuite* testSuite_apx_nodeManager(void);
 CuSuite* testSuite_apx_file(void);
 CuSuite* testSuite_apx_fileMap(void);
 CuSuite* testSuite_apx_nodeData(void);
 CuSuite* testsuite_apx_attributesParser(void);
 CuSuite* testSuite_apx_dataElement(void);
+CuSuite* testSuite_apx_dataProgram(void);
+CuSuite* testSuite_apx_codeGenerator(void);
 CuSuite* testSuite_remotefile(void);
 CuSuite* testSuite_apx_testServer(void);
+CuSuite* testSuite_apx_eventLoop(void);
 CuSuite* testSuite_apx_clientSession(void);
 CuSuite* testSuite_apx_sessionCmd(void);
-CuSuite* testsuite_soa_fsa(void);
+CuSuite* testsuite_sha256(void);
+CuSuite* testsuite_pack(void);
 
 void RunAllTests(void)
 {
@@ -44,13 +53,22 @@ void RunAllTests(void)
    CuSuiteAddSuite(suite, testSuite_apx_fileMap());
    CuSuiteAddSuite(suite, testSuite_apx_nodeData());
    CuSuiteAddSuite(suite, testSuite_apx_allocator());
+   CuSuiteAddSuite(suite, testSuite_apx_workerPool());
+   CuSuiteAddSuite(suite, testSuite_apx_conflationTable());
+   CuSuiteAddSuite(suite, testSuite_apx_mpscQueue());
+   CuSuiteAddSuite(suite, testSuite_apx_payload());
+   CuSuiteAddSuite(suite, testSuite_apx_nodeManager());
    CuSuiteAddSuite(suite, testSuite_remotefile());
    CuSuiteAddSuite(suite, testsuite_apx_attributesParser());
    CuSuiteAddSuite(suite, testSuite_apx_dataElement());
+   CuSuiteAddSuite(suite, testSuite_apx_dataProgram());
+   CuSuiteAddSuite(suite, testSuite_apx_codeGenerator());
    CuSuiteAddSuite(suite, testSuite_apx_testServer());
+   CuSuiteAddSuite(suite, testSuite_apx_eventLoop());
    CuSuiteAddSuite(suite, testSuite_apx_clientSession());
    CuSuiteAddSuite(suite, testSuite_apx_sessionCmd());
-   CuSuiteAddSuite(suite, testsuite_soa_fsa());
+   CuSuiteAddSuite(suite, testsuite_sha256());
+   CuSuiteAddSuite(suite, testsuite_pack());
 
    CuSuiteRun(suite);
    CuSuiteSummary(suite, output);
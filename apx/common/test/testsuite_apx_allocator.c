@@ -6,7 +6,14 @@
 #include <stdio.h>
 #include <stddef.h>
 #include <string.h>
+#ifdef _MSC_VER
+#include <Windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#endif
 #include "CuTest.h"
+#include "osmacro.h"
 #include "apx_allocator.h"
 #include "apx_parser.h"
 #ifdef MEM_LEAK_CHECK
@@ -17,11 +24,31 @@
 //////////////////////////////////////////////////////////////////////////////
 // CONSTANTS AND DATA TYPES
 //////////////////////////////////////////////////////////////////////////////
+#define NUM_OBJECTS 200
+#define OBJECT_SIZE 24
+
+typedef struct testThread_tag
+{
+   apx_allocator_t *allocator;
+   uint8_t *objects[NUM_OBJECTS];
+   THREAD_T thread;
+#ifdef _MSC_VER
+   unsigned int threadId;
+#endif
+}testThread_t;
 
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
 static void test_apx_allocator_create(CuTest* tc);
+static void test_apx_allocator_reuseLocalFree(CuTest* tc);
+static void test_apx_allocator_freeFromOtherThread(CuTest* tc);
+static void test_apx_allocator_freeAfterOwnerExit(CuTest* tc);
+static void test_apx_allocator_releaseEmptySlabs(CuTest* tc);
+static void testThread_run(testThread_t *self, THREAD_PROTO_PTR(func,arg));
+static void testThread_join(testThread_t *self);
+static THREAD_PROTO(allocTask,arg);
+static THREAD_PROTO(freeTask,arg);
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL VARIABLES
@@ -42,6 +69,10 @@ CuSuite* testSuite_apx_allocator(void)
    CuSuite* suite = CuSuiteNew();
 
    SUITE_ADD_TEST(suite, test_apx_allocator_create);
+   SUITE_ADD_TEST(suite, test_apx_allocator_reuseLocalFree);
+   SUITE_ADD_TEST(suite, test_apx_allocator_freeFromOtherThread);
+   SUITE_ADD_TEST(suite, test_apx_allocator_freeAfterOwnerExit);
+   SUITE_ADD_TEST(suite, test_apx_allocator_releaseEmptySlabs);
 
    return suite;
 }
@@ -58,8 +89,7 @@ static void test_apx_allocator_create(CuTest* tc)
    uint8_t *data4;
    uint8_t *data128;
    apx_allocator_t allocator;
-   apx_allocator_create(&allocator,100);
-   apx_allocator_start(&allocator);
+   apx_allocator_create(&allocator);
    data1 = apx_allocator_alloc(&allocator,1);
    CuAssertPtrNotNull(tc,data1);
    data2 = apx_allocator_alloc(&allocator,2);
@@ -74,7 +104,154 @@ static void test_apx_allocator_create(CuTest* tc)
    apx_allocator_free(&allocator,data3,3);
    apx_allocator_free(&allocator,data4,4);
    apx_allocator_free(&allocator,data128,128);
-   apx_allocator_stop(&allocator);
+   CuAssertIntEquals(tc, 0, apx_allocator_getNumAllocated(&allocator));
+   apx_allocator_destroy(&allocator);
+}
+
+static void test_apx_allocator_reuseLocalFree(CuTest* tc)
+{
+   apx_allocator_t allocator;
+   uint8_t *data1;
+   uint8_t *data2;
+   apx_allocator_create(&allocator);
+   data1 = apx_allocator_alloc(&allocator, 10);
+   CuAssertPtrNotNull(tc, data1);
+   CuAssertIntEquals(tc, 0, ((size_t) data1) & 7u);
+   apx_allocator_free(&allocator, data1, 10);
+   //same size class, the block freed by this thread is handed out again
+   data2 = apx_allocator_alloc(&allocator, 16);
+   CuAssertPtrEquals(tc, data1, data2);
+   apx_allocator_free(&allocator, data2, 16);
+   data1 = apx_allocator_alloc(&allocator, APX_ALLOCATOR_MAX_SMALL_SIZE+1);
+   CuAssertPtrNotNull(tc, data1);
+   CuAssertIntEquals(tc, 1, apx_allocator_getNumAllocated(&allocator));
+   apx_allocator_free(&allocator, data1, APX_ALLOCATOR_MAX_SMALL_SIZE+1);
+   CuAssertIntEquals(tc, 0, apx_allocator_getNumAllocated(&allocator));
+   apx_allocator_destroy(&allocator);
+}
+
+static void test_apx_allocator_freeFromOtherThread(CuTest* tc)
+{
+   apx_allocator_t allocator;
+   testThread_t *worker;
+   int32_t i;
+   worker = (testThread_t*) malloc(sizeof(testThread_t));
+   CuAssertPtrNotNull(tc, worker);
+   apx_allocator_create(&allocator);
+   worker->allocator = &allocator;
+   for (i=0; i<NUM_OBJECTS; i++)
+   {
+      worker->objects[i] = apx_allocator_alloc(&allocator, OBJECT_SIZE);
+      CuAssertPtrNotNull(tc, worker->objects[i]);
+      memset(worker->objects[i], (int) i, OBJECT_SIZE);
+   }
+   testThread_run(worker, freeTask);
+   testThread_join(worker);
+   CuAssertIntEquals(tc, 0, apx_allocator_getNumAllocated(&allocator));
+   //the blocks freed by the other thread are taken back by this thread
+   for (i=0; i<NUM_OBJECTS; i++)
+   {
+      worker->objects[i] = apx_allocator_alloc(&allocator, OBJECT_SIZE);
+      CuAssertPtrNotNull(tc, worker->objects[i]);
+   }
+   for (i=0; i<NUM_OBJECTS; i++)
+   {
+      apx_allocator_free(&allocator, worker->objects[i], OBJECT_SIZE);
+   }
+   CuAssertIntEquals(tc, 0, apx_allocator_getNumAllocated(&allocator));
    apx_allocator_destroy(&allocator);
+   free(worker);
 }
 
+static void test_apx_allocator_freeAfterOwnerExit(CuTest* tc)
+{
+   apx_allocator_t allocator;
+   testThread_t *worker;
+   int32_t i;
+   worker = (testThread_t*) malloc(sizeof(testThread_t));
+   CuAssertPtrNotNull(tc, worker);
+   apx_allocator_create(&allocator);
+   worker->allocator = &allocator;
+   testThread_run(worker, allocTask);
+   testThread_join(worker);
+   CuAssertIntEquals(tc, NUM_OBJECTS, apx_allocator_getNumAllocated(&allocator));
+   //the objects outlive the thread that allocated them, the last free deletes its cache
+   for (i=0; i<NUM_OBJECTS; i++)
+   {
+      CuAssertPtrNotNull(tc, worker->objects[i]);
+      CuAssertIntEquals(tc, (uint8_t) i, worker->objects[i][OBJECT_SIZE-1]);
+      apx_allocator_free(&allocator, worker->objects[i], OBJECT_SIZE);
+   }
+   CuAssertIntEquals(tc, 0, apx_allocator_getNumAllocated(&allocator));
+   apx_allocator_destroy(&allocator);
+   free(worker);
+}
+
+static void test_apx_allocator_releaseEmptySlabs(CuTest* tc)
+{
+   apx_allocator_t allocator;
+   uint8_t *objects[NUM_OBJECTS];
+   int32_t numSlabs;
+   int32_t i;
+   apx_allocator_create(&allocator);
+   numSlabs = apx_allocator_getNumSlabs();
+   for (i=0; i<NUM_OBJECTS; i++)
+   {
+      objects[i] = apx_allocator_alloc(&allocator, 100);
+      CuAssertPtrNotNull(tc, objects[i]);
+   }
+   CuAssertTrue(tc, apx_allocator_getNumSlabs() >= numSlabs + (int32_t) (NUM_OBJECTS / APX_ALLOCATOR_BLOCKS_PER_SLAB));
+   for (i=0; i<NUM_OBJECTS; i++)
+   {
+      apx_allocator_free(&allocator, objects[i], 100);
+   }
+   //all but one of the emptied slabs are given back to the system
+   CuAssertTrue(tc, apx_allocator_getNumSlabs() <= numSlabs + 1);
+   CuAssertIntEquals(tc, 0, apx_allocator_getNumAllocated(&allocator));
+   apx_allocator_destroy(&allocator);
+}
+
+static void testThread_run(testThread_t *self, THREAD_PROTO_PTR(func,arg))
+{
+#ifdef _MSC_VER
+   THREAD_CREATE(self->thread, func, self, self->threadId);
+#else
+   THREAD_CREATE(self->thread, func, self);
+#endif
+}
+
+static void testThread_join(testThread_t *self)
+{
+#ifdef _MSC_VER
+   WaitForSingleObject(self->thread, INFINITE);
+   CloseHandle(self->thread);
+#else
+   pthread_join(self->thread, 0);
+#endif
+}
+
+static THREAD_PROTO(allocTask,arg)
+{
+   testThread_t *self = (testThread_t*) arg;
+   int32_t i;
+   for (i=0; i<NUM_OBJECTS; i++)
+   {
+      self->objects[i] = apx_allocator_alloc(self->allocator, OBJECT_SIZE);
+      if (self->objects[i] != 0)
+      {
+         memset(self->objects[i], (int) i, OBJECT_SIZE);
+      }
+   }
+   THREAD_RETURN(0);
+}
+
+static THREAD_PROTO(freeTask,arg)
+{
+   testThread_t *self = (testThread_t*) arg;
+   int32_t i;
+   for (i=0; i<NUM_OBJECTS; i++)
+   {
+      apx_allocator_free(self->allocator, self->objects[i], OBJECT_SIZE);
+   }
+   THREAD_RETURN(0);
+}
@@ -0,0 +1,204 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx_conflationTable.h"
+#include "apx_fileManager.h"
+#include "apx_file.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define NUM_KEYS 100
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_apx_conflationTable_create(CuTest* tc);
+static void test_apx_conflationTable_insertFindRemove(CuTest* tc);
+static void test_apx_conflationTable_removeReplacedEntry(CuTest* tc);
+static void test_apx_conflationTable_manyKeys(CuTest* tc);
+static void test_apx_conflationTable_grow(CuTest* tc);
+static void test_apx_fileManager_conflatePendingWrites(CuTest* tc);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+
+CuSuite* testSuite_apx_conflationTable(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_apx_conflationTable_create);
+   SUITE_ADD_TEST(suite, test_apx_conflationTable_insertFindRemove);
+   SUITE_ADD_TEST(suite, test_apx_conflationTable_removeReplacedEntry);
+   SUITE_ADD_TEST(suite, test_apx_conflationTable_manyKeys);
+   SUITE_ADD_TEST(suite, test_apx_conflationTable_grow);
+   SUITE_ADD_TEST(suite, test_apx_fileManager_conflatePendingWrites);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_apx_conflationTable_create(CuTest* tc)
+{
+   apx_conflationTable_t table;
+   apx_conflationTable_t *pTable;
+   CuAssertIntEquals(tc, -1, apx_conflationTable_create(&table, 0));
+   CuAssertIntEquals(tc, 0, apx_conflationTable_create(&table, 10));
+   CuAssertUIntEquals(tc, 32, table.capacity);
+   CuAssertUIntEquals(tc, 0, apx_conflationTable_length(&table));
+   apx_conflationTable_destroy(&table);
+   pTable = apx_conflationTable_new(1);
+   CuAssertPtrNotNull(tc, pTable);
+   CuAssertUIntEquals(tc, 8, pTable->capacity);
+   apx_conflationTable_delete(pTable);
+}
+
+static void test_apx_conflationTable_insertFindRemove(CuTest* tc)
+{
+   apx_conflationTable_t table;
+   struct apx_file_tag *file1 = (struct apx_file_tag*) 0x1000;
+   struct apx_file_tag *file2 = (struct apx_file_tag*) 0x2000;
+   uint8_t data1[2];
+   uint8_t data2[2];
+   apx_conflationEntry_t *entry;
+   apx_conflationTable_create(&table, 10);
+   CuAssertPtrEquals(tc, 0, apx_conflationTable_find(&table, file1, 0));
+   CuAssertIntEquals(tc, 0, apx_conflationTable_insert(&table, file1, 0, 2, &data1[0]));
+   CuAssertIntEquals(tc, 0, apx_conflationTable_insert(&table, file2, 0, 2, &data2[0]));
+   CuAssertUIntEquals(tc, 2, apx_conflationTable_length(&table));
+   entry = apx_conflationTable_find(&table, file1, 0);
+   CuAssertPtrNotNull(tc, entry);
+   CuAssertPtrEquals(tc, &data1[0], entry->data);
+   CuAssertUIntEquals(tc, 2, entry->length);
+   CuAssertPtrEquals(tc, 0, apx_conflationTable_find(&table, file1, 2));
+   CuAssertTrue(tc, apx_conflationTable_remove(&table, file1, 0, &data1[0]));
+   CuAssertPtrEquals(tc, 0, apx_conflationTable_find(&table, file1, 0));
+   CuAssertPtrNotNull(tc, apx_conflationTable_find(&table, file2, 0));
+   CuAssertUIntEquals(tc, 1, apx_conflationTable_length(&table));
+   apx_conflationTable_destroy(&table);
+}
+
+static void test_apx_conflationTable_removeReplacedEntry(CuTest* tc)
+{
+   apx_conflationTable_t table;
+   struct apx_file_tag *file = (struct apx_file_tag*) 0x1000;
+   uint8_t oldData[4];
+   uint8_t newData[2];
+   apx_conflationTable_create(&table, 10);
+   apx_conflationTable_insert(&table, file, 4, 4, &oldData[0]);
+   apx_conflationTable_insert(&table, file, 4, 2, &newData[0]);
+   CuAssertUIntEquals(tc, 1, apx_conflationTable_length(&table));
+   //the old message leaving the queue must not remove the entry of the newer message
+   CuAssertTrue(tc, !apx_conflationTable_remove(&table, file, 4, &oldData[0]));
+   CuAssertPtrEquals(tc, &newData[0], apx_conflationTable_find(&table, file, 4)->data);
+   CuAssertTrue(tc, apx_conflationTable_remove(&table, file, 4, &newData[0]));
+   CuAssertUIntEquals(tc, 0, apx_conflationTable_length(&table));
+   apx_conflationTable_destroy(&table);
+}
+
+static void test_apx_conflationTable_manyKeys(CuTest* tc)
+{
+   apx_conflationTable_t table;
+   struct apx_file_tag *file = (struct apx_file_tag*) 0x1000;
+   uint8_t data[NUM_KEYS];
+   uint32_t i;
+   apx_conflationTable_create(&table, NUM_KEYS);
+   for (i=0; i<NUM_KEYS; i++)
+   {
+      CuAssertIntEquals(tc, 0, apx_conflationTable_insert(&table, file, i, 1, &data[i]));
+   }
+   CuAssertUIntEquals(tc, NUM_KEYS, apx_conflationTable_length(&table));
+   //remove every other key, the remaining keys must still be found after the probe sequences have been compacted
+   for (i=0; i<NUM_KEYS; i+=2)
+   {
+      CuAssertTrue(tc, apx_conflationTable_remove(&table, file, i, &data[i]));
+   }
+   for (i=0; i<NUM_KEYS; i++)
+   {
+      apx_conflationEntry_t *entry = apx_conflationTable_find(&table, file, i);
+      if ( (i % 2) == 0)
+      {
+         CuAssertPtrEquals(tc, 0, entry);
+      }
+      else
+      {
+         CuAssertPtrNotNull(tc, entry);
+         CuAssertPtrEquals(tc, &data[i], entry->data);
+      }
+   }
+   apx_conflationTable_destroy(&table);
+}
+
+static void test_apx_conflationTable_grow(CuTest* tc)
+{
+   apx_conflationTable_t table;
+   struct apx_file_tag *file = (struct apx_file_tag*) 0x1000;
+   uint8_t data[NUM_KEYS];
+   uint32_t i;
+   apx_conflationTable_create(&table, 1);
+   CuAssertUIntEquals(tc, 8, table.capacity);
+   for (i=0; i<NUM_KEYS; i++)
+   {
+      CuAssertIntEquals(tc, 0, apx_conflationTable_insert(&table, file, i, 1, &data[i]));
+   }
+   CuAssertUIntEquals(tc, NUM_KEYS, apx_conflationTable_length(&table));
+   CuAssertUIntEquals(tc, 256, table.capacity);
+   for (i=0; i<NUM_KEYS; i++)
+   {
+      apx_conflationEntry_t *entry = apx_conflationTable_find(&table, file, i);
+      CuAssertPtrNotNull(tc, entry);
+      CuAssertPtrEquals(tc, &data[i], entry->data);
+   }
+   apx_conflationTable_destroy(&table);
+}
+
+static void test_apx_fileManager_conflatePendingWrites(CuTest* tc)
+{
+   apx_fileManager_t fileManager;
+   apx_file_t *file = (apx_file_t*) 0x1000; //never dereferenced since the fileManager is not started
+   apx_msg_t msg;
+   uint8_t value[2];
+   CuAssertIntEquals(tc, 0, apx_fileManager_create(&fileManager, APX_FILEMANAGER_SERVER_MODE));
+   CuAssertIntEquals(tc, 0, apx_fileManager_enableConflation(&fileManager));
+   value[0] = 1; value[1] = 0;
+   apx_fileManager_triggerFileWriteCmdEvent(&fileManager, file, &value[0], 0, 2);
+   value[0] = 2;
+   apx_fileManager_triggerFileWriteCmdEvent(&fileManager, file, &value[0], 2, 2);
+   value[0] = 3;
+   apx_fileManager_triggerFileWriteCmdEvent(&fileManager, file, &value[0], 0, 2);
+   value[0] = 4;
+   apx_fileManager_triggerFileWriteCmdEvent(&fileManager, file, &value[0], 0, 2);
+   CuAssertIntEquals(tc, 2, apx_mpscQueue_length(&fileManager.messages));
+   CuAssertUIntEquals(tc, 2, fileManager.numConflatedWrites);
+   CuAssertTrue(tc, apx_mpscQueue_pop(&fileManager.messages, &msg));
+   CuAssertUIntEquals(tc, 0, msg.msgData1);
+   CuAssertIntEquals(tc, 4, msg.msgData4.data[0]);
+   CuAssertTrue(tc, apx_mpscQueue_pop(&fileManager.messages, &msg));
+   CuAssertUIntEquals(tc, 2, msg.msgData1);
+   CuAssertIntEquals(tc, 2, msg.msgData4.data[0]);
+   apx_fileManager_destroy(&fileManager);
+}
@@ -38,6 +38,8 @@ static void test_apx_dataElement_pack_string(CuTest *tc);
 static void test_apx_dataElement_pack_pair(CuTest *tc);
 static void test_apx_dataElement_pack_nested(CuTest *tc);
 static void test_apx_dataElement_pack_record_array(CuTest *tc);
+static void test_apx_dataElement_unpack_record(CuTest *tc);
+static void test_apx_dataElement_pack_array(CuTest *tc);
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -74,6 +76,8 @@ CuSuite* testSuite_apx_dataElement(void)
    SUITE_ADD_TEST(suite, test_apx_dataElement_pack_pair);
    SUITE_ADD_TEST(suite, test_apx_dataElement_pack_nested);
    SUITE_ADD_TEST(suite, test_apx_dataElement_pack_record_array);
+   SUITE_ADD_TEST(suite, test_apx_dataElement_unpack_record);
+   SUITE_ADD_TEST(suite, test_apx_dataElement_pack_array);
 
 
    return suite;
@@ -717,3 +721,67 @@ static void test_apx_dataElement_pack_record_array(CuTest *tc)
    adt_bytearray_delete(array);
    dtl_av_delete(av);
 }
+
+static void test_apx_dataElement_unpack_record(CuTest *tc)
+{
+   apx_dataElement_t *rootElem;
+   apx_dataElement_t *childElem;
+   const uint8_t data[8] = {0x78, 0x56, 0x34, 0x12, 0xFF, 'a', 'b', 0};
+   const uint8_t *pResult;
+   dtl_dv_t *dv = 0;
+   dtl_av_t *av;
+
+   //{"a"L"b"c"c"a[3]}
+   rootElem = apx_dataElement_new(APX_BASE_TYPE_RECORD, 0);
+   apx_dataElement_appendChild(rootElem, apx_dataElement_new(APX_BASE_TYPE_UINT32, 0));
+   apx_dataElement_appendChild(rootElem, apx_dataElement_new(APX_BASE_TYPE_SINT8, 0));
+   childElem = apx_dataElement_new(APX_BASE_TYPE_STRING, 0);
+   apx_dataElement_setArrayLen(childElem, 3);
+   apx_dataElement_appendChild(rootElem, childElem);
+
+   pResult = apx_dataElement_unpack_dv(rootElem, &data[0], &data[8], &dv);
+   CuAssertPtrEquals(tc, (void*) &data[8], (void*) pResult);
+   CuAssertIntEquals(tc, DTL_DV_ARRAY, dtl_dv_type(dv));
+   av = (dtl_av_t*) dv;
+   CuAssertIntEquals(tc, 3, dtl_av_length(av));
+   CuAssertUIntEquals(tc, 0x12345678, dtl_sv_get_u32((dtl_sv_t*) *dtl_av_get(av, 0)));
+   CuAssertIntEquals(tc, -1, dtl_sv_get_i32((dtl_sv_t*) *dtl_av_get(av, 1)));
+   CuAssertStrEquals(tc, "ab", dtl_sv_get_cstr((dtl_sv_t*) *dtl_av_get(av, 2)));
+   pResult = apx_dataElement_unpack_dv(rootElem, &data[0], &data[7], &dv);
+   CuAssertPtrEquals(tc, NULL, (void*) pResult);
+   apx_dataElement_delete(rootElem);
+   dtl_dv_delete(dv);
+}
+
+static void test_apx_dataElement_pack_array(CuTest *tc)
+{
+   apx_dataElement_t *element;
+   uint16_t values[100];
+   uint16_t result[100];
+   uint8_t buf[200];
+   int32_t i;
+
+   //S[100]
+   element = apx_dataElement_new(APX_BASE_TYPE_UINT16, 0);
+   apx_dataElement_setArrayLen(element, 100);
+   for (i = 0; i < 100; i++)
+   {
+      values[i] = (uint16_t) (0x1000 + i);
+   }
+   CuAssertPtrEquals(tc, &buf[200], apx_dataElement_pack_array(element, &buf[0], &buf[200], values));
+   CuAssertUIntEquals(tc, 0x00, buf[0]);
+   CuAssertUIntEquals(tc, 0x10, buf[1]);
+   CuAssertUIntEquals(tc, 0x63, buf[198]);
+   CuAssertUIntEquals(tc, 0x10, buf[199]);
+   memset(result, 0, sizeof(result));
+   CuAssertPtrEquals(tc, (void*) &buf[200], (void*) apx_dataElement_unpack_array(element, &buf[0], &buf[200], result));
+   CuAssertIntEquals(tc, 0, memcmp(values, result, sizeof(values)));
+   CuAssertPtrEquals(tc, NULL, apx_dataElement_pack_array(element, &buf[0], &buf[199], values));
+   apx_dataElement_delete(element);
+
+   //strings and records are not numeric arrays
+   element = apx_dataElement_new(APX_BASE_TYPE_STRING, 0);
+   apx_dataElement_setArrayLen(element, 10);
+   CuAssertPtrEquals(tc, NULL, apx_dataElement_pack_array(element, &buf[0], &buf[200], values));
+   apx_dataElement_delete(element);
+}
@@ -0,0 +1,680 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx_dataProgram.h"
+#include "apx_dataSignature.h"
+
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_apx_dataProgram_compileScalar(CuTest *tc);
+static void test_apx_dataProgram_fuseRecordFields(CuTest *tc);
+static void test_apx_dataProgram_packRecord(CuTest *tc);
+static void test_apx_dataProgram_packNested(CuTest *tc);
+static void test_apx_dataProgram_packRecordArray(CuTest *tc);
+static void test_apx_dataProgram_packErrors(CuTest *tc);
+static void test_apx_dataProgram_unpackScalar(CuTest *tc);
+static void test_apx_dataProgram_unpackRecordArray(CuTest *tc);
+static void test_apx_dataProgram_unpackStruct(CuTest *tc);
+static void test_apx_dataProgram_unpackNestedStruct(CuTest *tc);
+static void test_apx_dataProgram_packStruct(CuTest *tc);
+static void verifyInstruction(CuTest *tc, const apx_dataInstruction_t *instruction, uint8_t opcode, uint8_t flags, uint32_t offset, uint32_t length, uint32_t count);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+
+CuSuite* testSuite_apx_dataProgram(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_apx_dataProgram_compileScalar);
+   SUITE_ADD_TEST(suite, test_apx_dataProgram_fuseRecordFields);
+   SUITE_ADD_TEST(suite, test_apx_dataProgram_packRecord);
+   SUITE_ADD_TEST(suite, test_apx_dataProgram_packNested);
+   SUITE_ADD_TEST(suite, test_apx_dataProgram_packRecordArray);
+   SUITE_ADD_TEST(suite, test_apx_dataProgram_packErrors);
+   SUITE_ADD_TEST(suite, test_apx_dataProgram_unpackScalar);
+   SUITE_ADD_TEST(suite, test_apx_dataProgram_unpackRecordArray);
+   SUITE_ADD_TEST(suite, test_apx_dataProgram_unpackStruct);
+   SUITE_ADD_TEST(suite, test_apx_dataProgram_unpackNestedStruct);
+   SUITE_ADD_TEST(suite, test_apx_dataProgram_packStruct);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_apx_dataProgram_compileScalar(CuTest *tc)
+{
+   apx_dataSignature_t *dsg;
+   uint8_t buf[8];
+   dtl_sv_t *sv;
+   dtl_av_t *av;
+
+   dsg = apx_dataSignature_new("S");
+   CuAssertPtrNotNull(tc, dsg);
+   CuAssertPtrNotNull(tc, dsg->dataProgram);
+   CuAssertUIntEquals(tc, 1, apx_dataProgram_length(dsg->dataProgram));
+   verifyInstruction(tc, &dsg->dataProgram->instructions[0], APX_DATA_OP_U16, 0, 0, 2, 1);
+   CuAssertUIntEquals(tc, apx_dataSignature_packLen(dsg), dsg->dataProgram->packLen);
+   sv = dtl_sv_make_u32(0x1234);
+   CuAssertPtrEquals(tc, &buf[2], apx_dataSignature_pack_dv(dsg, &buf[0], &buf[8], (dtl_dv_t*) sv));
+   CuAssertIntEquals(tc, 0x34, buf[0]);
+   CuAssertIntEquals(tc, 0x12, buf[1]);
+   dtl_sv_delete(sv);
+
+   //a primitive array is a single instruction
+   CuAssertIntEquals(tc, 0, apx_dataSignature_update(dsg, "l[2]"));
+   CuAssertPtrNotNull(tc, dsg->dataProgram);
+   CuAssertUIntEquals(tc, 1, apx_dataProgram_length(dsg->dataProgram));
+   verifyInstruction(tc, &dsg->dataProgram->instructions[0], APX_DATA_OP_S32, APX_DATA_FLAG_ARRAY, 0, 4, 2);
+   av = dtl_av_new();
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_i32(-1));
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_i32(2));
+   CuAssertPtrEquals(tc, &buf[8], apx_dataSignature_pack_dv(dsg, &buf[0], &buf[8], (dtl_dv_t*) av));
+   CuAssertIntEquals(tc, 0xFF, buf[0]);
+   CuAssertIntEquals(tc, 0xFF, buf[3]);
+   CuAssertIntEquals(tc, 2, buf[4]);
+   CuAssertIntEquals(tc, 0, buf[7]);
+   dtl_av_delete(av);
+
+   //strings
+   CuAssertIntEquals(tc, 0, apx_dataSignature_update(dsg, "a[6]"));
+   CuAssertPtrNotNull(tc, dsg->dataProgram);
+   verifyInstruction(tc, &dsg->dataProgram->instructions[0], APX_DATA_OP_STRING, 0, 0, 6, 1);
+   memset(buf, 0xFF, sizeof(buf));
+   sv = dtl_sv_make_cstr("abc");
+   CuAssertPtrEquals(tc, &buf[6], apx_dataSignature_pack_dv(dsg, &buf[0], &buf[8], (dtl_dv_t*) sv));
+   CuAssertIntEquals(tc, 'a', buf[0]);
+   CuAssertIntEquals(tc, 'c', buf[2]);
+   CuAssertIntEquals(tc, 0, buf[3]);
+   CuAssertIntEquals(tc, 0, buf[5]);
+   CuAssertIntEquals(tc, 0xFF, buf[6]);
+   dtl_sv_delete(sv);
+
+   apx_dataSignature_delete(dsg);
+}
+
+static void test_apx_dataProgram_fuseRecordFields(CuTest *tc)
+{
+   apx_dataSignature_t *dsg;
+   apx_dataInstruction_t *instructions;
+
+   dsg = apx_dataSignature_new("{\"a\"C\"b\"C\"c\"S\"d\"S\"e\"S(0,7)\"f\"L\"g\"C[2]\"h\"C\"i\"a[4]}");
+   CuAssertPtrNotNull(tc, dsg);
+   CuAssertPtrNotNull(tc, dsg->dataProgram);
+   CuAssertUIntEquals(tc, 8, apx_dataProgram_length(dsg->dataProgram));
+   instructions = dsg->dataProgram->instructions;
+   verifyInstruction(tc, &instructions[0], APX_DATA_OP_RECORD, 0, 0, 19, 9);
+   verifyInstruction(tc, &instructions[1], APX_DATA_OP_U8, 0, 0, 1, 2);
+   verifyInstruction(tc, &instructions[2], APX_DATA_OP_U16, 0, 2, 2, 3);
+   verifyInstruction(tc, &instructions[3], APX_DATA_OP_U32, 0, 8, 4, 1);
+   verifyInstruction(tc, &instructions[4], APX_DATA_OP_U8, APX_DATA_FLAG_ARRAY, 12, 1, 2);
+   verifyInstruction(tc, &instructions[5], APX_DATA_OP_U8, 0, 14, 1, 1);
+   verifyInstruction(tc, &instructions[6], APX_DATA_OP_STRING, 0, 15, 4, 1);
+   verifyInstruction(tc, &instructions[7], APX_DATA_OP_END, 0, 0, 0, 0);
+   CuAssertUIntEquals(tc, 19, dsg->dataProgram->packLen);
+   CuAssertUIntEquals(tc, 19, apx_dataSignature_packLen(dsg));
+   apx_dataSignature_delete(dsg);
+}
+
+static void test_apx_dataProgram_packRecord(CuTest *tc)
+{
+   apx_dataSignature_t *dsg;
+   dtl_av_t *av;
+   dtl_av_t *av1;
+   dtl_av_t *bad;
+   int32_t i;
+   uint8_t expected[12];
+   uint8_t actual[12];
+   const uint8_t verify[12] = {0x12, 0x34, 0x02, 0x01, 0x04, 0x03, 0xFE, 0xFF, 'x', 'y', 0, 7};
+
+   dsg = apx_dataSignature_new("{\"a\"C\"b\"C\"c\"S\"d\"S\"e\"s\"f\"a[3]\"g\"c}");
+   CuAssertPtrNotNull(tc, dsg);
+   CuAssertPtrNotNull(tc, dsg->dataProgram);
+   av = dtl_av_new();
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_u32(0x12));
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_u32(0x34));
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_u32(0x0102));
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_u32(0x0304));
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_i32(-2));
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_cstr("xy"));
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_i32(7));
+   memset(expected, 0xAA, sizeof(expected));
+   memset(actual, 0xAA, sizeof(actual));
+   CuAssertPtrEquals(tc, &expected[12], apx_dataElement_pack_dv(dsg->dataElement, &expected[0], &expected[12], (dtl_dv_t*) av));
+   CuAssertPtrEquals(tc, &actual[12], apx_dataProgram_pack_dv(dsg->dataProgram, &actual[0], &actual[12], (dtl_dv_t*) av));
+   CuAssertTrue(tc, memcmp(verify, actual, sizeof(actual)) == 0);
+   CuAssertTrue(tc, memcmp(expected, actual, sizeof(actual)) == 0);
+
+   //a record field must be a scalar
+   bad = dtl_av_new();
+   for (i = 0; i < 7; i++)
+   {
+      if (i == 3)
+      {
+         av1 = dtl_av_new();
+         dtl_av_push(av1, (dtl_dv_t*) dtl_sv_make_u32(1));
+         dtl_av_push(bad, (dtl_dv_t*) av1);
+      }
+      else
+      {
+         dtl_av_push(bad, (dtl_dv_t*) dtl_sv_make_u32(1));
+      }
+   }
+   CuAssertPtrEquals(tc, NULL, apx_dataProgram_pack_dv(dsg->dataProgram, &actual[0], &actual[12], (dtl_dv_t*) bad));
+   dtl_av_delete(bad);
+   dtl_av_delete(av);
+   apx_dataSignature_delete(dsg);
+}
+
+static void test_apx_dataProgram_packNested(CuTest *tc)
+{
+   apx_dataElement_t *rootElem;
+   apx_dataElement_t *childElem;
+   apx_dataElement_t *grandChildElem;
+   apx_dataProgram_t program;
+   dtl_av_t *av;
+   dtl_av_t *av1;
+   uint8_t expected[15];
+   uint8_t actual[15];
+
+   //{"a"L"b"{"c"C"d"a[9]}"e"C}
+   rootElem = apx_dataElement_new(APX_BASE_TYPE_RECORD, 0);
+   childElem = apx_dataElement_new(APX_BASE_TYPE_RECORD, 0);
+   apx_dataElement_appendChild(childElem, apx_dataElement_new(APX_BASE_TYPE_UINT8, 0));
+   grandChildElem = apx_dataElement_new(APX_BASE_TYPE_STRING, 0);
+   apx_dataElement_setArrayLen(grandChildElem, 9);
+   apx_dataElement_appendChild(childElem, grandChildElem);
+   apx_dataElement_appendChild(rootElem, apx_dataElement_new(APX_BASE_TYPE_UINT32, 0));
+   apx_dataElement_appendChild(rootElem, childElem);
+   apx_dataElement_appendChild(rootElem, apx_dataElement_new(APX_BASE_TYPE_UINT8, 0));
+
+   apx_dataProgram_create(&program);
+   CuAssertIntEquals(tc, 0, apx_dataProgram_compile(&program, rootElem));
+   CuAssertUIntEquals(tc, 8, apx_dataProgram_length(&program));
+   verifyInstruction(tc, &program.instructions[0], APX_DATA_OP_RECORD, 0, 0, 15, 3);
+   verifyInstruction(tc, &program.instructions[1], APX_DATA_OP_U32, 0, 0, 4, 1);
+   verifyInstruction(tc, &program.instructions[2], APX_DATA_OP_RECORD, 0, 4, 10, 2);
+   verifyInstruction(tc, &program.instructions[3], APX_DATA_OP_U8, 0, 4, 1, 1);
+   verifyInstruction(tc, &program.instructions[4], APX_DATA_OP_STRING, 0, 5, 9, 1);
+   verifyInstruction(tc, &program.instructions[5], APX_DATA_OP_END, 0, 0, 0, 0);
+   //the last field must not be fused with the field of the nested record
+   verifyInstruction(tc, &program.instructions[6], APX_DATA_OP_U8, 0, 14, 1, 1);
+   verifyInstruction(tc, &program.instructions[7], APX_DATA_OP_END, 0, 0, 0, 0);
+
+   av1 = dtl_av_new();
+   dtl_av_push(av1, (dtl_dv_t*) dtl_sv_make_i32(3));
+   dtl_av_push(av1, (dtl_dv_t*) dtl_sv_make_cstr("        "));
+   av = dtl_av_new();
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_u32(0xFFFFFFFF));
+   dtl_av_push(av, (dtl_dv_t*) av1);
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_u32(9));
+   memset(expected, 0, sizeof(expected));
+   memset(actual, 0, sizeof(actual));
+   CuAssertPtrEquals(tc, &expected[15], apx_dataElement_pack_dv(rootElem, &expected[0], &expected[15], (dtl_dv_t*) av));
+   CuAssertPtrEquals(tc, &actual[15], apx_dataProgram_pack_dv(&program, &actual[0], &actual[15], (dtl_dv_t*) av));
+   CuAssertTrue(tc, memcmp(expected, actual, sizeof(actual)) == 0);
+   CuAssertIntEquals(tc, 3, actual[4]);
+   CuAssertIntEquals(tc, 9, actual[14]);
+
+   apx_dataProgram_destroy(&program);
+   apx_dataElement_delete(rootElem);
+   dtl_av_delete(av);
+}
+
+static void test_apx_dataProgram_packRecordArray(CuTest *tc)
+{
+   apx_dataElement_t *rootElement;
+   apx_dataElement_t *childElem;
+   apx_dataProgram_t *program;
+   dtl_av_t *av;
+   int32_t i;
+   uint8_t expected[(4+3+2)*3];
+   uint8_t actual[(4+3+2)*3];
+
+   //{LC[3]SS}[3]
+   rootElement = apx_dataElement_new(APX_BASE_TYPE_RECORD, 0);
+   apx_dataElement_appendChild(rootElement, apx_dataElement_new(APX_BASE_TYPE_UINT32, 0));
+   childElem = apx_dataElement_new(APX_BASE_TYPE_UINT8, 0);
+   apx_dataElement_setArrayLen(childElem, 3);
+   apx_dataElement_appendChild(rootElement, childElem);
+   apx_dataElement_appendChild(rootElement, apx_dataElement_new(APX_BASE_TYPE_UINT8, 0));
+   apx_dataElement_appendChild(rootElement, apx_dataElement_new(APX_BASE_TYPE_UINT8, 0));
+   apx_dataElement_setArrayLen(rootElement, 3);
+
+   program = apx_dataProgram_new();
+   CuAssertPtrNotNull(tc, program);
+   CuAssertIntEquals(tc, 0, apx_dataProgram_compile(program, rootElement));
+   CuAssertUIntEquals(tc, 7, apx_dataProgram_length(program));
+   CuAssertUIntEquals(tc, sizeof(actual), program->packLen);
+   verifyInstruction(tc, &program->instructions[0], APX_DATA_OP_ARRAY, 0, 0, 9, 3);
+   verifyInstruction(tc, &program->instructions[1], APX_DATA_OP_RECORD, 0, 0, 9, 4);
+   verifyInstruction(tc, &program->instructions[2], APX_DATA_OP_U32, 0, 0, 4, 1);
+   verifyInstruction(tc, &program->instructions[3], APX_DATA_OP_U8, APX_DATA_FLAG_ARRAY, 4, 1, 3);
+   verifyInstruction(tc, &program->instructions[4], APX_DATA_OP_U8, 0, 7, 1, 2);
+   verifyInstruction(tc, &program->instructions[5], APX_DATA_OP_END, 0, 0, 0, 0);
+   verifyInstruction(tc, &program->instructions[6], APX_DATA_OP_END, 0, 0, 0, 0);
+
+   av = dtl_av_new();
+   for (i = 0; i < 3; i++)
+   {
+      dtl_av_t *record = dtl_av_new();
+      dtl_av_t *bytes = dtl_av_new();
+      dtl_av_push(record, (dtl_dv_t*) dtl_sv_make_u32(0x12345678u + (uint32_t) i));
+      dtl_av_push(bytes, (dtl_dv_t*) dtl_sv_make_i32(i*3+1));
+      dtl_av_push(bytes, (dtl_dv_t*) dtl_sv_make_i32(i*3+2));
+      dtl_av_push(bytes, (dtl_dv_t*) dtl_sv_make_i32(i*3+3));
+      dtl_av_push(record, (dtl_dv_t*) bytes);
+      dtl_av_push(record, (dtl_dv_t*) dtl_sv_make_i32(100+i));
+      dtl_av_push(record, (dtl_dv_t*) dtl_sv_make_i32(200+i));
+      dtl_av_push(av, (dtl_dv_t*) record);
+   }
+   memset(expected, 0, sizeof(expected));
+   memset(actual, 0, sizeof(actual));
+   CuAssertPtrEquals(tc, &expected[sizeof(expected)], apx_dataElement_pack_dv(rootElement, &expected[0], &expected[sizeof(expected)], (dtl_dv_t*) av));
+   CuAssertPtrEquals(tc, &actual[sizeof(actual)], apx_dataProgram_pack_dv(program, &actual[0], &actual[sizeof(actual)], (dtl_dv_t*) av));
+   CuAssertTrue(tc, memcmp(expected, actual, sizeof(actual)) == 0);
+   CuAssertIntEquals(tc, 0x7A, actual[18]);
+   CuAssertIntEquals(tc, 7, actual[22]);
+   CuAssertIntEquals(tc, 102, actual[25]);
+   CuAssertIntEquals(tc, 202, actual[26]);
+
+   apx_dataProgram_delete(program);
+   apx_dataElement_delete(rootElement);
+   dtl_av_delete(av);
+}
+
+static void test_apx_dataProgram_packErrors(CuTest *tc)
+{
+   apx_dataSignature_t *dsg;
+   dtl_av_t *av;
+   dtl_av_t *av2;
+   dtl_av_t *bytes;
+   dtl_sv_t *sv;
+   uint8_t buf[8];
+
+   dsg = apx_dataSignature_new("{\"a\"S\"b\"C[2]}");
+   CuAssertPtrNotNull(tc, dsg);
+   CuAssertPtrNotNull(tc, dsg->dataProgram);
+   av = dtl_av_new();
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_u32(1));
+   sv = dtl_sv_make_u32(1);
+
+   //wrong number of record fields
+   CuAssertPtrEquals(tc, NULL, apx_dataProgram_pack_dv(dsg->dataProgram, &buf[0], &buf[8], (dtl_dv_t*) av));
+   //record from scalar
+   CuAssertPtrEquals(tc, NULL, apx_dataProgram_pack_dv(dsg->dataProgram, &buf[0], &buf[8], (dtl_dv_t*) sv));
+   //array from scalar
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_u32(2));
+   CuAssertPtrEquals(tc, NULL, apx_dataProgram_pack_dv(dsg->dataProgram, &buf[0], &buf[8], (dtl_dv_t*) av));
+   //buffer too small
+   av2 = dtl_av_new();
+   bytes = dtl_av_new();
+   dtl_av_push(bytes, (dtl_dv_t*) dtl_sv_make_u32(3));
+   dtl_av_push(bytes, (dtl_dv_t*) dtl_sv_make_u32(4));
+   dtl_av_push(av2, (dtl_dv_t*) dtl_sv_make_u32(1));
+   dtl_av_push(av2, (dtl_dv_t*) bytes);
+   CuAssertPtrEquals(tc, NULL, apx_dataProgram_pack_dv(dsg->dataProgram, &buf[0], &buf[3], (dtl_dv_t*) av2));
+   CuAssertPtrEquals(tc, &buf[4], apx_dataProgram_pack_dv(dsg->dataProgram, &buf[0], &buf[4], (dtl_dv_t*) av2));
+   CuAssertIntEquals(tc, 1, buf[0]);
+   CuAssertIntEquals(tc, 0, buf[1]);
+   CuAssertIntEquals(tc, 3, buf[2]);
+   CuAssertIntEquals(tc, 4, buf[3]);
+
+   //a signature that fails to parse has no program
+   CuAssertIntEquals(tc, 0, apx_dataSignature_update(dsg, "{\"a\"S\"b\"X}"));
+   CuAssertPtrEquals(tc, NULL, dsg->dataProgram);
+
+   dtl_av_delete(av);
+   dtl_av_delete(av2);
+   dtl_sv_delete(sv);
+   apx_dataSignature_delete(dsg);
+}
+
+static void test_apx_dataProgram_unpackScalar(CuTest *tc)
+{
+   apx_dataSignature_t *dsg;
+   dtl_dv_t *dv = 0;
+   dtl_dv_t *reused;
+   const uint8_t data1[8] = {0xFE, 0xFF, 0x02, 0x00, 0x00, 0x80, 0, 0};
+   const uint8_t data2[8] = {'a', 'b', 'c', 0, 'x', 'x', 0, 0};
+
+   dsg = apx_dataSignature_new("s");
+   CuAssertPtrNotNull(tc, dsg);
+   CuAssertPtrEquals(tc, (void*) &data1[2], (void*) apx_dataSignature_unpack_dv(dsg, &data1[0], &data1[8], &dv));
+   CuAssertPtrNotNull(tc, dv);
+   CuAssertIntEquals(tc, DTL_DV_SCALAR, dtl_dv_type(dv));
+   CuAssertIntEquals(tc, -2, dtl_sv_get_i32((dtl_sv_t*) dv));
+   //the scalar is reused
+   reused = dv;
+   CuAssertPtrEquals(tc, (void*) &data1[4], (void*) apx_dataSignature_unpack_dv(dsg, &data1[2], &data1[8], &dv));
+   CuAssertPtrEquals(tc, reused, dv);
+   CuAssertIntEquals(tc, 2, dtl_sv_get_i32((dtl_sv_t*) dv));
+   //a buffer that is too small
+   CuAssertPtrEquals(tc, NULL, (void*) apx_dataSignature_unpack_dv(dsg, &data1[0], &data1[1], &dv));
+
+   //primitive array
+   CuAssertIntEquals(tc, 0, apx_dataSignature_update(dsg, "S[3]"));
+   //the previous value has the wrong type
+   CuAssertPtrEquals(tc, NULL, (void*) apx_dataSignature_unpack_dv(dsg, &data1[0], &data1[8], &dv));
+   dtl_dv_delete(dv);
+   dv = 0;
+   CuAssertPtrEquals(tc, (void*) &data1[6], (void*) apx_dataSignature_unpack_dv(dsg, &data1[0], &data1[8], &dv));
+   CuAssertIntEquals(tc, DTL_DV_ARRAY, dtl_dv_type(dv));
+   CuAssertIntEquals(tc, 3, dtl_av_length((dtl_av_t*) dv));
+   CuAssertUIntEquals(tc, 0xFFFE, dtl_sv_get_u32((dtl_sv_t*) *dtl_av_get((dtl_av_t*) dv, 0)));
+   CuAssertUIntEquals(tc, 2, dtl_sv_get_u32((dtl_sv_t*) *dtl_av_get((dtl_av_t*) dv, 1)));
+   CuAssertUIntEquals(tc, 0x8000, dtl_sv_get_u32((dtl_sv_t*) *dtl_av_get((dtl_av_t*) dv, 2)));
+   dtl_dv_delete(dv);
+   dv = 0;
+
+   //string, the null-terminator ends the string
+   CuAssertIntEquals(tc, 0, apx_dataSignature_update(dsg, "a[6]"));
+   CuAssertPtrEquals(tc, (void*) &data2[6], (void*) apx_dataSignature_unpack_dv(dsg, &data2[0], &data2[8], &dv));
+   CuAssertStrEquals(tc, "abc", dtl_sv_get_cstr((dtl_sv_t*) dv));
+   //a string that fills the field
+   CuAssertIntEquals(tc, 0, apx_dataSignature_update(dsg, "a[3]"));
+   CuAssertPtrEquals(tc, (void*) &data2[3], (void*) apx_dataSignature_unpack_dv(dsg, &data2[0], &data2[8], &dv));
+   CuAssertStrEquals(tc, "abc", dtl_sv_get_cstr((dtl_sv_t*) dv));
+   dtl_dv_delete(dv);
+
+   apx_dataSignature_delete(dsg);
+}
+
+static void test_apx_dataProgram_unpackRecordArray(CuTest *tc)
+{
+   apx_dataElement_t *rootElement;
+   apx_dataElement_t *childElem;
+   apx_dataProgram_t *program;
+   dtl_av_t *av;
+   dtl_dv_t *dv = 0;
+   dtl_av_t *record;
+   dtl_dv_t *field;
+   int32_t i;
+   uint8_t packed[(4+3+2)*3];
+   uint8_t repacked[(4+3+2)*3];
+
+   //{"a"L"b"C[3]"c"s"d"c}[3]
+   rootElement = apx_dataElement_new(APX_BASE_TYPE_RECORD, 0);
+   apx_dataElement_appendChild(rootElement, apx_dataElement_new(APX_BASE_TYPE_UINT32, 0));
+   childElem = apx_dataElement_new(APX_BASE_TYPE_UINT8, 0);
+   apx_dataElement_setArrayLen(childElem, 3);
+   apx_dataElement_appendChild(rootElement, childElem);
+   apx_dataElement_appendChild(rootElement, apx_dataElement_new(APX_BASE_TYPE_SINT8, 0));
+   apx_dataElement_appendChild(rootElement, apx_dataElement_new(APX_BASE_TYPE_SINT8, 0));
+   apx_dataElement_setArrayLen(rootElement, 3);
+   program = apx_dataProgram_new();
+   CuAssertIntEquals(tc, 0, apx_dataProgram_compile(program, rootElement));
+
+   av = dtl_av_new();
+   for (i = 0; i < 3; i++)
+   {
+      dtl_av_t *bytes = dtl_av_new();
+      record = dtl_av_new();
+      dtl_av_push(record, (dtl_dv_t*) dtl_sv_make_u32(0x12345678u + (uint32_t) i));
+      dtl_av_push(bytes, (dtl_dv_t*) dtl_sv_make_i32(i*3+1));
+      dtl_av_push(bytes, (dtl_dv_t*) dtl_sv_make_i32(i*3+2));
+      dtl_av_push(bytes, (dtl_dv_t*) dtl_sv_make_i32(i*3+3));
+      dtl_av_push(record, (dtl_dv_t*) bytes);
+      dtl_av_push(record, (dtl_dv_t*) dtl_sv_make_i32(-i));
+      dtl_av_push(record, (dtl_dv_t*) dtl_sv_make_i32(-100-i));
+      dtl_av_push(av, (dtl_dv_t*) record);
+   }
+   CuAssertPtrEquals(tc, &packed[sizeof(packed)], apx_dataProgram_pack_dv(program, &packed[0], &packed[sizeof(packed)], (dtl_dv_t*) av));
+   dtl_av_delete(av);
+
+   CuAssertPtrEquals(tc, (void*) &packed[sizeof(packed)], (void*) apx_dataProgram_unpack_dv(program, &packed[0], &packed[sizeof(packed)], &dv));
+   CuAssertIntEquals(tc, DTL_DV_ARRAY, dtl_dv_type(dv));
+   CuAssertIntEquals(tc, 3, dtl_av_length((dtl_av_t*) dv));
+   record = (dtl_av_t*) *dtl_av_get((dtl_av_t*) dv, 2);
+   CuAssertIntEquals(tc, 4, dtl_av_length(record));
+   CuAssertUIntEquals(tc, 0x1234567A, dtl_sv_get_u32((dtl_sv_t*) *dtl_av_get(record, 0)));
+   CuAssertIntEquals(tc, 3, dtl_av_length((dtl_av_t*) *dtl_av_get(record, 1)));
+   CuAssertIntEquals(tc, -2, dtl_sv_get_i32((dtl_sv_t*) *dtl_av_get(record, 2)));
+   CuAssertIntEquals(tc, -102, dtl_sv_get_i32((dtl_sv_t*) *dtl_av_get(record, 3)));
+   CuAssertPtrEquals(tc, &repacked[sizeof(repacked)], apx_dataProgram_pack_dv(program, &repacked[0], &repacked[sizeof(repacked)], dv));
+   CuAssertTrue(tc, memcmp(packed, repacked, sizeof(packed)) == 0);
+
+   //decode new data into the same containers
+   field = *dtl_av_get((dtl_av_t*) *dtl_av_get(record, 1), 2);
+   packed[sizeof(packed)-3] = 99;
+   CuAssertPtrEquals(tc, (void*) &packed[sizeof(packed)], (void*) apx_dataProgram_unpack_dv(program, &packed[0], &packed[sizeof(packed)], &dv));
+   CuAssertPtrEquals(tc, record, *dtl_av_get((dtl_av_t*) dv, 2));
+   CuAssertPtrEquals(tc, field, *dtl_av_get((dtl_av_t*) *dtl_av_get(record, 1), 2));
+   CuAssertUIntEquals(tc, 99, dtl_sv_get_u32((dtl_sv_t*) field));
+
+   dtl_dv_delete(dv);
+   apx_dataProgram_delete(program);
+   apx_dataElement_delete(rootElement);
+}
+
+static void test_apx_dataProgram_unpackStruct(CuTest *tc)
+{
+   typedef struct
+   {
+      uint8_t a;
+      uint16_t b;
+      int32_t c;
+      char d[5];
+      uint8_t e[3];
+      int16_t f;
+   }record_t;
+   typedef struct
+   {
+      uint32_t a;
+      uint8_t b[3];
+      uint8_t c;
+      uint8_t d;
+   }element_t;
+   apx_dataSignature_t *dsg;
+   apx_dataElement_t *rootElement;
+   apx_dataElement_t *childElem;
+   apx_dataProgram_t program;
+   record_t record;
+   element_t elements[3];
+   uint16_t u16;
+   const uint8_t data[17] = {7, 0x34, 0x12, 0xFE, 0xFF, 0xFF, 0xFF, 'a', 'b', 0, 0, 0, 1, 2, 3, 0x00, 0x80};
+   uint8_t packed[(4+3+2)*3];
+   int32_t i;
+
+   dsg = apx_dataSignature_new("{\"a\"C\"b\"S\"c\"l\"d\"a[5]\"e\"C[3]\"f\"s}");
+   CuAssertPtrNotNull(tc, dsg);
+   CuAssertPtrNotNull(tc, dsg->dataProgram);
+   CuAssertUIntEquals(tc, sizeof(record_t), dsg->dataProgram->structSize);
+   memset(&record, 0xAA, sizeof(record));
+   CuAssertPtrEquals(tc, (void*) &data[17], (void*) apx_dataSignature_unpack_struct(dsg, &data[0], &data[17], &record, (uint32_t) sizeof(record)));
+   CuAssertUIntEquals(tc, 7, record.a);
+   CuAssertUIntEquals(tc, 0x1234, record.b);
+   CuAssertIntEquals(tc, -2, record.c);
+   CuAssertStrEquals(tc, "ab", record.d);
+   CuAssertUIntEquals(tc, 1, record.e[0]);
+   CuAssertUIntEquals(tc, 3, record.e[2]);
+   CuAssertIntEquals(tc, -32768, record.f);
+   //struct too small
+   CuAssertPtrEquals(tc, NULL, (void*) apx_dataSignature_unpack_struct(dsg, &data[0], &data[17], &record, (uint32_t) sizeof(record)-1));
+
+   //scalar signature
+   CuAssertIntEquals(tc, 0, apx_dataSignature_update(dsg, "S"));
+   CuAssertUIntEquals(tc, sizeof(uint16_t), dsg->dataProgram->structSize);
+   CuAssertPtrEquals(tc, (void*) &data[3], (void*) apx_dataSignature_unpack_struct(dsg, &data[1], &data[17], &u16, (uint32_t) sizeof(u16)));
+   CuAssertUIntEquals(tc, 0x1234, u16);
+   apx_dataSignature_delete(dsg);
+
+   //{"a"L"b"C[3]"c"C"d"C}[3]
+   rootElement = apx_dataElement_new(APX_BASE_TYPE_RECORD, 0);
+   apx_dataElement_appendChild(rootElement, apx_dataElement_new(APX_BASE_TYPE_UINT32, 0));
+   childElem = apx_dataElement_new(APX_BASE_TYPE_UINT8, 0);
+   apx_dataElement_setArrayLen(childElem, 3);
+   apx_dataElement_appendChild(rootElement, childElem);
+   apx_dataElement_appendChild(rootElement, apx_dataElement_new(APX_BASE_TYPE_UINT8, 0));
+   apx_dataElement_appendChild(rootElement, apx_dataElement_new(APX_BASE_TYPE_UINT8, 0));
+   apx_dataElement_setArrayLen(rootElement, 3);
+   apx_dataProgram_create(&program);
+   CuAssertIntEquals(tc, 0, apx_dataProgram_compile(&program, rootElement));
+   CuAssertUIntEquals(tc, sizeof(elements), program.structSize);
+   CuAssertUIntEquals(tc, sizeof(element_t), program.instructions[0].structLength);
+   for (i = 0; i < (int32_t) sizeof(packed); i++)
+   {
+      packed[i] = (uint8_t) i;
+   }
+   memset(elements, 0, sizeof(elements));
+   CuAssertPtrEquals(tc, (void*) &packed[sizeof(packed)], (void*) apx_dataProgram_unpack_struct(&program, &packed[0], &packed[sizeof(packed)], elements, (uint32_t) sizeof(elements)));
+   for (i = 0; i < 3; i++)
+   {
+      uint8_t first = (uint8_t) (i*9);
+      CuAssertUIntEquals(tc, (uint32_t) first | ((uint32_t) (first+1) << 8) | ((uint32_t) (first+2) << 16) | ((uint32_t) (first+3) << 24), elements[i].a);
+      CuAssertUIntEquals(tc, first+4, elements[i].b[0]);
+      CuAssertUIntEquals(tc, first+6, elements[i].b[2]);
+      CuAssertUIntEquals(tc, first+7, elements[i].c);
+      CuAssertUIntEquals(tc, first+8, elements[i].d);
+   }
+   apx_dataProgram_destroy(&program);
+   apx_dataElement_delete(rootElement);
+}
+
+static void test_apx_dataProgram_unpackNestedStruct(CuTest *tc)
+{
+   typedef struct
+   {
+      uint32_t a;
+      struct
+      {
+         uint8_t c;
+         char d[9];
+      }b;
+      uint8_t e;
+   }nested_t;
+   apx_dataElement_t *rootElem;
+   apx_dataElement_t *childElem;
+   apx_dataElement_t *grandChildElem;
+   apx_dataProgram_t program;
+   nested_t nested;
+   const uint8_t data[15] = {1, 0, 0, 0, 2, 'h', 'e', 'l', 'l', 'o', 0, 0, 0, 0, 3};
+
+   //{"a"L"b"{"c"C"d"a[9]}"e"C}
+   rootElem = apx_dataElement_new(APX_BASE_TYPE_RECORD, 0);
+   childElem = apx_dataElement_new(APX_BASE_TYPE_RECORD, 0);
+   apx_dataElement_appendChild(childElem, apx_dataElement_new(APX_BASE_TYPE_UINT8, 0));
+   grandChildElem = apx_dataElement_new(APX_BASE_TYPE_STRING, 0);
+   apx_dataElement_setArrayLen(grandChildElem, 9);
+   apx_dataElement_appendChild(childElem, grandChildElem);
+   apx_dataElement_appendChild(rootElem, apx_dataElement_new(APX_BASE_TYPE_UINT32, 0));
+   apx_dataElement_appendChild(rootElem, childElem);
+   apx_dataElement_appendChild(rootElem, apx_dataElement_new(APX_BASE_TYPE_UINT8, 0));
+
+   apx_dataProgram_create(&program);
+   CuAssertIntEquals(tc, 0, apx_dataProgram_compile(&program, rootElem));
+   CuAssertUIntEquals(tc, sizeof(nested_t), program.structSize);
+   CuAssertUIntEquals(tc, offsetof(nested_t, b), program.instructions[2].structOffset);
+   CuAssertUIntEquals(tc, offsetof(nested_t, e), program.instructions[6].structOffset);
+   memset(&nested, 0, sizeof(nested));
+   CuAssertPtrEquals(tc, (void*) &data[15], (void*) apx_dataProgram_unpack_struct(&program, &data[0], &data[15], &nested, (uint32_t) sizeof(nested)));
+   CuAssertUIntEquals(tc, 1, nested.a);
+   CuAssertUIntEquals(tc, 2, nested.b.c);
+   CuAssertStrEquals(tc, "hello", nested.b.d);
+   CuAssertUIntEquals(tc, 3, nested.e);
+   apx_dataProgram_destroy(&program);
+   apx_dataElement_delete(rootElem);
+}
+
+static void test_apx_dataProgram_packStruct(CuTest *tc)
+{
+   typedef struct
+   {
+      uint8_t a;
+      uint16_t b;
+      int32_t c;
+      char d[5];
+      uint16_t e[20];
+      int16_t f;
+   }record_t;
+   apx_dataSignature_t *dsg;
+   record_t record;
+   record_t result;
+   uint8_t packed[1+2+4+5+40+2];
+   uint8_t expected[sizeof(packed)];
+   dtl_av_t *av;
+   dtl_av_t *array;
+   int32_t i;
+
+   dsg = apx_dataSignature_new("{\"a\"C\"b\"S\"c\"l\"d\"a[5]\"e\"S[20]\"f\"s}");
+   CuAssertPtrNotNull(tc, dsg);
+   CuAssertPtrNotNull(tc, dsg->dataProgram);
+   memset(&record, 0, sizeof(record));
+   record.a = 7;
+   record.b = 0x1234;
+   record.c = -2;
+   strcpy(record.d, "abc");
+   record.d[4] = 'x'; //garbage after the terminator is not packed
+   for (i = 0; i < 20; i++)
+   {
+      record.e[i] = (uint16_t) (0x0102 * (i+1));
+   }
+   record.f = -32768;
+   CuAssertPtrEquals(tc, &packed[sizeof(packed)], apx_dataSignature_pack_struct(dsg, &packed[0], &packed[sizeof(packed)], &record, (uint32_t) sizeof(record)));
+
+   //same bytes as packing the equivalent dv
+   av = dtl_av_new();
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_u32(7));
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_u32(0x1234));
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_i32(-2));
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_cstr("abc"));
+   array = dtl_av_new();
+   for (i = 0; i < 20; i++)
+   {
+      dtl_av_push(array, (dtl_dv_t*) dtl_sv_make_u32((uint32_t) (0x0102 * (i+1))));
+   }
+   dtl_av_push(av, (dtl_dv_t*) array);
+   dtl_av_push(av, (dtl_dv_t*) dtl_sv_make_i32(-32768));
+   CuAssertPtrEquals(tc, &expected[sizeof(expected)], apx_dataSignature_pack_dv(dsg, &expected[0], &expected[sizeof(expected)], (dtl_dv_t*) av));
+   CuAssertIntEquals(tc, 0, memcmp(expected, packed, sizeof(packed)));
+   dtl_dv_delete((dtl_dv_t*) av);
+
+   memset(&result, 0xAA, sizeof(result));
+   CuAssertPtrEquals(tc, (void*) &packed[sizeof(packed)], (void*) apx_dataSignature_unpack_struct(dsg, &packed[0], &packed[sizeof(packed)], &result, (uint32_t) sizeof(result)));
+   CuAssertStrEquals(tc, "abc", result.d);
+   CuAssertUIntEquals(tc, 0x1234, result.b);
+   CuAssertUIntEquals(tc, 0x0102*20, result.e[19]);
+   CuAssertIntEquals(tc, -32768, result.f);
+   //buffer too small
+   CuAssertPtrEquals(tc, NULL, apx_dataSignature_pack_struct(dsg, &packed[0], &packed[sizeof(packed)-1], &record, (uint32_t) sizeof(record)));
+   apx_dataSignature_delete(dsg);
+}
+
+static void verifyInstruction(CuTest *tc, const apx_dataInstruction_t *instruction, uint8_t opcode, uint8_t flags, uint32_t offset, uint32_t length, uint32_t count)
+{
+   CuAssertUIntEquals(tc, opcode, instruction->opcode);
+   CuAssertUIntEquals(tc, flags, instruction->flags);
+   CuAssertUIntEquals(tc, offset, instruction->offset);
+   CuAssertUIntEquals(tc, length, instruction->length);
+   CuAssertUIntEquals(tc, count, instruction->count);
+}
@@ -0,0 +1,244 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#ifdef _MSC_VER
+#include <Windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#endif
+#include "CuTest.h"
+#include "osmacro.h"
+#include "apx_mpscQueue.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define NUM_PRODUCERS 4
+#define NUM_ELEMENTS_PER_PRODUCER 10000
+
+typedef struct testElement_tag
+{
+   uint32_t producerId;
+   uint32_t sequence;
+}testElement_t;
+
+typedef struct testProducer_tag
+{
+   apx_mpscQueue_t *queue;
+   uint32_t producerId;
+   uint32_t numWakeups; //number of pushes that reported wasEmpty
+   THREAD_T thread;
+#ifdef _MSC_VER
+   unsigned int threadId;
+#endif
+}testProducer_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_apx_mpscQueue_create(CuTest* tc);
+static void test_apx_mpscQueue_pushPop(CuTest* tc);
+static void test_apx_mpscQueue_wasEmpty(CuTest* tc);
+static void test_apx_mpscQueue_popMany(CuTest* tc);
+static void test_apx_mpscQueue_multipleProducers(CuTest* tc);
+static THREAD_PROTO(producerTask,arg);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+
+CuSuite* testSuite_apx_mpscQueue(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_apx_mpscQueue_create);
+   SUITE_ADD_TEST(suite, test_apx_mpscQueue_pushPop);
+   SUITE_ADD_TEST(suite, test_apx_mpscQueue_wasEmpty);
+   SUITE_ADD_TEST(suite, test_apx_mpscQueue_popMany);
+   SUITE_ADD_TEST(suite, test_apx_mpscQueue_multipleProducers);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_apx_mpscQueue_create(CuTest* tc)
+{
+   apx_mpscQueue_t queue;
+   apx_mpscQueue_t *pQueue;
+   CuAssertIntEquals(tc, -1, apx_mpscQueue_create(&queue, 0));
+   CuAssertIntEquals(tc, 0, apx_mpscQueue_create(&queue, sizeof(testElement_t)));
+   CuAssertIntEquals(tc, 0, apx_mpscQueue_length(&queue));
+   apx_mpscQueue_destroy(&queue);
+   pQueue = apx_mpscQueue_new(sizeof(testElement_t));
+   CuAssertPtrNotNull(tc, pQueue);
+   apx_mpscQueue_delete(pQueue);
+}
+
+static void test_apx_mpscQueue_pushPop(CuTest* tc)
+{
+   apx_mpscQueue_t queue;
+   testElement_t elem;
+   uint32_t i;
+   apx_mpscQueue_create(&queue, sizeof(testElement_t));
+   CuAssertTrue(tc, !apx_mpscQueue_pop(&queue, &elem));
+   //more than the old 16-bit ringbuffer limit
+   for (i=0; i<70000; i++)
+   {
+      elem.producerId = 0;
+      elem.sequence = i;
+      CuAssertIntEquals(tc, 0, apx_mpscQueue_push(&queue, &elem, 0));
+   }
+   CuAssertIntEquals(tc, 70000, apx_mpscQueue_length(&queue));
+   for (i=0; i<70000; i++)
+   {
+      CuAssertTrue(tc, apx_mpscQueue_pop(&queue, &elem));
+      CuAssertUIntEquals(tc, i, elem.sequence);
+   }
+   CuAssertTrue(tc, !apx_mpscQueue_pop(&queue, &elem));
+   CuAssertIntEquals(tc, 1, apx_allocator_getNumAllocated(&queue.nodeAllocator)); //only the stub node remains
+   CuAssertIntEquals(tc, 0, apx_mpscQueue_release(&queue, 70000));
+   //destroy frees the elements that were never popped
+   CuAssertIntEquals(tc, 0, apx_mpscQueue_push(&queue, &elem, 0));
+   apx_mpscQueue_destroy(&queue);
+}
+
+static void test_apx_mpscQueue_wasEmpty(CuTest* tc)
+{
+   apx_mpscQueue_t queue;
+   testElement_t elem = {0, 0};
+   bool wasEmpty = false;
+   apx_mpscQueue_create(&queue, sizeof(testElement_t));
+   apx_mpscQueue_push(&queue, &elem, &wasEmpty);
+   CuAssertTrue(tc, wasEmpty);
+   apx_mpscQueue_push(&queue, &elem, &wasEmpty);
+   CuAssertTrue(tc, !wasEmpty);
+   //popped but not yet released elements still count as pending, the consumer is awake
+   CuAssertTrue(tc, apx_mpscQueue_pop(&queue, &elem));
+   CuAssertTrue(tc, apx_mpscQueue_pop(&queue, &elem));
+   apx_mpscQueue_push(&queue, &elem, &wasEmpty);
+   CuAssertTrue(tc, !wasEmpty);
+   CuAssertIntEquals(tc, 1, apx_mpscQueue_release(&queue, 2));
+   CuAssertTrue(tc, apx_mpscQueue_pop(&queue, &elem));
+   CuAssertIntEquals(tc, 0, apx_mpscQueue_release(&queue, 1));
+   apx_mpscQueue_push(&queue, &elem, &wasEmpty);
+   CuAssertTrue(tc, wasEmpty);
+   apx_mpscQueue_destroy(&queue);
+}
+
+static void test_apx_mpscQueue_popMany(CuTest* tc)
+{
+   apx_mpscQueue_t queue;
+   testElement_t elems[4];
+   uint32_t i;
+   apx_mpscQueue_create(&queue, sizeof(testElement_t));
+   CuAssertIntEquals(tc, 0, apx_mpscQueue_popMany(&queue, &elems[0], 4));
+   for (i=0; i<6; i++)
+   {
+      elems[0].producerId = 0;
+      elems[0].sequence = i;
+      apx_mpscQueue_push(&queue, &elems[0], 0);
+   }
+   CuAssertIntEquals(tc, 4, apx_mpscQueue_popMany(&queue, &elems[0], 4));
+   for (i=0; i<4; i++)
+   {
+      CuAssertUIntEquals(tc, i, elems[i].sequence);
+   }
+   CuAssertIntEquals(tc, 2, apx_mpscQueue_release(&queue, 4));
+   CuAssertIntEquals(tc, 2, apx_mpscQueue_popMany(&queue, &elems[0], 4));
+   CuAssertUIntEquals(tc, 4, elems[0].sequence);
+   CuAssertUIntEquals(tc, 5, elems[1].sequence);
+   CuAssertIntEquals(tc, 0, apx_mpscQueue_release(&queue, 2));
+   apx_mpscQueue_destroy(&queue);
+}
+
+static void test_apx_mpscQueue_multipleProducers(CuTest* tc)
+{
+   apx_mpscQueue_t queue;
+   testProducer_t producers[NUM_PRODUCERS];
+   uint32_t nextSequence[NUM_PRODUCERS];
+   uint32_t numPopped = 0;
+   uint32_t numWakeups = 0;
+   uint32_t i;
+   apx_mpscQueue_create(&queue, sizeof(testElement_t));
+   for (i=0; i<NUM_PRODUCERS; i++)
+   {
+      producers[i].queue = &queue;
+      producers[i].producerId = i;
+      producers[i].numWakeups = 0;
+      nextSequence[i] = 0;
+#ifdef _MSC_VER
+      THREAD_CREATE(producers[i].thread, producerTask, &producers[i], producers[i].threadId);
+#else
+      THREAD_CREATE(producers[i].thread, producerTask, &producers[i]);
+#endif
+   }
+   while (numPopped < NUM_PRODUCERS*NUM_ELEMENTS_PER_PRODUCER)
+   {
+      testElement_t elem;
+      if (apx_mpscQueue_pop(&queue, &elem) == true)
+      {
+         //elements from the same producer must arrive in order
+         CuAssertTrue(tc, elem.producerId < NUM_PRODUCERS);
+         CuAssertUIntEquals(tc, nextSequence[elem.producerId], elem.sequence);
+         nextSequence[elem.producerId]++;
+         numPopped++;
+         apx_mpscQueue_release(&queue, 1);
+      }
+   }
+   for (i=0; i<NUM_PRODUCERS; i++)
+   {
+#ifdef _MSC_VER
+      WaitForSingleObject(producers[i].thread, INFINITE);
+      CloseHandle(producers[i].thread);
+#else
+      pthread_join(producers[i].thread, 0);
+#endif
+      numWakeups += producers[i].numWakeups;
+   }
+   CuAssertIntEquals(tc, 0, apx_mpscQueue_length(&queue));
+   CuAssertTrue(tc, numWakeups >= 1);
+   CuAssertTrue(tc, numWakeups <= NUM_PRODUCERS*NUM_ELEMENTS_PER_PRODUCER);
+   apx_mpscQueue_destroy(&queue);
+}
+
+static THREAD_PROTO(producerTask,arg)
+{
+   testProducer_t *self = (testProducer_t*) arg;
+   uint32_t i;
+   for (i=0; i<NUM_ELEMENTS_PER_PRODUCER; i++)
+   {
+      testElement_t elem;
+      bool wasEmpty = false;
+      elem.producerId = self->producerId;
+      elem.sequence = i;
+      apx_mpscQueue_push(self->queue, &elem, &wasEmpty);
+      if (wasEmpty == true)
+      {
+         self->numWakeups++;
+      }
+   }
+   THREAD_RETURN(0);
+}
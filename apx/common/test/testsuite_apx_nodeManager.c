@@ -0,0 +1,506 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx_nodeManager.h"
+#include "apx_nodeInfo.h"
+#include "apx_nodeData.h"
+#include "apx_router.h"
+#include "apx_fileManager.h"
+#include "apx_file.h"
+#include "sha256.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define NUM_PROVIDE_PORTS 4
+#define PORT_DATA_LEN 2
+#define SEND_BUF_SIZE (RMF_MAX_CMD_BUF_SIZE+RMF_MAX_HEADER_SIZE)
+
+typedef struct testTransmitter_tag
+{
+   uint8_t sendBuf[SEND_BUF_SIZE];
+   int32_t numSent;
+}testTransmitter_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_apx_nodeManager_coalesceAdjacentWrites(CuTest* tc);
+static void test_apx_nodeManager_reuseCachedDefinition(CuTest* tc);
+static void test_apx_nodeManager_resumeParkedNode(CuTest* tc);
+static void test_apx_nodeManager_releaseParkedNodeFromRouter(CuTest* tc);
+static void test_apx_nodeManager_parseDefinitionChunks(CuTest* tc);
+static uint8_t *testTransmitter_getSendBuffer(void *arg, int32_t msgLen);
+static int32_t testTransmitter_send(void *arg, int32_t offset, int32_t msgLen);
+static apx_file_t *createRemoteFile(const char *name, uint32_t address, uint32_t length, const uint8_t *definition);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static const char *m_testDefinition =
+      "APX/1.2\n"
+      "N\"TestNode\"\n"
+      "T\"Gear_T\"C(0,7)\n"
+      "P\"VehicleSpeed\"S:=65535\n"
+      "R\"GearSelection\"T[0]:=0\n";
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+
+CuSuite* testSuite_apx_nodeManager(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_apx_nodeManager_coalesceAdjacentWrites);
+   SUITE_ADD_TEST(suite, test_apx_nodeManager_reuseCachedDefinition);
+   SUITE_ADD_TEST(suite, test_apx_nodeManager_resumeParkedNode);
+   SUITE_ADD_TEST(suite, test_apx_nodeManager_releaseParkedNodeFromRouter);
+   SUITE_ADD_TEST(suite, test_apx_nodeManager_parseDefinitionChunks);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Provider ports P0..P3 (2 bytes each) are routed to the requester offsets 10, 12, 20 and 14.
+ * Writing all four ports must result in one write to [10,16) and one write to [20,22).
+ */
+static void test_apx_nodeManager_coalesceAdjacentWrites(CuTest* tc)
+{
+   apx_nodeManager_t nodeManager;
+   apx_fileManager_t fileManager;
+   apx_nodeInfo_t providerInfo;
+   apx_nodeInfo_t requesterInfo;
+   apx_nodeData_t providerData;
+   apx_nodeData_t requesterData;
+   apx_file_t remoteFile;
+   apx_file_t *inPortDataFile = (apx_file_t*) 0x1000; //never dereferenced since the fileManager is not started
+   apx_dataTriggerFunction_t *triggerFunctions[NUM_PROVIDE_PORTS];
+   uint32_t portOffsets[NUM_PROVIDE_PORTS+1];
+   uint32_t connectedPorts[1] = {0};
+   uint32_t destOffsets[NUM_PROVIDE_PORTS] = {10, 12, 20, 14};
+   uint8_t outPortData[NUM_PROVIDE_PORTS*PORT_DATA_LEN] = {1, 2, 3, 4, 5, 6, 7, 8};
+   apx_msg_t msg;
+   int32_t i;
+
+   apx_nodeManager_create(&nodeManager);
+   CuAssertIntEquals(tc, 0, apx_fileManager_create(&fileManager, APX_FILEMANAGER_SERVER_MODE));
+   memset(&providerInfo, 0, sizeof(providerInfo));
+   memset(&requesterInfo, 0, sizeof(requesterInfo));
+   memset(&remoteFile, 0, sizeof(remoteFile));
+   apx_nodeData_create(&providerData, "Provider", 0, 0, 0, 0, 0, &outPortData[0], 0, (uint32_t) sizeof(outPortData));
+   apx_nodeData_create(&requesterData, "Requester", 0, 0, 0, 0, 0, 0, 0, 0);
+   apx_nodeData_setNodeInfo(&providerData, &providerInfo);
+   apx_nodeData_setFileManager(&requesterData, &fileManager);
+   apx_nodeData_setInPortDataFile(&requesterData, inPortDataFile);
+   apx_nodeInfo_setNodeData(&requesterInfo, &requesterData);
+   for (i=0; i<NUM_PROVIDE_PORTS; i++)
+   {
+      triggerFunctions[i] = apx_dataTriggerFunction_new((uint32_t) i*PORT_DATA_LEN, PORT_DATA_LEN);
+      apx_dataTriggerFunction_addRoute(triggerFunctions[i], &requesterInfo, destOffsets[i]);
+      portOffsets[i] = (uint32_t) i*PORT_DATA_LEN;
+      connectedPorts[0] |= 1u << i;
+   }
+   portOffsets[NUM_PROVIDE_PORTS] = NUM_PROVIDE_PORTS*PORT_DATA_LEN;
+   providerInfo.outDataTriggerTable.triggerFunctions = &triggerFunctions[0];
+   providerInfo.outDataTriggerTable.portOffsets = &portOffsets[0];
+   providerInfo.outDataTriggerTable.connectedPorts = &connectedPorts[0];
+   providerInfo.outDataTriggerTable.numPorts = NUM_PROVIDE_PORTS;
+   remoteFile.fileType = APX_OUTDATA_FILE;
+   remoteFile.nodeData = &providerData;
+   remoteFile.fileInfo.length = (uint32_t) sizeof(outPortData);
+
+   apx_nodeManager_remoteFileWritten(&nodeManager, &fileManager, &remoteFile, 0, (int32_t) sizeof(outPortData));
+   CuAssertIntEquals(tc, 2, apx_mpscQueue_length(&fileManager.messages));
+   CuAssertTrue(tc, apx_mpscQueue_pop(&fileManager.messages, &msg));
+   CuAssertUIntEquals(tc, RMF_MSG_FILE_WRITE, msg.msgType);
+   CuAssertPtrEquals(tc, inPortDataFile, msg.msgData3.ptr);
+   CuAssertUIntEquals(tc, 10, msg.msgData1);
+   CuAssertUIntEquals(tc, 6, msg.msgData2);
+   CuAssertIntEquals(tc, 1, msg.msgData4.data[0]);
+   CuAssertIntEquals(tc, 4, msg.msgData4.data[3]);
+   CuAssertIntEquals(tc, 7, msg.msgData4.data[4]);
+   CuAssertIntEquals(tc, 8, msg.msgData4.data[5]);
+   CuAssertTrue(tc, apx_mpscQueue_pop(&fileManager.messages, &msg));
+   CuAssertUIntEquals(tc, 20, msg.msgData1);
+   CuAssertUIntEquals(tc, 2, msg.msgData2);
+   CuAssertIntEquals(tc, 5, msg.msgData4.data[0]);
+   apx_mpscQueue_release(&fileManager.messages, 2);
+
+   //a write that only covers one port is routed directly by its trigger function
+   apx_nodeManager_remoteFileWritten(&nodeManager, &fileManager, &remoteFile, 2, PORT_DATA_LEN);
+   CuAssertTrue(tc, apx_mpscQueue_pop(&fileManager.messages, &msg));
+   CuAssertUIntEquals(tc, 12, msg.msgData1);
+   CuAssertUIntEquals(tc, 2, msg.msgData2);
+   CuAssertIntEquals(tc, 3, msg.msgData4.data[0]);
+   CuAssertTrue(tc, !apx_mpscQueue_pop(&fileManager.messages, &msg));
+
+   for (i=0; i<NUM_PROVIDE_PORTS; i++)
+   {
+      apx_dataTriggerFunction_delete(triggerFunctions[i]);
+   }
+   apx_nodeData_destroy(&providerData);
+   apx_nodeData_destroy(&requesterData);
+   apx_fileManager_destroy(&fileManager);
+   apx_nodeManager_destroy(&nodeManager);
+}
+
+/**
+ * The first client uploads the definition of TestNode, the second client announces the same definition (same digest).
+ * The second node must be created without opening its definition file, its .out file is opened when it shows up.
+ */
+static void test_apx_nodeManager_reuseCachedDefinition(CuTest* tc)
+{
+   apx_nodeManager_t nodeManager;
+   apx_fileManager_t fileManager1;
+   apx_fileManager_t fileManager2;
+   apx_transmitHandler_t transmitHandler;
+   testTransmitter_t transmitter1;
+   testTransmitter_t transmitter2;
+   uint32_t definitionLen = (uint32_t) strlen(m_testDefinition);
+   apx_file_t *definitionFile1;
+   apx_file_t *definitionFile2;
+   apx_file_t *outDataFile2;
+   apx_nodeData_t *nodeData;
+   apx_nodeInfo_t *nodeInfo;
+
+   apx_nodeManager_create(&nodeManager);
+   CuAssertIntEquals(tc, 0, apx_fileManager_create(&fileManager1, APX_FILEMANAGER_SERVER_MODE));
+   CuAssertIntEquals(tc, 0, apx_fileManager_create(&fileManager2, APX_FILEMANAGER_SERVER_MODE));
+   memset(&transmitter1, 0, sizeof(transmitter1));
+   memset(&transmitter2, 0, sizeof(transmitter2));
+   memset(&transmitHandler, 0, sizeof(transmitHandler));
+   transmitHandler.getSendBuffer = testTransmitter_getSendBuffer;
+   transmitHandler.send = testTransmitter_send;
+   transmitHandler.arg = &transmitter1;
+   apx_fileManager_setTransmitHandler(&fileManager1, &transmitHandler);
+   transmitHandler.arg = &transmitter2;
+   apx_fileManager_setTransmitHandler(&fileManager2, &transmitHandler);
+
+   //first client, definition is downloaded and parsed
+   definitionFile1 = createRemoteFile("TestNode.apx", 0x4000000, definitionLen, (const uint8_t*) m_testDefinition);
+   apx_nodeManager_remoteFileAdded(&nodeManager, &fileManager1, definitionFile1);
+   CuAssertIntEquals(tc, 1, transmitter1.numSent);
+   CuAssertPtrNotNull(tc, definitionFile1->nodeData);
+   memcpy(definitionFile1->nodeData->definitionDataBuf, m_testDefinition, definitionLen);
+   apx_nodeManager_remoteFileWritten(&nodeManager, &fileManager1, definitionFile1, 0, (int32_t) definitionLen);
+   CuAssertIntEquals(tc, 1, (int) adt_hash_length(&nodeManager.nodeTemplateMap));
+   apx_nodeManager_detachFileManager(&nodeManager, &fileManager1);
+   CuAssertIntEquals(tc, 0, (int) adt_hash_length(&nodeManager.nodeInfoMap));
+
+   //second client announces the same definition, no file open is sent
+   definitionFile2 = createRemoteFile("TestNode.apx", 0x4000000, definitionLen, (const uint8_t*) m_testDefinition);
+   apx_nodeManager_remoteFileAdded(&nodeManager, &fileManager2, definitionFile2);
+   CuAssertIntEquals(tc, 0, transmitter2.numSent);
+   nodeData = definitionFile2->nodeData;
+   CuAssertPtrNotNull(tc, nodeData);
+   CuAssertPtrEquals(tc, 0, nodeData->definitionDataBuf);
+   nodeInfo = nodeData->nodeInfo;
+   CuAssertPtrNotNull(tc, nodeInfo);
+   CuAssertIntEquals(tc, 1, apx_node_getNumProvidePorts(nodeInfo->node));
+   CuAssertIntEquals(tc, 1, apx_node_getNumRequirePorts(nodeInfo->node));
+   CuAssertStrEquals(tc, "\"GearSelection\"C(0,7)", apx_port_getPortSignature(apx_node_getRequirePort(nodeInfo->node, 0)));
+   CuAssertIntEquals(tc, 1, (int) nodeData->inPortDataLen);
+   CuAssertPtrEquals(tc, 0, nodeData->outPortDataBuf);
+
+   //the .out file is seen after the node has been created
+   outDataFile2 = createRemoteFile("TestNode.out", 0, 2, 0);
+   apx_nodeManager_remoteFileAdded(&nodeManager, &fileManager2, outDataFile2);
+   CuAssertIntEquals(tc, 1, transmitter2.numSent);
+   CuAssertPtrEquals(tc, nodeData, outDataFile2->nodeData);
+   CuAssertPtrNotNull(tc, nodeData->outPortDataBuf);
+   CuAssertUIntEquals(tc, 2, nodeData->outPortDataLen);
+
+   apx_nodeManager_detachFileManager(&nodeManager, &fileManager2);
+   apx_file_delete(definitionFile1);
+   apx_file_delete(definitionFile2);
+   apx_file_delete(outDataFile2);
+   apx_fileManager_destroy(&fileManager1);
+   apx_fileManager_destroy(&fileManager2);
+   apx_nodeManager_destroy(&nodeManager);
+}
+
+/**
+ * A client with a session token disconnects and reconnects with the same token and definition.
+ * The node must be resumed (same nodeInfo and data buffers) instead of being recreated. Once parked again it expires after the grace period.
+ */
+static void test_apx_nodeManager_resumeParkedNode(CuTest* tc)
+{
+   apx_nodeManager_t nodeManager;
+   apx_fileManager_t fileManager1;
+   apx_fileManager_t fileManager2;
+   apx_transmitHandler_t transmitHandler;
+   testTransmitter_t transmitter1;
+   testTransmitter_t transmitter2;
+   uint32_t definitionLen = (uint32_t) strlen(m_testDefinition);
+   apx_file_t *definitionFile1;
+   apx_file_t *outDataFile1;
+   apx_file_t *definitionFile2;
+   apx_file_t *outDataFile2;
+   apx_nodeData_t *nodeData;
+   apx_nodeInfo_t *nodeInfo;
+   uint8_t *outPortDataBuf;
+
+   apx_nodeManager_create(&nodeManager);
+   apx_nodeManager_setSessionGracePeriod(&nodeManager, 1000);
+   CuAssertIntEquals(tc, 0, apx_fileManager_create(&fileManager1, APX_FILEMANAGER_SERVER_MODE));
+   CuAssertIntEquals(tc, 0, apx_fileManager_create(&fileManager2, APX_FILEMANAGER_SERVER_MODE));
+   apx_fileManager_setSessionToken(&fileManager1, "a1b2c3");
+   apx_fileManager_setSessionToken(&fileManager2, "a1b2c3");
+   memset(&transmitter1, 0, sizeof(transmitter1));
+   memset(&transmitter2, 0, sizeof(transmitter2));
+   memset(&transmitHandler, 0, sizeof(transmitHandler));
+   transmitHandler.getSendBuffer = testTransmitter_getSendBuffer;
+   transmitHandler.send = testTransmitter_send;
+   transmitHandler.arg = &transmitter1;
+   apx_fileManager_setTransmitHandler(&fileManager1, &transmitHandler);
+   transmitHandler.arg = &transmitter2;
+   apx_fileManager_setTransmitHandler(&fileManager2, &transmitHandler);
+
+   //first connection
+   definitionFile1 = createRemoteFile("TestNode.apx", 0x4000000, definitionLen, (const uint8_t*) m_testDefinition);
+   outDataFile1 = createRemoteFile("TestNode.out", 0, 2, 0);
+   apx_fileMap_insertFile(&fileManager1.remoteFileMap, definitionFile1);
+   apx_fileMap_insertFile(&fileManager1.remoteFileMap, outDataFile1);
+   apx_nodeManager_remoteFileAdded(&nodeManager, &fileManager1, definitionFile1);
+   memcpy(definitionFile1->nodeData->definitionDataBuf, m_testDefinition, definitionLen);
+   apx_nodeManager_remoteFileWritten(&nodeManager, &fileManager1, definitionFile1, 0, (int32_t) definitionLen);
+   nodeData = definitionFile1->nodeData;
+   nodeInfo = nodeData->nodeInfo;
+   CuAssertPtrNotNull(tc, nodeInfo);
+   outPortDataBuf = nodeData->outPortDataBuf;
+   CuAssertPtrNotNull(tc, outPortDataBuf);
+   CuAssertPtrEquals(tc, nodeData, outDataFile1->nodeData);
+   outPortDataBuf[0] = 0x34;
+   outPortDataBuf[1] = 0x12;
+
+   //disconnect, the node is kept without a fileManager
+   apx_nodeManager_parkFileManager(&nodeManager, &fileManager1, 100);
+   CuAssertIntEquals(tc, 1, (int) adt_hash_length(&nodeManager.nodeInfoMap));
+   CuAssertIntEquals(tc, 1, (int) adt_hash_length(&nodeManager.parkedNodeMap));
+   CuAssertPtrEquals(tc, 0, nodeData->fileManager);
+   CuAssertPtrEquals(tc, 0, nodeData->inPortDataFile);
+   CuAssertPtrEquals(tc, 0, definitionFile1->nodeData);
+   CuAssertPtrEquals(tc, 0, outDataFile1->nodeData);
+   apx_fileManager_destroy(&fileManager1);
+   apx_nodeManager_expireParkedNodes(&nodeManager, 600);
+   CuAssertIntEquals(tc, 1, (int) adt_hash_length(&nodeManager.parkedNodeMap));
+
+   //reconnect, neither the definition nor the node is recreated
+   definitionFile2 = createRemoteFile("TestNode.apx", 0x4000000, definitionLen, (const uint8_t*) m_testDefinition);
+   outDataFile2 = createRemoteFile("TestNode.out", 0, 2, 0);
+   apx_fileMap_insertFile(&fileManager2.remoteFileMap, definitionFile2);
+   apx_nodeManager_remoteFileAdded(&nodeManager, &fileManager2, definitionFile2);
+   CuAssertIntEquals(tc, 0, transmitter2.numSent);
+   CuAssertIntEquals(tc, 0, (int) adt_hash_length(&nodeManager.parkedNodeMap));
+   CuAssertPtrEquals(tc, nodeData, definitionFile2->nodeData);
+   CuAssertPtrEquals(tc, nodeInfo, nodeData->nodeInfo);
+   CuAssertPtrEquals(tc, &fileManager2, nodeData->fileManager);
+   CuAssertPtrNotNull(tc, nodeData->outPortDataSnapshot);
+   apx_fileMap_insertFile(&fileManager2.remoteFileMap, outDataFile2);
+   apx_nodeManager_remoteFileAdded(&nodeManager, &fileManager2, outDataFile2);
+   CuAssertIntEquals(tc, 1, transmitter2.numSent);
+   CuAssertPtrEquals(tc, nodeData, outDataFile2->nodeData);
+   CuAssertPtrEquals(tc, outPortDataBuf, nodeData->outPortDataBuf);
+   //the client sends its out data when the file is opened, the snapshot is only used for that write
+   apx_nodeManager_remoteFileWritten(&nodeManager, &fileManager2, outDataFile2, 0, 2);
+   CuAssertPtrEquals(tc, 0, nodeData->outPortDataSnapshot);
+
+   //second disconnect, the client does not come back in time
+   apx_nodeManager_parkFileManager(&nodeManager, &fileManager2, 0xFFFFFF00u);
+   CuAssertIntEquals(tc, 1, (int) adt_hash_length(&nodeManager.parkedNodeMap));
+   apx_nodeManager_expireParkedNodes(&nodeManager, 0x000002E7u); //timer wrapped around, 999ms later
+   CuAssertIntEquals(tc, 1, (int) adt_hash_length(&nodeManager.parkedNodeMap));
+   apx_nodeManager_expireParkedNodes(&nodeManager, 0x000002E8u);
+   CuAssertIntEquals(tc, 0, (int) adt_hash_length(&nodeManager.parkedNodeMap));
+   CuAssertIntEquals(tc, 0, (int) adt_hash_length(&nodeManager.nodeInfoMap));
+
+   apx_fileManager_destroy(&fileManager2);
+   apx_nodeManager_destroy(&nodeManager);
+}
+
+/**
+ * Parked nodes no longer have a fileManager. They must still be detached cleanly from the router,
+ * both when another client takes over the name and when the grace period expires.
+ */
+static void test_apx_nodeManager_releaseParkedNodeFromRouter(CuTest* tc)
+{
+   apx_nodeManager_t nodeManager;
+   apx_router_t router;
+   apx_fileManager_t fileManager1;
+   apx_fileManager_t fileManager2;
+   apx_transmitHandler_t transmitHandler;
+   testTransmitter_t transmitter1;
+   testTransmitter_t transmitter2;
+   uint32_t definitionLen = (uint32_t) strlen(m_testDefinition);
+   apx_file_t *definitionFile1;
+   apx_file_t *definitionFile2;
+
+   apx_router_create(&router);
+   apx_nodeManager_create(&nodeManager);
+   apx_nodeManager_setRouter(&nodeManager, &router);
+   apx_nodeManager_setSessionGracePeriod(&nodeManager, 1000);
+   CuAssertIntEquals(tc, 0, apx_fileManager_create(&fileManager1, APX_FILEMANAGER_SERVER_MODE));
+   CuAssertIntEquals(tc, 0, apx_fileManager_create(&fileManager2, APX_FILEMANAGER_SERVER_MODE));
+   apx_fileManager_setSessionToken(&fileManager1, "a1b2c3");
+   apx_fileManager_setSessionToken(&fileManager2, "d4e5f6");
+   memset(&transmitter1, 0, sizeof(transmitter1));
+   memset(&transmitter2, 0, sizeof(transmitter2));
+   memset(&transmitHandler, 0, sizeof(transmitHandler));
+   transmitHandler.getSendBuffer = testTransmitter_getSendBuffer;
+   transmitHandler.send = testTransmitter_send;
+   transmitHandler.arg = &transmitter1;
+   apx_fileManager_setTransmitHandler(&fileManager1, &transmitHandler);
+   transmitHandler.arg = &transmitter2;
+   apx_fileManager_setTransmitHandler(&fileManager2, &transmitHandler);
+
+   //first client is attached to the router, then disconnects
+   definitionFile1 = createRemoteFile("TestNode.apx", 0x4000000, definitionLen, (const uint8_t*) m_testDefinition);
+   apx_fileMap_insertFile(&fileManager1.remoteFileMap, definitionFile1);
+   apx_nodeManager_remoteFileAdded(&nodeManager, &fileManager1, definitionFile1);
+   memcpy(definitionFile1->nodeData->definitionDataBuf, m_testDefinition, definitionLen);
+   apx_nodeManager_remoteFileWritten(&nodeManager, &fileManager1, definitionFile1, 0, (int32_t) definitionLen);
+   CuAssertPtrNotNull(tc, definitionFile1->nodeData->nodeInfo);
+   CuAssertIntEquals(tc, 1, adt_ary_length(&router.nodeInfoList));
+   apx_nodeManager_parkFileManager(&nodeManager, &fileManager1, 100);
+   CuAssertIntEquals(tc, 1, (int) adt_hash_length(&nodeManager.parkedNodeMap));
+   CuAssertIntEquals(tc, 1, adt_ary_length(&router.nodeInfoList));
+   apx_fileManager_destroy(&fileManager1);
+
+   //a client with another session token takes over the name, the parked node is replaced in the router
+   definitionFile2 = createRemoteFile("TestNode.apx", 0x4000000, definitionLen, (const uint8_t*) m_testDefinition);
+   apx_fileMap_insertFile(&fileManager2.remoteFileMap, definitionFile2);
+   apx_nodeManager_remoteFileAdded(&nodeManager, &fileManager2, definitionFile2);
+   CuAssertIntEquals(tc, 0, (int) adt_hash_length(&nodeManager.parkedNodeMap));
+   CuAssertPtrNotNull(tc, definitionFile2->nodeData->nodeInfo);
+   CuAssertPtrEquals(tc, &fileManager2, definitionFile2->nodeData->fileManager);
+   CuAssertIntEquals(tc, 1, adt_ary_length(&router.nodeInfoList));
+   CuAssertPtrEquals(tc, definitionFile2->nodeData->nodeInfo, adt_ary_value(&router.nodeInfoList, 0));
+
+   //second client disconnects and does not come back in time
+   apx_nodeManager_parkFileManager(&nodeManager, &fileManager2, 200);
+   CuAssertIntEquals(tc, 1, (int) adt_hash_length(&nodeManager.parkedNodeMap));
+   apx_nodeManager_expireParkedNodes(&nodeManager, 1200);
+   CuAssertIntEquals(tc, 0, (int) adt_hash_length(&nodeManager.parkedNodeMap));
+   CuAssertIntEquals(tc, 0, (int) adt_hash_length(&nodeManager.nodeInfoMap));
+   CuAssertIntEquals(tc, 0, adt_ary_length(&router.nodeInfoList));
+
+   apx_fileManager_destroy(&fileManager2);
+   apx_nodeManager_destroy(&nodeManager);
+   apx_router_destroy(&router);
+}
+
+/**
+ * A definition that arrives in several messages is parsed chunk by chunk, the node is created when the last chunk arrives.
+ * The second client sends its chunks out of order which makes the nodeManager parse the complete file at the end instead.
+ */
+static void test_apx_nodeManager_parseDefinitionChunks(CuTest* tc)
+{
+   apx_nodeManager_t nodeManager;
+   apx_fileManager_t fileManager;
+   apx_transmitHandler_t transmitHandler;
+   testTransmitter_t transmitter;
+   uint32_t definitionLen = (uint32_t) strlen(m_testDefinition);
+   apx_file_t *definitionFile;
+   apx_nodeData_t *nodeData;
+   int32_t pass;
+
+   for (pass=0; pass<2; pass++)
+   {
+      apx_nodeManager_create(&nodeManager);
+      CuAssertIntEquals(tc, 0, apx_fileManager_create(&fileManager, APX_FILEMANAGER_SERVER_MODE));
+      memset(&transmitter, 0, sizeof(transmitter));
+      memset(&transmitHandler, 0, sizeof(transmitHandler));
+      transmitHandler.getSendBuffer = testTransmitter_getSendBuffer;
+      transmitHandler.send = testTransmitter_send;
+      transmitHandler.arg = &transmitter;
+      apx_fileManager_setTransmitHandler(&fileManager, &transmitHandler);
+      definitionFile = createRemoteFile("TestNode.apx", 0x4000000, definitionLen, 0);
+      apx_fileMap_insertFile(&fileManager.remoteFileMap, definitionFile);
+      apx_nodeManager_remoteFileAdded(&nodeManager, &fileManager, definitionFile);
+      nodeData = definitionFile->nodeData;
+      CuAssertPtrNotNull(tc, nodeData);
+      memcpy(nodeData->definitionDataBuf, m_testDefinition, definitionLen);
+      if (pass == 0)
+      {
+         apx_nodeManager_remoteFileChunkWritten(&nodeManager, &fileManager, definitionFile, 0, 20);
+         CuAssertIntEquals(tc, 1, (int) adt_hash_length(&nodeManager.definitionParserMap));
+         apx_nodeManager_remoteFileChunkWritten(&nodeManager, &fileManager, definitionFile, 20, 30);
+         CuAssertIntEquals(tc, 1, (int) adt_hash_length(&nodeManager.definitionParserMap));
+      }
+      else
+      {
+         apx_nodeManager_remoteFileChunkWritten(&nodeManager, &fileManager, definitionFile, 0, 20);
+         apx_nodeManager_remoteFileChunkWritten(&nodeManager, &fileManager, definitionFile, 30, 20);
+         CuAssertIntEquals(tc, 0, (int) adt_hash_length(&nodeManager.definitionParserMap));
+         apx_nodeManager_remoteFileChunkWritten(&nodeManager, &fileManager, definitionFile, 20, 10);
+         CuAssertIntEquals(tc, 0, (int) adt_hash_length(&nodeManager.definitionParserMap));
+      }
+      apx_nodeManager_remoteFileWritten(&nodeManager, &fileManager, definitionFile, 50, (int32_t) definitionLen - 50);
+      CuAssertIntEquals(tc, 0, (int) adt_hash_length(&nodeManager.definitionParserMap));
+      CuAssertIntEquals(tc, 1, (int) adt_hash_length(&nodeManager.nodeInfoMap));
+      CuAssertPtrNotNull(tc, nodeData->nodeInfo);
+      CuAssertIntEquals(tc, 1, apx_node_getNumProvidePorts(nodeData->nodeInfo->node));
+      CuAssertIntEquals(tc, 1, apx_node_getNumRequirePorts(nodeData->nodeInfo->node));
+      CuAssertIntEquals(tc, 1, (int) nodeData->inPortDataLen);
+
+      apx_nodeManager_detachFileManager(&nodeManager, &fileManager);
+      apx_fileManager_destroy(&fileManager);
+      apx_nodeManager_destroy(&nodeManager);
+   }
+}
+
+static uint8_t *testTransmitter_getSendBuffer(void *arg, int32_t msgLen)
+{
+   testTransmitter_t *self = (testTransmitter_t*) arg;
+   if ( (self != 0) && (msgLen <= (int32_t) SEND_BUF_SIZE) )
+   {
+      return &self->sendBuf[0];
+   }
+   return 0;
+}
+
+static int32_t testTransmitter_send(void *arg, int32_t offset, int32_t msgLen)
+{
+   testTransmitter_t *self = (testTransmitter_t*) arg;
+   (void) offset;
+   (void) msgLen;
+   self->numSent++;
+   return 0;
+}
+
+/**
+ * creates a remote file, definition files get the SHA-256 digest of definition
+ */
+static apx_file_t *createRemoteFile(const char *name, uint32_t address, uint32_t length, const uint8_t *definition)
+{
+   rmf_fileInfo_t fileInfo;
+   rmf_fileInfo_create(&fileInfo, name, address, length, RMF_FILE_TYPE_FIXED);
+   if (definition != 0)
+   {
+      uint8_t digest[SHA256_DIGEST_SIZE];
+      sha256_calc(definition, length, &digest[0]);
+      rmf_fileInfo_setDigestData(&fileInfo, RMF_DIGEST_TYPE_SHA256, &digest[0], RMF_DIGEST_SIZE);
+   }
+   return apx_file_newRemoteFile(&fileInfo);
+}
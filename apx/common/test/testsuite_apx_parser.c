@@ -8,6 +8,7 @@
 #include <string.h>
 #include "CuTest.h"
 #include "apx_parser.h"
+#include "apx_stream.h"
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
 #endif
@@ -28,6 +29,8 @@
 static void test_apx_parser_file(CuTest* tc);
 static void test_apx_parser_fileWithErrorErrors(CuTest* tc);
 static void test_apx_parser_fileWithInitValues(CuTest* tc);
+static void test_apx_parser_chunkedStream(CuTest* tc);
+static void createParserStream(apx_istream_t *istream, apx_parser_t *parser);
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL VARIABLES
@@ -36,6 +39,14 @@ static void test_apx_parser_fileWithInitValues(CuTest* tc);
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL VARIABLES
 //////////////////////////////////////////////////////////////////////////////
+static const char *m_definition =
+      "APX/1.2\n"
+      "N\"TestNode\"\n"
+      "T\"SoundRequest_T\"{\"SoundId\"S\"Volume\"C}\n"
+      "P\"VehicleSpeed\"S:=65535\n"
+      "P\"SoundRequest\"T[0]:={65535,255}\n"
+      "R\"EngineRunningStatus\"C(0,3):=3\n"
+      "\n";
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -50,6 +61,7 @@ CuSuite* testSuite_apx_parser(void)
    SUITE_ADD_TEST(suite, test_apx_parser_file);
    SUITE_ADD_TEST(suite, test_apx_parser_fileWithErrorErrors);
    SUITE_ADD_TEST(suite, test_apx_parser_fileWithInitValues);
+   SUITE_ADD_TEST(suite, test_apx_parser_chunkedStream);
 
    return suite;
 }
@@ -111,3 +123,53 @@ static void test_apx_parser_fileWithInitValues(CuTest* tc)
 
    apx_parser_destroy(&parser);
 }
+
+/**
+ * The same definition written in one piece and in chunks that split lines at every possible position must give the same node
+ */
+static void test_apx_parser_chunkedStream(CuTest* tc)
+{
+   uint32_t definitionLen = (uint32_t) strlen(m_definition);
+   uint32_t chunkLen;
+   for (chunkLen = 1; chunkLen <= definitionLen; chunkLen++)
+   {
+      apx_parser_t parser;
+      apx_istream_t istream;
+      apx_node_t *node;
+      uint32_t offset;
+      apx_parser_create(&parser);
+      createParserStream(&istream, &parser);
+      apx_istream_open(&istream);
+      for (offset = 0; offset < definitionLen; offset += chunkLen)
+      {
+         uint32_t len = ( (definitionLen - offset) < chunkLen)? definitionLen - offset : chunkLen;
+         apx_istream_write(&istream, (const uint8_t*) &m_definition[offset], len);
+      }
+      apx_istream_close(&istream);
+      CuAssertIntEquals(tc, 0, (int) adt_bytearray_length(&istream.buf));
+      CuAssertIntEquals(tc, 1, apx_parser_getNumNodes(&parser));
+      node = apx_parser_getNode(&parser, 0);
+      CuAssertStrEquals(tc, "TestNode", node->name);
+      CuAssertIntEquals(tc, 2, apx_node_getNumProvidePorts(node));
+      CuAssertIntEquals(tc, 1, apx_node_getNumRequirePorts(node));
+      CuAssertStrEquals(tc, "SoundRequest", apx_node_getProvidePort(node, 1)->name);
+      CuAssertStrEquals(tc, "EngineRunningStatus", apx_node_getRequirePort(node, 0)->name);
+      apx_istream_destroy(&istream);
+      apx_parser_destroy(&parser);
+   }
+}
+
+static void createParserStream(apx_istream_t *istream, apx_parser_t *parser)
+{
+   apx_istream_handler_t handler;
+   memset(&handler, 0, sizeof(handler));
+   handler.arg = parser;
+   handler.open = apx_parser_vopen;
+   handler.close = apx_parser_vclose;
+   handler.node = apx_parser_vnode;
+   handler.datatype = apx_parser_vdatatype;
+   handler.provide = apx_parser_vprovide;
+   handler.require = apx_parser_vrequire;
+   handler.node_end = apx_parser_vnode_end;
+   apx_istream_create(istream, &handler);
+}
@@ -0,0 +1,161 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx_payload.h"
+#include "apx_fileManager.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define LARGE_DATA_LEN 32
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_apx_payload_retainRelease(CuTest* tc);
+static void test_apx_fileManager_inlineWrite(CuTest* tc);
+static void test_apx_fileManager_sharedPayload(CuTest* tc);
+static void test_apx_fileManager_conflatePayload(CuTest* tc);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+
+CuSuite* testSuite_apx_payload(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_apx_payload_retainRelease);
+   SUITE_ADD_TEST(suite, test_apx_fileManager_inlineWrite);
+   SUITE_ADD_TEST(suite, test_apx_fileManager_sharedPayload);
+   SUITE_ADD_TEST(suite, test_apx_fileManager_conflatePayload);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_apx_payload_retainRelease(CuTest* tc)
+{
+   int32_t numAllocated = apx_payload_getNumAllocated();
+   apx_payload_t *payload = apx_payload_new(LARGE_DATA_LEN);
+   CuAssertPtrNotNull(tc, payload);
+   CuAssertUIntEquals(tc, LARGE_DATA_LEN, apx_payload_length(payload));
+   CuAssertIntEquals(tc, 1, payload->refCount);
+   CuAssertIntEquals(tc, numAllocated+1, apx_payload_getNumAllocated());
+   memset(apx_payload_data(payload), 0xAA, LARGE_DATA_LEN);
+   apx_payload_retain(payload);
+   CuAssertIntEquals(tc, 2, payload->refCount);
+   apx_payload_release(payload);
+   CuAssertIntEquals(tc, numAllocated+1, apx_payload_getNumAllocated());
+   apx_payload_release(payload);
+   CuAssertIntEquals(tc, numAllocated, apx_payload_getNumAllocated());
+}
+
+static void test_apx_fileManager_inlineWrite(CuTest* tc)
+{
+   apx_fileManager_t fileManager;
+   apx_file_t *file = (apx_file_t*) 0x1000; //never dereferenced since the fileManager is not started
+   apx_msg_t msg;
+   uint8_t value[APX_MSG_INLINE_DATA_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8};
+   int32_t numAllocated = apx_payload_getNumAllocated();
+   CuAssertIntEquals(tc, 0, apx_fileManager_create(&fileManager, APX_FILEMANAGER_SERVER_MODE));
+   apx_fileManager_triggerFileWriteCmdEvent(&fileManager, file, &value[0], 0, APX_MSG_INLINE_DATA_SIZE);
+   //data that fits inside the message needs no extra allocation
+   CuAssertIntEquals(tc, numAllocated, apx_payload_getNumAllocated());
+   value[0] = 0;
+   CuAssertTrue(tc, apx_mpscQueue_pop(&fileManager.messages, &msg));
+   CuAssertUIntEquals(tc, RMF_MSG_FILE_WRITE, msg.msgType);
+   CuAssertUIntEquals(tc, APX_MSG_INLINE_DATA_SIZE, msg.msgData2);
+   CuAssertIntEquals(tc, 1, msg.msgData4.data[0]);
+   CuAssertIntEquals(tc, 8, msg.msgData4.data[APX_MSG_INLINE_DATA_SIZE-1]);
+   apx_fileManager_destroy(&fileManager);
+}
+
+static void test_apx_fileManager_sharedPayload(CuTest* tc)
+{
+   apx_fileManager_t fileManager1;
+   apx_fileManager_t fileManager2;
+   apx_file_t *file = (apx_file_t*) 0x1000;
+   apx_payload_t *payload;
+   apx_msg_t msg1;
+   apx_msg_t msg2;
+   int32_t numAllocated = apx_payload_getNumAllocated();
+   CuAssertIntEquals(tc, 0, apx_fileManager_create(&fileManager1, APX_FILEMANAGER_SERVER_MODE));
+   CuAssertIntEquals(tc, 0, apx_fileManager_create(&fileManager2, APX_FILEMANAGER_SERVER_MODE));
+   payload = apx_payload_new(LARGE_DATA_LEN);
+   memset(apx_payload_data(payload), 0x55, LARGE_DATA_LEN);
+   apx_fileManager_triggerFileWritePayloadEvent(&fileManager1, file, payload, 0);
+   apx_fileManager_triggerFileWritePayloadEvent(&fileManager2, file, payload, 4);
+   CuAssertIntEquals(tc, 3, payload->refCount);
+   apx_payload_release(payload);
+   CuAssertIntEquals(tc, numAllocated+1, apx_payload_getNumAllocated());
+   CuAssertTrue(tc, apx_mpscQueue_pop(&fileManager1.messages, &msg1));
+   CuAssertTrue(tc, apx_mpscQueue_pop(&fileManager2.messages, &msg2));
+   //both destinations see the same copy of the data
+   CuAssertPtrEquals(tc, payload, msg1.msgData4.ptr);
+   CuAssertPtrEquals(tc, payload, msg2.msgData4.ptr);
+   CuAssertUIntEquals(tc, LARGE_DATA_LEN, msg1.msgData2);
+   CuAssertUIntEquals(tc, 4, msg2.msgData1);
+   apx_payload_release((apx_payload_t*) msg1.msgData4.ptr);
+   CuAssertIntEquals(tc, numAllocated+1, apx_payload_getNumAllocated());
+   apx_payload_release((apx_payload_t*) msg2.msgData4.ptr);
+   CuAssertIntEquals(tc, numAllocated, apx_payload_getNumAllocated());
+   //a message that is still queued at destroy gives back its reference
+   payload = apx_payload_new(LARGE_DATA_LEN);
+   apx_fileManager_triggerFileWritePayloadEvent(&fileManager1, file, payload, 0);
+   apx_payload_release(payload);
+   apx_fileManager_destroy(&fileManager1);
+   apx_fileManager_destroy(&fileManager2);
+   CuAssertIntEquals(tc, numAllocated, apx_payload_getNumAllocated());
+}
+
+static void test_apx_fileManager_conflatePayload(CuTest* tc)
+{
+   apx_fileManager_t fileManager;
+   apx_file_t *file = (apx_file_t*) 0x1000;
+   apx_payload_t *payload1;
+   apx_payload_t *payload2;
+   apx_msg_t msg;
+   int32_t numAllocated = apx_payload_getNumAllocated();
+   CuAssertIntEquals(tc, 0, apx_fileManager_create(&fileManager, APX_FILEMANAGER_SERVER_MODE));
+   CuAssertIntEquals(tc, 0, apx_fileManager_enableConflation(&fileManager));
+   payload1 = apx_payload_new(LARGE_DATA_LEN);
+   payload2 = apx_payload_new(LARGE_DATA_LEN);
+   apx_fileManager_triggerFileWritePayloadEvent(&fileManager, file, payload1, 0);
+   apx_fileManager_triggerFileWritePayloadEvent(&fileManager, file, payload2, 0);
+   CuAssertIntEquals(tc, 1, apx_mpscQueue_length(&fileManager.messages));
+   CuAssertUIntEquals(tc, 1, fileManager.numConflatedWrites);
+   //the queued message dropped its reference to the older payload
+   CuAssertIntEquals(tc, 1, payload1->refCount);
+   CuAssertIntEquals(tc, 2, payload2->refCount);
+   apx_payload_release(payload1);
+   apx_payload_release(payload2);
+   CuAssertTrue(tc, apx_mpscQueue_pop(&fileManager.messages, &msg));
+   CuAssertPtrEquals(tc, payload2, msg.msgData4.ptr);
+   apx_payload_release((apx_payload_t*) msg.msgData4.ptr);
+   CuAssertIntEquals(tc, numAllocated, apx_payload_getNumAllocated());
+   apx_fileManager_destroy(&fileManager);
+}
@@ -18,7 +18,7 @@ void test_apx_port_create(CuTest* tc)
    CuAssertPtrEquals(tc,NULL,port.dataSignature);
    CuAssertPtrEquals(tc,NULL,(void*)port.derivedDsg.str);
    CuAssertPtrEquals(tc,NULL,port.name);
-   CuAssertPtrEquals(tc,NULL,port.portSignature);
+   CuAssertPtrEquals(tc,NULL,(void*)port.portSignature);
    apx_port_destroy(&port);
 
    apx_port_create(&port,APX_REQUIRE_PORT,"DPFSootLevel","T[95]",NULL);
@@ -30,6 +30,36 @@ void test_apx_port_create(CuTest* tc)
 
 }
 
+void test_apx_port_internedSignature(CuTest* tc)
+{
+   apx_port_t port1;
+   apx_port_t port2;
+   apx_port_t port3;
+   int32_t numSignatures = apx_portSignatureTable_getNumSignatures();
+   apx_port_create(&port1,APX_PROVIDE_PORT,"VehicleSpeed","S",NULL);
+   apx_port_create(&port2,APX_REQUIRE_PORT,"VehicleSpeed","T[0]",NULL);
+   apx_port_create(&port3,APX_REQUIRE_PORT,"EngineSpeed","S",NULL);
+   CuAssertIntEquals(tc,APX_INVALID_PORT_SIGNATURE_ID,port1.portSignatureId);
+   apx_port_setDerivedDataSignature(&port2,"S");
+   CuAssertStrEquals(tc,"\"VehicleSpeed\"S",apx_port_derivePortSignature(&port1));
+   CuAssertStrEquals(tc,"\"VehicleSpeed\"S",apx_port_derivePortSignature(&port2));
+   CuAssertStrEquals(tc,"\"EngineSpeed\"S",apx_port_getPortSignature(&port3));
+   //identical port signatures share both the string and the ID
+   CuAssertTrue(tc,port1.portSignatureId >= 0);
+   CuAssertIntEquals(tc,port1.portSignatureId,apx_port_getPortSignatureId(&port2));
+   CuAssertPtrEquals(tc,(void*)port1.portSignature,(void*)port2.portSignature);
+   CuAssertTrue(tc,port1.portSignatureId != apx_port_getPortSignatureId(&port3));
+   CuAssertIntEquals(tc,numSignatures+2,apx_portSignatureTable_getNumSignatures());
+   CuAssertStrEquals(tc,"\"EngineSpeed\"S",apx_portSignatureTable_getSignature(port3.portSignatureId));
+   //deriving the signature again must not take an extra reference
+   apx_port_derivePortSignature(&port1);
+   apx_port_destroy(&port1);
+   CuAssertStrEquals(tc,"\"VehicleSpeed\"S",apx_portSignatureTable_getSignature(port2.portSignatureId));
+   apx_port_destroy(&port2);
+   apx_port_destroy(&port3);
+   CuAssertIntEquals(tc,numSignatures,apx_portSignatureTable_getNumSignatures());
+}
+
 
 
 
@@ -38,6 +68,7 @@ CuSuite* testsuite_apx_port(void)
    CuSuite* suite = CuSuiteNew();
 
    SUITE_ADD_TEST(suite, test_apx_port_create);
+   SUITE_ADD_TEST(suite, test_apx_port_internedSignature);
 
    return suite;
 }
@@ -9,6 +9,7 @@
 #include "CuTest.h"
 #include "apx_routerPortMapEntry.h"
 #include "apx_parser.h"
+#include "apx_port.h"
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
 #endif
@@ -17,11 +18,13 @@
 //////////////////////////////////////////////////////////////////////////////
 // CONSTANTS AND DATA TYPES
 //////////////////////////////////////////////////////////////////////////////
+#define NUM_TEST_NODES 6
 
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
 static void test_apx_routerPortMapEntry_create(CuTest* tc);
+static void test_apx_routerPortMapEntry_remove(CuTest* tc);
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL VARIABLES
@@ -42,6 +45,7 @@ CuSuite* testSuite_apx_routerPortMapEntry(void)
    CuSuite* suite = CuSuiteNew();
 
    SUITE_ADD_TEST(suite, test_apx_routerPortMapEntry_create);
+   SUITE_ADD_TEST(suite, test_apx_routerPortMapEntry_remove);
 
    return suite;
 }
@@ -95,4 +99,55 @@ static void test_apx_routerPortMapEntry_create(CuTest* tc)
 
 }
 
+/**
+ * nodes 0..2 provide the signal, nodes 3..5 require it
+ */
+static void test_apx_routerPortMapEntry_remove(CuTest* tc)
+{
+   apx_routerPortMapEntry_t portMapEntry;
+   apx_node_t nodes[NUM_TEST_NODES];
+   apx_portref_t *portref;
+   int32_t i;
+   apx_routerPortMapEntry_create(&portMapEntry);
+   for (i=0;i<NUM_TEST_NODES;i++)
+   {
+      apx_node_create(&nodes[i], "test");
+      if (i < NUM_TEST_NODES/2)
+      {
+         apx_node_createProvidePort(&nodes[i], "WheelBasedVehicleSpeed", "S", 0);
+         CuAssertIntEquals(tc, 0, apx_routerPortMapEntry_insertProvidePort(&portMapEntry,&nodes[i],0));
+      }
+      else
+      {
+         apx_node_createRequirePort(&nodes[i], "WheelBasedVehicleSpeed", "S", 0);
+         CuAssertIntEquals(tc, 0, apx_routerPortMapEntry_insertRequirePort(&portMapEntry,&nodes[i],0));
+      }
+   }
+   //removing a provider keeps the remaining providers in attach order
+   CuAssertIntEquals(tc, 0, apx_routerPortMapEntry_removePort(&portMapEntry,&nodes[1],apx_node_getProvidePort(&nodes[1],0)));
+   CuAssertIntEquals(tc, 2, adt_ary_length(&portMapEntry.providePorts));
+   CuAssertPtrEquals(tc, &nodes[0], apx_routerPortMapEntry_getProvidePortById(&portMapEntry,0)->node);
+   CuAssertPtrEquals(tc, &nodes[2], apx_routerPortMapEntry_getProvidePortById(&portMapEntry,1)->node);
+   CuAssertIntEquals(tc, -1, apx_node_getProvidePort(&nodes[1],0)->portMapIndex);
+   //removing a port that is not in the list has no effect
+   CuAssertIntEquals(tc, 0, apx_routerPortMapEntry_removePort(&portMapEntry,&nodes[1],apx_node_getProvidePort(&nodes[1],0)));
+   CuAssertIntEquals(tc, 2, adt_ary_length(&portMapEntry.providePorts));
+   //removing a require port moves the last require port into its position
+   CuAssertIntEquals(tc, 0, apx_routerPortMapEntry_removePort(&portMapEntry,&nodes[3],apx_node_getRequirePort(&nodes[3],0)));
+   CuAssertIntEquals(tc, 2, adt_ary_length(&portMapEntry.requirePorts));
+   portref = apx_routerPortMapEntry_getRequirePortById(&portMapEntry,0);
+   CuAssertPtrEquals(tc, &nodes[5], portref->node);
+   CuAssertIntEquals(tc, 0, portref->port->portMapIndex);
+   //the moved port can still be found
+   apx_routerPortMapEntry_insertRequirePort(&portMapEntry,&nodes[5],0);
+   CuAssertIntEquals(tc, 2, adt_ary_length(&portMapEntry.requirePorts));
+   CuAssertIntEquals(tc, 0, apx_routerPortMapEntry_removePort(&portMapEntry,&nodes[5],apx_node_getRequirePort(&nodes[5],0)));
+   CuAssertIntEquals(tc, 0, apx_routerPortMapEntry_removePort(&portMapEntry,&nodes[4],apx_node_getRequirePort(&nodes[4],0)));
+   CuAssertIntEquals(tc, 0, adt_ary_length(&portMapEntry.requirePorts));
 
+   apx_routerPortMapEntry_destroy(&portMapEntry);
+   for (i=0;i<NUM_TEST_NODES;i++)
+   {
+      apx_node_destroy(&nodes[i]);
+   }
+}
@@ -27,6 +27,9 @@
 // LOCAL FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
 static void test_apx_router_create(CuTest* tc);
+static void test_apx_router_attachDetachBookkeeping(CuTest* tc);
+static void test_apx_router_attachDetachBatch(CuTest* tc);
+static void verifyNodeInfoList(CuTest* tc, apx_router_t *router);
 //static int create_test_nodes(apx_node_t *nodeList, apx_nodeInfo_t *nodeInfoList, apx_port_t **ports, int maxNumNodes);
 //static void destroy_test_nodes(apx_node_t *nodeList, apx_nodeInfo_t *nodeInfoList, int numNodes);
 
@@ -49,6 +52,8 @@ CuSuite* testSuite_apx_router(void)
    CuSuite* suite = CuSuiteNew();
 
    SUITE_ADD_TEST(suite, test_apx_router_create);
+   SUITE_ADD_TEST(suite, test_apx_router_attachDetachBookkeeping);
+   SUITE_ADD_TEST(suite, test_apx_router_attachDetachBatch);
 
    return suite;
 }
@@ -167,6 +172,144 @@ static void test_apx_router_create(CuTest* tc)
    apx_parser_destroy(&parser);
 }
 
+static void test_apx_router_attachDetachBookkeeping(CuTest* tc)
+{
+   const char *fileNames[5] = {APX_TEST_DATA_PATH "test1.apx", APX_TEST_DATA_PATH "test2.apx", APX_TEST_DATA_PATH "test3.apx",
+         APX_TEST_DATA_PATH "test4.apx", APX_TEST_DATA_PATH "test5.apx"};
+   apx_node_t *apx_node[5];
+   apx_nodeInfo_t nodeInfoList[5];
+   apx_parser_t parser;
+   apx_router_t router;
+   int32_t i;
 
+   apx_parser_create(&parser);
+   for (i=0;i<5;i++)
+   {
+      apx_node[i] = apx_parser_parseFile(&parser, fileNames[i]);
+      CuAssertPtrNotNull(tc,apx_node[i]);
+      apx_nodeInfo_create(&nodeInfoList[i],apx_node[i]);
+   }
+   apx_router_create(&router);
+   for (i=0;i<5;i++)
+   {
+      apx_router_attachNodeInfo(&router,&nodeInfoList[i]);
+      CuAssertPtrEquals(tc, &router, nodeInfoList[i].router);
+      //every node that got new connectors has been post processed
+      CuAssertIntEquals(tc, 0, adt_ary_length(&router.dirtyNodeInfoList));
+   }
+   verifyNodeInfoList(tc, &router);
+   CuAssertIntEquals(tc, 5, adt_ary_length(&router.nodeInfoList));
+   for (i=0;i<5;i++)
+   {
+      CuAssertTrue(tc, !nodeInfoList[i].isDirty);
+      CuAssertUIntEquals(tc, 0, nodeInfoList[i].pendingProvidePortFlags);
+      CuAssertUIntEquals(tc, 0, nodeInfoList[i].pendingRequirePortFlags);
+   }
+   //attaching a node twice is ignored
+   apx_router_attachNodeInfo(&router,&nodeInfoList[2]);
+   CuAssertIntEquals(tc, 5, adt_ary_length(&router.nodeInfoList));
+
+   apx_router_detachNodeInfo(&router,&nodeInfoList[1]);
+   CuAssertIntEquals(tc, 4, adt_ary_length(&router.nodeInfoList));
+   CuAssertPtrEquals(tc, 0, nodeInfoList[1].router);
+   CuAssertPtrEquals(tc, 0, nodeInfoList[1].dirtyList);
+   CuAssertIntEquals(tc, 0, adt_ary_length(&router.dirtyNodeInfoList));
+   verifyNodeInfoList(tc, &router);
+   //detaching a node that is not attached is ignored
+   apx_router_detachNodeInfo(&router,&nodeInfoList[1]);
+   CuAssertIntEquals(tc, 4, adt_ary_length(&router.nodeInfoList));
+   apx_router_detachNodeInfo(&router,&nodeInfoList[4]);
+   apx_router_detachNodeInfo(&router,&nodeInfoList[0]);
+   CuAssertIntEquals(tc, 2, adt_ary_length(&router.nodeInfoList));
+   verifyNodeInfoList(tc, &router);
 
+   apx_router_destroy(&router);
+   for(i=0;i<5;i++)
+   {
+      apx_nodeInfo_destroy(&nodeInfoList[i]);
+   }
+   apx_parser_destroy(&parser);
+}
 
+static void test_apx_router_attachDetachBatch(CuTest* tc)
+{
+   const char *fileNames[4] = {APX_TEST_DATA_PATH "test1.apx", APX_TEST_DATA_PATH "test2.apx", APX_TEST_DATA_PATH "test3.apx",
+         APX_TEST_DATA_PATH "test4.apx"};
+   apx_node_t *apx_node[4];
+   apx_nodeInfo_t nodeInfoList[4];
+   apx_parser_t parser;
+   apx_router_t router;
+   adt_ary_t batch;
+   adt_ary_t *connectors;
+   int32_t i;
+
+   apx_parser_create(&parser);
+   for (i=0;i<4;i++)
+   {
+      apx_node[i] = apx_parser_parseFile(&parser, fileNames[i]);
+      CuAssertPtrNotNull(tc,apx_node[i]);
+      apx_nodeInfo_create(&nodeInfoList[i],apx_node[i]);
+   }
+   apx_router_create(&router);
+   adt_ary_create(&batch, (void(*)(void*)) 0);
+   adt_ary_push(&batch, &nodeInfoList[2]); //test3
+   adt_ary_push(&batch, &nodeInfoList[0]); //test1
+   adt_ary_push(&batch, &nodeInfoList[1]); //test2
+   adt_ary_push(&batch, &nodeInfoList[3]); //test4
+   apx_router_attachNodeInfoBatch(&router, &batch);
+   CuAssertIntEquals(tc, 4, adt_ary_length(&router.nodeInfoList));
+   CuAssertIntEquals(tc, 0, adt_ary_length(&router.dirtyNodeInfoList));
+   verifyNodeInfoList(tc, &router);
+   //test2 is attached after test1 and provides WheelBasedVehicleSpeed to test3 and test4
+   connectors = apx_nodeInfo_getProvidePortConnectorList(&nodeInfoList[1],0);
+   CuAssertPtrNotNull(tc,connectors);
+   CuAssertIntEquals(tc,2,adt_ary_length(connectors));
+   connectors = apx_nodeInfo_getProvidePortConnectorList(&nodeInfoList[0],0);
+   CuAssertTrue(tc, (connectors == 0) || (adt_ary_length(connectors) == 0) );
+   connectors = apx_nodeInfo_getProvidePortConnectorList(&nodeInfoList[0],2); //test1/VehicleMode
+   CuAssertPtrNotNull(tc,connectors);
+   CuAssertIntEquals(tc,2,adt_ary_length(connectors));
+   for (i=0;i<4;i++)
+   {
+      CuAssertUIntEquals(tc, 0, nodeInfoList[i].pendingProvidePortFlags);
+      CuAssertUIntEquals(tc, 0, nodeInfoList[i].pendingRequirePortFlags);
+   }
+
+   adt_ary_clear(&batch);
+   adt_ary_push(&batch, &nodeInfoList[1]); //test2
+   adt_ary_push(&batch, &nodeInfoList[3]); //test4
+   apx_router_detachNodeInfoBatch(&router, &batch);
+   CuAssertIntEquals(tc, 2, adt_ary_length(&router.nodeInfoList));
+   CuAssertIntEquals(tc, 0, adt_ary_length(&router.dirtyNodeInfoList));
+   verifyNodeInfoList(tc, &router);
+   CuAssertPtrEquals(tc, 0, nodeInfoList[1].router);
+   CuAssertPtrEquals(tc, 0, nodeInfoList[1].dirtyList);
+   CuAssertPtrEquals(tc, 0, nodeInfoList[3].dirtyList);
+   //test3 is rerouted to test1, test4 was detached in the same batch and is left unconnected
+   connectors = apx_nodeInfo_getProvidePortConnectorList(&nodeInfoList[0],0);
+   CuAssertPtrNotNull(tc,connectors);
+   CuAssertIntEquals(tc,1,adt_ary_length(connectors));
+   CuAssertPtrEquals(tc, 0, apx_nodeInfo_getRequirePortConnector(&nodeInfoList[3],0));
+   connectors = apx_nodeInfo_getProvidePortConnectorList(&nodeInfoList[0],2);
+   CuAssertTrue(tc, (connectors == 0) || (adt_ary_length(connectors) == 0) );
+
+   adt_ary_destroy(&batch);
+   apx_router_destroy(&router);
+   for(i=0;i<4;i++)
+   {
+      apx_nodeInfo_destroy(&nodeInfoList[i]);
+   }
+   apx_parser_destroy(&parser);
+}
+
+static void verifyNodeInfoList(CuTest* tc, apx_router_t *router)
+{
+   int32_t i;
+   int32_t numNodes = adt_ary_length(&router->nodeInfoList);
+   for (i=0;i<numNodes;i++)
+   {
+      apx_nodeInfo_t *nodeInfo = (apx_nodeInfo_t*) adt_ary_value(&router->nodeInfoList,i);
+      CuAssertPtrEquals(tc, router, nodeInfo->router);
+      CuAssertIntEquals(tc, i, nodeInfo->routerIndex);
+   }
+}
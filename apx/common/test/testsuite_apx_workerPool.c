@@ -0,0 +1,290 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx_workerPool.h"
+#include "apx_fileManager.h"
+#include "apx_nodeData.h"
+#include "apx_file.h"
+#include "rmf.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define NUM_CONNECTIONS 8
+#define NUM_WORKERS 3
+#define NUM_EVENTS 200
+#define SEND_BUF_SIZE 64
+#define WAIT_TIMEOUT_MS 5000
+#define WAIT_INTERVAL_MS 10
+
+typedef struct testConnection_tag
+{
+   apx_fileManager_t fileManager;
+   apx_nodeData_t nodeData;
+   apx_file_t *localFile; //weak pointer, owned by fileManager
+   uint8_t definitionBuf[NUM_EVENTS];
+   uint8_t sendBuf[SEND_BUF_SIZE];
+   uint8_t received[NUM_EVENTS];
+   uint32_t numReceived; //protected by fileManager.sendLock
+}testConnection_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_apx_workerPool_create(CuTest* tc);
+static void test_apx_workerPool_startStop(CuTest* tc);
+static void test_apx_workerPool_connectionOrderIsPreserved(CuTest* tc);
+static void test_apx_workerPool_restartFileManager(CuTest* tc);
+static uint8_t *testConnection_getSendBuffer(void *arg, int32_t msgLen);
+static int32_t testConnection_send(void *arg, int32_t offset, int32_t msgLen);
+static uint32_t testConnection_getNumReceived(testConnection_t *self);
+static uint32_t testConnection_waitForNumReceived(testConnection_t *self, uint32_t numExpected);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+
+CuSuite* testSuite_apx_workerPool(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_apx_workerPool_create);
+   SUITE_ADD_TEST(suite, test_apx_workerPool_startStop);
+   SUITE_ADD_TEST(suite, test_apx_workerPool_connectionOrderIsPreserved);
+   SUITE_ADD_TEST(suite, test_apx_workerPool_restartFileManager);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_apx_workerPool_create(CuTest* tc)
+{
+   apx_workerPool_t workerPool;
+   apx_workerPool_t *pWorkerPool;
+   CuAssertIntEquals(tc, -1, apx_workerPool_create(&workerPool, 0));
+   CuAssertIntEquals(tc, 0, apx_workerPool_create(&workerPool, NUM_WORKERS));
+   CuAssertIntEquals(tc, NUM_WORKERS, workerPool.numWorkers);
+   CuAssertIntEquals(tc, 0, workerPool.numStarted);
+   apx_workerPool_destroy(&workerPool);
+   pWorkerPool = apx_workerPool_new(1);
+   CuAssertPtrNotNull(tc, pWorkerPool);
+   apx_workerPool_delete(pWorkerPool);
+}
+
+static void test_apx_workerPool_startStop(CuTest* tc)
+{
+   apx_workerPool_t workerPool;
+   apx_workerPool_create(&workerPool, NUM_WORKERS);
+   CuAssertIntEquals(tc, 0, apx_workerPool_start(&workerPool));
+   CuAssertIntEquals(tc, NUM_WORKERS, workerPool.numStarted);
+   apx_workerPool_stop(&workerPool);
+   CuAssertIntEquals(tc, 0, workerPool.numStarted);
+   apx_workerPool_destroy(&workerPool);
+}
+
+static void test_apx_workerPool_connectionOrderIsPreserved(CuTest* tc)
+{
+   apx_workerPool_t workerPool;
+   testConnection_t *connections;
+   int32_t i;
+   int32_t j;
+   int32_t elapsed;
+   connections = (testConnection_t*) malloc(sizeof(testConnection_t)*NUM_CONNECTIONS);
+   CuAssertPtrNotNull(tc, connections);
+   apx_workerPool_create(&workerPool, NUM_WORKERS);
+   apx_workerPool_start(&workerPool);
+   for (i=0; i<NUM_CONNECTIONS; i++)
+   {
+      apx_transmitHandler_t transmitHandler;
+      testConnection_t *connection = &connections[i];
+      connection->numReceived = 0;
+      for (j=0; j<NUM_EVENTS; j++)
+      {
+         connection->definitionBuf[j] = (uint8_t) j;
+      }
+      apx_nodeData_create(&connection->nodeData, "TestNode", connection->definitionBuf, NUM_EVENTS, 0, 0, 0, 0, 0, 0);
+      CuAssertIntEquals(tc, 0, apx_fileManager_create(&connection->fileManager, APX_FILEMANAGER_SERVER_MODE));
+      memset(&transmitHandler, 0, sizeof(transmitHandler));
+      transmitHandler.arg = connection;
+      transmitHandler.getSendBuffer = testConnection_getSendBuffer;
+      transmitHandler.send = testConnection_send;
+      apx_fileManager_setTransmitHandler(&connection->fileManager, &transmitHandler);
+      apx_fileManager_setWorkerPool(&connection->fileManager, &workerPool);
+      connection->localFile = apx_file_newLocalDefinitionFile(&connection->nodeData);
+      CuAssertPtrNotNull(tc, connection->localFile);
+      apx_fileManager_attachLocalDefinitionFile(&connection->fileManager, connection->localFile);
+      apx_fileManager_start(&connection->fileManager);
+   }
+   //interleave events from all connections, each connection must still see its own events in order
+   for (j=0; j<NUM_EVENTS; j++)
+   {
+      for (i=0; i<NUM_CONNECTIONS; i++)
+      {
+         apx_fileManager_triggerFileUpdatedEvent(&connections[i].fileManager, connections[i].localFile, (uint32_t) j, 1);
+      }
+   }
+   for (i=0; i<NUM_CONNECTIONS; i++)
+   {
+      for (elapsed=0; elapsed<WAIT_TIMEOUT_MS; elapsed+=WAIT_INTERVAL_MS)
+      {
+         if (testConnection_getNumReceived(&connections[i]) == NUM_EVENTS)
+         {
+            break;
+         }
+         SLEEP(WAIT_INTERVAL_MS);
+      }
+      CuAssertIntEquals(tc, NUM_EVENTS, testConnection_getNumReceived(&connections[i]));
+      for (j=0; j<NUM_EVENTS; j++)
+      {
+         CuAssertIntEquals(tc, j, connections[i].received[j]);
+      }
+   }
+   for (i=0; i<NUM_CONNECTIONS; i++)
+   {
+      apx_fileManagerBatchStats_t stats;
+      apx_fileManager_stop(&connections[i].fileManager);
+      apx_fileManager_getBatchStats(&connections[i].fileManager, &stats);
+      //all events and the exit message were processed, in at most one batch per message
+      CuAssertTrue(tc, stats.numMessages > NUM_EVENTS);
+      CuAssertTrue(tc, stats.numBatches >= 1);
+      CuAssertTrue(tc, stats.numBatches <= stats.numMessages);
+      CuAssertTrue(tc, stats.maxBatchSize <= stats.numMessages);
+      apx_fileManager_destroy(&connections[i].fileManager);
+      apx_nodeData_destroy(&connections[i].nodeData);
+   }
+   apx_workerPool_destroy(&workerPool);
+   free(connections);
+}
+
+/**
+ * A stopped fileManager is scheduled again after a restart. Stopping it after the pool has been stopped must not block.
+ */
+static void test_apx_workerPool_restartFileManager(CuTest* tc)
+{
+   apx_workerPool_t workerPool;
+   apx_transmitHandler_t transmitHandler;
+   testConnection_t *connection;
+   int32_t j;
+   connection = (testConnection_t*) malloc(sizeof(testConnection_t));
+   CuAssertPtrNotNull(tc, connection);
+   apx_workerPool_create(&workerPool, NUM_WORKERS);
+   apx_workerPool_start(&workerPool);
+   connection->numReceived = 0;
+   for (j=0; j<NUM_EVENTS; j++)
+   {
+      connection->definitionBuf[j] = (uint8_t) j;
+   }
+   apx_nodeData_create(&connection->nodeData, "TestNode", connection->definitionBuf, NUM_EVENTS, 0, 0, 0, 0, 0, 0);
+   CuAssertIntEquals(tc, 0, apx_fileManager_create(&connection->fileManager, APX_FILEMANAGER_SERVER_MODE));
+   memset(&transmitHandler, 0, sizeof(transmitHandler));
+   transmitHandler.arg = connection;
+   transmitHandler.getSendBuffer = testConnection_getSendBuffer;
+   transmitHandler.send = testConnection_send;
+   apx_fileManager_setTransmitHandler(&connection->fileManager, &transmitHandler);
+   apx_fileManager_setWorkerPool(&connection->fileManager, &workerPool);
+   connection->localFile = apx_file_newLocalDefinitionFile(&connection->nodeData);
+   CuAssertPtrNotNull(tc, connection->localFile);
+   apx_fileManager_attachLocalDefinitionFile(&connection->fileManager, connection->localFile);
+
+   apx_fileManager_start(&connection->fileManager);
+   for (j=0; j<NUM_EVENTS/2; j++)
+   {
+      apx_fileManager_triggerFileUpdatedEvent(&connection->fileManager, connection->localFile, (uint32_t) j, 1);
+   }
+   CuAssertIntEquals(tc, NUM_EVENTS/2, testConnection_waitForNumReceived(connection, NUM_EVENTS/2));
+   apx_fileManager_stop(&connection->fileManager);
+   CuAssertTrue(tc, !connection->fileManager.isScheduled);
+
+   apx_fileManager_start(&connection->fileManager);
+   for (j=NUM_EVENTS/2; j<NUM_EVENTS; j++)
+   {
+      apx_fileManager_triggerFileUpdatedEvent(&connection->fileManager, connection->localFile, (uint32_t) j, 1);
+   }
+   CuAssertIntEquals(tc, NUM_EVENTS, testConnection_waitForNumReceived(connection, NUM_EVENTS));
+   for (j=0; j<NUM_EVENTS; j++)
+   {
+      CuAssertIntEquals(tc, j, connection->received[j]);
+   }
+   apx_fileManager_stop(&connection->fileManager);
+
+   //no worker is left to process RMF_MSG_EXIT
+   apx_fileManager_start(&connection->fileManager);
+   apx_workerPool_stop(&workerPool);
+   apx_fileManager_stop(&connection->fileManager);
+   CuAssertTrue(tc, !connection->fileManager.isWorkerPoolActive);
+
+   apx_fileManager_destroy(&connection->fileManager);
+   apx_nodeData_destroy(&connection->nodeData);
+   apx_workerPool_destroy(&workerPool);
+   free(connection);
+}
+
+static uint8_t *testConnection_getSendBuffer(void *arg, int32_t msgLen)
+{
+   testConnection_t *self = (testConnection_t*) arg;
+   if ( (self != 0) && (msgLen <= SEND_BUF_SIZE) )
+   {
+      return &self->sendBuf[0];
+   }
+   return 0;
+}
+
+/**
+ * called while fileManager.sendLock is held. Each message carries a single byte of data which is the last byte of the message.
+ */
+static int32_t testConnection_send(void *arg, int32_t offset, int32_t msgLen)
+{
+   testConnection_t *self = (testConnection_t*) arg;
+   if ( (self != 0) && (msgLen > 0) && (self->numReceived < NUM_EVENTS) )
+   {
+      self->received[self->numReceived++] = self->sendBuf[offset+msgLen-1];
+      return 0;
+   }
+   return -1;
+}
+
+static uint32_t testConnection_getNumReceived(testConnection_t *self)
+{
+   uint32_t retval;
+   SPINLOCK_ENTER(self->fileManager.sendLock);
+   retval = self->numReceived;
+   SPINLOCK_LEAVE(self->fileManager.sendLock);
+   return retval;
+}
+
+static uint32_t testConnection_waitForNumReceived(testConnection_t *self, uint32_t numExpected)
+{
+   int32_t elapsed;
+   for (elapsed=0; elapsed<WAIT_TIMEOUT_MS; elapsed+=WAIT_INTERVAL_MS)
+   {
+      if (testConnection_getNumReceived(self) == numExpected)
+      {
+         break;
+      }
+      SLEEP(WAIT_INTERVAL_MS);
+   }
+   return testConnection_getNumReceived(self);
+}
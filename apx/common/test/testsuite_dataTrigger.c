@@ -10,6 +10,8 @@
 #include "apx_dataTrigger.h"
 #include "apx_parser.h"
 #include "apx_router.h"
+#include "apx_nodeData.h"
+#include "apx_fileManager.h"
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
 #endif
@@ -28,6 +30,11 @@
 // LOCAL FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
 static void test_apx_dataTriggerTable_create(CuTest* tc);
+static void test_apx_dataTriggerFunction_routes(CuTest* tc);
+static void test_apx_dataTriggerFunction_invalidateRoutes(CuTest* tc);
+static void test_apx_dataTriggerFunction_invalidateOneRequester(CuTest* tc);
+static void test_apx_dataTriggerTable_findPort(CuTest* tc);
+static void test_apx_dataTriggerTable_nextConnectedPort(CuTest* tc);
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL VARIABLES
@@ -48,6 +55,11 @@ CuSuite* testSuite_apx_dataTrigger(void)
    CuSuite* suite = CuSuiteNew();
 
    SUITE_ADD_TEST(suite, test_apx_dataTriggerTable_create);
+   SUITE_ADD_TEST(suite, test_apx_dataTriggerFunction_routes);
+   SUITE_ADD_TEST(suite, test_apx_dataTriggerFunction_invalidateRoutes);
+   SUITE_ADD_TEST(suite, test_apx_dataTriggerFunction_invalidateOneRequester);
+   SUITE_ADD_TEST(suite, test_apx_dataTriggerTable_findPort);
+   SUITE_ADD_TEST(suite, test_apx_dataTriggerTable_nextConnectedPort);
 
    return suite;
 }
@@ -108,4 +120,129 @@ static void test_apx_dataTriggerTable_create(CuTest* tc)
    apx_parser_destroy(&parser);
 }
 
+static void test_apx_dataTriggerFunction_routes(CuTest* tc)
+{
+   apx_dataTriggerFunction_t triggerFunction;
+   apx_nodeInfo_t nodeInfo[10];
+   int32_t i;
+   memset(&nodeInfo[0], 0, sizeof(nodeInfo));
+   apx_dataTriggerFunction_create(&triggerFunction, 4, 2);
+   CuAssertIntEquals(tc, 0, apx_dataTriggerFunction_compileRoutes(&triggerFunction));
+   for (i=0; i<10; i++)
+   {
+      CuAssertIntEquals(tc, 0, apx_dataTriggerFunction_addRoute(&triggerFunction, &nodeInfo[i], (uint32_t) i*2));
+   }
+   CuAssertIntEquals(tc, 10, apx_dataTriggerFunction_compileRoutes(&triggerFunction));
+   CuAssertTrue(tc, triggerFunction.routeCapacity >= 10);
+   for (i=0; i<10; i++)
+   {
+      CuAssertPtrEquals(tc, &nodeInfo[i], triggerFunction.routeNodeInfo[i]);
+      CuAssertUIntEquals(tc, i*2, triggerFunction.routeDestOffset[i]);
+      //no nodeData attached yet, nothing to write to
+      CuAssertPtrEquals(tc, 0, triggerFunction.routeFile[i]);
+   }
+   apx_dataTriggerFunction_clearRoutes(&triggerFunction);
+   CuAssertIntEquals(tc, 0, apx_dataTriggerFunction_compileRoutes(&triggerFunction));
+   CuAssertTrue(tc, triggerFunction.routeCapacity >= 10);
+   apx_dataTriggerFunction_destroy(&triggerFunction);
+}
 
+static void test_apx_dataTriggerFunction_invalidateRoutes(CuTest* tc)
+{
+   apx_dataTriggerFunction_t triggerFunction;
+   apx_nodeInfo_t nodeInfo;
+   apx_nodeData_t nodeData;
+   apx_file_t *file = (apx_file_t*) 0x1000; //never dereferenced
+   apx_fileManager_t *fileManager = (apx_fileManager_t*) 0x2000;
+   memset(&nodeInfo, 0, sizeof(nodeInfo));
+   memset(&nodeData, 0, sizeof(nodeData));
+   apx_dataTriggerFunction_create(&triggerFunction, 0, 1);
+   apx_dataTriggerFunction_addRoute(&triggerFunction, &nodeInfo, 3);
+   CuAssertIntEquals(tc, 1, apx_dataTriggerFunction_compileRoutes(&triggerFunction));
+   CuAssertPtrEquals(tc, 0, triggerFunction.routeFile[0]);
+   apx_nodeData_setNodeInfo(&nodeData, &nodeInfo);
+   apx_nodeInfo_setNodeData(&nodeInfo, &nodeData);
+   apx_nodeData_setFileManager(&nodeData, fileManager);
+   apx_nodeData_setInPortDataFile(&nodeData, file);
+   CuAssertIntEquals(tc, 1, apx_dataTriggerFunction_compileRoutes(&triggerFunction));
+   CuAssertPtrEquals(tc, file, triggerFunction.routeFile[0]);
+   CuAssertPtrEquals(tc, fileManager, triggerFunction.routeFileManager[0]);
+   apx_nodeData_setInPortDataFile(&nodeData, 0);
+   CuAssertIntEquals(tc, 1, apx_dataTriggerFunction_compileRoutes(&triggerFunction));
+   CuAssertPtrEquals(tc, 0, triggerFunction.routeFile[0]);
+   apx_dataTriggerFunction_destroy(&triggerFunction);
+}
+
+static void test_apx_dataTriggerFunction_invalidateOneRequester(CuTest* tc)
+{
+   apx_dataTriggerFunction_t triggerFunction;
+   apx_nodeInfo_t nodeInfo[2];
+   apx_nodeData_t nodeData[2];
+   apx_file_t *file = (apx_file_t*) 0x1000; //never dereferenced
+   apx_fileManager_t *fileManager1 = (apx_fileManager_t*) 0x2000;
+   apx_fileManager_t *fileManager2 = (apx_fileManager_t*) 0x3000;
+   int32_t i;
+   memset(&nodeInfo[0], 0, sizeof(nodeInfo));
+   memset(&nodeData[0], 0, sizeof(nodeData));
+   apx_dataTriggerFunction_create(&triggerFunction, 0, 1);
+   for (i=0; i<2; i++)
+   {
+      apx_nodeData_setNodeInfo(&nodeData[i], &nodeInfo[i]);
+      apx_nodeInfo_setNodeData(&nodeInfo[i], &nodeData[i]);
+      apx_nodeData_setInPortDataFile(&nodeData[i], file);
+      apx_nodeData_setFileManager(&nodeData[i], fileManager1);
+      apx_dataTriggerFunction_addRoute(&triggerFunction, &nodeInfo[i], (uint32_t) i);
+   }
+   CuAssertIntEquals(tc, 2, apx_dataTriggerFunction_compileRoutes(&triggerFunction));
+   CuAssertPtrEquals(tc, fileManager1, triggerFunction.routeFileManager[0]);
+   CuAssertPtrEquals(tc, fileManager1, triggerFunction.routeFileManager[1]);
+   //bypass the setter of the second requester, its route must not be re-resolved when only the first requester changes
+   nodeData[1].fileManager = fileManager2;
+   apx_nodeData_setFileManager(&nodeData[0], fileManager2);
+   CuAssertIntEquals(tc, 2, apx_dataTriggerFunction_compileRoutes(&triggerFunction));
+   CuAssertPtrEquals(tc, fileManager2, triggerFunction.routeFileManager[0]);
+   CuAssertPtrEquals(tc, fileManager1, triggerFunction.routeFileManager[1]);
+   apx_dataTrigger_invalidateRoutes(&nodeInfo[1]);
+   CuAssertIntEquals(tc, 2, apx_dataTriggerFunction_compileRoutes(&triggerFunction));
+   CuAssertPtrEquals(tc, fileManager2, triggerFunction.routeFileManager[1]);
+   apx_dataTriggerFunction_destroy(&triggerFunction);
+}
+
+static void test_apx_dataTriggerTable_findPort(CuTest* tc)
+{
+   apx_dataTriggerTable_t table;
+   uint32_t portOffsets[5] = {0, 1, 3, 3, 8}; //port 2 has length 0
+   uint32_t connectedPorts[1] = {0};
+   memset(&table, 0, sizeof(table));
+   table.portOffsets = &portOffsets[0];
+   table.connectedPorts = &connectedPorts[0];
+   table.numPorts = 4;
+   CuAssertIntEquals(tc, 0, apx_dataTriggerTable_findPort(&table, 0));
+   CuAssertIntEquals(tc, 1, apx_dataTriggerTable_findPort(&table, 1));
+   CuAssertIntEquals(tc, 1, apx_dataTriggerTable_findPort(&table, 2));
+   CuAssertIntEquals(tc, 3, apx_dataTriggerTable_findPort(&table, 3));
+   CuAssertIntEquals(tc, 3, apx_dataTriggerTable_findPort(&table, 7));
+   CuAssertIntEquals(tc, -1, apx_dataTriggerTable_findPort(&table, 8));
+   table.numPorts = 0;
+   CuAssertIntEquals(tc, -1, apx_dataTriggerTable_findPort(&table, 0));
+}
+
+static void test_apx_dataTriggerTable_nextConnectedPort(CuTest* tc)
+{
+   apx_dataTriggerTable_t table;
+   uint32_t connectedPorts[4] = {0, 0, 0, 0};
+   memset(&table, 0, sizeof(table));
+   table.connectedPorts = &connectedPorts[0];
+   table.numPorts = 100;
+   CuAssertIntEquals(tc, -1, apx_dataTriggerTable_nextConnectedPort(&table, 0, 100));
+   connectedPorts[0] = 1u << 5;
+   connectedPorts[2] = 1u << 1; //port 65
+   connectedPorts[3] = 1u << 3; //port 99
+   CuAssertIntEquals(tc, 5, apx_dataTriggerTable_nextConnectedPort(&table, 0, 100));
+   CuAssertIntEquals(tc, 5, apx_dataTriggerTable_nextConnectedPort(&table, 5, 100));
+   CuAssertIntEquals(tc, 65, apx_dataTriggerTable_nextConnectedPort(&table, 6, 100));
+   CuAssertIntEquals(tc, -1, apx_dataTriggerTable_nextConnectedPort(&table, 6, 65));
+   CuAssertIntEquals(tc, 99, apx_dataTriggerTable_nextConnectedPort(&table, 66, 100));
+   CuAssertIntEquals(tc, 99, apx_dataTriggerTable_nextConnectedPort(&table, 66, 1000));
+   CuAssertIntEquals(tc, -1, apx_dataTriggerTable_nextConnectedPort(&table, 100, 1000));
+}
@@ -0,0 +1,99 @@
+/**
+ * Linux epoll based event loop. Replaces the per-connection I/O thread of msocket by letting one thread service many sockets.
+ * Outgoing data is written without blocking, whatever the socket can't accept right away is written by the event loop thread once the socket becomes writable.
+ */
+#ifndef APX_EVENT_LOOP_H
+#define APX_EVENT_LOOP_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#if defined(_MSC_PLATFORM_TOOLSET) && (_MSC_PLATFORM_TOOLSET<=110)
+#include "msc_bool.h"
+#else
+#include <stdbool.h>
+#endif
+
+#ifdef __linux__
+#define APX_EVENT_LOOP_SUPPORTED 1
+#else
+#define APX_EVENT_LOOP_SUPPORTED 0
+#endif
+
+#if APX_EVENT_LOOP_SUPPORTED
+#include <pthread.h>
+#include "osmacro.h"
+#include "msocket.h"
+#include "adt_bytearray.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#ifndef APX_EVENT_LOOP_MAX_EVENTS
+#define APX_EVENT_LOOP_MAX_EVENTS 256 //maximum number of epoll events returned from one call to epoll_wait
+#endif
+
+#ifndef APX_EVENT_LOOP_READ_SIZE
+#define APX_EVENT_LOOP_READ_SIZE 16384 //number of bytes read from a socket in each call to recv
+#endif
+
+#ifndef APX_EVENT_LOOP_MAX_PENDING_SEND
+#define APX_EVENT_LOOP_MAX_PENDING_SEND 4194304 //a connection is closed when its peer lets more than this number of unsent bytes pile up (4MB)
+#endif
+
+/**
+ * a socket registered in the event loop
+ */
+typedef struct apx_eventLoopItem_tag
+{
+   int fd;
+   msocket_handler_t handlerTable; //only tcp_data and tcp_disconnected are used
+   void *handlerArg;
+   adt_bytearray_t receiveBuffer; //holds partial messages between two read events
+   MUTEX_T sendLock; //protects sendBuffer, isClosed and refCount. Held while writing to fd
+   adt_bytearray_t sendBuffer; //data not yet accepted by the socket, written by the event loop thread on EPOLLOUT
+   bool isClosed; //set when the socket is closing (send error or item removed from the event loop), nothing is written to fd after that
+   uint8_t refCount; //the event loop holds one reference, the owner of the socket may hold another
+   struct apx_eventLoopItem_tag *next; //next item in list of all registered items
+   struct apx_eventLoopItem_tag *prev; //previous item in list of all registered items
+}apx_eventLoopItem_t;
+
+typedef struct apx_eventLoop_tag
+{
+   THREAD_T workerThread;
+   bool workerThreadValid;
+   int epollFd;
+   int wakeupFd; //eventfd used to wake up the worker thread when it's time to stop
+   SPINLOCK_T lock; //protects itemList
+   apx_eventLoopItem_t *itemList; //strong references to all registered items
+   uint32_t numItems;
+   bool isRunning;
+   uint8_t readBuffer[APX_EVENT_LOOP_READ_SIZE]; //only accessed by workerThread
+}apx_eventLoop_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+int8_t apx_eventLoop_create(apx_eventLoop_t *self);
+void apx_eventLoop_destroy(apx_eventLoop_t *self);
+apx_eventLoop_t *apx_eventLoop_new(void);
+void apx_eventLoop_delete(apx_eventLoop_t *self);
+void apx_eventLoop_vdelete(void *arg);
+
+int8_t apx_eventLoop_start(apx_eventLoop_t *self);
+void apx_eventLoop_stop(apx_eventLoop_t *self);
+int8_t apx_eventLoop_pinToCpu(apx_eventLoop_t *self, uint16_t index);
+int8_t apx_eventLoop_addSocket(apx_eventLoop_t *self, int fd, const msocket_handler_t *handlerTable, void *handlerArg, apx_eventLoopItem_t **item);
+uint32_t apx_eventLoop_getNumSockets(apx_eventLoop_t *self);
+int8_t apx_eventLoopItem_send(apx_eventLoopItem_t *self, const uint8_t *data, uint32_t dataLen);
+void apx_eventLoopItem_release(apx_eventLoopItem_t *self);
+
+#endif //APX_EVENT_LOOP_SUPPORTED
+
+#endif //APX_EVENT_LOOP_H
@@ -13,6 +13,8 @@
 #include "apx_nodeManager.h"
 #include "apx_serverConnection.h"
 #include "apx_router.h"
+#include "apx_workerPool.h"
+#include "apx_eventLoop.h"
 #include "adt_list.h"
 
 
@@ -32,6 +34,14 @@ typedef struct apx_server_tag
    apx_router_t router; //this component handles all routing tables within the server
    MUTEX_T mutex;
    int8_t debugMode;
+   uint16_t numWorkers; //number of threads in workerPool, 0 means that each connection uses its own worker thread
+   apx_workerPool_t *workerPool; //strong pointer to worker pool shared by all connections (created by apx_server_start)
+   bool isConflationEnabled; //when true, each connection only transmits the latest pending value of each port
+#if APX_EVENT_LOOP_SUPPORTED
+   uint16_t numEventLoops; //number of event loop threads servicing socket reads, 0 means that each connection uses its own msocket I/O thread
+   uint16_t nextEventLoop; //index of the event loop that receives the next accepted connection
+   apx_eventLoop_t **eventLoops; //strong pointer to array of strong pointers to event loops (created by apx_server_start)
+#endif
 }apx_server_t;
 
 //////////////////////////////////////////////////////////////////////////////
@@ -46,6 +56,11 @@ void apx_server_create(apx_server_t *self, uint16_t port);
 void apx_server_destroy(apx_server_t *self);
 void apx_server_start(apx_server_t *self);
 void apx_server_setDebugMode(apx_server_t *self, int8_t debugMode);
+void apx_server_setNumWorkers(apx_server_t *self, uint16_t numWorkers);
+void apx_server_setNumEventLoops(apx_server_t *self, uint16_t numEventLoops);
+void apx_server_setConflationMode(apx_server_t *self, bool isEnabled);
+void apx_server_setSessionGracePeriod(apx_server_t *self, uint32_t gracePeriodMs);
+void apx_server_expireSessions(apx_server_t *self);
 
 
 #endif //APX_SERVER_H
@@ -28,6 +28,23 @@
 struct apx_server_tag;
 struct apx_testServer_tag;
 
+#ifndef APX_SERVER_CONNECTION_MAX_QUEUED_FRAMES
+#define APX_SERVER_CONNECTION_MAX_QUEUED_FRAMES 64 //maximum number of messages that are transmitted together in one batch
+#endif
+
+#ifndef APX_SERVER_CONNECTION_MAX_QUEUED_BYTES
+#define APX_SERVER_CONNECTION_MAX_QUEUED_BYTES 65536 //the send queue is transmitted early when it grows beyond this size
+#endif
+
+/**
+ * location of one complete message (header included) inside the sendBuffer
+ */
+typedef struct apx_serverConnectionFrame_tag
+{
+   uint32_t offset;
+   uint32_t length;
+}apx_serverConnectionFrame_t;
+
 typedef struct apx_serverConnection_tag
 {
    apx_fileManager_t fileManager;
@@ -37,12 +54,18 @@ typedef struct apx_serverConnection_tag
 #else
    msocket_t *msocket;
    struct apx_server_tag *server;
+   struct apx_eventLoopItem_tag *eventLoopItem; //strong reference, when set all output is written without blocking through the event loop instead of msocket_send
 #endif
 
    bool isGreetingParsed;
    int8_t debugMode;
    adt_bytearray_t sendBuffer;
    uint8_t numHeaderMaxLen;
+   //outbound frame queue, protected by fileManager.sendLock
+   bool isBatchActive; //when true, messages are queued in the beginning of sendBuffer instead of being sent immediately
+   uint32_t sendQueueLen; //number of bytes in the beginning of sendBuffer that are occupied by queued frames
+   uint16_t numQueuedFrames;
+   apx_serverConnectionFrame_t queuedFrames[APX_SERVER_CONNECTION_MAX_QUEUED_FRAMES];
 }apx_serverConnection_t;
 
 //////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,686 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE //pthread_setaffinity_np
+#endif
+#include "apx_eventLoop.h"
+#if APX_EVENT_LOOP_SUPPORTED
+#include <errno.h>
+#include <sched.h>
+#include <malloc.h>
+#include <assert.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "apx_logging.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define RECEIVE_BUFFER_GROW_SIZE 8192
+#define SEND_BUFFER_GROW_SIZE 8192
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static apx_eventLoopItem_t *apx_eventLoopItem_new(int fd, const msocket_handler_t *handlerTable, void *handlerArg);
+static void apx_eventLoopItem_delete(apx_eventLoopItem_t *self);
+static int8_t apx_eventLoopItem_write(apx_eventLoopItem_t *self, const uint8_t *data, uint32_t dataLen, uint32_t *sendLen);
+static int8_t apx_eventLoopItem_writePending(apx_eventLoopItem_t *self);
+static void apx_eventLoopItem_markClosed(apx_eventLoopItem_t *self);
+static void apx_eventLoop_insertItem(apx_eventLoop_t *self, apx_eventLoopItem_t *item);
+static void apx_eventLoop_removeItem(apx_eventLoop_t *self, apx_eventLoopItem_t *item);
+static void apx_eventLoop_deleteAllItems(apx_eventLoop_t *self);
+static int8_t apx_eventLoop_readItem(apx_eventLoop_t *self, apx_eventLoopItem_t *item);
+static int8_t apx_eventLoop_processData(apx_eventLoopItem_t *item, const uint8_t *dataBuf, uint32_t dataLen);
+static void apx_eventLoop_closeItem(apx_eventLoop_t *self, apx_eventLoopItem_t *item);
+static THREAD_PROTO(eventLoopTask,arg);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+int8_t apx_eventLoop_create(apx_eventLoop_t *self)
+{
+   if (self != 0)
+   {
+      struct epoll_event event;
+      self->epollFd = epoll_create1(EPOLL_CLOEXEC);
+      if (self->epollFd < 0)
+      {
+         return -1;
+      }
+      self->wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if (self->wakeupFd < 0)
+      {
+         int savedErrno = errno;
+         close(self->epollFd);
+         errno = savedErrno;
+         return -1;
+      }
+      memset(&event, 0, sizeof(event));
+      event.events = EPOLLIN;
+      event.data.ptr = (void*) 0; //a null pointer identifies the wakeupFd
+      if (epoll_ctl(self->epollFd, EPOLL_CTL_ADD, self->wakeupFd, &event) != 0)
+      {
+         int savedErrno = errno;
+         close(self->wakeupFd);
+         close(self->epollFd);
+         errno = savedErrno;
+         return -1;
+      }
+      self->workerThreadValid = false;
+      self->itemList = (apx_eventLoopItem_t*) 0;
+      self->numItems = 0;
+      self->isRunning = false;
+      SPINLOCK_INIT(self->lock);
+      return 0;
+   }
+   errno = EINVAL;
+   return -1;
+}
+
+void apx_eventLoop_destroy(apx_eventLoop_t *self)
+{
+   if (self != 0)
+   {
+      apx_eventLoop_stop(self);
+      apx_eventLoop_deleteAllItems(self);
+      close(self->wakeupFd);
+      close(self->epollFd);
+      SPINLOCK_DESTROY(self->lock);
+   }
+}
+
+apx_eventLoop_t *apx_eventLoop_new(void)
+{
+   apx_eventLoop_t *self = (apx_eventLoop_t*) malloc(sizeof(apx_eventLoop_t));
+   if(self != 0)
+   {
+      int8_t result = apx_eventLoop_create(self);
+      if (result != 0)
+      {
+         free(self);
+         self = 0;
+      }
+   }
+   else
+   {
+      errno = ENOMEM;
+   }
+   return self;
+}
+
+void apx_eventLoop_delete(apx_eventLoop_t *self)
+{
+   if (self != 0)
+   {
+      apx_eventLoop_destroy(self);
+      free(self);
+   }
+}
+
+void apx_eventLoop_vdelete(void *arg)
+{
+   apx_eventLoop_delete((apx_eventLoop_t*) arg);
+}
+
+int8_t apx_eventLoop_start(apx_eventLoop_t *self)
+{
+   if ( (self != 0) && (self->workerThreadValid == false) )
+   {
+      int rc;
+      self->isRunning = true;
+      rc = THREAD_CREATE(self->workerThread,eventLoopTask,self);
+      if(rc != 0)
+      {
+         self->isRunning = false;
+         errno = rc;
+         return -1;
+      }
+      self->workerThreadValid = true;
+      return 0;
+   }
+   errno = EINVAL;
+   return -1;
+}
+
+/**
+ * Pins the worker thread to one CPU. index selects the CPU among those the process is allowed to run on (modulo their number).
+ * Must be called after apx_eventLoop_start.
+ */
+int8_t apx_eventLoop_pinToCpu(apx_eventLoop_t *self, uint16_t index)
+{
+   if ( (self != 0) && (self->workerThreadValid == true) )
+   {
+      cpu_set_t allowedCpus;
+      cpu_set_t cpuSet;
+      int numAllowedCpus;
+      int cpu;
+      int rc;
+      if (sched_getaffinity(0, sizeof(allowedCpus), &allowedCpus) != 0)
+      {
+         return -1;
+      }
+      numAllowedCpus = CPU_COUNT(&allowedCpus);
+      if (numAllowedCpus == 0)
+      {
+         errno = EINVAL;
+         return -1;
+      }
+      index = (uint16_t) (index % numAllowedCpus);
+      for (cpu=0; cpu<CPU_SETSIZE; cpu++)
+      {
+         if (CPU_ISSET(cpu, &allowedCpus))
+         {
+            if (index == 0)
+            {
+               break;
+            }
+            index--;
+         }
+      }
+      CPU_ZERO(&cpuSet);
+      CPU_SET(cpu, &cpuSet);
+      rc = pthread_setaffinity_np(self->workerThread, sizeof(cpuSet), &cpuSet);
+      if (rc != 0)
+      {
+         errno = rc;
+         return -1;
+      }
+      return 0;
+   }
+   errno = EINVAL;
+   return -1;
+}
+
+/**
+ * Stops the worker thread. Sockets that are still registered are removed from the event loop when it is destroyed, their tcp_disconnected handlers are never called.
+ */
+void apx_eventLoop_stop(apx_eventLoop_t *self)
+{
+   if ( (self != 0) && (self->workerThreadValid == true) )
+   {
+      uint64_t value = 1;
+      SPINLOCK_ENTER(self->lock);
+      self->isRunning = false;
+      SPINLOCK_LEAVE(self->lock);
+      if (write(self->wakeupFd, &value, sizeof(value)) != sizeof(value))
+      {
+         APX_LOG_ERROR("[APX_EVENT_LOOP] failed to wake up worker thread, errno=%d", errno);
+      }
+      if(pthread_equal(pthread_self(),self->workerThread) == 0)
+      {
+         void *status;
+         int s = pthread_join(self->workerThread, &status);
+         if (s != 0)
+         {
+            APX_LOG_ERROR("[APX_EVENT_LOOP] pthread_join error %d\n",s);
+         }
+      }
+      else
+      {
+         APX_LOG_ERROR("[APX_EVENT_LOOP] pthread_join attempted on pthread_self()\n");
+      }
+      self->workerThreadValid = false;
+   }
+}
+
+/**
+ * Registers a connected socket in the event loop. From now on all data received on fd is delivered to handlerTable->tcp_data from the event loop thread.
+ * handlerTable->tcp_disconnected is called (also from the event loop thread) when the peer closes the connection or an error occurs.
+ * The event loop never closes fd, that is still the responsibility of the owner of the socket.
+ * The socket is read and written using MSG_DONTWAIT which means the file descriptor itself can stay in blocking mode.
+ * When item is not null it receives a reference to the registered item which the owner uses with apx_eventLoopItem_send.
+ * The owner must give it back using apx_eventLoopItem_release before it closes fd.
+ */
+int8_t apx_eventLoop_addSocket(apx_eventLoop_t *self, int fd, const msocket_handler_t *handlerTable, void *handlerArg, apx_eventLoopItem_t **item)
+{
+   if ( (self != 0) && (fd >= 0) && (handlerTable != 0) )
+   {
+      struct epoll_event event;
+      apx_eventLoopItem_t *newItem = apx_eventLoopItem_new(fd, handlerTable, handlerArg);
+      if (newItem == 0)
+      {
+         errno = ENOMEM;
+         return -1;
+      }
+      if (item != 0)
+      {
+         newItem->refCount++;
+      }
+      apx_eventLoop_insertItem(self, newItem);
+      memset(&event, 0, sizeof(event));
+      //in edge-triggered mode EPOLLOUT is only reported when the socket goes from full to writable, which is exactly when the sendBuffer needs attention
+      event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+      event.data.ptr = (void*) newItem;
+      if (epoll_ctl(self->epollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+      {
+         int savedErrno = errno;
+         APX_LOG_ERROR("[APX_EVENT_LOOP] epoll_ctl(EPOLL_CTL_ADD) failed, errno=%d", savedErrno);
+         apx_eventLoop_removeItem(self, newItem);
+         apx_eventLoopItem_delete(newItem);
+         errno = savedErrno;
+         return -1;
+      }
+      if (item != 0)
+      {
+         *item = newItem;
+      }
+      return 0;
+   }
+   errno = EINVAL;
+   return -1;
+}
+
+uint32_t apx_eventLoop_getNumSockets(apx_eventLoop_t *self)
+{
+   uint32_t retval = 0;
+   if (self != 0)
+   {
+      SPINLOCK_ENTER(self->lock);
+      retval = self->numItems;
+      SPINLOCK_LEAVE(self->lock);
+   }
+   return retval;
+}
+
+/**
+ * Sends data on the socket of the item without ever blocking the caller. Can be called from any thread.
+ * Data that the socket doesn't accept right away is copied to the sendBuffer of the item and written by the event loop thread when the socket becomes writable.
+ * A peer that stops reading gets its connection closed once APX_EVENT_LOOP_MAX_PENDING_SEND bytes are waiting.
+ * Returns 0 when all data was either sent or queued, -1 when the socket is closing.
+ */
+int8_t apx_eventLoopItem_send(apx_eventLoopItem_t *self, const uint8_t *data, uint32_t dataLen)
+{
+   if ( (self != 0) && (data != 0) )
+   {
+      int8_t retval = 0;
+      MUTEX_LOCK(self->sendLock);
+      if (self->isClosed == true)
+      {
+         errno = ENOTCONN;
+         retval = -1;
+      }
+      else
+      {
+         uint32_t sendLen = 0;
+         uint32_t pendingLen = adt_bytearray_length(&self->sendBuffer);
+         if (pendingLen == 0)
+         {
+            //nothing is waiting, try to write directly from the caller's buffer
+            retval = apx_eventLoopItem_write(self, data, dataLen, &sendLen);
+         }
+         if ( (retval == 0) && (sendLen < dataLen) )
+         {
+            if ( (pendingLen + (dataLen - sendLen)) > APX_EVENT_LOOP_MAX_PENDING_SEND)
+            {
+               APX_LOG_ERROR("[APX_EVENT_LOOP] peer of fd %d is not reading, %u bytes are waiting to be sent", self->fd, (unsigned int) pendingLen);
+               retval = -1;
+            }
+            else if (adt_bytearray_append(&self->sendBuffer, data + sendLen, dataLen - sendLen) != 0)
+            {
+               APX_LOG_ERROR("[APX_EVENT_LOOP] %s", "out of memory in send buffer");
+               retval = -1;
+            }
+         }
+         if (retval != 0)
+         {
+            //the event loop thread sees the hangup and closes the item
+            apx_eventLoopItem_markClosed(self);
+            (void) shutdown(self->fd, SHUT_RDWR);
+         }
+      }
+      MUTEX_UNLOCK(self->sendLock);
+      return retval;
+   }
+   errno = EINVAL;
+   return -1;
+}
+
+/**
+ * Gives back the reference received from apx_eventLoop_addSocket. The item is deleted when both the owner and the event loop are done with it.
+ */
+void apx_eventLoopItem_release(apx_eventLoopItem_t *self)
+{
+   if (self != 0)
+   {
+      uint8_t refCount;
+      MUTEX_LOCK(self->sendLock);
+      refCount = --self->refCount;
+      MUTEX_UNLOCK(self->sendLock);
+      if (refCount == 0)
+      {
+         apx_eventLoopItem_delete(self);
+      }
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static apx_eventLoopItem_t *apx_eventLoopItem_new(int fd, const msocket_handler_t *handlerTable, void *handlerArg)
+{
+   apx_eventLoopItem_t *self = (apx_eventLoopItem_t*) malloc(sizeof(apx_eventLoopItem_t));
+   if (self != 0)
+   {
+      self->fd = fd;
+      memcpy(&self->handlerTable, handlerTable, sizeof(msocket_handler_t));
+      self->handlerArg = handlerArg;
+      adt_bytearray_create(&self->receiveBuffer, RECEIVE_BUFFER_GROW_SIZE);
+      adt_bytearray_create(&self->sendBuffer, SEND_BUFFER_GROW_SIZE);
+      MUTEX_INIT(self->sendLock);
+      self->isClosed = false;
+      self->refCount = 1;
+      self->next = (apx_eventLoopItem_t*) 0;
+      self->prev = (apx_eventLoopItem_t*) 0;
+   }
+   return self;
+}
+
+static void apx_eventLoopItem_delete(apx_eventLoopItem_t *self)
+{
+   if (self != 0)
+   {
+      adt_bytearray_destroy(&self->receiveBuffer);
+      adt_bytearray_destroy(&self->sendBuffer);
+      MUTEX_DESTROY(self->sendLock);
+      free(self);
+   }
+}
+
+static void apx_eventLoop_insertItem(apx_eventLoop_t *self, apx_eventLoopItem_t *item)
+{
+   SPINLOCK_ENTER(self->lock);
+   item->prev = (apx_eventLoopItem_t*) 0;
+   item->next = self->itemList;
+   if (self->itemList != 0)
+   {
+      self->itemList->prev = item;
+   }
+   self->itemList = item;
+   self->numItems++;
+   SPINLOCK_LEAVE(self->lock);
+}
+
+static void apx_eventLoop_removeItem(apx_eventLoop_t *self, apx_eventLoopItem_t *item)
+{
+   SPINLOCK_ENTER(self->lock);
+   if (item->prev != 0)
+   {
+      item->prev->next = item->next;
+   }
+   else
+   {
+      self->itemList = item->next;
+   }
+   if (item->next != 0)
+   {
+      item->next->prev = item->prev;
+   }
+   item->next = (apx_eventLoopItem_t*) 0;
+   item->prev = (apx_eventLoopItem_t*) 0;
+   self->numItems--;
+   SPINLOCK_LEAVE(self->lock);
+}
+
+/**
+ * Only called when the worker thread is not running
+ */
+static void apx_eventLoop_deleteAllItems(apx_eventLoop_t *self)
+{
+   apx_eventLoopItem_t *item = self->itemList;
+   while (item != 0)
+   {
+      apx_eventLoopItem_t *next = item->next;
+      (void) epoll_ctl(self->epollFd, EPOLL_CTL_DEL, item->fd, (struct epoll_event*) 0);
+      MUTEX_LOCK(item->sendLock);
+      apx_eventLoopItem_markClosed(item);
+      MUTEX_UNLOCK(item->sendLock);
+      apx_eventLoopItem_release(item);
+      item = next;
+   }
+   self->itemList = (apx_eventLoopItem_t*) 0;
+   self->numItems = 0;
+}
+
+/**
+ * Edge-triggered mode requires us to read until the socket reports EAGAIN.
+ * Returns 0 when the socket is still healthy and -1 when it should be closed
+ */
+static int8_t apx_eventLoop_readItem(apx_eventLoop_t *self, apx_eventLoopItem_t *item)
+{
+   for(;;)
+   {
+      ssize_t len = recv(item->fd, &self->readBuffer[0], sizeof(self->readBuffer), MSG_DONTWAIT);
+      if (len > 0)
+      {
+         if (apx_eventLoop_processData(item, &self->readBuffer[0], (uint32_t) len) != 0)
+         {
+            return -1;
+         }
+      }
+      else if (len == 0)
+      {
+         //peer has closed the connection
+         return -1;
+      }
+      else if ( (errno == EAGAIN) || (errno == EWOULDBLOCK) )
+      {
+         break;
+      }
+      else if (errno != EINTR)
+      {
+         return -1;
+      }
+   }
+   return 0;
+}
+
+/**
+ * Hands new data to the tcp_data handler. Incomplete messages are kept in the receiveBuffer of the item until more data arrives.
+ * When nothing is pending (which is the common case) the data is parsed directly from the read buffer without copying it first.
+ */
+static int8_t apx_eventLoop_processData(apx_eventLoopItem_t *item, const uint8_t *dataBuf, uint32_t dataLen)
+{
+   const uint8_t *pBegin = dataBuf;
+   uint32_t totalLen = dataLen;
+   uint32_t parseLen = 0;
+   int8_t result;
+   if (item->handlerTable.tcp_data == 0)
+   {
+      return 0;
+   }
+   if (adt_bytearray_length(&item->receiveBuffer) > 0)
+   {
+      if (adt_bytearray_append(&item->receiveBuffer, dataBuf, dataLen) != 0)
+      {
+         APX_LOG_ERROR("[APX_EVENT_LOOP] %s", "out of memory in receive buffer");
+         return -1;
+      }
+      pBegin = adt_bytearray_data(&item->receiveBuffer);
+      totalLen = adt_bytearray_length(&item->receiveBuffer);
+   }
+   result = item->handlerTable.tcp_data(item->handlerArg, pBegin, totalLen, &parseLen);
+   if (result != 0)
+   {
+      return -1;
+   }
+   assert(parseLen <= totalLen);
+   if (pBegin == dataBuf)
+   {
+      if (parseLen < totalLen)
+      {
+         if (adt_bytearray_append(&item->receiveBuffer, dataBuf + parseLen, totalLen - parseLen) != 0)
+         {
+            APX_LOG_ERROR("[APX_EVENT_LOOP] %s", "out of memory in receive buffer");
+            return -1;
+         }
+      }
+   }
+   else if (parseLen == totalLen)
+   {
+      adt_bytearray_clear(&item->receiveBuffer);
+   }
+   else if (parseLen > 0)
+   {
+      adt_bytearray_trimLeft(&item->receiveBuffer, pBegin + parseLen);
+   }
+   return 0;
+}
+
+/**
+ * Writes as much of data as the socket accepts without blocking. sendLen receives the number of bytes written.
+ * Returns -1 on socket errors, running out of socket buffer space is not an error. Called while sendLock is held.
+ */
+static int8_t apx_eventLoopItem_write(apx_eventLoopItem_t *self, const uint8_t *data, uint32_t dataLen, uint32_t *sendLen)
+{
+   uint32_t totalLen = 0;
+   int8_t retval = 0;
+   while (totalLen < dataLen)
+   {
+      ssize_t len = send(self->fd, data + totalLen, dataLen - totalLen, MSG_DONTWAIT | MSG_NOSIGNAL);
+      if (len >= 0)
+      {
+         totalLen += (uint32_t) len;
+      }
+      else if ( (errno == EAGAIN) || (errno == EWOULDBLOCK) )
+      {
+         break;
+      }
+      else if (errno != EINTR)
+      {
+         APX_LOG_ERROR("[APX_EVENT_LOOP] send failed on fd %d, errno=%d", self->fd, errno);
+         retval = -1;
+         break;
+      }
+   }
+   *sendLen = totalLen;
+   return retval;
+}
+
+/**
+ * Called from the event loop thread when the socket has become writable. Returns -1 when the socket should be closed.
+ */
+static int8_t apx_eventLoopItem_writePending(apx_eventLoopItem_t *self)
+{
+   int8_t retval = 0;
+   uint32_t pendingLen;
+   MUTEX_LOCK(self->sendLock);
+   pendingLen = adt_bytearray_length(&self->sendBuffer);
+   if ( (self->isClosed == false) && (pendingLen > 0) )
+   {
+      uint32_t sendLen;
+      const uint8_t *pBegin = adt_bytearray_data(&self->sendBuffer);
+      retval = apx_eventLoopItem_write(self, pBegin, pendingLen, &sendLen);
+      if (sendLen == pendingLen)
+      {
+         adt_bytearray_clear(&self->sendBuffer);
+      }
+      else if (sendLen > 0)
+      {
+         adt_bytearray_trimLeft(&self->sendBuffer, pBegin + sendLen);
+      }
+   }
+   MUTEX_UNLOCK(self->sendLock);
+   return retval;
+}
+
+/**
+ * Called while sendLock is held
+ */
+static void apx_eventLoopItem_markClosed(apx_eventLoopItem_t *self)
+{
+   self->isClosed = true;
+   adt_bytearray_clear(&self->sendBuffer);
+}
+
+/**
+ * Removes the item from the event loop and notifies its owner. After tcp_disconnected has been called the owner is free to close the socket.
+ */
+static void apx_eventLoop_closeItem(apx_eventLoop_t *self, apx_eventLoopItem_t *item)
+{
+   (void) epoll_ctl(self->epollFd, EPOLL_CTL_DEL, item->fd, (struct epoll_event*) 0);
+   apx_eventLoop_removeItem(self, item);
+   MUTEX_LOCK(item->sendLock);
+   apx_eventLoopItem_markClosed(item);
+   MUTEX_UNLOCK(item->sendLock);
+   if (item->handlerTable.tcp_disconnected != 0)
+   {
+      item->handlerTable.tcp_disconnected(item->handlerArg);
+   }
+   apx_eventLoopItem_release(item);
+}
+
+static THREAD_PROTO(eventLoopTask,arg)
+{
+   if(arg!=0)
+   {
+      apx_eventLoop_t *self = (apx_eventLoop_t*) arg;
+      struct epoll_event events[APX_EVENT_LOOP_MAX_EVENTS];
+      bool isRunning = true;
+      while (isRunning == true)
+      {
+         int i;
+         int numEvents = epoll_wait(self->epollFd, &events[0], APX_EVENT_LOOP_MAX_EVENTS, -1);
+         if (numEvents < 0)
+         {
+            if (errno == EINTR)
+            {
+               continue;
+            }
+            APX_LOG_ERROR("[APX_EVENT_LOOP] epoll_wait failed, errno=%d", errno);
+            break;
+         }
+         for (i=0; i<numEvents; i++)
+         {
+            apx_eventLoopItem_t *item = (apx_eventLoopItem_t*) events[i].data.ptr;
+            if (item == 0)
+            {
+               uint64_t value;
+               (void) read(self->wakeupFd, &value, sizeof(value));
+               SPINLOCK_ENTER(self->lock);
+               isRunning = self->isRunning;
+               SPINLOCK_LEAVE(self->lock);
+            }
+            else
+            {
+               int8_t result = 0;
+               //read any remaining data before acting on a hangup so that nothing sent just before the close is lost
+               if ( (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0)
+               {
+                  result = apx_eventLoop_readItem(self, item);
+               }
+               if ( (result == 0) && ( (events[i].events & EPOLLOUT) != 0) )
+               {
+                  result = apx_eventLoopItem_writePending(item);
+               }
+               if ( (result != 0) || ( (events[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0) )
+               {
+                  apx_eventLoop_closeItem(self, item);
+               }
+            }
+         }
+      }
+   }
+   THREAD_RETURN(0);
+}
+
+#endif //APX_EVENT_LOOP_SUPPORTED
@@ -5,6 +5,13 @@
 #include "apx_server.h"
 #include "apx_logging.h"
 #include <stdio.h>
+#include <errno.h>
+#include <malloc.h>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -21,6 +28,12 @@ typedef struct apx_serverInfo_tag
 static void apx_server_accept(void *arg,msocket_server_t *srv,msocket_t *msocket);
 static int8_t apx_server_data(void *arg, const uint8_t *dataBuf, uint32_t dataLen, uint32_t *parseLen);
 static void apx_server_disconnected(void *arg);
+static uint32_t apx_server_getTimeMs(void);
+#if APX_EVENT_LOOP_SUPPORTED
+static void apx_server_startEventLoops(apx_server_t *self);
+static void apx_server_stopEventLoops(apx_server_t *self);
+static void apx_server_deleteEventLoops(apx_server_t *self);
+#endif
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL VARIABLES
@@ -42,6 +55,14 @@ void apx_server_create(apx_server_t *self, uint16_t tcpPort)
       adt_list_create(&self->connections,apx_serverConnection_vdelete);
       self->tcpPort = tcpPort;
       self->debugMode = APX_DEBUG_NONE;
+      self->numWorkers = 0;
+      self->workerPool = (apx_workerPool_t*) 0;
+      self->isConflationEnabled = false;
+#if APX_EVENT_LOOP_SUPPORTED
+      self->numEventLoops = 0;
+      self->nextEventLoop = 0;
+      self->eventLoops = (apx_eventLoop_t**) 0;
+#endif
       memset(&serverHandler,0,sizeof(serverHandler));
       msocket_server_create(&self->tcpServer,AF_INET, apx_serverConnection_vdelete);
 #ifndef _MSC_VER
@@ -61,6 +82,34 @@ void apx_server_start(apx_server_t *self)
 {
    if (self != 0)
    {
+      if ( (self->numWorkers > 0) && (self->workerPool == 0) )
+      {
+         self->workerPool = apx_workerPool_new(self->numWorkers);
+         if (self->workerPool != 0)
+         {
+            if (apx_workerPool_start(self->workerPool) != 0)
+            {
+               APX_LOG_ERROR("[APX_SERVER] %s", "apx_workerPool_start() failed, falling back to one worker thread per connection");
+               apx_workerPool_delete(self->workerPool);
+               self->workerPool = (apx_workerPool_t*) 0;
+            }
+         }
+         else
+         {
+            APX_LOG_ERROR("[APX_SERVER] %s", "apx_workerPool_new() returned 0");
+         }
+      }
+#if APX_EVENT_LOOP_SUPPORTED
+      if ( (self->workerPool != 0) && (self->numEventLoops == 0) )
+      {
+         //pool workers must never block on a socket write, the event loop takes care of output that a slow peer doesn't accept right away
+         self->numEventLoops = 1;
+      }
+      if ( (self->numEventLoops > 0) && (self->eventLoops == 0) )
+      {
+         apx_server_startEventLoops(self);
+      }
+#endif
       msocket_server_start(&self->tcpServer,0,0,self->tcpPort);
    }
 }
@@ -69,8 +118,20 @@ void apx_server_destroy(apx_server_t *self)
 {
    if (self != 0)
    {
+#if APX_EVENT_LOOP_SUPPORTED
+      //no more socket events may be delivered to connections that are about to be deleted
+      apx_server_stopEventLoops(self);
+#endif
       //close and delete all open server connections
       adt_list_destroy(&self->connections);
+#if APX_EVENT_LOOP_SUPPORTED
+      apx_server_deleteEventLoops(self);
+#endif
+      //all fileManagers have now been stopped, it's safe to stop the worker pool
+      if (self->workerPool != 0)
+      {
+         apx_workerPool_delete(self->workerPool);
+      }
       //destroy the tcp server
       msocket_server_destroy(&self->tcpServer);
       //destroy the local socket server
@@ -93,6 +154,72 @@ void apx_server_setDebugMode(apx_server_t *self, int8_t debugMode)
    }
 }
 
+/**
+ * Sets the number of threads in the worker pool that processes messages for all connections.
+ * Use 0 to give each connection its own worker thread. Must be called before apx_server_start.
+ * On Linux the worker pool always runs together with at least one event loop which writes the output that the sockets don't accept right away.
+ */
+void apx_server_setNumWorkers(apx_server_t *self, uint16_t numWorkers)
+{
+   if ( (self != 0) && (self->workerPool == 0) )
+   {
+      self->numWorkers = numWorkers;
+   }
+}
+
+/**
+ * Sets the number of epoll event loop threads that read from the sockets of all connections. Connections are distributed over the event loops in round-robin order.
+ * Use 0 to give each connection its own msocket I/O thread. Must be called before apx_server_start. Event loops are only supported on Linux.
+ */
+void apx_server_setNumEventLoops(apx_server_t *self, uint16_t numEventLoops)
+{
+#if APX_EVENT_LOOP_SUPPORTED
+   if ( (self != 0) && (self->eventLoops == 0) )
+   {
+      self->numEventLoops = numEventLoops;
+   }
+#else
+   if ( (self != 0) && (numEventLoops > 0) )
+   {
+      APX_LOG_WARNING("[APX_SERVER] %s", "event loops are not supported on this platform, using one I/O thread per connection");
+   }
+#endif
+}
+
+/**
+ * Enables latest-value conflation of port writes in all connections accepted after this call (see apx_fileManager_enableConflation)
+ */
+void apx_server_setConflationMode(apx_server_t *self, bool isEnabled)
+{
+   if (self != 0)
+   {
+      self->isConflationEnabled = isEnabled;
+   }
+}
+
+/**
+ * Nodes of a client that disconnects with a session token are kept for gracePeriodMs, a client that reconnects with the same token
+ * and definition within that time resumes them with its router connections intact. 0 (default) disables session resumption.
+ */
+void apx_server_setSessionGracePeriod(apx_server_t *self, uint32_t gracePeriodMs)
+{
+   if (self != 0)
+   {
+      apx_nodeManager_setSessionGracePeriod(&self->nodeManager, gracePeriodMs);
+   }
+}
+
+/**
+ * Removes nodes of disconnected clients whose session grace period has run out. Call periodically (e.g. from the main loop)
+ */
+void apx_server_expireSessions(apx_server_t *self)
+{
+   if (self != 0)
+   {
+      apx_nodeManager_expireParkedNodes(&self->nodeManager, apx_server_getTimeMs());
+   }
+}
+
 
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL FUNCTIONS
@@ -133,8 +260,34 @@ static void apx_server_accept(void *arg,msocket_server_t *srv,msocket_t *msocket
          {
             apx_serverConnection_setDebugMode(newConnection, self->debugMode);
          }
+         if (self->workerPool != 0)
+         {
+            apx_fileManager_setWorkerPool(&newConnection->fileManager, self->workerPool);
+         }
+         if ( (self->isConflationEnabled == true) && (apx_fileManager_enableConflation(&newConnection->fileManager) != 0) )
+         {
+            APX_LOG_ERROR("[APX_SERVER] %s", "apx_fileManager_enableConflation() failed");
+         }
+#if APX_EVENT_LOOP_SUPPORTED
+         if (self->eventLoops != 0)
+         {
+            apx_eventLoop_t *eventLoop = self->eventLoops[self->nextEventLoop];
+            self->nextEventLoop = (uint16_t) ((self->nextEventLoop + 1) % self->numEventLoops);
+            //the event loop takes over the job of the internal listening thread in the msocket
+            if (apx_eventLoop_addSocket(eventLoop, msocket->tcpsockfd, &handlerTable, newConnection, &newConnection->eventLoopItem) != 0)
+            {
+               APX_LOG_ERROR("[APX_SERVER] apx_eventLoop_addSocket() failed, errno=%d. Using msocket I/O thread", errno);
+               msocket_start_io(msocket);
+            }
+         }
+         else
+         {
+            msocket_start_io(msocket);
+         }
+#else
          //now that the handler is setup, start the internal listening thread in the msocket
          msocket_start_io(msocket);
+#endif
          //trigger the new connection to send the greeting message (in case there is any to be sent)
          apx_serverConnection_start(newConnection);
       }
@@ -152,7 +305,7 @@ static int8_t apx_server_data(void *arg, const uint8_t *dataBuf, uint32_t dataLe
 }
 
 /**
- * called by msocket worker thread when it detects a disconnect event on the msocket
+ * called by msocket worker thread (or the event loop thread) when it detects a disconnect event on the msocket
  */
 static void apx_server_disconnected(void *arg)
 {
@@ -164,8 +317,17 @@ static void apx_server_disconnected(void *arg)
       MUTEX_LOCK(server->mutex);
       adt_list_remove(&server->connections, connection);
       //the thread inside the msocket class cannot shutdown itself, instead use the cleanup thread to do the job of shutting it down
-      apx_nodeManager_detachFileManager(&server->nodeManager, &connection->fileManager);
+      apx_nodeManager_parkFileManager(&server->nodeManager, &connection->fileManager, apx_server_getTimeMs());
       APX_LOG_INFO("[APX_SERVER] Client (%p) disconnected", (void*)connection);
+#if APX_EVENT_LOOP_SUPPORTED
+      if (connection->eventLoopItem != 0)
+      {
+         //called from the event loop thread. The msocket never started its I/O thread, there is nothing for the cleanup thread to shut down
+         MUTEX_UNLOCK(server->mutex);
+         apx_serverConnection_delete(connection);
+         return;
+      }
+#endif
       switch (connection->msocket->addressFamily)
       {
          case AF_INET: //intentional fallthrough
@@ -184,3 +346,91 @@ static void apx_server_disconnected(void *arg)
    }
 }
 
+
+#if APX_EVENT_LOOP_SUPPORTED
+/**
+ * Creates and starts numEventLoops event loops. On failure the server keeps running with the event loops that could be started.
+ */
+static void apx_server_startEventLoops(apx_server_t *self)
+{
+   uint16_t i;
+   self->eventLoops = (apx_eventLoop_t**) malloc(sizeof(apx_eventLoop_t*)*self->numEventLoops);
+   if (self->eventLoops == 0)
+   {
+      APX_LOG_ERROR("[APX_SERVER] %s", "out of memory while creating event loops, falling back to one I/O thread per connection");
+      return;
+   }
+   for (i=0; i<self->numEventLoops; i++)
+   {
+      apx_eventLoop_t *eventLoop = apx_eventLoop_new();
+      if (eventLoop == 0)
+      {
+         APX_LOG_ERROR("[APX_SERVER] apx_eventLoop_new() failed, errno=%d", errno);
+         break;
+      }
+      if (apx_eventLoop_start(eventLoop) != 0)
+      {
+         APX_LOG_ERROR("[APX_SERVER] apx_eventLoop_start() failed, errno=%d", errno);
+         apx_eventLoop_delete(eventLoop);
+         break;
+      }
+      //one event loop per CPU keeps the socket data of a connection in the cache of the CPU that reads it
+      if (apx_eventLoop_pinToCpu(eventLoop, i) != 0)
+      {
+         APX_LOG_WARNING("[APX_SERVER] apx_eventLoop_pinToCpu() failed, errno=%d", errno);
+      }
+      self->eventLoops[i] = eventLoop;
+   }
+   if (i < self->numEventLoops)
+   {
+      if (i == 0)
+      {
+         APX_LOG_ERROR("[APX_SERVER] %s", "no event loop could be started, falling back to one I/O thread per connection");
+         free(self->eventLoops);
+         self->eventLoops = (apx_eventLoop_t**) 0;
+      }
+      self->numEventLoops = i;
+   }
+   self->nextEventLoop = 0;
+}
+
+static void apx_server_stopEventLoops(apx_server_t *self)
+{
+   if (self->eventLoops != 0)
+   {
+      uint16_t i;
+      for (i=0; i<self->numEventLoops; i++)
+      {
+         apx_eventLoop_stop(self->eventLoops[i]);
+      }
+   }
+}
+
+static void apx_server_deleteEventLoops(apx_server_t *self)
+{
+   if (self->eventLoops != 0)
+   {
+      uint16_t i;
+      for (i=0; i<self->numEventLoops; i++)
+      {
+         apx_eventLoop_delete(self->eventLoops[i]);
+      }
+      free(self->eventLoops);
+      self->eventLoops = (apx_eventLoop_t**) 0;
+   }
+}
+#endif
+
+/**
+ * monotonic millisecond clock used for session expiry, wraps around after 49 days
+ */
+static uint32_t apx_server_getTimeMs(void)
+{
+#ifdef _WIN32
+   return (uint32_t) GetTickCount();
+#else
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint32_t) ( ((uint64_t) now.tv_sec * 1000u) + ((uint64_t) now.tv_nsec / 1000000u) );
+#endif
+}
@@ -15,6 +15,9 @@
 #include "apx_testServer.h"
 #else
 #include "apx_server.h"
+#if APX_EVENT_LOOP_SUPPORTED
+#include <unistd.h>
+#endif
 #endif
 #include "headerutil.h"
 #include "bstr.h"
@@ -40,6 +43,10 @@ static void apx_serverConnection_parseGreeting(apx_serverConnection_t *self, con
 static uint8_t apx_serverConnection_parseMessage(apx_serverConnection_t *self, const uint8_t *dataBuf, uint32_t dataLen, uint32_t *parseLen);
 static uint8_t *apx_serverConnection_getSendBuffer(void *arg, int32_t msgLen);
 static int32_t apx_serverConnection_send(void *arg, int32_t offset, int32_t msgLen);
+static void apx_serverConnection_beginBatch(void *arg);
+static void apx_serverConnection_endBatch(void *arg);
+static void apx_serverConnection_flushFrames(apx_serverConnection_t *self);
+static void apx_serverConnection_transmit(apx_serverConnection_t *self, const uint8_t *data, uint32_t dataLen);
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -67,12 +74,16 @@ int8_t apx_serverConnection_create(apx_serverConnection_t *self, msocket_t *sock
       self->testsocket=socket;
 #else
       self->msocket = socket;
+      self->eventLoopItem = (struct apx_eventLoopItem_tag*) 0;
 #endif
       self->server=server;
       self->isGreetingParsed = false;
       self->debugMode = APX_DEBUG_NONE;
       self->numHeaderMaxLen = (int8_t) sizeof(uint32_t); //currently only 4-byte header is supported. There might be a future version where we support both 16-bit and 32-bit message headers
       adt_bytearray_create(&self->sendBuffer, SEND_BUFFER_GROW_SIZE);
+      self->isBatchActive = false;
+      self->sendQueueLen = 0;
+      self->numQueuedFrames = 0;
       return apx_fileManager_create(&self->fileManager, APX_FILEMANAGER_SERVER_MODE);
    }
    errno=EINVAL;
@@ -83,12 +94,32 @@ void apx_serverConnection_destroy(apx_serverConnection_t *self)
 {
    if (self != 0)
    {
+      apx_fileManagerBatchStats_t stats;
+      apx_fileManager_stop(&self->fileManager);
+      apx_fileManager_getBatchStats(&self->fileManager, &stats);
+      if (stats.numBatches > 0)
+      {
+         APX_LOG_INFO("[APX_SRV_CONNECTION] (%p) processed %u messages in %u batches, max batch size %u", (void*) self,
+               (unsigned int) stats.numMessages, (unsigned int) stats.numBatches, (unsigned int) stats.maxBatchSize);
+      }
       apx_fileManager_destroy(&self->fileManager);
       adt_bytearray_destroy(&self->sendBuffer);
 #ifdef UNIT_TEST
       testsocket_delete(self->testsocket);
 #else
-      msocket_delete(self->msocket);
+#if APX_EVENT_LOOP_SUPPORTED
+      if (self->eventLoopItem != 0)
+      {
+         //the socket was serviced by the event loop, the msocket I/O thread was never started and must not be torn down
+         apx_eventLoopItem_release(self->eventLoopItem);
+         close(self->msocket->tcpsockfd);
+         free(self->msocket);
+      }
+      else
+#endif
+      {
+         msocket_delete(self->msocket);
+      }
 #endif
    }
 }
@@ -163,10 +194,13 @@ void apx_serverConnection_start(apx_serverConnection_t *self)
    {
       apx_transmitHandler_t serverTransmitHandler;
       //register transmit handler with our fileManager
+      memset(&serverTransmitHandler, 0, sizeof(serverTransmitHandler));
       serverTransmitHandler.arg = self;
       serverTransmitHandler.send = apx_serverConnection_send;
       serverTransmitHandler.getSendAvail = 0;
       serverTransmitHandler.getSendBuffer = apx_serverConnection_getSendBuffer;
+      serverTransmitHandler.beginBatch = apx_serverConnection_beginBatch;
+      serverTransmitHandler.endBatch = apx_serverConnection_endBatch;
       apx_fileManager_setTransmitHandler(&self->fileManager, &serverTransmitHandler);
       //register connection with the server nodeManager
       apx_nodeManager_attachFileManager(&self->server->nodeManager, &self->fileManager);
@@ -271,9 +305,19 @@ static void apx_serverConnection_parseGreeting(apx_serverConnection_t *self, con
             if (lengthOfLine<MAX_HEADER_LEN)
             {
                char tmp[MAX_HEADER_LEN+1];
+               const size_t tokenHeaderLen = sizeof(RMF_SESSION_TOKEN_HEADER)-1;
                memcpy(tmp,pMark,lengthOfLine);
                tmp[lengthOfLine]=0;
                //printf("\tgreeting-line: '%s'\n",tmp);
+               if (strncmp(tmp, RMF_SESSION_TOKEN_HEADER, tokenHeaderLen) == 0)
+               {
+                  const char *value = &tmp[tokenHeaderLen];
+                  while (*value == ' ')
+                  {
+                     value++;
+                  }
+                  apx_fileManager_setSessionToken(&self->fileManager, value);
+               }
             }
          }
       }
@@ -344,7 +388,7 @@ static uint8_t apx_serverConnection_parseMessage(apx_serverConnection_t *self, c
 }
 
 /**
- * callback for fileManager when it requests a send buffer
+ * callback for fileManager when it requests a send buffer. The buffer is placed after any frames already waiting in the send queue.
  */
 static uint8_t *apx_serverConnection_getSendBuffer(void *arg, int32_t msgLen)
 {
@@ -355,7 +399,7 @@ static uint8_t *apx_serverConnection_getSendBuffer(void *arg, int32_t msgLen)
       int32_t requestedLen;
       //create a buffer where we have room to encode the message header (the length of the message) in addition to the user requested length
       int32_t currentLen = adt_bytearray_length(&self->sendBuffer);
-      requestedLen= msgLen + self->numHeaderMaxLen;
+      requestedLen= ((int32_t) self->sendQueueLen) + msgLen + self->numHeaderMaxLen;
       if (currentLen<requestedLen)
       {
          result = adt_bytearray_resize(&self->sendBuffer, (uint32_t) requestedLen);
@@ -364,7 +408,7 @@ static uint8_t *apx_serverConnection_getSendBuffer(void *arg, int32_t msgLen)
       {
          uint8_t *data = adt_bytearray_data(&self->sendBuffer);
          assert(data != 0);
-         return &data[self->numHeaderMaxLen];
+         return &data[self->sendQueueLen + self->numHeaderMaxLen];
       }
    }
    return 0;
@@ -372,6 +416,7 @@ static uint8_t *apx_serverConnection_getSendBuffer(void *arg, int32_t msgLen)
 
 /**
  * callback for fileManager when it requests to send buffer (which it previously retreived by  apx_serverConnection_getSendBuffer
+ * While a batch is active the message is only added to the send queue, it is transmitted when the batch ends.
  */
 static int32_t apx_serverConnection_send(void *arg, int32_t offset, int32_t msgLen)
 {
@@ -381,12 +426,13 @@ static int32_t apx_serverConnection_send(void *arg, int32_t offset, int32_t msgL
       int32_t sendBufferLen;
       uint8_t *sendBuffer = adt_bytearray_data(&self->sendBuffer);
       sendBufferLen = adt_bytearray_length(&self->sendBuffer);
-      if ((sendBuffer != 0) && (msgLen+self->numHeaderMaxLen<=sendBufferLen) )
+      if ((sendBuffer != 0) && (((int32_t) self->sendQueueLen)+self->numHeaderMaxLen+offset+msgLen<=sendBufferLen) )
       {
          uint8_t header[sizeof(uint32_t)];
          uint8_t headerLen;
          uint8_t *headerEnd;
          uint8_t *pBegin;
+         uint32_t frameOffset;
          if (self->numHeaderMaxLen == (uint8_t) sizeof(uint32_t))
          {
             headerEnd = headerutil_numEncode32(header, (uint32_t) sizeof(header), msgLen);
@@ -405,7 +451,8 @@ static int32_t apx_serverConnection_send(void *arg, int32_t offset, int32_t msgL
             return -1; //not yet implemented
          }
          //place header just before user data begin
-         pBegin = sendBuffer+(self->numHeaderMaxLen+offset-headerLen); //the part in the parenthesis is where the user data begins
+         frameOffset = self->sendQueueLen+(self->numHeaderMaxLen+offset-headerLen); //the part in the parenthesis is where the user data begins
+         pBegin = sendBuffer+frameOffset;
          memcpy(pBegin, header, headerLen);
          if (self->debugMode >= APX_DEBUG_4_HIGH)
          {
@@ -424,12 +471,21 @@ static int32_t apx_serverConnection_send(void *arg, int32_t offset, int32_t msgL
             }
             APX_LOG_DEBUG("[APX_SRV_CONNECTION] %s", msg);
          }
-		 
-#ifdef UNIT_TEST
-		 testsocket_serverSend(self->testsocket, pBegin, msgLen+headerLen);
-#else
-		 msocket_send(self->msocket, pBegin, msgLen+headerLen);
-#endif
+         if (self->isBatchActive == true)
+         {
+            apx_serverConnectionFrame_t *frame = &self->queuedFrames[self->numQueuedFrames++];
+            frame->offset = frameOffset;
+            frame->length = (uint32_t) (msgLen+headerLen);
+            self->sendQueueLen = frame->offset + frame->length;
+            if ( (self->numQueuedFrames == APX_SERVER_CONNECTION_MAX_QUEUED_FRAMES) || (self->sendQueueLen >= APX_SERVER_CONNECTION_MAX_QUEUED_BYTES) )
+            {
+               apx_serverConnection_flushFrames(self);
+            }
+         }
+         else
+         {
+            apx_serverConnection_transmit(self, pBegin, (uint32_t) (msgLen+headerLen));
+         }
          return 0;
       }
       else
@@ -439,3 +495,73 @@ static int32_t apx_serverConnection_send(void *arg, int32_t offset, int32_t msgL
    }
    return -1;
 }
+
+/**
+ * callback for fileManager when it starts processing messages. Called while fileManager.sendLock is held.
+ */
+static void apx_serverConnection_beginBatch(void *arg)
+{
+   apx_serverConnection_t *self = (apx_serverConnection_t*) arg;
+   if (self != 0)
+   {
+      self->isBatchActive = true;
+   }
+}
+
+/**
+ * callback for fileManager when it has no more messages to process. Called while fileManager.sendLock is held.
+ */
+static void apx_serverConnection_endBatch(void *arg)
+{
+   apx_serverConnection_t *self = (apx_serverConnection_t*) arg;
+   if (self != 0)
+   {
+      apx_serverConnection_flushFrames(self);
+      self->isBatchActive = false;
+   }
+}
+
+/**
+ * transmits all queued frames as one contiguous block using a single call to msocket_send
+ */
+static void apx_serverConnection_flushFrames(apx_serverConnection_t *self)
+{
+   if (self->numQueuedFrames > 0)
+   {
+      uint16_t i;
+      uint8_t *sendBuffer = adt_bytearray_data(&self->sendBuffer);
+      //close the gaps left by the variable-length headers so that all frames can be sent as one contiguous block
+      uint32_t totalLen = 0;
+      for (i=0; i<self->numQueuedFrames; i++)
+      {
+         const apx_serverConnectionFrame_t *frame = &self->queuedFrames[i];
+         if (frame->offset != totalLen)
+         {
+            memmove(sendBuffer + totalLen, sendBuffer + frame->offset, frame->length);
+         }
+         totalLen += frame->length;
+      }
+      apx_serverConnection_transmit(self, sendBuffer, totalLen);
+      self->numQueuedFrames = 0;
+   }
+   self->sendQueueLen = 0;
+}
+
+static void apx_serverConnection_transmit(apx_serverConnection_t *self, const uint8_t *data, uint32_t dataLen)
+{
+#ifdef UNIT_TEST
+   testsocket_serverSend(self->testsocket, data, dataLen);
+#else
+#if APX_EVENT_LOOP_SUPPORTED
+   if (self->eventLoopItem != 0)
+   {
+      //never blocks, a slow peer must not hold up the worker thread that produced the data
+      (void) apx_eventLoopItem_send(self->eventLoopItem, data, dataLen);
+   }
+   else
+#endif
+   {
+      msocket_send(self->msocket, data, dataLen);
+   }
+#endif
+}
@@ -18,12 +18,17 @@
 // CONSTANTS AND DATA TYPES
 //////////////////////////////////////////////////////////////////////////////
 #define DEFAULT_PORT 5000
+#define DEFAULT_NUM_WORKERS 4
+#define MAX_NUM_WORKERS 1024
+#define MAX_NUM_EVENT_LOOPS 256
+#define MAX_SESSION_GRACE_PERIOD_MS 3600000
 
 //////////////////////////////////////////////////////////////////////////////
 // LOCAL FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
 static int parse_args(int argc, char **argv);
 static void printUsage(char *name);
+static uint16_t getDefaultNumEventLoops(void);
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL VARIABLES
@@ -34,6 +39,10 @@ int8_t g_debug; // Global so apx_logging can use it from everywhere
 // LOCAL VARIABLES
 //////////////////////////////////////////////////////////////////////////////
 static uint16_t m_port;
+static uint16_t m_numWorkers;
+static uint16_t m_numEventLoops;
+static bool m_isConflationEnabled;
+static uint32_t m_sessionGracePeriodMs;
 static apx_server_t m_server;
 static int32_t m_count;
 static const char *SW_VERSION_STR = SW_VERSION_LITERAL;
@@ -50,6 +59,10 @@ int main(int argc, char **argv)
    m_count = 0;
    g_debug = 0;
    m_port = DEFAULT_PORT;
+   m_numWorkers = DEFAULT_NUM_WORKERS;
+   m_numEventLoops = getDefaultNumEventLoops();
+   m_isConflationEnabled = false;
+   m_sessionGracePeriodMs = 0;
    printf("APX Server %s\n", SW_VERSION_STR);
    if(argc>1)
    {
@@ -76,10 +89,15 @@ int main(int argc, char **argv)
 #endif
    apx_server_create(&m_server,m_port);
    apx_server_setDebugMode(&m_server, g_debug);
+   apx_server_setNumWorkers(&m_server, m_numWorkers);
+   apx_server_setNumEventLoops(&m_server, m_numEventLoops);
+   apx_server_setConflationMode(&m_server, m_isConflationEnabled);
+   apx_server_setSessionGracePeriod(&m_server, m_sessionGracePeriodMs);
    apx_server_start(&m_server);
    for(;;)
    {
-      SLEEP(5000); //main thread is sleeping while child threads do all the work
+      SLEEP(1000); //main thread is sleeping while child threads do all the work
+      apx_server_expireSessions(&m_server);
 /*    if (++m_count==20) //this counter is used during testing to verify that all resources are properly cleaned up
       {
          break;
@@ -139,6 +157,55 @@ static int parse_args(int argc, char **argv)
             }
          }
       }
+      else if (strncmp(argv[i], "--workers=", 10) == 0)
+      {
+         char *endptr=0;
+         long num = strtol(&argv[i][10],&endptr,10);
+         if ( (endptr > &argv[i][10]) && (num >= 0) && (num <= MAX_NUM_WORKERS) )
+         {
+            m_numWorkers=(uint16_t) num;
+         }
+         else
+         {
+            printf("Invalid number of workers %s\n", &argv[i][10]);
+            printUsage(argv[0]);
+            return -1;
+         }
+      }
+      else if (strncmp(argv[i], "--event-loops=", 14) == 0)
+      {
+         char *endptr=0;
+         long num = strtol(&argv[i][14],&endptr,10);
+         if ( (endptr > &argv[i][14]) && (num >= 0) && (num <= MAX_NUM_EVENT_LOOPS) )
+         {
+            m_numEventLoops=(uint16_t) num;
+         }
+         else
+         {
+            printf("Invalid number of event loops %s\n", &argv[i][14]);
+            printUsage(argv[0]);
+            return -1;
+         }
+      }
+      else if (strncmp(argv[i], "--session-grace=", 16) == 0)
+      {
+         char *endptr=0;
+         long num = strtol(&argv[i][16],&endptr,10);
+         if ( (endptr > &argv[i][16]) && (num >= 0) && (num <= MAX_SESSION_GRACE_PERIOD_MS) )
+         {
+            m_sessionGracePeriodMs=(uint32_t) num;
+         }
+         else
+         {
+            printf("Invalid session grace period %s\n", &argv[i][16]);
+            printUsage(argv[0]);
+            return -1;
+         }
+      }
+      else if (strcmp(argv[i], "--conflate") == 0)
+      {
+         m_isConflationEnabled = true;
+      }
       else
       {
          printf("Unknown argument %s\n", argv[i]);
@@ -149,9 +216,26 @@ static int parse_args(int argc, char **argv)
    return 0;
 }
 
+/**
+ * One event loop per online CPU on Linux, elsewhere each connection gets its own I/O thread
+ */
+static uint16_t getDefaultNumEventLoops(void)
+{
+#ifdef __linux__
+   long numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+   if (numCpus < 1)
+   {
+      return 1;
+   }
+   return (numCpus > MAX_NUM_EVENT_LOOPS)? MAX_NUM_EVENT_LOOPS : (uint16_t) numCpus;
+#else
+   return 0;
+#endif
+}
+
 static void printUsage(char *name)
 {   
-   printf("%s -p<port> [--debug=<level 1-4>]\n",name);
+   printf("%s -p<port> [--debug=<level 1-4>] [--workers=<threads, 0 for one thread per connection>] [--event-loops=<threads, 0 for one I/O thread per connection, default one per CPU>] [--conflate] [--session-grace=<milliseconds, 0 disables session resumption>]\n",name);
 }
 
 
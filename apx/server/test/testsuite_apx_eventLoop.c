@@ -0,0 +1,323 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx_eventLoop.h"
+#if APX_EVENT_LOOP_SUPPORTED
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#endif
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#if APX_EVENT_LOOP_SUPPORTED
+#define NUM_MESSAGES 100
+#define WAIT_TIMEOUT_MS 5000
+#define WAIT_INTERVAL_MS 10
+#define SEND_CHUNK_SIZE 4096
+#define NUM_SEND_CHUNKS 256 //far more than the socket buffers can hold
+
+/**
+ * Receives messages of the form <length><payload> where the length is a single byte
+ */
+typedef struct testReceiver_tag
+{
+   SPINLOCK_T lock;
+   uint8_t messages[NUM_MESSAGES]; //first payload byte of each received message
+   uint32_t numMessages;
+   uint32_t numDisconnects;
+}testReceiver_t;
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+#if APX_EVENT_LOOP_SUPPORTED
+static void test_apx_eventLoop_create(CuTest* tc);
+static void test_apx_eventLoop_partialMessages(CuTest* tc);
+static void test_apx_eventLoop_disconnect(CuTest* tc);
+static void test_apx_eventLoop_sendToSlowPeer(CuTest* tc);
+static int8_t testReceiver_data(void *arg, const uint8_t *dataBuf, uint32_t dataLen, uint32_t *parseLen);
+static void testReceiver_disconnected(void *arg);
+static uint32_t testReceiver_getNumMessages(testReceiver_t *self);
+static uint32_t testReceiver_getNumDisconnects(testReceiver_t *self);
+static void testReceiver_setup(testReceiver_t *self, msocket_handler_t *handlerTable);
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+
+CuSuite* testSuite_apx_eventLoop(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+#if APX_EVENT_LOOP_SUPPORTED
+   SUITE_ADD_TEST(suite, test_apx_eventLoop_create);
+   SUITE_ADD_TEST(suite, test_apx_eventLoop_partialMessages);
+   SUITE_ADD_TEST(suite, test_apx_eventLoop_disconnect);
+   SUITE_ADD_TEST(suite, test_apx_eventLoop_sendToSlowPeer);
+#endif
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+#if APX_EVENT_LOOP_SUPPORTED
+static void test_apx_eventLoop_create(CuTest* tc)
+{
+   apx_eventLoop_t eventLoop;
+   apx_eventLoop_t *pEventLoop;
+   CuAssertIntEquals(tc, 0, apx_eventLoop_create(&eventLoop));
+   CuAssertIntEquals(tc, 0, apx_eventLoop_getNumSockets(&eventLoop));
+   CuAssertIntEquals(tc, -1, apx_eventLoop_pinToCpu(&eventLoop, 0));
+   CuAssertIntEquals(tc, 0, apx_eventLoop_start(&eventLoop));
+   CuAssertIntEquals(tc, -1, apx_eventLoop_start(&eventLoop));
+   CuAssertIntEquals(tc, 0, apx_eventLoop_pinToCpu(&eventLoop, 0));
+   CuAssertIntEquals(tc, 0, apx_eventLoop_pinToCpu(&eventLoop, 1000)); //wraps around the number of available CPUs
+   apx_eventLoop_stop(&eventLoop);
+   apx_eventLoop_destroy(&eventLoop);
+   pEventLoop = apx_eventLoop_new();
+   CuAssertPtrNotNull(tc, pEventLoop);
+   apx_eventLoop_delete(pEventLoop);
+}
+
+static void test_apx_eventLoop_partialMessages(CuTest* tc)
+{
+   apx_eventLoop_t eventLoop;
+   testReceiver_t receiver;
+   msocket_handler_t handlerTable;
+   int sv[2];
+   uint32_t i;
+   int32_t elapsed;
+   testReceiver_setup(&receiver, &handlerTable);
+   CuAssertIntEquals(tc, 0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+   CuAssertIntEquals(tc, 0, apx_eventLoop_create(&eventLoop));
+   CuAssertIntEquals(tc, 0, apx_eventLoop_addSocket(&eventLoop, sv[0], &handlerTable, &receiver, 0));
+   CuAssertIntEquals(tc, 1, apx_eventLoop_getNumSockets(&eventLoop));
+   CuAssertIntEquals(tc, 0, apx_eventLoop_start(&eventLoop));
+   //send each message in two writes to force the event loop to keep partial messages between reads
+   for (i=0; i<NUM_MESSAGES; i++)
+   {
+      uint8_t msg[4];
+      msg[0] = 3;
+      msg[1] = (uint8_t) i;
+      msg[2] = 0;
+      msg[3] = 0;
+      CuAssertIntEquals(tc, 2, (int) write(sv[1], &msg[0], 2));
+      if ( (i % 10) == 0)
+      {
+         SLEEP(1);
+      }
+      CuAssertIntEquals(tc, 2, (int) write(sv[1], &msg[2], 2));
+   }
+   for (elapsed=0; elapsed<WAIT_TIMEOUT_MS; elapsed+=WAIT_INTERVAL_MS)
+   {
+      if (testReceiver_getNumMessages(&receiver) == NUM_MESSAGES)
+      {
+         break;
+      }
+      SLEEP(WAIT_INTERVAL_MS);
+   }
+   CuAssertIntEquals(tc, NUM_MESSAGES, testReceiver_getNumMessages(&receiver));
+   for (i=0; i<NUM_MESSAGES; i++)
+   {
+      CuAssertIntEquals(tc, i, receiver.messages[i]);
+   }
+   apx_eventLoop_destroy(&eventLoop);
+   CuAssertIntEquals(tc, 0, testReceiver_getNumDisconnects(&receiver));
+   close(sv[0]);
+   close(sv[1]);
+   SPINLOCK_DESTROY(receiver.lock);
+}
+
+static void test_apx_eventLoop_disconnect(CuTest* tc)
+{
+   apx_eventLoop_t eventLoop;
+   testReceiver_t receiver;
+   msocket_handler_t handlerTable;
+   int sv[2];
+   int32_t elapsed;
+   uint8_t msg[2] = {1, 7};
+   testReceiver_setup(&receiver, &handlerTable);
+   CuAssertIntEquals(tc, 0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+   CuAssertIntEquals(tc, 0, apx_eventLoop_create(&eventLoop));
+   CuAssertIntEquals(tc, 0, apx_eventLoop_start(&eventLoop));
+   CuAssertIntEquals(tc, 0, apx_eventLoop_addSocket(&eventLoop, sv[0], &handlerTable, &receiver, 0));
+   //data sent just before the close must still be delivered
+   CuAssertIntEquals(tc, 2, (int) write(sv[1], &msg[0], 2));
+   close(sv[1]);
+   for (elapsed=0; elapsed<WAIT_TIMEOUT_MS; elapsed+=WAIT_INTERVAL_MS)
+   {
+      if (testReceiver_getNumDisconnects(&receiver) == 1)
+      {
+         break;
+      }
+      SLEEP(WAIT_INTERVAL_MS);
+   }
+   CuAssertIntEquals(tc, 1, testReceiver_getNumDisconnects(&receiver));
+   CuAssertIntEquals(tc, 1, testReceiver_getNumMessages(&receiver));
+   CuAssertIntEquals(tc, 7, receiver.messages[0]);
+   CuAssertIntEquals(tc, 0, apx_eventLoop_getNumSockets(&eventLoop));
+   apx_eventLoop_destroy(&eventLoop);
+   close(sv[0]);
+   SPINLOCK_DESTROY(receiver.lock);
+}
+
+static void test_apx_eventLoop_sendToSlowPeer(CuTest* tc)
+{
+   apx_eventLoop_t eventLoop;
+   apx_eventLoopItem_t *item = 0;
+   testReceiver_t receiver;
+   msocket_handler_t handlerTable;
+   struct timeval timeout;
+   int sv[2];
+   int sendBufSize = SEND_CHUNK_SIZE;
+   uint8_t chunk[SEND_CHUNK_SIZE];
+   uint32_t i;
+   uint32_t totalLen = 0;
+   uint32_t pendingLen;
+   int32_t elapsed;
+   testReceiver_setup(&receiver, &handlerTable);
+   CuAssertIntEquals(tc, 0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+   CuAssertIntEquals(tc, 0, setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &sendBufSize, sizeof(sendBufSize)));
+   timeout.tv_sec = WAIT_TIMEOUT_MS / 1000;
+   timeout.tv_usec = 0;
+   CuAssertIntEquals(tc, 0, setsockopt(sv[1], SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)));
+   CuAssertIntEquals(tc, 0, apx_eventLoop_create(&eventLoop));
+   CuAssertIntEquals(tc, 0, apx_eventLoop_addSocket(&eventLoop, sv[0], &handlerTable, &receiver, &item));
+   CuAssertPtrNotNull(tc, item);
+   CuAssertIntEquals(tc, 0, apx_eventLoop_start(&eventLoop));
+   //nobody reads from sv[1] yet, the sends must still return right away
+   for (i=0; i<NUM_SEND_CHUNKS; i++)
+   {
+      memset(chunk, (int) i, sizeof(chunk));
+      CuAssertIntEquals(tc, 0, apx_eventLoopItem_send(item, chunk, sizeof(chunk)));
+   }
+   MUTEX_LOCK(item->sendLock);
+   pendingLen = adt_bytearray_length(&item->sendBuffer);
+   MUTEX_UNLOCK(item->sendLock);
+   CuAssertTrue(tc, pendingLen > 0);
+   //the event loop writes the rest as the peer reads
+   while (totalLen < (SEND_CHUNK_SIZE * NUM_SEND_CHUNKS))
+   {
+      uint8_t buf[SEND_CHUNK_SIZE];
+      ssize_t len = read(sv[1], buf, sizeof(buf));
+      CuAssertTrue(tc, len > 0);
+      for (i=0; i<(uint32_t) len; i++)
+      {
+         if (buf[i] != (uint8_t) ((totalLen + i) / SEND_CHUNK_SIZE))
+         {
+            break;
+         }
+      }
+      CuAssertIntEquals(tc, (int) len, (int) i);
+      totalLen += (uint32_t) len;
+   }
+   MUTEX_LOCK(item->sendLock);
+   pendingLen = adt_bytearray_length(&item->sendBuffer);
+   MUTEX_UNLOCK(item->sendLock);
+   CuAssertUIntEquals(tc, 0, pendingLen);
+   //nothing is written once the socket has been closed by the event loop
+   close(sv[1]);
+   for (elapsed=0; elapsed<WAIT_TIMEOUT_MS; elapsed+=WAIT_INTERVAL_MS)
+   {
+      if (testReceiver_getNumDisconnects(&receiver) == 1)
+      {
+         break;
+      }
+      SLEEP(WAIT_INTERVAL_MS);
+   }
+   CuAssertIntEquals(tc, 1, testReceiver_getNumDisconnects(&receiver));
+   CuAssertIntEquals(tc, -1, apx_eventLoopItem_send(item, chunk, sizeof(chunk)));
+   apx_eventLoop_destroy(&eventLoop);
+   apx_eventLoopItem_release(item);
+   close(sv[0]);
+   SPINLOCK_DESTROY(receiver.lock);
+}
+
+/**
+ * Called from the event loop thread
+ */
+static int8_t testReceiver_data(void *arg, const uint8_t *dataBuf, uint32_t dataLen, uint32_t *parseLen)
+{
+   testReceiver_t *self = (testReceiver_t*) arg;
+   uint32_t totalParseLen = 0;
+   while (totalParseLen < dataLen)
+   {
+      uint32_t msgLen = dataBuf[totalParseLen];
+      if (totalParseLen + 1 + msgLen > dataLen)
+      {
+         break;
+      }
+      SPINLOCK_ENTER(self->lock);
+      if (self->numMessages < NUM_MESSAGES)
+      {
+         self->messages[self->numMessages++] = dataBuf[totalParseLen + 1];
+      }
+      SPINLOCK_LEAVE(self->lock);
+      totalParseLen += 1 + msgLen;
+   }
+   *parseLen = totalParseLen;
+   return 0;
+}
+
+static void testReceiver_disconnected(void *arg)
+{
+   testReceiver_t *self = (testReceiver_t*) arg;
+   SPINLOCK_ENTER(self->lock);
+   self->numDisconnects++;
+   SPINLOCK_LEAVE(self->lock);
+}
+
+static uint32_t testReceiver_getNumMessages(testReceiver_t *self)
+{
+   uint32_t retval;
+   SPINLOCK_ENTER(self->lock);
+   retval = self->numMessages;
+   SPINLOCK_LEAVE(self->lock);
+   return retval;
+}
+
+static uint32_t testReceiver_getNumDisconnects(testReceiver_t *self)
+{
+   uint32_t retval;
+   SPINLOCK_ENTER(self->lock);
+   retval = self->numDisconnects;
+   SPINLOCK_LEAVE(self->lock);
+   return retval;
+}
+
+static void testReceiver_setup(testReceiver_t *self, msocket_handler_t *handlerTable)
+{
+   memset(self, 0, sizeof(testReceiver_t));
+   SPINLOCK_INIT(self->lock);
+   memset(handlerTable, 0, sizeof(msocket_handler_t));
+   handlerTable->tcp_data = testReceiver_data;
+   handlerTable->tcp_disconnected = testReceiver_disconnected;
+}
+#endif
@@ -0,0 +1,197 @@
+/*****************************************************************************
+* \file:    bstr_bench.c
+* \brief:   Measures the byte scanning functions of bstr in each scan mode
+*
+* Usage: bstr_bench [file.apx ...]
+* Without arguments a synthetic 2 MB APX definition is used.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bstr.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define SYNTHETIC_DEFINITION_SIZE (2u*1024u*1024u)
+#define MIN_BENCH_BYTES (256u*1024u*1024u) //each mode scans at least this much data
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static uint8_t *readFile(const char *path, size_t *len);
+static uint8_t *createSyntheticDefinition(size_t *len);
+static void runBenchmark(const char *name, const uint8_t *buf, size_t len);
+static size_t scanDefinition(const uint8_t *pBegin, const uint8_t *pEnd);
+static const char *getScanModeName(int mode);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+   int i;
+   if (argc < 2)
+   {
+      size_t len;
+      uint8_t *buf = createSyntheticDefinition(&len);
+      if (buf == 0)
+      {
+         return 1;
+      }
+      runBenchmark("synthetic", buf, len);
+      free(buf);
+   }
+   for (i=1; i<argc; i++)
+   {
+      size_t len;
+      uint8_t *buf = readFile(argv[i], &len);
+      if (buf == 0)
+      {
+         printf("Failed to read %s\n", argv[i]);
+         return 1;
+      }
+      runBenchmark(argv[i], buf, len);
+      free(buf);
+   }
+   return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static uint8_t *readFile(const char *path, size_t *len)
+{
+   uint8_t *buf = 0;
+   FILE *fh = fopen(path, "rb");
+   if (fh != 0)
+   {
+      long size;
+      fseek(fh, 0, SEEK_END);
+      size = ftell(fh);
+      fseek(fh, 0, SEEK_SET);
+      if (size > 0)
+      {
+         buf = (uint8_t*) malloc((size_t) size);
+         if ( (buf != 0) && (fread(buf, 1, (size_t) size, fh) != (size_t) size) )
+         {
+            free(buf);
+            buf = 0;
+         }
+         *len = (size_t) size;
+      }
+      fclose(fh);
+   }
+   return buf;
+}
+
+/**
+ * a gateway-like definition: record types and a large number of provide and require ports
+ */
+static uint8_t *createSyntheticDefinition(size_t *len)
+{
+   char *buf = (char*) malloc(SYNTHETIC_DEFINITION_SIZE + 256u);
+   if (buf != 0)
+   {
+      size_t pos = 0;
+      unsigned int i = 0;
+      pos += (size_t) sprintf(&buf[pos], "APX/1.2\nN\"GatewayNode\"\n");
+      pos += (size_t) sprintf(&buf[pos], "T\"VehicleStatus_T\"{\"Speed\"S\"Gear\"C(0,7)\"Odometer\"L\"Name\"a[16]}\n");
+      while (pos < SYNTHETIC_DEFINITION_SIZE)
+      {
+         if ( (i & 1u) == 0u )
+         {
+            pos += (size_t) sprintf(&buf[pos], "P\"SignalGroup%05u_VehicleStatus\"T[0]:={65535,7,0xFFFFFFFF,\"unknown\"}\n", i);
+         }
+         else
+         {
+            pos += (size_t) sprintf(&buf[pos], "R\"Signal%05u_WheelBasedVehicleSpeed\"S(0,65535):=65535\n", i);
+         }
+         i++;
+      }
+      *len = pos;
+   }
+   return (uint8_t*) buf;
+}
+
+static void runBenchmark(const char *name, const uint8_t *buf, size_t len)
+{
+   int maxMode = bstr_setScanMode(BSTR_SCAN_MODE_AVX2);
+   int mode;
+   double scalarTime = 0.0;
+   unsigned int numIterations = (unsigned int) (MIN_BENCH_BYTES / len) + 1u;
+   printf("%s: %u bytes, %u iterations\n", name, (unsigned int) len, numIterations);
+   for (mode = BSTR_SCAN_MODE_SCALAR; mode <= maxMode; mode++)
+   {
+      unsigned int i;
+      size_t numTokens = 0;
+      clock_t begin;
+      double elapsed;
+      bstr_setScanMode(mode);
+      begin = clock();
+      for (i=0; i<numIterations; i++)
+      {
+         numTokens += scanDefinition(buf, buf+len);
+      }
+      elapsed = (double) (clock() - begin) / CLOCKS_PER_SEC;
+      if (mode == BSTR_SCAN_MODE_SCALAR)
+      {
+         scalarTime = elapsed;
+      }
+      printf("   %-6s %8.1f MB/s  speed-up %.2fx  (%u tokens)\n", getScanModeName(mode),
+            ((double) len * numIterations) / (elapsed * 1024.0 * 1024.0), (elapsed > 0.0)? scalarTime / elapsed : 0.0, (unsigned int) numTokens);
+   }
+   bstr_setScanMode(BSTR_SCAN_MODE_AVX2);
+}
+
+/**
+ * the scanning done by apx_istream_write and apx_splitDeclarationLine: split into lines, match the quoted name, find the ':' before the attributes
+ */
+static size_t scanDefinition(const uint8_t *pBegin, const uint8_t *pEnd)
+{
+   size_t numTokens = 0;
+   const uint8_t *pNext = pBegin;
+   while (pNext < pEnd)
+   {
+      const uint8_t *pLineEnd = bstr_line(pNext, pEnd);
+      if ( (pLineEnd == pNext) && (*pNext != '\n') )
+      {
+         break;
+      }
+      if ( (pLineEnd - pNext) > 1)
+      {
+         const uint8_t *pResult = bstr_matchPair(pNext+1, pLineEnd, '"', '"', '\\');
+         if (pResult > pNext+1)
+         {
+            numTokens++;
+            pResult = bstr_searchVal(pResult+1, pLineEnd, ':');
+            if ( (pResult > pNext) && (*pResult == ':') )
+            {
+               numTokens++;
+            }
+         }
+      }
+      pNext = pLineEnd+1;
+   }
+   return numTokens;
+}
+
+static const char *getScanModeName(int mode)
+{
+   switch(mode)
+   {
+   case BSTR_SCAN_MODE_SCALAR:
+      return "scalar";
+   case BSTR_SCAN_MODE_SSE2:
+      return "sse2";
+   case BSTR_SCAN_MODE_AVX2:
+      return "avx2";
+   default:
+      return "?";
+   }
+}
@@ -12,6 +12,11 @@
 
 #include <stdint.h>
 
+//byte scanning implementations, see bstr_setScanMode
+#define BSTR_SCAN_MODE_SCALAR 0
+#define BSTR_SCAN_MODE_SSE2   1
+#define BSTR_SCAN_MODE_AVX2   2
+
 /***************** Public Function Declarations *******************/
 uint8_t *bstr_make(const uint8_t *pBegin, const uint8_t *pEnd);
 uint8_t *bstr_make_x(const uint8_t *pBegin, const uint8_t *pEnd, uint16_t startOffset, uint16_t endOffset);
@@ -27,4 +32,6 @@ const uint8_t *bstr_whilePredicate(const uint8_t *pBegin, const uint8_t *pEnd, i
 int bstr_pred_isHorizontalSpace(int c);
 int bstr_pred_isDigit(int c);
 int bstr_pred_isHexDigit(int c);
+int bstr_setScanMode(int mode);
+int bstr_getScanMode(void);
 #endif //BSTR_H
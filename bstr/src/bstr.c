@@ -5,17 +5,44 @@
 #include <stdio.h>
 #include <ctype.h>
 #include "bstr.h"
+#ifndef BSTR_DISABLE_SIMD
+# if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#  define BSTR_SSE2_SUPPORTED 1
+#  include <emmintrin.h>
+#  if defined(_MSC_VER)
+#   include <intrin.h>
+#  endif
+# endif
+# if defined(BSTR_SSE2_SUPPORTED) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+//AVX2 code is compiled with a target attribute and only called when the CPU supports it
+#  define BSTR_AVX2_SUPPORTED 1
+#  include <immintrin.h>
+# endif
+#endif
 
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
 #endif
 
+#define BSTR_SSE2_BLOCK_SIZE 16
+#define BSTR_AVX2_BLOCK_SIZE 32
 
 
 /**************** Private Function Declarations *******************/
+static const uint8_t *bstr_scanAny(const uint8_t *pBegin, const uint8_t *pEnd, uint8_t a, uint8_t b, uint8_t c);
+static const uint8_t *bstr_scanAny_scalar(const uint8_t *pBegin, const uint8_t *pEnd, uint8_t a, uint8_t b, uint8_t c);
+#ifdef BSTR_SSE2_SUPPORTED
+static const uint8_t *bstr_scanAny_sse2(const uint8_t *pBegin, const uint8_t *pEnd, uint8_t a, uint8_t b, uint8_t c);
+static uint32_t bstr_countTrailingZeros(uint32_t mask);
+#endif
+#ifdef BSTR_AVX2_SUPPORTED
+static const uint8_t *bstr_scanAny_avx2(const uint8_t *pBegin, const uint8_t *pEnd, uint8_t a, uint8_t b, uint8_t c);
+#endif
+static int bstr_getMaxScanMode(void);
 
 
 /**************** Private Variable Declarations *******************/
+static int m_scanMode = BSTR_SCAN_MODE_AVX2; //upper limit, the best mode supported by the build and the CPU is used
 const int ASCIIHexToInt[256] =
 {
     // ASCII
@@ -91,12 +118,10 @@ const uint8_t *bstr_searchVal(const uint8_t *pBegin, const uint8_t *pEnd, uint8_
    {
       return 0; //invalid arguments
    }
-   while(pNext < pEnd){
-      uint8_t c = *pNext;
-      if(c == val){
-         return pNext;
-      }
-      pNext++;
+   pNext = bstr_scanAny(pNext, pEnd, val, val, val);
+   if (pNext < pEnd)
+   {
+      return pNext;
    }
    return pBegin; //val was not found before pEnd was reached
 }
@@ -114,38 +139,43 @@ const uint8_t *bstr_matchPair(const uint8_t *pBegin, const uint8_t *pEnd, uint8_
       if (*pNext == left){
          pNext++;
          if (escapeChar != 0){
-            uint8_t isEscape = 0;
             while (pNext < pEnd){
-               uint8_t c = *pNext;
-               if (isEscape != 0){
-                  //ignore this char
-                  pNext++;
-                  isEscape = 0;
-                  continue;
+               uint8_t c;
+               //skip ahead to the next character that matters
+               pNext = bstr_scanAny(pNext, pEnd, left, right, escapeChar);
+               if (pNext == pEnd){
+                  break;
                }
-               else {
-                  if ( c == escapeChar ){
-                     isEscape = 1;
+               c = *pNext;
+               if ( c == escapeChar ){
+                  //ignore the next char
+                  if (++pNext == pEnd){
+                     break;
                   }
-                  else if (c == right){
-                     if (innerLevelCount == 0) {
-                        return pNext;
-                     }
-                     else {
-                        innerLevelCount--;
-                     }
+               }
+               else if (c == right){
+                  if (innerLevelCount == 0) {
+                     return pNext;
                   }
-                  else if ( c == left )
-                  {
-                     innerLevelCount++;
+                  else {
+                     innerLevelCount--;
                   }
                }
+               else if ( c == left )
+               {
+                  innerLevelCount++;
+               }
                pNext++;
             }
          }
          else{
             while (pNext < pEnd) {
-               uint8_t c = *pNext;
+               uint8_t c;
+               pNext = bstr_scanAny(pNext, pEnd, left, right, right);
+               if (pNext == pEnd){
+                  break;
+               }
+               c = *pNext;
                if (c == right){
                   if (innerLevelCount == 0) {
                      return pNext;
@@ -333,4 +363,161 @@ int bstr_pred_isHexDigit(int c)
    return ((c >= '0') && (c <= '9') ) || ((c >= 'a') && (c <= 'f')) || ((c >= 'A') && (c <= 'F'));
 }
 
+/**
+ * Selects how bytes are scanned by bstr_searchVal, bstr_line and bstr_matchPair. The best implementation that is
+ * supported by both the build and the CPU is used by default, a lower mode can be selected for comparison (e.g. benchmarks).
+ * Returns the mode that is in effect, which is lower than \par mode if \par mode is not supported.
+ */
+int bstr_setScanMode(int mode)
+{
+   if (mode < BSTR_SCAN_MODE_SCALAR)
+   {
+      mode = BSTR_SCAN_MODE_SCALAR;
+   }
+   m_scanMode = mode;
+   return bstr_getScanMode();
+}
+
+/**
+ * returns the byte scanning implementation in use (BSTR_SCAN_MODE_SCALAR, BSTR_SCAN_MODE_SSE2 or BSTR_SCAN_MODE_AVX2)
+ */
+int bstr_getScanMode(void)
+{
+   int maxMode = bstr_getMaxScanMode();
+   return (m_scanMode < maxMode)? m_scanMode : maxMode;
+}
+
 /***************** Private Function Definitions *******************/
+
+/**
+ * returns a pointer to the first byte in [pBegin, pEnd) that equals \par a, \par b or \par c, pEnd if there is none.
+ * Searching for one or two values is done by repeating a value.
+ */
+static const uint8_t *bstr_scanAny(const uint8_t *pBegin, const uint8_t *pEnd, uint8_t a, uint8_t b, uint8_t c)
+{
+#ifdef BSTR_SSE2_SUPPORTED
+   if ( (pEnd - pBegin) >= BSTR_SSE2_BLOCK_SIZE )
+   {
+      int mode = bstr_getScanMode();
+# ifdef BSTR_AVX2_SUPPORTED
+      if ( (mode >= BSTR_SCAN_MODE_AVX2) && ( (pEnd - pBegin) >= BSTR_AVX2_BLOCK_SIZE ) )
+      {
+         return bstr_scanAny_avx2(pBegin, pEnd, a, b, c);
+      }
+# endif
+      if (mode >= BSTR_SCAN_MODE_SSE2)
+      {
+         return bstr_scanAny_sse2(pBegin, pEnd, a, b, c);
+      }
+   }
+#endif
+   return bstr_scanAny_scalar(pBegin, pEnd, a, b, c);
+}
+
+static const uint8_t *bstr_scanAny_scalar(const uint8_t *pBegin, const uint8_t *pEnd, uint8_t a, uint8_t b, uint8_t c)
+{
+   const uint8_t *pNext = pBegin;
+   while (pNext < pEnd)
+   {
+      uint8_t v = *pNext;
+      if ( (v == a) || (v == b) || (v == c) )
+      {
+         break;
+      }
+      pNext++;
+   }
+   return pNext;
+}
+
+#ifdef BSTR_SSE2_SUPPORTED
+static const uint8_t *bstr_scanAny_sse2(const uint8_t *pBegin, const uint8_t *pEnd, uint8_t a, uint8_t b, uint8_t c)
+{
+   const uint8_t *pNext = pBegin;
+   const __m128i va = _mm_set1_epi8((char) a);
+   const __m128i vb = _mm_set1_epi8((char) b);
+   const __m128i vc = _mm_set1_epi8((char) c);
+   while ( (pEnd - pNext) >= BSTR_SSE2_BLOCK_SIZE )
+   {
+      __m128i data = _mm_loadu_si128((const __m128i*) pNext);
+      __m128i match = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(data, va), _mm_cmpeq_epi8(data, vb)), _mm_cmpeq_epi8(data, vc));
+      uint32_t mask = (uint32_t) _mm_movemask_epi8(match);
+      if (mask != 0u)
+      {
+         return pNext + bstr_countTrailingZeros(mask);
+      }
+      pNext += BSTR_SSE2_BLOCK_SIZE;
+   }
+   return bstr_scanAny_scalar(pNext, pEnd, a, b, c);
+}
+
+/**
+ * mask must not be 0
+ */
+static uint32_t bstr_countTrailingZeros(uint32_t mask)
+{
+#if defined(__GNUC__)
+   return (uint32_t) __builtin_ctz(mask);
+#elif defined(_MSC_VER)
+   unsigned long index;
+   _BitScanForward(&index, (unsigned long) mask);
+   return (uint32_t) index;
+#else
+   uint32_t count = 0u;
+   while ( (mask & 1u) == 0u )
+   {
+      mask >>= 1;
+      count++;
+   }
+   return count;
+#endif
+}
+#endif
+
+#ifdef BSTR_AVX2_SUPPORTED
+__attribute__((target("avx2")))
+static const uint8_t *bstr_scanAny_avx2(const uint8_t *pBegin, const uint8_t *pEnd, uint8_t a, uint8_t b, uint8_t c)
+{
+   const uint8_t *pNext = pBegin;
+   const __m256i va = _mm256_set1_epi8((char) a);
+   const __m256i vb = _mm256_set1_epi8((char) b);
+   const __m256i vc = _mm256_set1_epi8((char) c);
+   while ( (pEnd - pNext) >= BSTR_AVX2_BLOCK_SIZE )
+   {
+      __m256i data = _mm256_loadu_si256((const __m256i*) pNext);
+      __m256i match = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(data, va), _mm256_cmpeq_epi8(data, vb)), _mm256_cmpeq_epi8(data, vc));
+      uint32_t mask = (uint32_t) _mm256_movemask_epi8(match);
+      if (mask != 0u)
+      {
+         return pNext + bstr_countTrailingZeros(mask);
+      }
+      pNext += BSTR_AVX2_BLOCK_SIZE;
+   }
+   if ( (pEnd - pNext) >= BSTR_SSE2_BLOCK_SIZE )
+   {
+      //half a block is done here rather than in bstr_scanAny_sse2, calling non-VEX SSE code with dirty upper registers stalls the CPU
+      __m128i data = _mm_loadu_si128((const __m128i*) pNext);
+      __m128i match = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(data, _mm256_castsi256_si128(va)), _mm_cmpeq_epi8(data, _mm256_castsi256_si128(vb))), _mm_cmpeq_epi8(data, _mm256_castsi256_si128(vc)));
+      uint32_t mask = (uint32_t) _mm_movemask_epi8(match);
+      if (mask != 0u)
+      {
+         return pNext + bstr_countTrailingZeros(mask);
+      }
+      pNext += BSTR_SSE2_BLOCK_SIZE;
+   }
+   return bstr_scanAny_scalar(pNext, pEnd, a, b, c);
+}
+#endif
+
+/**
+ * the best scan mode supported by this build and CPU
+ */
+static int bstr_getMaxScanMode(void)
+{
+#if defined(BSTR_AVX2_SUPPORTED)
+   return __builtin_cpu_supports("avx2")? BSTR_SCAN_MODE_AVX2 : BSTR_SCAN_MODE_SSE2;
+#elif defined(BSTR_SSE2_SUPPORTED)
+   return BSTR_SCAN_MODE_SSE2;
+#else
+   return BSTR_SCAN_MODE_SCALAR;
+#endif
+}
@@ -24,6 +24,8 @@
 //////////////////////////////////////////////////////////////////////////////
 static void test_bstr_toUnsignedLong_base10(CuTest* tc);
 static void test_bstr_toUnsignedLong_base16(CuTest* tc);
+static void test_bstr_searchVal_allScanModes(CuTest* tc);
+static void test_bstr_matchPair_allScanModes(CuTest* tc);
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL VARIABLES
@@ -45,6 +47,8 @@ CuSuite* testsuite_bstr(void)
 
    SUITE_ADD_TEST(suite, test_bstr_toUnsignedLong_base10);
    SUITE_ADD_TEST(suite, test_bstr_toUnsignedLong_base16);
+   SUITE_ADD_TEST(suite, test_bstr_searchVal_allScanModes);
+   SUITE_ADD_TEST(suite, test_bstr_matchPair_allScanModes);
 
    return suite;
 }
@@ -116,3 +120,61 @@ static void test_bstr_toUnsignedLong_base16(CuTest* tc)
    CuAssertUIntEquals(tc, 4294967295UL, value);
 
 }
+
+/**
+ * every position of the value relative to the 16 and 32 byte blocks of the SIMD implementations
+ */
+static void test_bstr_searchVal_allScanModes(CuTest* tc)
+{
+   uint8_t buf[100];
+   int mode;
+   int maxMode = bstr_setScanMode(BSTR_SCAN_MODE_AVX2);
+   for (mode = BSTR_SCAN_MODE_SCALAR; mode <= maxMode; mode++)
+   {
+      uint32_t start;
+      CuAssertIntEquals(tc, mode, bstr_setScanMode(mode));
+      for (start = 0; start < 4; start++)
+      {
+         uint32_t pos;
+         memset(buf, 'a', sizeof(buf));
+         CuAssertConstPtrEquals(tc, &buf[start], bstr_searchVal(&buf[start], &buf[sizeof(buf)], '\n'));
+         for (pos = start; pos < sizeof(buf); pos++)
+         {
+            buf[pos] = '\n';
+            CuAssertConstPtrEquals(tc, &buf[pos], bstr_searchVal(&buf[start], &buf[sizeof(buf)], '\n'));
+            CuAssertConstPtrEquals(tc, &buf[pos], bstr_line(&buf[start], &buf[sizeof(buf)]));
+            //the value just outside the range must not be found
+            CuAssertConstPtrEquals(tc, &buf[start], bstr_searchVal(&buf[start], &buf[pos], '\n'));
+            buf[pos] = 'a';
+         }
+      }
+   }
+   bstr_setScanMode(BSTR_SCAN_MODE_AVX2);
+}
+
+static void test_bstr_matchPair_allScanModes(CuTest* tc)
+{
+   const char *quoted = "\"a long string with an escaped \\\" quote that spans several SIMD blocks\" rest";
+   const char *nested = "{\"a\"S\"b\"{\"c\"C\"d\"{\"e\"L\"f\"L}\"g\"a[32]}\"h\"{\"i\"C}\"j\"S} rest";
+   const char *unterminated = "\"an unterminated string that is longer than one AVX2 block\\";
+   int mode;
+   int maxMode = bstr_setScanMode(BSTR_SCAN_MODE_AVX2);
+   for (mode = BSTR_SCAN_MODE_SCALAR; mode <= maxMode; mode++)
+   {
+      const uint8_t *pBegin;
+      const uint8_t *pEnd;
+      bstr_setScanMode(mode);
+      pBegin = (const uint8_t*) quoted;
+      pEnd = pBegin + strlen(quoted);
+      CuAssertConstPtrEquals(tc, pEnd - 6, bstr_matchPair(pBegin, pEnd, '"', '"', '\\'));
+      pBegin = (const uint8_t*) nested;
+      pEnd = pBegin + strlen(nested);
+      CuAssertConstPtrEquals(tc, pEnd - 6, bstr_matchPair(pBegin, pEnd, '{', '}', 0));
+      CuAssertConstPtrEquals(tc, pEnd - 6, bstr_matchPair(pBegin, pEnd, '{', '}', '\\'));
+      pBegin = (const uint8_t*) unterminated;
+      pEnd = pBegin + strlen(unterminated);
+      CuAssertConstPtrEquals(tc, pBegin, bstr_matchPair(pBegin, pEnd, '"', '"', '\\'));
+      CuAssertConstPtrEquals(tc, 0, bstr_matchPair(pBegin + 1, pEnd, '"', '"', '\\'));
+   }
+   bstr_setScanMode(BSTR_SCAN_MODE_AVX2);
+}
@@ -63,6 +63,8 @@
 #define RMF_GREETING_MAX_LEN 127
 #define RMF_GREETING_START "RMFP/1.0\n"
 #define RMF_NUMHEADER_FORMAT "NumHeader-Format:"
+#define RMF_SESSION_TOKEN_HEADER "Session-Token:" //optional greeting header, lets the server resume the nodes of a client that reconnects
+#define RMF_SESSION_TOKEN_MAX_LEN 64
 
 #define RMF_INVALID_ADDRESS (uint32_t) (0xFFFFFFFF)
 /**
@@ -470,7 +470,7 @@ void rmf_fileInfo_vdelete(void *arg)
  */
 int8_t rmf_fileInfo_setDigestData(rmf_fileInfo_t *info, uint16_t digestType, const uint8_t *digestData, uint32_t digestDataLen)
 {
-   if ( (info != 0) && (digestType <= RMF_FILE_TYPE_STREAM) && (digestData != 0) && ( (digestDataLen == 0) || (digestDataLen == RMF_DIGEST_SIZE) ) )
+   if ( (info != 0) && (digestType <= RMF_DIGEST_TYPE_SHA256) && (digestData != 0) && ( (digestDataLen == 0) || (digestDataLen == RMF_DIGEST_SIZE) ) )
    {
       info->digestType = digestType;
       memcpy(info->digestData, digestData, RMF_DIGEST_SIZE);
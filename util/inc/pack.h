@@ -41,6 +41,10 @@ void packBE(_UINT8* p, _PACK_BASE_TYPE value, _UINT8 u8Size);
 void packLE(_UINT8* p, _PACK_BASE_TYPE value, _UINT8 u8Size);
 _PACK_BASE_TYPE unpackBE(const _UINT8* p, _UINT8 u8Size);
 _PACK_BASE_TYPE unpackLE(const _UINT8* p, _UINT8 u8Size);
+void packArrayBE(_UINT8* p, const void *values, _UINT8 u8Size, _UINT32 count);
+void packArrayLE(_UINT8* p, const void *values, _UINT8 u8Size, _UINT32 count);
+void unpackArrayBE(void *values, const _UINT8* p, _UINT8 u8Size, _UINT32 count);
+void unpackArrayLE(void *values, const _UINT8* p, _UINT8 u8Size, _UINT32 count);
 
 #undef _UINT8
 #undef _UINT32
@@ -1,5 +1,6 @@
 
 /********************************* Includes **********************************/
+#include <string.h>
 #include "pack.h"
 #ifdef USE_PLATFORM_TYPES
 #include "Platform_Types.h"
@@ -19,12 +20,24 @@
 #define _PACK_BASE_TYPE _UINT32
 #endif
 
+#if !defined(PACK_DISABLE_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+//SSSE3 code is compiled with a target attribute and only called when the CPU supports it
+#define PACK_SSSE3_SUPPORTED 1
+#include <tmmintrin.h>
+#endif
+
 
 /**************************** Constants and Types ****************************/
+#define PACK_SIMD_BLOCK_SIZE 16
 
 /********************************* Variables *********************************/
 
 /************************* Local Function Prototypes *************************/
+static int isLittleEndianHost(void);
+static void convertArray(_UINT8 *pDest, const _UINT8 *pSrc, _UINT8 u8Size, _UINT32 count, int swap);
+#ifdef PACK_SSSE3_SUPPORTED
+static _UINT32 swapArray_ssse3(_UINT8 *pDest, const _UINT8 *pSrc, _UINT8 u8Size, _UINT32 numBytes);
+#endif
 
 /***************************** Exported Functions ****************************/
 void packBE(_UINT8* p, _PACK_BASE_TYPE value, _UINT8 u8Size)
@@ -90,6 +103,102 @@ _PACK_BASE_TYPE unpackLE(const _UINT8* p, _UINT8 u8Size)
    return 0;
 }
 
+/**
+ * Packs count native integers of u8Size bytes (1, 2, 4 or 8) from values into p as big-endian.
+ * values and p must not overlap.
+ */
+void packArrayBE(_UINT8* p, const void *values, _UINT8 u8Size, _UINT32 count)
+{
+   convertArray(p, (const _UINT8*) values, u8Size, count, isLittleEndianHost());
+}
+
+/**
+ * Packs count native integers of u8Size bytes (1, 2, 4 or 8) from values into p as little-endian.
+ * On little-endian hosts this is a plain memcpy. values and p must not overlap.
+ */
+void packArrayLE(_UINT8* p, const void *values, _UINT8 u8Size, _UINT32 count)
+{
+   convertArray(p, (const _UINT8*) values, u8Size, count, !isLittleEndianHost());
+}
+
+void unpackArrayBE(void *values, const _UINT8* p, _UINT8 u8Size, _UINT32 count)
+{
+   convertArray((_UINT8*) values, p, u8Size, count, isLittleEndianHost());
+}
+
+void unpackArrayLE(void *values, const _UINT8* p, _UINT8 u8Size, _UINT32 count)
+{
+   convertArray((_UINT8*) values, p, u8Size, count, !isLittleEndianHost());
+}
+
 
 /****************************** Local Functions ******************************/
+static int isLittleEndianHost(void)
+{
+   const _UINT32 value = 1u;
+   return (*((const _UINT8*) &value) == 1u)? 1 : 0;
+}
+
+/**
+ * copies count values of u8Size bytes from pSrc to pDest, reversing the byte order of each value when swap is set
+ */
+static void convertArray(_UINT8 *pDest, const _UINT8 *pSrc, _UINT8 u8Size, _UINT32 count, int swap)
+{
+   _UINT32 numBytes;
+   _UINT32 i = 0;
+   if ( (u8Size != 1) && (u8Size != 2) && (u8Size != 4) && (u8Size != 8) )
+   {
+      return;
+   }
+   numBytes = (_UINT32) u8Size * count;
+   if ( (swap == 0) || (u8Size == 1) )
+   {
+      memcpy(pDest, pSrc, numBytes);
+      return;
+   }
+#ifdef PACK_SSSE3_SUPPORTED
+   if ( (numBytes >= PACK_SIMD_BLOCK_SIZE) && __builtin_cpu_supports("ssse3") )
+   {
+      i = swapArray_ssse3(pDest, pSrc, u8Size, numBytes);
+   }
+#endif
+   for (; i < numBytes; i += u8Size)
+   {
+      _UINT8 j;
+      for (j = 0; j < u8Size; j++)
+      {
+         pDest[i + j] = pSrc[i + u8Size - 1u - j];
+      }
+   }
+}
+
+#ifdef PACK_SSSE3_SUPPORTED
+/**
+ * byte-swaps 16 bytes (8, 4 or 2 values) per step with one shuffle, returns the number of bytes done
+ */
+__attribute__((target("ssse3")))
+static _UINT32 swapArray_ssse3(_UINT8 *pDest, const _UINT8 *pSrc, _UINT8 u8Size, _UINT32 numBytes)
+{
+   __m128i mask;
+   _UINT32 i;
+   switch(u8Size)
+   {
+   case 2:
+      mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+      break;
+   case 4:
+      mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+      break;
+   default:
+      mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+      break;
+   }
+   for (i = 0; (i + PACK_SIMD_BLOCK_SIZE) <= numBytes; i += PACK_SIMD_BLOCK_SIZE)
+   {
+      __m128i value = _mm_loadu_si128((const __m128i*) (pSrc + i));
+      _mm_storeu_si128((__m128i*) (pDest + i), _mm_shuffle_epi8(value, mask));
+   }
+   return i;
+}
+#endif
 
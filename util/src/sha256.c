@@ -0,0 +1,208 @@
+/*****************************************************************************
+* \file      sha256.c
+* \author    Conny Gustafsson
+* \date      2026-10-17
+* \brief     SHA-256 message digest (FIPS 180-4)
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include "sha256.h"
+#include "pack.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define ROTR(x,n) (((x) >> (n)) | ((x) << (32u-(n))))
+#define CH(x,y,z)  (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x,y,z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define EP0(x) (ROTR(x,2) ^ ROTR(x,13) ^ ROTR(x,22))
+#define EP1(x) (ROTR(x,6) ^ ROTR(x,11) ^ ROTR(x,25))
+#define SIG0(x) (ROTR(x,7) ^ ROTR(x,18) ^ ((x) >> 3))
+#define SIG1(x) (ROTR(x,17) ^ ROTR(x,19) ^ ((x) >> 10))
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void sha256_transform(sha256_ctx_t *ctx, const uint8_t *block);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static const uint32_t m_k[64] =
+{
+   0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul, 0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+   0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul, 0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+   0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul, 0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+   0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul, 0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+   0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul, 0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+   0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul, 0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+   0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul, 0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+   0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul, 0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+void sha256_init(sha256_ctx_t *ctx)
+{
+   if (ctx != 0)
+   {
+      ctx->state[0] = 0x6a09e667ul;
+      ctx->state[1] = 0xbb67ae85ul;
+      ctx->state[2] = 0x3c6ef372ul;
+      ctx->state[3] = 0xa54ff53aul;
+      ctx->state[4] = 0x510e527ful;
+      ctx->state[5] = 0x9b05688cul;
+      ctx->state[6] = 0x1f83d9abul;
+      ctx->state[7] = 0x5be0cd19ul;
+      ctx->totalLen = 0u;
+      ctx->bufLen = 0u;
+   }
+}
+
+void sha256_update(sha256_ctx_t *ctx, const uint8_t *data, uint32_t dataLen)
+{
+   if ( (ctx == 0) || ( (data == 0) && (dataLen > 0u) ) )
+   {
+      return;
+   }
+   ctx->totalLen += dataLen;
+   if (ctx->bufLen > 0u)
+   {
+      uint32_t fill = SHA256_BLOCK_SIZE - ctx->bufLen;
+      if (fill > dataLen)
+      {
+         fill = dataLen;
+      }
+      memcpy(&ctx->buf[ctx->bufLen], data, fill);
+      ctx->bufLen += fill;
+      data += fill;
+      dataLen -= fill;
+      if (ctx->bufLen < SHA256_BLOCK_SIZE)
+      {
+         return;
+      }
+      sha256_transform(ctx, &ctx->buf[0]);
+      ctx->bufLen = 0u;
+   }
+   //full blocks are processed directly from the caller's buffer
+   while (dataLen >= SHA256_BLOCK_SIZE)
+   {
+      sha256_transform(ctx, data);
+      data += SHA256_BLOCK_SIZE;
+      dataLen -= SHA256_BLOCK_SIZE;
+   }
+   if (dataLen > 0u)
+   {
+      memcpy(&ctx->buf[0], data, dataLen);
+      ctx->bufLen = dataLen;
+   }
+}
+
+/**
+ * Writes SHA256_DIGEST_SIZE bytes into digest. The context must be re-initialized before it can be reused.
+ */
+void sha256_final(sha256_ctx_t *ctx, uint8_t *digest)
+{
+   uint64_t bitLen;
+   int32_t i;
+   if ( (ctx == 0) || (digest == 0) )
+   {
+      return;
+   }
+   bitLen = ctx->totalLen << 3;
+   ctx->buf[ctx->bufLen++] = 0x80;
+   if (ctx->bufLen > (SHA256_BLOCK_SIZE - 8u))
+   {
+      memset(&ctx->buf[ctx->bufLen], 0, SHA256_BLOCK_SIZE - ctx->bufLen);
+      sha256_transform(ctx, &ctx->buf[0]);
+      ctx->bufLen = 0u;
+   }
+   memset(&ctx->buf[ctx->bufLen], 0, (SHA256_BLOCK_SIZE - 8u) - ctx->bufLen);
+   packBE(&ctx->buf[SHA256_BLOCK_SIZE - 8u], (uint32_t) (bitLen >> 32), 4);
+   packBE(&ctx->buf[SHA256_BLOCK_SIZE - 4u], (uint32_t) bitLen, 4);
+   sha256_transform(ctx, &ctx->buf[0]);
+   for (i = 0; i < 8; i++)
+   {
+      packBE(&digest[i*4], ctx->state[i], 4);
+   }
+}
+
+void sha256_calc(const uint8_t *data, uint32_t dataLen, uint8_t *digest)
+{
+   sha256_ctx_t ctx;
+   sha256_init(&ctx);
+   sha256_update(&ctx, data, dataLen);
+   sha256_final(&ctx, digest);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void sha256_transform(sha256_ctx_t *ctx, const uint8_t *block)
+{
+   uint32_t w[64];
+   uint32_t a, b, c, d, e, f, g, h;
+   int32_t i;
+   for (i = 0; i < 16; i++)
+   {
+      w[i] = (uint32_t) unpackBE(&block[i*4], 4);
+   }
+   for (i = 16; i < 64; i++)
+   {
+      w[i] = SIG1(w[i-2]) + w[i-7] + SIG0(w[i-15]) + w[i-16];
+   }
+   a = ctx->state[0];
+   b = ctx->state[1];
+   c = ctx->state[2];
+   d = ctx->state[3];
+   e = ctx->state[4];
+   f = ctx->state[5];
+   g = ctx->state[6];
+   h = ctx->state[7];
+   for (i = 0; i < 64; i++)
+   {
+      uint32_t t1 = h + EP1(e) + CH(e,f,g) + m_k[i] + w[i];
+      uint32_t t2 = EP0(a) + MAJ(a,b,c);
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+   }
+   ctx->state[0] += a;
+   ctx->state[1] += b;
+   ctx->state[2] += c;
+   ctx->state[3] += d;
+   ctx->state[4] += e;
+   ctx->state[5] += f;
+   ctx->state[6] += g;
+   ctx->state[7] += h;
+}
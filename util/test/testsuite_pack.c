@@ -0,0 +1,159 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "CuTest.h"
+#include "pack.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define NUM_VALUES 37 //not a multiple of the 16 byte SIMD block
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_packArray_u8(CuTest* tc);
+static void test_packArray_u16(CuTest* tc);
+static void test_packArray_u32(CuTest* tc);
+static void test_packArray_u64(CuTest* tc);
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GLOBAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+
+CuSuite* testsuite_pack(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_packArray_u8);
+   SUITE_ADD_TEST(suite, test_packArray_u16);
+   SUITE_ADD_TEST(suite, test_packArray_u32);
+   SUITE_ADD_TEST(suite, test_packArray_u64);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_packArray_u8(CuTest* tc)
+{
+   uint8_t values[NUM_VALUES];
+   uint8_t result[NUM_VALUES];
+   uint8_t buf[NUM_VALUES];
+   int i;
+   for (i = 0; i < NUM_VALUES; i++)
+   {
+      values[i] = (uint8_t) (i * 7);
+   }
+   packArrayBE(buf, values, 1, NUM_VALUES);
+   CuAssertIntEquals(tc, 0, memcmp(buf, values, NUM_VALUES));
+   memset(result, 0, sizeof(result));
+   unpackArrayLE(result, buf, 1, NUM_VALUES);
+   CuAssertIntEquals(tc, 0, memcmp(result, values, NUM_VALUES));
+}
+
+static void test_packArray_u16(CuTest* tc)
+{
+   uint16_t values[NUM_VALUES];
+   uint16_t result[NUM_VALUES];
+   uint8_t buf[NUM_VALUES*2];
+   int i;
+   for (i = 0; i < NUM_VALUES; i++)
+   {
+      values[i] = (uint16_t) (0x1234 + i * 0x0101);
+   }
+   packArrayLE(buf, values, 2, NUM_VALUES);
+   for (i = 0; i < NUM_VALUES; i++)
+   {
+      CuAssertUIntEquals(tc, values[i], (uint16_t) unpackLE(&buf[i*2], 2));
+   }
+   memset(result, 0, sizeof(result));
+   unpackArrayLE(result, buf, 2, NUM_VALUES);
+   CuAssertIntEquals(tc, 0, memcmp(result, values, sizeof(values)));
+
+   packArrayBE(buf, values, 2, NUM_VALUES);
+   for (i = 0; i < NUM_VALUES; i++)
+   {
+      CuAssertUIntEquals(tc, values[i], (uint16_t) unpackBE(&buf[i*2], 2));
+   }
+   memset(result, 0, sizeof(result));
+   unpackArrayBE(result, buf, 2, NUM_VALUES);
+   CuAssertIntEquals(tc, 0, memcmp(result, values, sizeof(values)));
+}
+
+static void test_packArray_u32(CuTest* tc)
+{
+   uint32_t values[NUM_VALUES];
+   uint32_t result[NUM_VALUES];
+   uint8_t buf[NUM_VALUES*4];
+   int i;
+   for (i = 0; i < NUM_VALUES; i++)
+   {
+      values[i] = 0x12345678u + (uint32_t) i * 0x01010101u;
+   }
+   packArrayLE(buf, values, 4, NUM_VALUES);
+   for (i = 0; i < NUM_VALUES; i++)
+   {
+      CuAssertUIntEquals(tc, values[i], (uint32_t) unpackLE(&buf[i*4], 4));
+   }
+   memset(result, 0, sizeof(result));
+   unpackArrayLE(result, buf, 4, NUM_VALUES);
+   CuAssertIntEquals(tc, 0, memcmp(result, values, sizeof(values)));
+
+   packArrayBE(buf, values, 4, NUM_VALUES);
+   for (i = 0; i < NUM_VALUES; i++)
+   {
+      CuAssertUIntEquals(tc, values[i], (uint32_t) unpackBE(&buf[i*4], 4));
+   }
+   memset(result, 0, sizeof(result));
+   unpackArrayBE(result, buf, 4, NUM_VALUES);
+   CuAssertIntEquals(tc, 0, memcmp(result, values, sizeof(values)));
+}
+
+static void test_packArray_u64(CuTest* tc)
+{
+   uint64_t values[NUM_VALUES];
+   uint64_t result[NUM_VALUES];
+   uint8_t buf[NUM_VALUES*8];
+   int i;
+   for (i = 0; i < NUM_VALUES; i++)
+   {
+      values[i] = 0x0102030405060708ull + (uint64_t) i * 0x1010101010101010ull;
+   }
+   packArrayLE(buf, values, 8, NUM_VALUES);
+   for (i = 0; i < NUM_VALUES; i++)
+   {
+      CuAssertIntEquals(tc, (uint8_t) values[i], buf[i*8]);
+      CuAssertIntEquals(tc, (uint8_t) (values[i] >> 56), buf[i*8+7]);
+   }
+   packArrayBE(buf, values, 8, NUM_VALUES);
+   for (i = 0; i < NUM_VALUES; i++)
+   {
+      CuAssertIntEquals(tc, (uint8_t) (values[i] >> 56), buf[i*8]);
+      CuAssertIntEquals(tc, (uint8_t) values[i], buf[i*8+7]);
+   }
+   memset(result, 0, sizeof(result));
+   unpackArrayBE(result, buf, 8, NUM_VALUES);
+   CuAssertIntEquals(tc, 0, memcmp(result, values, sizeof(values)));
+}
@@ -0,0 +1,122 @@
+/*****************************************************************************
+* \file      testsuite_sha256.c
+* \author    Conny Gustafsson
+* \date      2026-10-17
+* \brief     Unit tests for sha256
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include <stdlib.h>
+#include "CuTest.h"
+#include "sha256.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_sha256_empty(CuTest* tc);
+static void test_sha256_abc(CuTest* tc);
+static void test_sha256_twoBlocks(CuTest* tc);
+static void test_sha256_incrementalUpdate(CuTest* tc);
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+CuSuite* testsuite_sha256(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_sha256_empty);
+   SUITE_ADD_TEST(suite, test_sha256_abc);
+   SUITE_ADD_TEST(suite, test_sha256_twoBlocks);
+   SUITE_ADD_TEST(suite, test_sha256_incrementalUpdate);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void test_sha256_empty(CuTest* tc)
+{
+   const uint8_t expected[SHA256_DIGEST_SIZE] = {
+      0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+      0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55
+   };
+   uint8_t digest[SHA256_DIGEST_SIZE];
+   sha256_calc((const uint8_t*) "", 0, &digest[0]);
+   CuAssertIntEquals(tc, 0, memcmp(&expected[0], &digest[0], SHA256_DIGEST_SIZE));
+}
+
+static void test_sha256_abc(CuTest* tc)
+{
+   const uint8_t expected[SHA256_DIGEST_SIZE] = {
+      0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+      0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+   };
+   uint8_t digest[SHA256_DIGEST_SIZE];
+   sha256_calc((const uint8_t*) "abc", 3, &digest[0]);
+   CuAssertIntEquals(tc, 0, memcmp(&expected[0], &digest[0], SHA256_DIGEST_SIZE));
+}
+
+static void test_sha256_twoBlocks(CuTest* tc)
+{
+   const char *msg = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+   const uint8_t expected[SHA256_DIGEST_SIZE] = {
+      0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+      0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1
+   };
+   uint8_t digest[SHA256_DIGEST_SIZE];
+   sha256_calc((const uint8_t*) msg, (uint32_t) strlen(msg), &digest[0]);
+   CuAssertIntEquals(tc, 0, memcmp(&expected[0], &digest[0], SHA256_DIGEST_SIZE));
+}
+
+/**
+ * One million 'a' fed in uneven pieces so that the internal block buffer is exercised
+ */
+static void test_sha256_incrementalUpdate(CuTest* tc)
+{
+   const uint8_t expected[SHA256_DIGEST_SIZE] = {
+      0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+      0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+   };
+   uint8_t digest[SHA256_DIGEST_SIZE];
+   uint8_t chunk[1000];
+   sha256_ctx_t ctx;
+   uint32_t remain = 1000000u;
+   uint32_t step = 1u;
+   memset(&chunk[0], 'a', sizeof(chunk));
+   sha256_init(&ctx);
+   while (remain > 0u)
+   {
+      uint32_t len = (step < remain)? step : remain;
+      sha256_update(&ctx, &chunk[0], len);
+      remain -= len;
+      step = (step * 7u + 3u) % (uint32_t) sizeof(chunk) + 1u;
+   }
+   sha256_final(&ctx, &digest[0]);
+   CuAssertIntEquals(tc, 0, memcmp(&expected[0], &digest[0], SHA256_DIGEST_SIZE));
+}